@@ -0,0 +1,331 @@
+/**
+ * @file FixBenchmark.cpp
+ * @brief Throughput of the FIX parser and of a loopback FIX session
+ *
+ * 1. Parser: parses and maps a stream of pre-encoded NewOrderSingle,
+ *    OrderCancelRequest and OrderCancelReplaceRequest messages on one
+ *    core, reporting messages per second.
+ * 2. Session: a client logs on to a FixSession served over a TCP
+ *    loopback connection and streams orders in pipelined windows; every
+ *    request must be answered by an ExecutionReport or OrderCancelReject.
+ *
+ * Usage: FixBenchmark [parser messages] [session messages] [window]
+ */
+
+#include "FixSession.hpp"
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    /**
+     * @brief Encodes the i-th request of the benchmark flow
+     *
+     * Three new orders around 150.00 for one cancel and one replace of
+     * earlier orders, as in an active market maker's flow.
+     */
+    std::string_view encodeRequest(FixWriter& writer, int i, std::uint32_t seqNum,
+                                   std::chrono::system_clock::time_point now)
+    {
+        int idorder = i + 1;
+        switch (i % 5)
+        {
+        case 3:
+            writer.begin("F", seqNum, "CLIENT", "ENGINE", now);
+            writer.add(FixTag::CL_ORD_ID, idorder);
+            writer.add(FixTag::ORIG_CL_ORD_ID, idorder - 3);
+            writer.add(FixTag::SECURITY_ID, 1);
+            writer.add(FixTag::SECURITY_EXCHANGE, std::string_view("XPAR"));
+            writer.add(FixTag::CURRENCY, std::string_view("EUR"));
+            writer.add(FixTag::SIDE, '1');
+            break;
+        case 4:
+            writer.begin("G", seqNum, "CLIENT", "ENGINE", now);
+            writer.add(FixTag::CL_ORD_ID, idorder);
+            writer.add(FixTag::ORIG_CL_ORD_ID, idorder - 3);
+            writer.add(FixTag::SECURITY_ID, 1);
+            writer.add(FixTag::SECURITY_EXCHANGE, std::string_view("XPAR"));
+            writer.add(FixTag::CURRENCY, std::string_view("EUR"));
+            writer.add(FixTag::SIDE, '2');
+            writer.add(FixTag::ORDER_QTY, 100);
+            writer.add(FixTag::ORD_TYPE, '2');
+            writer.addDecimal(FixTag::PRICE, 150.05);
+            break;
+        default:
+        {
+            bool buy = i % 2 == 0;
+            writer.begin("D", seqNum, "CLIENT", "ENGINE", now);
+            writer.add(FixTag::CL_ORD_ID, idorder);
+            writer.add(FixTag::SECURITY_ID, 1);
+            writer.add(FixTag::SECURITY_EXCHANGE, std::string_view("XPAR"));
+            writer.add(FixTag::CURRENCY, std::string_view("EUR"));
+            writer.add(FixTag::SIDE, buy ? '1' : '2');
+            writer.add(FixTag::ORDER_QTY, 100 * (1 + i % 3));
+            writer.add(FixTag::ORD_TYPE, '2');
+            writer.addDecimal(FixTag::PRICE, buy ? 149.99 - (i % 7) * 0.01 : 150.01 + (i % 7) * 0.01);
+            writer.add(FixTag::TIME_IN_FORCE, '0');
+            break;
+        }
+        }
+        return writer.finish();
+    }
+
+    /**
+     * @brief Parses and maps a pre-encoded flow repeatedly on the calling thread
+     *
+     * @param messages Number of messages to process
+     * @return bool True if every message parsed and mapped
+     */
+    bool benchmarkParser(long long messages)
+    {
+        constexpr int DISTINCT = 4096;
+        FixWriter writer;
+        std::vector<char> stream;
+        auto now = std::chrono::system_clock::now();
+        for (int i = 0; i < DISTINCT; ++i)
+        {
+            std::string_view message = encodeRequest(writer, i + 5, static_cast<std::uint32_t>(i + 1), now);
+            stream.insert(stream.end(), message.begin(), message.end());
+        }
+
+        FixMessage message;
+        Order order;
+        FixOrderChange change;
+        long long processed = 0;
+        long long mapped = 0;
+        auto start = std::chrono::steady_clock::now();
+        while (processed < messages)
+        {
+            std::size_t offset = 0;
+            while (offset < stream.size() && processed < messages)
+            {
+                std::size_t consumed;
+                if (parseFixMessage(stream.data() + offset, stream.size() - offset, message, consumed) !=
+                    DecodeStatus::OK)
+                {
+                    std::cerr << "Parser benchmark: message " << processed << " failed to parse" << std::endl;
+                    return false;
+                }
+                offset += consumed;
+                processed++;
+                if (message.getMsgType() == "D")
+                {
+                    mapped += fixToOrder(message, 1, now, order);
+                }
+                else
+                {
+                    mapped += fixToOrderChange(message, change);
+                }
+            }
+        }
+        double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        std::cout << "Parser: " << processed << " messages (" << stream.size() / DISTINCT
+            << " bytes average) in " << elapsed << " s, "
+            << static_cast<long long>(processed / elapsed) << " messages/s on one core\n";
+        return mapped == processed;
+    }
+
+    /**
+     * @brief Serves one FIX session on an accepted socket until the client leaves
+     */
+    void serveSession(int fd, MatchingEngine& engine, FixSessionStats& stats)
+    {
+        FixSession session(engine, "ENGINE", "CLIENT", 1);
+        std::vector<char> input(256 * 1024);
+        std::size_t received = 0;
+        while (true)
+        {
+            ssize_t count = read(fd, input.data() + received, input.size() - received);
+            if (count <= 0)
+            {
+                break;
+            }
+            received += static_cast<std::size_t>(count);
+            std::size_t consumed = session.onData(input.data(), received, std::chrono::system_clock::now());
+            std::memmove(input.data(), input.data() + consumed, received - consumed);
+            received -= consumed;
+
+            std::string_view output = session.getOutput();
+            std::size_t written = 0;
+            while (written < output.size())
+            {
+                ssize_t result = write(fd, output.data() + written, output.size() - written);
+                if (result <= 0)
+                {
+                    break;
+                }
+                written += static_cast<std::size_t>(result);
+            }
+            session.consumeOutput(written);
+            if (session.isClosed())
+            {
+                break;
+            }
+        }
+        stats = session.getStats();
+        close(fd);
+    }
+
+    /**
+     * @brief Client side: reads and counts a number of FIX responses
+     */
+    bool readResponses(int fd, std::vector<char>& buffer, std::size_t& size, int count, int& reports)
+    {
+        FixMessage message;
+        while (count > 0)
+        {
+            std::size_t consumed;
+            DecodeStatus status = parseFixMessage(buffer.data(), size, message, consumed);
+            if (status == DecodeStatus::INCOMPLETE)
+            {
+                ssize_t received = read(fd, buffer.data() + size, buffer.size() - size);
+                if (received <= 0)
+                {
+                    return false;
+                }
+                size += static_cast<std::size_t>(received);
+                continue;
+            }
+            if (status != DecodeStatus::OK)
+            {
+                return false;
+            }
+            std::string_view msgType = message.getMsgType();
+            if (msgType == "8" || msgType == "9" || msgType == "A")
+            {
+                reports += msgType != "A";
+                count--;
+            }
+            else if (msgType == "5" || msgType == "3")
+            {
+                std::cerr << "Session benchmark: unexpected " << (msgType == "5" ? "Logout: " : "Reject: ")
+                    << message.getString(FixTag::TEXT) << std::endl;
+                return false;
+            }
+            std::memmove(buffer.data(), buffer.data() + consumed, size - consumed);
+            size -= consumed;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Streams requests through a FIX session over TCP loopback
+     *
+     * @param messages Number of requests
+     * @param window Requests sent before waiting for their responses
+     * @param report Destination of the results
+     * @return bool True if every request was answered
+     */
+    bool benchmarkSession(int messages, int window, std::ostream& report)
+    {
+        InstrumentManager instrumentManager;
+        instrumentManager.addInstrument(Instrument(1, "XPAR", "EUR", "AAPL", 20220101, State::ACTIVE,
+                                                   150, 1001, 100, 2, 1, 1, 2022));
+        MatchingEngine engine(instrumentManager);
+
+        int listener = socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in local{};
+        local.sin_family = AF_INET;
+        local.sin_port = 0;
+        inet_pton(AF_INET, "127.0.0.1", &local.sin_addr);
+        socklen_t localLength = sizeof(local);
+        if (listener < 0 || bind(listener, reinterpret_cast<sockaddr*>(&local), sizeof(local)) != 0 ||
+            listen(listener, 1) != 0 || getsockname(listener, reinterpret_cast<sockaddr*>(&local), &localLength) != 0)
+        {
+            std::cerr << "Session benchmark: cannot listen: " << std::strerror(errno) << std::endl;
+            return false;
+        }
+
+        FixSessionStats serverStats;
+        std::thread server([listener, &engine, &serverStats]
+        {
+            int fd = accept(listener, nullptr, nullptr);
+            int noDelay = 1;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+            serveSession(fd, engine, serverStats);
+        });
+
+        int fd = socket(AF_INET, SOCK_STREAM, 0);
+        int noDelay = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+        bool ok = connect(fd, reinterpret_cast<sockaddr*>(&local), sizeof(local)) == 0;
+
+        FixWriter writer;
+        std::vector<char> batch;
+        std::vector<char> responses(256 * 1024);
+        std::size_t responseSize = 0;
+        int reports = 0;
+        std::uint32_t seqNum = 1;
+        auto now = std::chrono::system_clock::now();
+
+        writer.begin("A", seqNum++, "CLIENT", "ENGINE", now);
+        writer.add(FixTag::ENCRYPT_METHOD, '0');
+        writer.add(FixTag::HEART_BT_INT, 30);
+        writer.add(FixTag::RESET_SEQ_NUM_FLAG, 'Y');
+        std::string_view logon = writer.finish();
+        ok = ok && write(fd, logon.data(), logon.size()) == static_cast<ssize_t>(logon.size()) &&
+            readResponses(fd, responses, responseSize, 1, reports);
+
+        auto start = std::chrono::steady_clock::now();
+        for (int sent = 0; ok && sent < messages;)
+        {
+            batch.clear();
+            int count = std::min(window, messages - sent);
+            for (int i = 0; i < count; ++i, ++sent)
+            {
+                std::string_view request = encodeRequest(writer, sent, seqNum++, now);
+                batch.insert(batch.end(), request.begin(), request.end());
+            }
+            ok = write(fd, batch.data(), batch.size()) == static_cast<ssize_t>(batch.size()) &&
+                readResponses(fd, responses, responseSize, count, reports);
+        }
+        double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        writer.begin("5", seqNum++, "CLIENT", "ENGINE", now);
+        std::string_view logout = writer.finish();
+        ok = write(fd, logout.data(), logout.size()) == static_cast<ssize_t>(logout.size()) && ok;
+        server.join();
+        close(fd);
+        close(listener);
+
+        report << "Session: " << messages << " requests, window " << window << ", " << reports
+            << " reports in " << elapsed << " s, " << static_cast<long long>(messages / elapsed)
+            << " round trips/s (" << serverStats.orders << " applied, " << serverStats.rejected << " refused)\n";
+        return ok && reports == messages;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    long long parserMessages = argc > 1 ? std::atoll(argv[1]) : 5000000;
+    int sessionMessages = argc > 2 ? std::atoi(argv[2]) : 200000;
+    int window = argc > 3 ? std::atoi(argv[3]) : 64;
+    if (parserMessages <= 0 || sessionMessages <= 0 || window <= 0)
+    {
+        std::cerr << "Usage: FixBenchmark [parser messages] [session messages] [window]" << std::endl;
+        return 2;
+    }
+
+    bool ok = benchmarkParser(parserMessages);
+
+    // The engine reports every order on stdout, which would be the bottleneck
+    std::ostringstream discarded;
+    std::ostringstream report;
+    std::streambuf* console = std::cout.rdbuf(discarded.rdbuf());
+    ok = benchmarkSession(sessionMessages, window, report) && ok;
+    std::cout.rdbuf(console);
+
+    std::cout << report.str() << (ok ? "PASSED" : "FAILED") << std::endl;
+    return ok ? 0 : 1;
+}
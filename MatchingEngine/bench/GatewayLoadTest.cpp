@@ -0,0 +1,301 @@
+/**
+ * @file GatewayLoadTest.cpp
+ * @brief Loopback load test of the order gateway
+ *
+ * Starts an engine and a gateway on 127.0.0.1, then connects one client
+ * thread per firm. Each client logs on and streams new orders, cancels
+ * and amends in pipelined windows, checking that every request gets
+ * exactly one ack or reject in sequence. Reports the request rate and
+ * the gateway counters; exits non-zero if any response is missing or
+ * out of order.
+ *
+ * Usage: GatewayLoadTest [sessions] [requests per session] [window]
+ */
+
+#include "OrderGateway.hpp"
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    /// Token of every firm in the test
+    constexpr std::uint64_t FIRM_TOKEN = 0x10AD7E57ULL;
+
+    /**
+     * @brief Outcome of one client session
+     */
+    struct ClientResult
+    {
+        bool ok = false; ///< Every response received, in sequence
+        std::uint64_t acks = 0; ///< ACK messages received
+        std::uint64_t rejects = 0; ///< REJECT messages received
+    };
+
+    /**
+     * @brief Writes a whole buffer to a blocking socket
+     */
+    bool sendAll(int fd, const std::uint8_t* data, std::size_t size)
+    {
+        while (size > 0)
+        {
+            ssize_t written = write(fd, data, size);
+            if (written <= 0)
+            {
+                return false;
+            }
+            data += written;
+            size -= static_cast<std::size_t>(written);
+        }
+        return true;
+    }
+
+    /**
+     * @brief Client receive side: reads and checks a number of responses
+     */
+    class ResponseReader
+    {
+    public:
+        explicit ResponseReader(int fd) : fd(fd) {}
+
+        /**
+         * @brief Reads responses until count of them have been decoded
+         *
+         * @param count Number of responses expected
+         * @param result Counters to update
+         * @return true if all responses arrived with consecutive sequence numbers
+         */
+        bool read(int count, ClientResult& result)
+        {
+            EntryMessage message;
+            while (count > 0)
+            {
+                std::size_t consumed = 0;
+                DecodeStatus status = decodeEntryMessage(buffer + offset, size - offset, message, consumed);
+                if (status == DecodeStatus::INCOMPLETE)
+                {
+                    std::copy(buffer + offset, buffer + size, buffer);
+                    size -= offset;
+                    offset = 0;
+                    ssize_t received = ::read(fd, buffer + size, sizeof(buffer) - size);
+                    if (received <= 0)
+                    {
+                        return false;
+                    }
+                    size += static_cast<std::size_t>(received);
+                    continue;
+                }
+                if (status != DecodeStatus::OK || message.header.sequence != nextSequence)
+                {
+                    return false;
+                }
+                nextSequence++;
+                offset += consumed;
+                count--;
+                if (message.type == EntryMessageType::ACK)
+                {
+                    result.acks++;
+                }
+                else
+                {
+                    result.rejects++;
+                }
+            }
+            return true;
+        }
+
+    private:
+        int fd; ///< Connected socket
+        std::uint8_t buffer[64 * 1024]; ///< Received bytes
+        std::size_t offset = 0; ///< First undecoded byte
+        std::size_t size = 0; ///< Bytes in buffer
+        std::uint32_t nextSequence = 1; ///< Expected gateway sequence number
+    };
+
+    /**
+     * @brief Runs one client session
+     *
+     * Orders alternate sides around the reference price so that part of
+     * the flow trades; every fourth request cancels and every eighth
+     * amends an earlier order of the firm, which may already be filled.
+     */
+    ClientResult runClient(std::uint16_t port, int idfirm, int requests, int window, const CodeTable& codes)
+    {
+        ClientResult result;
+        int fd = socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in remote{};
+        remote.sin_family = AF_INET;
+        remote.sin_port = htons(port);
+        inet_pton(AF_INET, "127.0.0.1", &remote.sin_addr);
+        if (fd < 0 || connect(fd, reinterpret_cast<sockaddr*>(&remote), sizeof(remote)) != 0)
+        {
+            std::cerr << "Firm " << idfirm << " cannot connect: " << std::strerror(errno) << std::endl;
+            return result;
+        }
+        int noDelay = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+
+        ResponseReader reader(fd);
+        std::uint32_t sequence = 1;
+        LogonMessage logon = makeLogon(idfirm, FIRM_TOKEN, sequence++);
+        if (!sendAll(fd, reinterpret_cast<const std::uint8_t*>(&logon), sizeof(logon)) || !reader.read(1, result))
+        {
+            close(fd);
+            return result;
+        }
+
+        std::uint16_t mic = codes.find("XPAR");
+        std::uint16_t currency = codes.find("EUR");
+        std::vector<std::uint8_t> batch;
+        batch.reserve(static_cast<std::size_t>(window) * MAX_ENTRY_MESSAGE_SIZE);
+        int firstOrderId = idfirm * 10000000;
+        int sent = 0;
+        while (sent < requests)
+        {
+            batch.clear();
+            int count = std::min(window, requests - sent);
+            for (int i = 0; i < count; ++i, ++sent)
+            {
+                int idorder = firstOrderId + sent;
+                if (sent % 4 == 3)
+                {
+                    CancelOrderMessage cancel{};
+                    stampHeader(cancel, EntryMessageType::CANCEL_ORDER, sequence++);
+                    cancel.idorder = idorder - 3;
+                    cancel.idinstrument = 1;
+                    cancel.micCode = mic;
+                    cancel.currencyCode = currency;
+                    auto bytes = reinterpret_cast<const std::uint8_t*>(&cancel);
+                    batch.insert(batch.end(), bytes, bytes + sizeof(cancel));
+                }
+                else if (sent % 8 == 6)
+                {
+                    AmendOrderMessage amend{};
+                    stampHeader(amend, EntryMessageType::AMEND_ORDER, sequence++);
+                    amend.idorder = idorder - 2;
+                    amend.idinstrument = 1;
+                    amend.newPrice = 149.0;
+                    amend.newQuantity = 100;
+                    amend.micCode = mic;
+                    amend.currencyCode = currency;
+                    auto bytes = reinterpret_cast<const std::uint8_t*>(&amend);
+                    batch.insert(batch.end(), bytes, bytes + sizeof(amend));
+                }
+                else
+                {
+                    NewOrderMessage order{};
+                    stampHeader(order, EntryMessageType::NEW_ORDER, sequence++);
+                    bool buy = (sent / 2) % 2 == 0;
+                    order.price = buy ? 150.0 - (sent % 5) * 0.01 : 150.0 + (sent % 5) * 0.01 - 0.02;
+                    order.idorder = idorder;
+                    order.idinstrument = 1;
+                    order.idfirm = idfirm;
+                    order.quantity = 100 * (1 + sent % 3);
+                    order.micCode = mic;
+                    order.currencyCode = currency;
+                    order.side = buy ? 'B' : 'S';
+                    order.timeInForce = static_cast<std::uint8_t>(TimeInForce::DAY);
+                    order.limitType = static_cast<std::uint8_t>(LimitType::LIMIT);
+                    order.stopType = static_cast<std::uint8_t>(StopType::NONE);
+                    auto bytes = reinterpret_cast<const std::uint8_t*>(&order);
+                    batch.insert(batch.end(), bytes, bytes + sizeof(order));
+                }
+            }
+            if (!sendAll(fd, batch.data(), batch.size()) || !reader.read(count, result))
+            {
+                close(fd);
+                return result;
+            }
+        }
+
+        close(fd);
+        result.ok = true;
+        return result;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    int sessionCount = argc > 1 ? std::atoi(argv[1]) : 4;
+    int requests = argc > 2 ? std::atoi(argv[2]) : 100000;
+    int window = argc > 3 ? std::atoi(argv[3]) : 64;
+    if (sessionCount <= 0 || requests <= 0 || window <= 0)
+    {
+        std::cerr << "Usage: GatewayLoadTest [sessions] [requests per session] [window]" << std::endl;
+        return 2;
+    }
+
+    InstrumentManager instrumentManager;
+    instrumentManager.addInstrument(Instrument(1, "XPAR", "EUR", "AAPL", 20220101, State::ACTIVE,
+                                               150, 1001, 100, 2, 1, 1, 2022));
+    CodeTable codes;
+    codes.internInstruments(instrumentManager);
+
+    // The engine reports every order on stdout, which would be the bottleneck
+    std::ostringstream discarded;
+    std::streambuf* console = std::cout.rdbuf(discarded.rdbuf());
+
+    MatchingEngine engine(instrumentManager);
+    OrderGateway gateway(engine, codes);
+    for (int firm = 1; firm <= sessionCount; ++firm)
+    {
+        gateway.addFirm(firm, FIRM_TOKEN);
+    }
+    if (!gateway.start("127.0.0.1", 0))
+    {
+        std::cout.rdbuf(console);
+        return 1;
+    }
+
+    std::vector<ClientResult> results(sessionCount);
+    std::vector<std::thread> clients;
+    auto start = std::chrono::steady_clock::now();
+    for (int firm = 1; firm <= sessionCount; ++firm)
+    {
+        clients.emplace_back([&results, &codes, &gateway, firm, requests, window]
+        {
+            results[firm - 1] = runClient(gateway.getPort(), firm, requests, window, codes);
+        });
+    }
+    for (auto& client : clients)
+    {
+        client.join();
+    }
+    auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    // Let the gateway see the disconnects before reading its counters
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    GatewayStats stats = gateway.getStats();
+    gateway.stop();
+    std::cout.rdbuf(console);
+
+    bool ok = true;
+    std::uint64_t acks = 0, rejects = 0;
+    for (int i = 0; i < sessionCount; ++i)
+    {
+        ok = ok && results[i].ok;
+        acks += results[i].acks;
+        rejects += results[i].rejects;
+    }
+    double total = static_cast<double>(sessionCount) * requests;
+    std::cout << "Sessions: " << sessionCount << ", requests per session: " << requests
+        << ", window: " << window << "\n";
+    std::cout << "Responses: " << acks << " acks, " << rejects << " rejects\n";
+    std::cout << "Elapsed: " << elapsed << " s, " << static_cast<long long>(total / elapsed) << " requests/s\n";
+    std::cout << "Gateway: " << stats.sessions << " sessions, " << stats.logons << " logons, "
+        << stats.requests << " requests, " << stats.writes << " writev calls ("
+        << (stats.writes > 0 ? static_cast<double>(stats.acks + stats.rejects) / stats.writes : 0.0)
+        << " responses per call)\n";
+    std::cout << (ok ? "PASSED" : "FAILED: missing or out of sequence responses") << std::endl;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,346 @@
+/**
+ * @file OrderBookBenchmark.cpp
+ * @brief Microbenchmarks of the OrderBook operations at several book depths
+ *
+ * Each scenario runs against a book prefilled with resting orders on both
+ * sides (500 price levels per side) and restores the book outside the
+ * timed batches, so every batch sees the same depth:
+ * - insert_touch: passive limit order joining the best level
+ * - insert_deep: passive limit order joining the worst level
+ * - cancel: cancel of a random resting order
+ * - single_fill: aggressive order filling one resting order (add + match)
+ * - sweep_10: aggressive order sweeping 10 price levels (add + match),
+ *   which fills 10 x depth / 1000 resting orders
+ * - gtd_expiry: one removeExpiredOrders pass over the whole book, 1% of
+ *   the orders expired (ns/op is per pass)
+ *
+ * Reports ns/op and heap allocations/op, counted by replacing the global
+ * operator new. Single-threaded, no Qt.
+ *
+ * Usage: OrderBookBenchmark [max depth] [operations per scenario]
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <random>
+#include <streambuf>
+#include <vector>
+#include "OrderBook.hpp"
+#include "TestSupport.hpp"
+
+namespace
+{
+    std::atomic<std::uint64_t> allocationCount{0};
+}
+
+void* operator new(std::size_t size)
+{
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    if (void* memory = std::malloc(size == 0 ? 1 : size))
+    {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* memory) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept
+{
+    std::free(memory);
+}
+
+namespace
+{
+    /// Price levels per side of the prefilled book
+    constexpr int LEVELS = 500;
+
+    /// Tick size of the benchmark instrument
+    constexpr double TICK = 0.01;
+
+    /// Best bid of the prefilled book; the best ask is one tick above
+    constexpr double BEST_BID = 100.00;
+
+    /// Quantity of every resting order
+    constexpr int ORDER_QUANTITY = 100;
+
+    /// Operations timed together between two clock reads
+    constexpr int BATCH = 1000;
+
+    /// Firm of the resting orders and firm of the aggressors, distinct so
+    /// that self-trade prevention stays out of the measure
+    constexpr int RESTING_FIRM = 1001;
+    constexpr int AGGRESSOR_FIRM = 1002;
+
+    /**
+     * @struct Measure
+     * @brief Accumulated cost of a scenario
+     */
+    struct Measure
+    {
+        std::chrono::nanoseconds elapsed{0}; ///< Time spent in timed batches
+        std::uint64_t allocations = 0; ///< Allocations made in timed batches
+        std::uint64_t operations = 0; ///< Operations timed
+    };
+
+    /**
+     * @brief Runs a batch of operations between two clock reads
+     *
+     * @param measure Accumulated cost, updated
+     * @param count Number of operations in the batch
+     * @param body Callable executing the operation of index i
+     */
+    template <typename Body>
+    void timeBatch(Measure& measure, int count, Body&& body)
+    {
+        std::uint64_t allocationsBefore = allocationCount.load(std::memory_order_relaxed);
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < count; ++i)
+        {
+            body(i);
+        }
+        measure.elapsed += std::chrono::steady_clock::now() - start;
+        measure.allocations += allocationCount.load(std::memory_order_relaxed) - allocationsBefore;
+        measure.operations += count;
+    }
+
+    /**
+     * @brief Builds a limit order of the benchmark instrument
+     */
+    Order makeOrder(int idorder, OrderType side, double price, int quantity,
+                    std::chrono::system_clock::time_point now, int idfirm = RESTING_FIRM)
+    {
+        return Order(idorder, "XPAR", "EUR", now, price, quantity, TimeInForce::DAY, side,
+                     LimitType::LIMIT, 1, quantity, idfirm);
+    }
+
+    /**
+     * @brief Price of a level, 0 being the touch
+     */
+    double levelPrice(OrderType side, int level)
+    {
+        return side == OrderType::BID ? BEST_BID - level * TICK : BEST_BID + (level + 1) * TICK;
+    }
+
+    /**
+     * @class BenchmarkBook
+     * @brief A prefilled book and the ids of its resting orders
+     */
+    class BenchmarkBook
+    {
+    public:
+        /**
+         * @brief Fills both sides with depth / 2 orders over LEVELS levels
+         *
+         * @param depth Number of resting orders
+         * @param gtdEvery One order in gtdEvery is a GTD order already expired
+         *                 at expiryTime, 0 for none
+         */
+        BenchmarkBook(int depth, int gtdEvery, std::chrono::system_clock::time_point expiryTime)
+        {
+            auto now = std::chrono::system_clock::now();
+            for (int i = 0; i < depth; ++i)
+            {
+                OrderType side = i % 2 == 0 ? OrderType::BID : OrderType::ASK;
+                int level = (i / 2) % LEVELS;
+                Order order = makeOrder(nextId++, side, levelPrice(side, level), ORDER_QUANTITY, now);
+                if (gtdEvery > 0 && i % gtdEvery == 0)
+                {
+                    order.timeinforce = TimeInForce::GTD;
+                    order.expirationDate = expiryTime;
+                }
+                book.addOrder(order);
+                resting.push_back(order.idorder);
+            }
+        }
+
+        OrderBook book; ///< Book under test
+        std::vector<int> resting; ///< Ids of the prefilled orders still resting
+        int nextId = 1; ///< Next order id
+    };
+
+    /**
+     * @brief Prints one result line
+     */
+    void report(const char* scenario, int depth, const Measure& measure)
+    {
+        double operations = static_cast<double>(measure.operations);
+        std::printf("%-14s %9d %12.1f %12.2f\n", scenario, depth,
+                    static_cast<double>(measure.elapsed.count()) / operations,
+                    static_cast<double>(measure.allocations) / operations);
+    }
+
+    /**
+     * @brief Passive orders joining one level, cancelled after each batch
+     */
+    Measure benchmarkInsert(BenchmarkBook& fixture, int level, int operations)
+    {
+        Measure measure;
+        auto now = std::chrono::system_clock::now();
+        std::vector<Order> orders;
+        orders.reserve(BATCH);
+        while (measure.operations < static_cast<std::uint64_t>(operations))
+        {
+            orders.clear();
+            for (int i = 0; i < BATCH; ++i)
+            {
+                orders.push_back(makeOrder(fixture.nextId++, OrderType::BID,
+                                           levelPrice(OrderType::BID, level), ORDER_QUANTITY, now));
+            }
+            timeBatch(measure, BATCH, [&](int i) { fixture.book.addOrder(orders[i]); });
+            for (const Order& order : orders)
+            {
+                fixture.book.cancelOrder(order.idorder);
+            }
+        }
+        return measure;
+    }
+
+    /**
+     * @brief Cancels of random resting orders, re-entered after each batch
+     */
+    Measure benchmarkCancel(BenchmarkBook& fixture, int operations, std::mt19937& random)
+    {
+        Measure measure;
+        auto now = std::chrono::system_clock::now();
+        std::vector<Order> cancelled;
+        cancelled.reserve(BATCH);
+        int batch = std::min<int>(BATCH, static_cast<int>(fixture.resting.size()));
+        while (measure.operations < static_cast<std::uint64_t>(operations))
+        {
+            // Pick distinct victims by moving them to the end of the id list
+            cancelled.clear();
+            for (int i = 0; i < batch; ++i)
+            {
+                std::size_t remaining = fixture.resting.size() - i;
+                std::size_t pick = std::uniform_int_distribution<std::size_t>(0, remaining - 1)(random);
+                std::swap(fixture.resting[pick], fixture.resting[remaining - 1]);
+                cancelled.push_back(*fixture.book.findOrder(fixture.resting[remaining - 1]));
+            }
+            timeBatch(measure, batch, [&](int i) { fixture.book.cancelOrder(cancelled[i].idorder); });
+
+            // Re-enter the same orders under new ids, at the back of their level
+            for (int i = 0; i < batch; ++i)
+            {
+                Order order = makeOrder(fixture.nextId++, cancelled[i].ordertype, cancelled[i].price,
+                                        ORDER_QUANTITY, now);
+                fixture.book.addOrder(order);
+                fixture.resting[fixture.resting.size() - batch + i] = order.idorder;
+            }
+        }
+        return measure;
+    }
+
+    /**
+     * @brief Tops every bid level back up to its prefilled quantity
+     */
+    void refillBids(BenchmarkBook& fixture, int ordersPerLevel, std::chrono::system_clock::time_point now)
+    {
+        for (int level = 0; level < LEVELS; ++level)
+        {
+            double price = levelPrice(OrderType::BID, level);
+            long long missing = static_cast<long long>(ordersPerLevel) * ORDER_QUANTITY
+                - fixture.book.getQuantityAtPrice(OrderType::BID, price);
+            for (; missing > 0; missing -= ORDER_QUANTITY)
+            {
+                fixture.book.addOrder(makeOrder(fixture.nextId++, OrderType::BID, price, ORDER_QUANTITY, now));
+            }
+        }
+    }
+
+    /**
+     * @brief Aggressive sell orders against the bids, the bids refilled after each batch
+     *
+     * @param levels 0 to fill a single resting order, otherwise the number
+     *               of whole price levels each order sweeps
+     */
+    Measure benchmarkAggressor(BenchmarkBook& fixture, int depth, int levels, int operations)
+    {
+        Measure measure;
+        auto now = std::chrono::system_clock::now();
+        int ordersPerLevel = std::max(1, depth / 2 / LEVELS);
+        int quantity = std::max(1, levels * ordersPerLevel) * ORDER_QUANTITY;
+        // Limit at the deepest bid: the quantity alone decides what is filled
+        double limit = levelPrice(OrderType::BID, LEVELS - 1);
+        // A batch leaves at least half of the bid side in place
+        int batch = std::min(BATCH, LEVELS * ordersPerLevel / 2 / (quantity / ORDER_QUANTITY));
+
+        std::vector<Order> aggressors;
+        aggressors.reserve(batch);
+        while (measure.operations < static_cast<std::uint64_t>(operations))
+        {
+            aggressors.clear();
+            for (int i = 0; i < batch; ++i)
+            {
+                aggressors.push_back(makeOrder(fixture.nextId++, OrderType::ASK, limit, quantity, now, AGGRESSOR_FIRM));
+            }
+            timeBatch(measure, batch, [&](int i)
+            {
+                fixture.book.addOrder(aggressors[i]);
+                fixture.book.matchOrders();
+            });
+            refillBids(fixture, ordersPerLevel, now);
+        }
+        return measure;
+    }
+
+    /**
+     * @brief One removeExpiredOrders pass per operation over a fresh book
+     */
+    Measure benchmarkExpiry(int depth, int operations)
+    {
+        Measure measure;
+        auto now = std::chrono::system_clock::now();
+        for (int run = 0; run < operations; ++run)
+        {
+            BenchmarkBook fixture(depth, 100, now - std::chrono::seconds(1));
+            timeBatch(measure, 1, [&](int) { fixture.book.removeExpiredOrders(now); });
+        }
+        return measure;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    int maxDepth = argc > 1 ? std::atoi(argv[1]) : 1000000;
+    int operations = argc > 2 ? std::atoi(argv[2]) : 100000;
+    if (maxDepth < 1000 || operations <= 0)
+    {
+        std::cerr << "Usage: OrderBookBenchmark [max depth >= 1000] [operations per scenario]" << std::endl;
+        return 2;
+    }
+
+    // Matching reports every trade on stdout
+    NullBuffer discarded;
+    std::streambuf* console = std::cout.rdbuf(&discarded);
+
+    std::printf("%-14s %9s %12s %12s\n", "scenario", "depth", "ns/op", "allocs/op");
+    std::mt19937 random(42);
+    for (int depth = 1000; depth <= maxDepth; depth *= 10)
+    {
+        BenchmarkBook fixture(depth, 0, std::chrono::system_clock::time_point());
+        int deepestLevel = std::min(LEVELS, depth / 2) - 1;
+
+        report("insert_touch", depth, benchmarkInsert(fixture, 0, operations));
+        report("insert_deep", depth, benchmarkInsert(fixture, deepestLevel, operations));
+        report("cancel", depth, benchmarkCancel(fixture, operations, random));
+        report("single_fill", depth, benchmarkAggressor(fixture, depth, 0, operations));
+        // Bound the number of fills of the sweeps rather than the number of sweeps
+        int ordersPerLevel = std::max(1, depth / 2 / LEVELS);
+        report("sweep_10", depth, benchmarkAggressor(fixture, depth, 10, std::max(1, operations / 10 / ordersPerLevel)));
+        report("gtd_expiry", depth, benchmarkExpiry(depth, std::max(1, 1000000 / depth)));
+        std::fflush(stdout);
+    }
+
+    std::cout.rdbuf(console);
+    return 0;
+}
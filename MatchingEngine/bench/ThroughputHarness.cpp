@@ -0,0 +1,256 @@
+/**
+ * @file ThroughputHarness.cpp
+ * @brief End-to-end throughput and latency of the MatchingEngine under synthetic flow
+ *
+ * Loads the instruments of a CSV file (InputData/instrument_input.csv
+ * layout), then runs one OrderFlowGenerator per thread against a started
+ * MatchingEngine: new orders go through addAndValidateOrder, cancels
+ * through cancelOrder. Reports the sustained event rate and latency
+ * percentiles per event type. A dashboard-like consumer samples the
+ * conflated Level 2 images every DASHBOARD_INTERVAL during the run and
+ * reports how many deltas conflation absorbed.
+ *
+ * With a target rate the load is open-loop: each event is due at its
+ * generated arrival time and its latency runs from that time, so a
+ * stalled engine shows up as queueing delay instead of a lower rate.
+ * With rate 0 events are sent back-to-back and latency is the call time.
+ *
+ * In a build with ENABLE_PROBES the hot-path probes record the whole run
+ * and their rings are written to ThroughputHarness.probes for ProbeReport.
+ *
+ * Usage: ThroughputHarness <instruments.csv> [threads] [events per thread]
+ *                          [events/s per thread] [cancel ratio]
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <streambuf>
+#include <string>
+#include <thread>
+#include <vector>
+#include "ConflatingSubscriber.hpp"
+#include "InstrumentManager.hpp"
+#include "MatchingEngine.hpp"
+#include "OrderFlowGenerator.hpp"
+#include "Probe.hpp"
+#include "TestSupport.hpp"
+
+namespace
+{
+    /// Delivery interval of the conflated market data consumer
+    constexpr std::chrono::milliseconds DASHBOARD_INTERVAL{100};
+
+    /**
+     * @struct ThreadResult
+     * @brief Latencies and outcomes of one order source
+     */
+    struct ThreadResult
+    {
+        std::vector<std::int64_t> newOrderLatencies; ///< Nanoseconds per new order
+        std::vector<std::int64_t> cancelLatencies; ///< Nanoseconds per cancel
+        std::uint64_t accepted = 0; ///< New orders accepted by the engine
+        std::uint64_t cancelled = 0; ///< Cancels that found their order
+    };
+
+    /**
+     * @brief Drives the engine with the flow of one generator
+     */
+    void runSource(MatchingEngine& engine, OrderFlowGenerator& generator, int events,
+                   std::chrono::steady_clock::time_point start, bool openLoop, ThreadResult& result)
+    {
+        result.newOrderLatencies.reserve(events);
+        result.cancelLatencies.reserve(events);
+        while (std::chrono::steady_clock::now() < start)
+        {
+        }
+        for (int i = 0; i < events; ++i)
+        {
+            const OrderFlowEvent& event = generator.next();
+
+            auto sent = std::chrono::steady_clock::now();
+            if (openLoop)
+            {
+                auto due = start + event.arrival;
+                while (sent < due)
+                {
+                    sent = std::chrono::steady_clock::now();
+                }
+                sent = due;
+            }
+
+            if (event.type == FlowEventType::NEW_ORDER)
+            {
+                result.accepted += engine.addAndValidateOrder(event.order) ? 1 : 0;
+            }
+            else
+            {
+                MatchingEngine::InstrumentKey key(event.order.idinstrument, event.order.marketIdentificationCode,
+                                                  event.order.tradingCurrency);
+                result.cancelled += engine.cancelOrder(key, event.order.idorder) ? 1 : 0;
+            }
+
+            std::int64_t latency = (std::chrono::steady_clock::now() - sent).count();
+            (event.type == FlowEventType::NEW_ORDER ? result.newOrderLatencies : result.cancelLatencies)
+                .push_back(latency);
+        }
+    }
+
+    /**
+     * @brief Prints the latency percentiles of one event type
+     */
+    void reportLatencies(const char* label, std::vector<std::int64_t>& latencies)
+    {
+        if (latencies.empty())
+        {
+            std::printf("%-10s %10s\n", label, "no events");
+            return;
+        }
+        std::sort(latencies.begin(), latencies.end());
+        auto percentile = [&latencies](double p)
+        {
+            std::size_t index = static_cast<std::size_t>(p * static_cast<double>(latencies.size() - 1));
+            return static_cast<long long>(latencies[index]);
+        };
+        std::printf("%-10s %10lld %10lld %10lld %10lld %12lld\n", label, percentile(0.50), percentile(0.90),
+                    percentile(0.99), percentile(0.999), static_cast<long long>(latencies.back()));
+    }
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 2)
+    {
+        std::cerr << "Usage: ThroughputHarness <instruments.csv> [threads] [events per thread] "
+            "[events/s per thread] [cancel ratio]" << std::endl;
+        return 2;
+    }
+    int threadCount = argc > 2 ? std::atoi(argv[2]) : 4;
+    int events = argc > 3 ? std::atoi(argv[3]) : 200000;
+    double rate = argc > 4 ? std::atof(argv[4]) : 0.0;
+    double cancelRatio = argc > 5 ? std::atof(argv[5]) : 0.3;
+    if (threadCount <= 0 || events <= 0 || rate < 0.0 || cancelRatio < 0.0 || cancelRatio > 1.0)
+    {
+        std::cerr << "Invalid arguments" << std::endl;
+        return 2;
+    }
+
+    // The engine reports every order on stdout, which would be the bottleneck
+    NullBuffer discarded;
+    std::streambuf* console = std::cout.rdbuf(&discarded);
+
+    InstrumentManager instrumentManager;
+    if (instrumentManager.loadFromCsv(argv[1], "XPAR", "EUR") <= 0)
+    {
+        std::cout.rdbuf(console);
+        std::cerr << "No instrument loaded from " << argv[1] << std::endl;
+        return 1;
+    }
+
+    std::vector<OrderFlowGenerator> generators;
+    for (int t = 0; t < threadCount; ++t)
+    {
+        OrderFlowConfig config;
+        config.ordersPerSecond = rate;
+        config.cancelRatio = cancelRatio;
+        config.seed = 1000 + t;
+        generators.emplace_back(instrumentManager.getInstruments(), config, t + 1, threadCount);
+    }
+    if (!generators.front().hasInstruments())
+    {
+        std::cout.rdbuf(console);
+        std::cerr << "No ACTIVE instrument in " << argv[1] << std::endl;
+        return 1;
+    }
+
+    MatchingEngine engine(instrumentManager);
+    engine.start();
+    Probes::setEnabled(Probes::COMPILED_IN);
+
+    // Slow consumer of the conflated images, as a GUI would be
+    std::atomic<bool> sourcesDone{false};
+    ConflatingSubscriber dashboard(engine.getMarketDataPublisher(), DASHBOARD_INTERVAL);
+    std::thread dashboardThread([&]
+    {
+        auto ignore = [](const L2Message&)
+        {
+        };
+        while (!sourcesDone.load(std::memory_order_acquire))
+        {
+            dashboard.poll(ignore);
+            std::this_thread::sleep_for(DASHBOARD_INTERVAL / 10);
+        }
+        dashboard.flush(ignore);
+    });
+
+    std::vector<ThreadResult> results(threadCount);
+    std::vector<std::thread> sources;
+    auto start = std::chrono::steady_clock::now() + std::chrono::milliseconds(10);
+    for (int t = 0; t < threadCount; ++t)
+    {
+        sources.emplace_back([&, t]
+        {
+            runSource(engine, generators[t], events, start, rate > 0.0, results[t]);
+        });
+    }
+    for (auto& source : sources)
+    {
+        source.join();
+    }
+    auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    sourcesDone.store(true, std::memory_order_release);
+    dashboardThread.join();
+    engine.stop();
+    Probes::setEnabled(false);
+    std::cout.rdbuf(console);
+
+    ThreadResult total;
+    for (ThreadResult& result : results)
+    {
+        total.accepted += result.accepted;
+        total.cancelled += result.cancelled;
+        total.newOrderLatencies.insert(total.newOrderLatencies.end(), result.newOrderLatencies.begin(),
+                                       result.newOrderLatencies.end());
+        total.cancelLatencies.insert(total.cancelLatencies.end(), result.cancelLatencies.begin(),
+                                     result.cancelLatencies.end());
+    }
+    double eventCount = static_cast<double>(threadCount) * events;
+
+    std::printf("Threads: %d, events per thread: %d, target: %s, cancel ratio: %.2f\n", threadCount, events,
+                rate > 0.0 ? (std::to_string(static_cast<long long>(rate)) + " events/s per thread").c_str()
+                           : "back-to-back", cancelRatio);
+    std::printf("New orders: %zu (%llu accepted), cancels: %zu (%llu found)\n", total.newOrderLatencies.size(),
+                static_cast<unsigned long long>(total.accepted), total.cancelLatencies.size(),
+                static_cast<unsigned long long>(total.cancelled));
+    std::printf("Elapsed: %.3f s, %lld events/s\n", elapsed, static_cast<long long>(eventCount / elapsed));
+    TradingStats::Totals traded = engine.getStats().getTotals();
+    std::printf("Trades: %lld, quantity: %lld, volume: %.2f\n", static_cast<long long>(traded.tradeCount),
+                static_cast<long long>(traded.quantity), traded.getVolume());
+    const ConflationStats& conflation = dashboard.getStats();
+    std::printf("Conflated L2 every %lld ms: %llu deltas, %llu delivered, %llu conflated (%.1f%%) in %llu deliveries\n",
+                static_cast<long long>(DASHBOARD_INTERVAL.count()),
+                static_cast<unsigned long long>(conflation.received),
+                static_cast<unsigned long long>(conflation.delivered),
+                static_cast<unsigned long long>(conflation.conflated),
+                conflation.received > 0 ? 100.0 * conflation.conflated / conflation.received : 0.0,
+                static_cast<unsigned long long>(conflation.flushes));
+    std::printf("%-10s %10s %10s %10s %10s %12s\n", "latency ns", "p50", "p90", "p99", "p99.9", "max");
+    reportLatencies("new order", total.newOrderLatencies);
+    reportLatencies("cancel", total.cancelLatencies);
+    std::printf("Engine stages:\n");
+    std::fflush(stdout);
+    engine.getLatency().display(std::cout);
+
+    if (Probes::COMPILED_IN)
+    {
+        std::ofstream dump("ThroughputHarness.probes");
+        Probes::dump(dump);
+        std::cout << "Probe rings written to ThroughputHarness.probes" << std::endl;
+    }
+    return 0;
+}
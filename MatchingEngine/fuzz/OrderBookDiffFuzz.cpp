@@ -0,0 +1,645 @@
+/**
+ * @file OrderBookDiffFuzz.cpp
+ * @brief Differential fuzz harness of the order book against a reference model
+ *
+ * Decodes arbitrary bytes as a stream of new orders (limit, market and
+ * iceberg, DAY and GTD, with self-trade prevention), batches of new
+ * orders added before a single matching cycle, cancels, amends and GTD
+ * expiry sweeps, and applies each request both to an OrderBook and
+ * to a reference book kept as a flat vector of orders, where every
+ * decision is a linear scan. After each request the harness checks that
+ * both produced the same fills, return values, depth on both sides and
+ * remaining quantity of every resting order.
+ *
+ * The reference implements the FIFO allocation with the book's rules:
+ * - The newer order (by entry sequence) is the aggressor and trades print
+ *   at the price of the resting order, or at the aggressor's limit when a
+ *   market order of a batch rests
+ * - An exhausted iceberg refills its peak from the reserve and moves to
+ *   the back of its level, keeping its entry sequence
+ * - An amend keeps the queue position of a quantity decrease at the same
+ *   price and re-queues the order otherwise
+ * - What is left of a market order after matching is cancelled
+ *
+ * Built as a libFuzzer target with Clang; with other compilers it is a
+ * standalone driver that replays files given on the command line or runs
+ * a fixed number of random inputs and prints the operation rate.
+ */
+
+#include "Clock.hpp"
+#include "OrderBook.hpp"
+#include "OrderFlowGenerator.hpp"
+#include "TestSupport.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+namespace
+{
+    /// Prices are drawn from a narrow band of ticks so that most orders cross
+    constexpr double PRICE_TICK = 0.05;
+    constexpr int BASE_TICK = 2000;
+    constexpr int PRICE_TICKS = 16;
+
+    /// Firms submitting orders, few enough for frequent self-trades
+    constexpr int FIRM_COUNT = 3;
+
+    /// Largest number of orders added before a matching cycle
+    constexpr int MAX_BATCH = 6;
+
+    /// Requests applied across every input, for the driver's report
+    long long operations = 0;
+
+    /**
+     * @brief Reports a divergence and stops
+     */
+    [[noreturn]] void fail(long long request, const std::string& what)
+    {
+        std::cerr << "Order book differential fuzz: request " << request << ": " << what << std::endl;
+        std::abort();
+    }
+
+    /**
+     * @struct Fill
+     * @brief One execution, as seen by both books
+     */
+    struct Fill
+    {
+        int buyOrderId;
+        int sellOrderId;
+        int buyFirmId;
+        int sellFirmId;
+        double price;
+        int quantity;
+    };
+
+    /**
+     * @struct ReferenceOrder
+     * @brief Resting order of the reference book
+     */
+    struct ReferenceOrder
+    {
+        int idorder;
+        OrderType side;
+        bool market;
+        double price;
+        int quantity; ///< Displayed remaining quantity
+        int hiddenQuantity; ///< Iceberg reserve
+        int peakSize; ///< Iceberg peak, 0 for a regular order
+        int idfirm;
+        SelfTradePrevention stpMode;
+        bool gtd;
+        std::chrono::system_clock::time_point expirationDate;
+        std::uint64_t sequence; ///< Entry sequence, decides the aggressor
+        std::uint64_t position; ///< Queue position within the price level
+    };
+
+    /**
+     * @class ReferenceBook
+     * @brief Trivially correct order book: unsorted orders, linear scans
+     */
+    class ReferenceBook
+    {
+    public:
+        void add(const Order& order, std::vector<Fill>& fills)
+        {
+            queue(order);
+            match(fills);
+        }
+
+        /**
+         * @brief Queues a new order without matching, as a batch does
+         */
+        void queue(const Order& order)
+        {
+            ReferenceOrder resting{};
+            resting.idorder = order.idorder;
+            resting.side = order.ordertype;
+            resting.market = order.limitType == LimitType::NONE;
+            resting.price = order.price;
+            resting.quantity = order.quantity;
+            resting.hiddenQuantity = order.hiddenQuantity;
+            resting.peakSize = order.peakSize;
+            resting.idfirm = order.idfirm;
+            resting.stpMode = order.stpMode;
+            resting.gtd = order.timeinforce == TimeInForce::GTD;
+            resting.expirationDate = order.expirationDate;
+            queue(resting);
+        }
+
+        /**
+         * @brief Matches the crossing orders, then cancels what is left of market orders
+         */
+        void match(std::vector<Fill>& fills)
+        {
+            while (true)
+            {
+                int bid = front(OrderType::BID);
+                int ask = front(OrderType::ASK);
+                if (bid < 0 || ask < 0)
+                {
+                    break;
+                }
+                ReferenceOrder& buy = orders[bid];
+                ReferenceOrder& sell = orders[ask];
+                if (!buy.market && !sell.market && buy.price < sell.price)
+                {
+                    break;
+                }
+
+                ReferenceOrder& aggressor = buy.sequence > sell.sequence ? buy : sell;
+                ReferenceOrder& resting = buy.sequence > sell.sequence ? sell : buy;
+
+                if (buy.market && sell.market)
+                {
+                    aggressor.quantity = 0;
+                    aggressor.hiddenQuantity = 0;
+                    cleanup();
+                    continue;
+                }
+
+                if (buy.idfirm == sell.idfirm && aggressor.stpMode != SelfTradePrevention::NONE)
+                {
+                    switch (aggressor.stpMode)
+                    {
+                    case SelfTradePrevention::CANCEL_RESTING:
+                        resting.quantity = resting.hiddenQuantity = 0;
+                        break;
+                    case SelfTradePrevention::CANCEL_AGGRESSOR:
+                        aggressor.quantity = aggressor.hiddenQuantity = 0;
+                        break;
+                    case SelfTradePrevention::CANCEL_BOTH:
+                        resting.quantity = resting.hiddenQuantity = 0;
+                        aggressor.quantity = aggressor.hiddenQuantity = 0;
+                        break;
+                    case SelfTradePrevention::DECREMENT:
+                    default:
+                    {
+                        int decrement = std::min(buy.quantity, sell.quantity);
+                        buy.quantity -= decrement;
+                        sell.quantity -= decrement;
+                        break;
+                    }
+                    }
+                    cleanup();
+                    continue;
+                }
+
+                // Every trade prints at a limit price: a resting market order has none
+                double price = resting.market ? aggressor.price : resting.price;
+                int quantity = std::min(aggressor.quantity, resting.quantity);
+                fills.push_back({buy.idorder, sell.idorder, buy.idfirm, sell.idfirm, price, quantity});
+                buy.quantity -= quantity;
+                sell.quantity -= quantity;
+                cleanup();
+            }
+
+            orders.erase(std::remove_if(orders.begin(), orders.end(), [](const ReferenceOrder& order)
+            {
+                return order.market;
+            }), orders.end());
+        }
+
+        bool cancel(int idorder, int idfirm)
+        {
+            auto it = find(idorder);
+            if (it == orders.end() || !isOwnedBy(*it, idfirm))
+            {
+                return false;
+            }
+            orders.erase(it);
+            return true;
+        }
+
+        bool amend(int idorder, double price, int quantity, int idfirm, std::vector<Fill>& fills)
+        {
+            auto it = find(idorder);
+            if (it == orders.end() || quantity <= 0 || !isOwnedBy(*it, idfirm))
+            {
+                return false;
+            }
+
+            int remaining = it->quantity + it->hiddenQuantity;
+            if (price == it->price && quantity <= remaining)
+            {
+                int cut = remaining - quantity;
+                int fromHidden = std::min(cut, it->hiddenQuantity);
+                it->hiddenQuantity -= fromHidden;
+                it->quantity -= cut - fromHidden;
+                return true;
+            }
+
+            ReferenceOrder amended = *it;
+            orders.erase(it);
+            amended.price = price;
+            amended.quantity = amended.peakSize > 0 ? std::min(amended.peakSize, quantity) : quantity;
+            amended.hiddenQuantity = quantity - amended.quantity;
+            queue(amended);
+            match(fills);
+            return true;
+        }
+
+        int expire(std::chrono::system_clock::time_point now)
+        {
+            auto expired = std::remove_if(orders.begin(), orders.end(), [now](const ReferenceOrder& order)
+            {
+                return order.gtd && order.expirationDate <= now;
+            });
+            int count = static_cast<int>(orders.end() - expired);
+            orders.erase(expired, orders.end());
+            return count;
+        }
+
+        /**
+         * @brief Aggregates the limit orders of one side, best price first
+         */
+        std::vector<DepthLevel> getDepth(OrderType side) const
+        {
+            std::map<double, DepthLevel> levels;
+            for (const ReferenceOrder& order : orders)
+            {
+                if (order.side == side && !order.market)
+                {
+                    DepthLevel& level = levels.emplace(order.price, DepthLevel{order.price, 0, 0}).first->second;
+                    level.quantity += order.quantity;
+                    ++level.orderCount;
+                }
+            }
+            std::vector<DepthLevel> depth;
+            for (const auto& [price, level] : levels)
+            {
+                depth.push_back(level);
+            }
+            if (side == OrderType::BID)
+            {
+                std::reverse(depth.begin(), depth.end());
+            }
+            return depth;
+        }
+
+        const std::vector<ReferenceOrder>& getOrders() const { return orders; }
+
+    private:
+        static bool isOwnedBy(const ReferenceOrder& order, int idfirm)
+        {
+            return idfirm == OrderBook::ANY_FIRM || order.idfirm == idfirm;
+        }
+
+        std::vector<ReferenceOrder>::iterator find(int idorder)
+        {
+            return std::find_if(orders.begin(), orders.end(), [idorder](const ReferenceOrder& order)
+            {
+                return order.idorder == idorder;
+            });
+        }
+
+        void queue(ReferenceOrder order)
+        {
+            order.sequence = nextSequence++;
+            order.position = nextPosition++;
+            orders.push_back(order);
+        }
+
+        /**
+         * @brief Returns the front order of a side, or -1
+         *
+         * Market orders first, then the best price, then queue position.
+         */
+        int front(OrderType side) const
+        {
+            int best = -1;
+            for (std::size_t i = 0; i < orders.size(); ++i)
+            {
+                const ReferenceOrder& order = orders[i];
+                if (order.side != side)
+                {
+                    continue;
+                }
+                if (best < 0)
+                {
+                    best = static_cast<int>(i);
+                    continue;
+                }
+                const ReferenceOrder& current = orders[best];
+                bool better;
+                if (order.market != current.market)
+                {
+                    better = order.market;
+                }
+                else if (!order.market && order.price != current.price)
+                {
+                    better = side == OrderType::BID ? order.price > current.price : order.price < current.price;
+                }
+                else
+                {
+                    better = order.position < current.position;
+                }
+                best = better ? static_cast<int>(i) : best;
+            }
+            return best;
+        }
+
+        /**
+         * @brief Refills exhausted icebergs and removes other exhausted orders
+         */
+        void cleanup()
+        {
+            for (ReferenceOrder& order : orders)
+            {
+                if (order.quantity == 0 && order.hiddenQuantity > 0)
+                {
+                    int refill = std::min(order.peakSize, order.hiddenQuantity);
+                    order.quantity = refill;
+                    order.hiddenQuantity -= refill;
+                    order.position = nextPosition++;
+                }
+            }
+            orders.erase(std::remove_if(orders.begin(), orders.end(), [](const ReferenceOrder& order)
+            {
+                return order.quantity == 0;
+            }), orders.end());
+        }
+
+        std::vector<ReferenceOrder> orders; ///< Resting orders, in no particular order
+        std::uint64_t nextSequence = 1; ///< Entry sequence of the next queued order
+        std::uint64_t nextPosition = 1; ///< Queue position of the next queued or refilled order
+    };
+
+    /**
+     * @brief Reads the fuzz input one byte at a time, zeros past the end
+     */
+    class InputReader
+    {
+    public:
+        InputReader(const std::uint8_t* data, std::size_t size) : data(data), size(size)
+        {
+        }
+
+        bool atEnd() const { return offset >= size; }
+
+        unsigned next() { return offset < size ? data[offset++] : 0; }
+
+    private:
+        const std::uint8_t* data;
+        std::size_t size;
+        std::size_t offset = 0;
+    };
+
+    double tickPrice(unsigned byte)
+    {
+        return (BASE_TICK + static_cast<int>(byte % PRICE_TICKS)) * PRICE_TICK;
+    }
+
+    /**
+     * @brief Decodes a new order: limit, iceberg one time in four, or market
+     */
+    Order decodeOrder(InputReader& input, bool market, std::chrono::system_clock::time_point now, int idorder)
+    {
+        unsigned flags = input.next();
+        OrderType side = flags & 1 ? OrderType::ASK : OrderType::BID;
+        LimitType limitType = market ? LimitType::NONE : LimitType::LIMIT;
+        double price = market ? 0.0 : tickPrice(input.next());
+        int quantity = 1 + static_cast<int>(input.next() % 64);
+        int idfirm = 1 + static_cast<int>((flags >> 1) % FIRM_COUNT);
+        bool gtd = !market && (flags & 0x80) != 0;
+
+        Order order = gtd
+                          ? Order(idorder, "XPAR", "EUR", now, price, quantity, TimeInForce::GTD, side,
+                                  limitType, 1, quantity, idfirm, now + std::chrono::seconds(input.next() % 64))
+                          : Order(idorder, "XPAR", "EUR", now, price, quantity, TimeInForce::DAY, side,
+                                  limitType, 1, quantity, idfirm);
+        order.stpMode = static_cast<SelfTradePrevention>((flags >> 3) % 5);
+        if (!market && (flags & 0x60) == 0x60)
+        {
+            order.setIcebergPeak(1 + static_cast<int>(input.next() % 16));
+        }
+        return order;
+    }
+
+    /**
+     * @brief Checks the trades, depth and resting orders of both books
+     */
+    void compare(long long request, const OrderBook& book, const ReferenceBook& reference,
+                 const std::vector<Fill>& fills, std::size_t& tradesSeen)
+    {
+        const std::vector<Trade>& trades = book.getTrades();
+        if (trades.size() - tradesSeen != fills.size())
+        {
+            fail(request, "book executed " + std::to_string(trades.size() - tradesSeen) + " trades, reference " +
+                 std::to_string(fills.size()));
+        }
+        for (const Fill& fill : fills)
+        {
+            const Trade& trade = trades[tradesSeen++];
+            if (trade.buyOrderId != fill.buyOrderId || trade.sellOrderId != fill.sellOrderId ||
+                trade.buyFirmId != fill.buyFirmId || trade.sellFirmId != fill.sellFirmId ||
+                trade.price != fill.price || trade.quantity != fill.quantity)
+            {
+                fail(request, "trade " + std::to_string(trade.tradeId) + " " + std::to_string(trade.buyOrderId) +
+                     "/" + std::to_string(trade.sellOrderId) + " " + std::to_string(trade.quantity) + "@" +
+                     std::to_string(trade.price) + ", reference " + std::to_string(fill.buyOrderId) + "/" +
+                     std::to_string(fill.sellOrderId) + " " + std::to_string(fill.quantity) + "@" +
+                     std::to_string(fill.price));
+            }
+        }
+
+        for (OrderType side : {OrderType::BID, OrderType::ASK})
+        {
+            std::vector<DepthLevel> expected = reference.getDepth(side);
+            std::vector<DepthLevel> actual = book.getDepth(side, expected.size() + 1);
+            if (actual.size() != expected.size())
+            {
+                fail(request, "depth has " + std::to_string(actual.size()) + " levels, reference " +
+                     std::to_string(expected.size()));
+            }
+            int orderCount = 0;
+            for (std::size_t i = 0; i < expected.size(); ++i)
+            {
+                if (actual[i].price != expected[i].price || actual[i].quantity != expected[i].quantity ||
+                    actual[i].orderCount != expected[i].orderCount)
+                {
+                    fail(request, "depth level " + std::to_string(i) + " differs at price " +
+                         std::to_string(expected[i].price));
+                }
+                orderCount += expected[i].orderCount;
+            }
+            if (book.getOrderCount(side) != orderCount)
+            {
+                fail(request, "book holds " + std::to_string(book.getOrderCount(side)) + " orders on a side, reference " +
+                     std::to_string(orderCount));
+            }
+        }
+
+        for (const ReferenceOrder& expected : reference.getOrders())
+        {
+            const Order* order = book.findOrder(expected.idorder);
+            if (order == nullptr || order->ordertype != expected.side || order->price != expected.price ||
+                order->quantity != expected.quantity || order->hiddenQuantity != expected.hiddenQuantity)
+            {
+                fail(request, "resting order " + std::to_string(expected.idorder) + " differs");
+            }
+        }
+    }
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const std::uint8_t* data, std::size_t size)
+{
+    // The book logs every fill on stdout
+    static NullBuffer discarded;
+    static std::streambuf* console = std::cout.rdbuf(&discarded);
+    static_cast<void>(console);
+
+    SimulatedClock clock;
+    std::chrono::system_clock::time_point now(SESSION_START);
+    clock.set(now);
+    OrderBook book;
+    book.setClock(&clock);
+    ReferenceBook reference;
+
+    InputReader input(data, size);
+    std::vector<Fill> fills;
+    std::size_t tradesSeen = 0;
+    int nextOrderId = 1;
+
+    for (long long request = 0; !input.atEnd(); ++request)
+    {
+        fills.clear();
+        unsigned op = input.next() % 9;
+        switch (op)
+        {
+        case 0:
+        case 1:
+        case 2:
+        case 3: // New limit order
+        case 4: // New market order
+        {
+            Order order = decodeOrder(input, op == 4, now, nextOrderId++);
+            book.addOrder(order);
+            book.matchOrders();
+            reference.add(order, fills);
+            break;
+        }
+        case 8: // Batch of new orders, one market order in four, matched once
+        {
+            int count = 2 + static_cast<int>(input.next() % (MAX_BATCH - 1));
+            for (int i = 0; i < count; ++i)
+            {
+                Order order = decodeOrder(input, input.next() % 4 == 0, now, nextOrderId++);
+                book.addOrder(order);
+                reference.queue(order);
+            }
+            book.matchOrders();
+            reference.match(fills);
+            break;
+        }
+        case 5: // Cancel, sometimes of an unknown order or by another firm
+        {
+            int idorder = 1 + static_cast<int>(input.next() % nextOrderId);
+            unsigned firm = input.next() % (FIRM_COUNT + 2);
+            int idfirm = firm == 0 ? OrderBook::ANY_FIRM : static_cast<int>(firm);
+            bool cancelled = book.cancelOrder(idorder, idfirm);
+            if (cancelled != reference.cancel(idorder, idfirm))
+            {
+                fail(request, "cancel of order " + std::to_string(idorder) + " returned " +
+                     (cancelled ? "true" : "false"));
+            }
+            break;
+        }
+        case 6: // Amend, zero quantities included
+        {
+            int idorder = 1 + static_cast<int>(input.next() % nextOrderId);
+            double price = tickPrice(input.next());
+            int quantity = static_cast<int>(input.next() % 64);
+            unsigned firm = input.next() % (FIRM_COUNT + 2);
+            int idfirm = firm == 0 ? OrderBook::ANY_FIRM : static_cast<int>(firm);
+            const Order* current = book.findOrder(idorder);
+            if (current != nullptr && (firm & 1) != 0)
+            {
+                price = current->price; // Exercise the priority-preserving path
+            }
+
+            bool amended = book.amendOrder(idorder, price, quantity, idfirm);
+            if (amended)
+            {
+                book.matchOrders();
+            }
+            if (amended != reference.amend(idorder, price, quantity, idfirm, fills))
+            {
+                fail(request, "amend of order " + std::to_string(idorder) + " returned " +
+                     (amended ? "true" : "false"));
+            }
+            break;
+        }
+        case 7: // Time passes, then a GTD sweep
+        {
+            now += std::chrono::seconds(input.next() % 16);
+            clock.set(now);
+            int expired = book.removeExpiredOrders(now);
+            if (expired != reference.expire(now))
+            {
+                fail(request, "expiry sweep removed " + std::to_string(expired) + " orders");
+            }
+            break;
+        }
+        default:
+            break;
+        }
+
+        compare(request, book, reference, fills, tradesSeen);
+        ++operations;
+    }
+    return 0;
+}
+
+#ifndef ORDER_BOOK_LIBFUZZER
+
+/**
+ * @brief Standalone driver
+ *
+ * With arguments, replays each file as one input. Without, runs a fixed
+ * number of random inputs and prints the rate of requests checked.
+ */
+int main(int argc, char** argv)
+{
+    if (argc > 1)
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            std::ifstream file(argv[i], std::ios::binary);
+            std::vector<std::uint8_t> input((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+            LLVMFuzzerTestOneInput(input.data(), input.size());
+        }
+        std::printf("Replayed %d inputs, %lld requests\n", argc - 1, operations);
+        return 0;
+    }
+
+    // Deterministic, so a failing input can be reproduced
+    FastRandom random(0x0D1FFULL);
+    const int iterations = 2000;
+    const std::size_t inputSize = 4096;
+    std::vector<std::uint8_t> input(inputSize);
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i)
+    {
+        for (std::uint8_t& byte : input)
+        {
+            byte = static_cast<std::uint8_t>(random.next());
+        }
+        LLVMFuzzerTestOneInput(input.data(), input.size());
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::printf("Fuzzed %d inputs, %lld requests in %.2f s, %.0f requests/min\n", iterations, operations, seconds,
+                seconds > 0.0 ? operations / seconds * 60.0 : 0.0);
+    return 0;
+}
+
+#endif // ORDER_BOOK_LIBFUZZER
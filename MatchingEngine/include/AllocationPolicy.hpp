@@ -0,0 +1,154 @@
+/**
+ * @file AllocationPolicy.hpp
+ * @brief Compile-time allocation policies used by the matching loop
+ *
+ * An allocation policy decides how the quantity of an aggressor order is
+ * shared among the orders resting at the touch. Policies are plain structs
+ * with a static template member, so the matching loop is instantiated once
+ * per policy and the allocation is inlined, with no virtual dispatch.
+ */
+
+#ifndef ALLOCATIONPOLICY_HPP
+#define ALLOCATIONPOLICY_HPP
+
+#include <algorithm>
+#include "PriceLevel.hpp"
+
+/**
+ * @enum AllocationAlgorithm
+ * @brief Allocation algorithm selected for a trading group
+ *
+ * - FIFO: Price-time priority, the oldest order is filled first
+ * - PRO_RATA: Quantity shared in proportion to the resting quantities
+ * - PRICE_TIME_PRO_RATA: Oldest order filled first, remainder shared pro-rata
+ */
+enum class AllocationAlgorithm
+{
+    FIFO, // Price-time priority
+    PRO_RATA, // Proportional allocation at the touch
+    PRICE_TIME_PRO_RATA // Top order priority, then pro-rata
+};
+
+/**
+ * @struct FifoAllocation
+ * @brief Price-time priority: one fill against the front order
+ *
+ * The matching loop calls the policy again for the next front order,
+ * so the whole level is consumed in time priority.
+ */
+struct FifoAllocation
+{
+    /// Only the front order of the level can be filled
+    static constexpr bool FRONT_ONLY = true;
+
+    /**
+     * @brief Fills the front order of the resting level
+     *
+     * @param level Resting level at the touch
+     * @param quantity Quantity of the aggressor order to allocate
+     * @param lotSize Instrument lot size (unused)
+     * @param fill Callable fill(Order&, int) returning the executed quantity
+     * @return int Quantity executed
+     */
+    template <typename Fill>
+    static int allocate(PriceLevel& level, int quantity, int lotSize, Fill&& fill)
+    {
+        (void)lotSize;
+        Order& front = level.front();
+        return fill(front, std::min(quantity, front.quantity));
+    }
+};
+
+/**
+ * @struct ProRataAllocation
+ * @brief Proportional allocation across every order at the touch
+ *
+ * Each order receives its share of the aggressor quantity in proportion
+ * to its displayed quantity, rounded down to whole lots. What is left
+ * after rounding is allocated in time priority.
+ */
+struct ProRataAllocation
+{
+    /// Fills may hit any order of the level
+    static constexpr bool FRONT_ONLY = false;
+
+    /**
+     * @brief Shares the aggressor quantity across the resting level
+     *
+     * @param level Resting level at the touch
+     * @param quantity Quantity of the aggressor order to allocate
+     * @param lotSize Instrument lot size, shares are whole lots
+     * @param fill Callable fill(Order&, int) returning the executed quantity
+     * @return int Quantity executed
+     */
+    template <typename Fill>
+    static int allocate(PriceLevel& level, int quantity, int lotSize, Fill&& fill)
+    {
+        long long levelQuantity = level.getTotalQuantity();
+        int executed = 0;
+        if (levelQuantity <= 0 || quantity <= 0)
+        {
+            return 0;
+        }
+
+        // Proportional shares, rounded down to whole lots
+        if (quantity < levelQuantity)
+        {
+            for (Order& order : level)
+            {
+                long long share = static_cast<long long>(quantity) * order.quantity / levelQuantity;
+                share -= share % lotSize;
+                if (share > 0)
+                {
+                    executed += fill(order, static_cast<int>(share));
+                }
+            }
+        }
+
+        // Rounding remainder (or the whole level when it is smaller) in time priority
+        for (Order& order : level)
+        {
+            if (executed >= quantity)
+            {
+                break;
+            }
+            int remainder = std::min(order.quantity, quantity - executed);
+            if (remainder > 0)
+            {
+                executed += fill(order, remainder);
+            }
+        }
+        return executed;
+    }
+};
+
+/**
+ * @struct PriceTimeProRataAllocation
+ * @brief Hybrid allocation: top order priority, then pro-rata
+ *
+ * The oldest order at the touch is filled first, rewarding the order
+ * that set the price; the remaining quantity is shared pro-rata.
+ */
+struct PriceTimeProRataAllocation
+{
+    /// Fills may hit any order of the level
+    static constexpr bool FRONT_ONLY = false;
+
+    /**
+     * @brief Fills the top order, then shares the rest pro-rata
+     *
+     * @param level Resting level at the touch
+     * @param quantity Quantity of the aggressor order to allocate
+     * @param lotSize Instrument lot size, pro-rata shares are whole lots
+     * @param fill Callable fill(Order&, int) returning the executed quantity
+     * @return int Quantity executed
+     */
+    template <typename Fill>
+    static int allocate(PriceLevel& level, int quantity, int lotSize, Fill&& fill)
+    {
+        int executed = FifoAllocation::allocate(level, quantity, lotSize, fill);
+        return executed + ProRataAllocation::allocate(level, quantity - executed, lotSize, fill);
+    }
+};
+
+#endif // ALLOCATIONPOLICY_HPP
@@ -0,0 +1,328 @@
+/**
+ * @file BookSide.hpp
+ * @brief Defines one side (BID or ASK) of the order book
+ *
+ * Both sides of the book share a single implementation parameterised on
+ * the side. The price ordering and the crossing test are constexpr
+ * functions of the side, so each side gets its own specialised code
+ * with the comparisons inlined, and no branch on the side at run time.
+ */
+
+#ifndef BOOKSIDE_HPP
+#define BOOKSIDE_HPP
+
+#include <map>
+#include <limits>
+#include <vector>
+#include <chrono>
+#include <cstdint>
+#include "Order.hpp"
+#include "PriceLevel.hpp"
+
+/**
+ * @class BookSide
+ * @brief Price levels of one side of the book, best price first
+ *
+ * @tparam Side OrderType::BID (descending prices) or OrderType::ASK (ascending prices)
+ *
+ * Exposes the usual map interface over its levels (begin, find, erase...)
+ * plus the operations that the order book used to duplicate per side.
+ * Level totals are kept consistent by going through PriceLevel; orders
+ * are only added or removed through BookSide so that the side keeps a
+ * running order count.
+ */
+template <OrderType Side>
+class BookSide
+{
+public:
+    /**
+     * @brief Orders prices from the best to the worst for this side
+     */
+    struct PriceCompare
+    {
+        constexpr bool operator()(double lhs, double rhs) const
+        {
+            if constexpr (Side == OrderType::BID)
+            {
+                return lhs > rhs;
+            }
+            else
+            {
+                return lhs < rhs;
+            }
+        }
+    };
+
+    /**
+     * @brief Orders stop prices from the first to trigger to the last
+     *
+     * Buy stops trigger on rising prices, so the lowest stop comes first;
+     * sell stops trigger on falling prices, so the highest comes first.
+     * This is the reverse of the level ordering.
+     */
+    struct StopCompare
+    {
+        constexpr bool operator()(double lhs, double rhs) const
+        {
+            return PriceCompare{}(rhs, lhs);
+        }
+    };
+
+    using Levels = std::map<double, PriceLevel, PriceCompare>;
+    using StopOrders = std::multimap<double, Order, StopCompare>;
+    using iterator = typename Levels::iterator;
+    using const_iterator = typename Levels::const_iterator;
+    using const_reverse_iterator = typename Levels::const_reverse_iterator;
+
+    /// Side of the orders held
+    static constexpr OrderType SIDE = Side;
+
+    /// Display name of the side
+    static constexpr const char* NAME = Side == OrderType::BID ? "BID" : "ASK";
+
+    /// Book key of market orders, ahead of every limit price of the side
+    static constexpr double MARKET_PRICE = Side == OrderType::BID ? std::numeric_limits<double>::max() : 0.0;
+
+    /**
+     * @brief True if lhs is a strictly better price than rhs for this side
+     */
+    static constexpr bool isBetter(double lhs, double rhs)
+    {
+        return PriceCompare{}(lhs, rhs);
+    }
+
+    /**
+     * @brief True if a level of this side trades with an opposite limit price
+     *
+     * @param levelPrice Price of a level of this side
+     * @param limitPrice Limit price of an opposite order (or best opposite level)
+     */
+    static constexpr bool crosses(double levelPrice, double limitPrice)
+    {
+        return !isBetter(limitPrice, levelPrice);
+    }
+
+    /**
+     * @brief True if a stop of this side is triggered by a trade price
+     *
+     * @param stopPrice Stop price of the order
+     * @param lastPrice Price of the last trade
+     */
+    static constexpr bool isTriggered(double stopPrice, double lastPrice)
+    {
+        return !StopCompare{}(lastPrice, stopPrice);
+    }
+
+    /**
+     * @brief Appends an order at the back of the level of its price
+     *
+     * @param order The order to be queued
+     * @return PriceLevel::iterator Position of the queued order
+     */
+    PriceLevel::iterator push(const Order& order)
+    {
+        ++orderCount;
+        return levels[order.price].push(order);
+    }
+
+    /**
+     * @brief Removes a queued order and its level if it becomes empty
+     *
+     * @param price Price of the level holding the order
+     * @param position Position of the order in the level
+     */
+    void erase(double price, PriceLevel::iterator position)
+    {
+        auto levelIt = levels.find(price);
+        levelIt->second.erase(position);
+        --orderCount;
+        if (levelIt->second.empty())
+        {
+            levels.erase(levelIt);
+        }
+    }
+
+    /**
+     * @brief Removes or replenishes exhausted orders at the head of the best levels
+     *
+     * @param now Priority timestamp given to replenished icebergs
+     * @param onRemove Called with each order before it is removed
+     * @param onReplenish Called with each iceberg after its peak is refilled
+     */
+    template <typename OnRemove, typename OnReplenish>
+    void cleanupFront(std::chrono::system_clock::time_point now, OnRemove onRemove, OnReplenish onReplenish)
+    {
+        while (!levels.empty())
+        {
+            auto it = levels.begin();
+            PriceLevel& level = it->second;
+            while (!level.empty() && level.front().quantity == 0)
+            {
+                if (level.front().hiddenQuantity > 0)
+                {
+                    Order& order = level.front();
+                    level.replenishFront(now);
+                    onReplenish(order);
+                }
+                else
+                {
+                    onRemove(level.front());
+                    level.popFront();
+                    --orderCount;
+                }
+            }
+            if (!level.empty())
+            {
+                break;
+            }
+            levels.erase(it);
+        }
+    }
+
+    /**
+     * @brief Removes or replenishes exhausted orders anywhere in one level
+     *
+     * Walks the level once; replenished icebergs move to the back and are
+     * not visited again. An empty level is left for cleanupFront.
+     *
+     * @param level Level of this side whose orders were filled away from the front
+     * @param now Priority timestamp given to replenished icebergs
+     * @param onRemove Called with each order before it is removed
+     * @param onReplenish Called with each iceberg after its peak is refilled
+     */
+    template <typename OnRemove, typename OnReplenish>
+    void sweepExhausted(PriceLevel& level, std::chrono::system_clock::time_point now, OnRemove onRemove,
+                        OnReplenish onReplenish)
+    {
+        int count = level.getOrderCount();
+        auto it = level.begin();
+        for (int i = 0; i < count; ++i)
+        {
+            auto current = it++;
+            if (current->quantity > 0)
+            {
+                continue;
+            }
+            if (current->hiddenQuantity > 0)
+            {
+                level.replenish(current, now);
+                onReplenish(*current);
+            }
+            else
+            {
+                onRemove(*current);
+                level.erase(current);
+                --orderCount;
+            }
+        }
+    }
+
+    /**
+     * @brief Removes every order matching a predicate and the emptied levels
+     *
+     * @param pred Predicate returning true for orders to remove
+     * @return int Number of orders removed
+     */
+    template <typename Predicate>
+    int removeIf(Predicate pred)
+    {
+        int removed = 0;
+        for (auto it = levels.begin(); it != levels.end();)
+        {
+            int levelRemoved = it->second.removeIf(pred);
+            removed += levelRemoved;
+            orderCount -= levelRemoved;
+            it = it->second.empty() ? levels.erase(it) : std::next(it);
+        }
+        return removed;
+    }
+
+    /**
+     * @brief Returns the aggregated best levels, from the best price outwards
+     *
+     * Resting market orders have no price and are left out.
+     *
+     * @param maxLevels Maximum number of levels to return
+     */
+    std::vector<DepthLevel> getDepth(std::size_t maxLevels) const
+    {
+        std::vector<DepthLevel> depth;
+        for (const auto& [price, level] : levels)
+        {
+            if (depth.size() >= maxLevels)
+            {
+                break;
+            }
+            if (price == MARKET_PRICE)
+            {
+                continue;
+            }
+            depth.push_back({price, level.getTotalQuantity(), level.getOrderCount()});
+        }
+        return depth;
+    }
+
+    /**
+     * @brief Returns the displayed quantity resting at a price, 0 if none
+     */
+    long long getQuantityAtPrice(double price) const
+    {
+        auto it = levels.find(price);
+        return it == levels.end() ? 0 : it->second.getTotalQuantity();
+    }
+
+    /**
+     * @brief Returns the quantity an opposite order limited at limitPrice can execute
+     *
+     * Iceberg reserves are executable and therefore counted.
+     */
+    long long getAvailableQuantity(double limitPrice) const
+    {
+        long long available = 0;
+        for (const auto& [price, level] : levels)
+        {
+            if (!crosses(price, limitPrice))
+            {
+                break;
+            }
+            available += level.getTotalQuantity() + level.getHiddenQuantity();
+        }
+        return available;
+    }
+
+    /**
+     * @brief Returns the number of orders resting on this side, in O(1)
+     */
+    int getOrderCount() const { return orderCount; }
+
+    iterator find(double price) { return levels.find(price); }
+    const_iterator find(double price) const { return levels.find(price); }
+
+    /**
+     * @brief Removes a whole level and its orders
+     *
+     * @param position Level to remove
+     * @return iterator Next level
+     */
+    iterator erase(iterator position)
+    {
+        orderCount -= position->second.getOrderCount();
+        return levels.erase(position);
+    }
+
+    bool empty() const { return levels.empty(); }
+    std::size_t size() const { return levels.size(); }
+
+    iterator begin() { return levels.begin(); }
+    iterator end() { return levels.end(); }
+    const_iterator begin() const { return levels.begin(); }
+    const_iterator end() const { return levels.end(); }
+    const_reverse_iterator rbegin() const { return levels.rbegin(); }
+    const_reverse_iterator rend() const { return levels.rend(); }
+
+private:
+    Levels levels; ///< Price levels, best price first
+    int orderCount = 0; ///< Orders resting on this side
+};
+
+#endif // BOOKSIDE_HPP
@@ -0,0 +1,232 @@
+/**
+ * @file BroadcastRing.hpp
+ * @brief Lock-free single-buffer broadcast ring for fixed-size messages
+ *
+ * Producers claim a slot with one atomic increment and encode their
+ * message in place; each consumer keeps its own cursor and reads without
+ * taking any lock, so a slow consumer never blocks the engine. A consumer
+ * that falls more than one ring behind is told it was overrun and must
+ * resynchronise (for market data: from the next snapshot). The ring
+ * state is a single standard-layout block, so it can live in shared
+ * memory and be read from other processes.
+ */
+
+#ifndef BROADCASTRING_HPP
+#define BROADCASTRING_HPP
+
+#include <atomic>
+#include <memory>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
+
+/**
+ * @enum ReadStatus
+ * @brief Outcome of reading one sequence from a broadcast ring
+ *
+ * - OK: The message was copied out
+ * - EMPTY: The sequence has not been published yet
+ * - OVERRUN: The slot was already reused by a later sequence
+ */
+enum class ReadStatus
+{
+    OK, // Message read
+    EMPTY, // Nothing new yet
+    OVERRUN // Reader fell more than one ring behind
+};
+
+/**
+ * @class BroadcastRing
+ * @brief Multi-producer, multi-consumer broadcast ring with per-slot sequences
+ *
+ * @tparam T Trivially copyable message type
+ * @tparam Capacity Number of slots, a power of two
+ *
+ * Sequences start at 1. Each slot stores the sequence of the message it
+ * holds, written last with release ordering; readers check it before and
+ * after copying the payload, as in a seqlock, to detect a concurrent
+ * overwrite. Capacity must exceed the number of concurrent producers.
+ * Sequences are 64-bit atomics, which must be lock-free for the ring to
+ * be shared between processes.
+ */
+template <typename T, std::size_t Capacity>
+class BroadcastRing
+{
+    static_assert((Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+    static_assert(std::is_trivially_copyable<T>::value, "Messages must be trivially copyable");
+
+public:
+    static constexpr std::size_t CAPACITY = Capacity;
+
+    /**
+     * @brief One ring entry, on its own cache lines
+     */
+    struct alignas(64) Slot
+    {
+        std::atomic<std::uint64_t> sequence{0}; ///< Sequence held, 0 while being written
+        T payload; ///< Encoded message
+    };
+
+    /**
+     * @brief Complete ring state, all zeros when empty
+     */
+    struct Storage
+    {
+        alignas(64) std::atomic<std::uint64_t> head{0}; ///< Last claimed sequence
+        Slot slots[Capacity]; ///< Ring entries
+    };
+
+    /**
+     * @brief Allocates the ring state once, on the heap
+     */
+    BroadcastRing() : ownedStorage(new Storage()), storage(ownedStorage.get())
+    {
+    }
+
+    /**
+     * @brief Uses ring state allocated by the caller, e.g. in shared memory
+     *
+     * @param external Zero-filled (new ring) or already used ring state
+     */
+    explicit BroadcastRing(Storage* external) : storage(external)
+    {
+    }
+
+    BroadcastRing(const BroadcastRing&) = delete;
+    BroadcastRing& operator=(const BroadcastRing&) = delete;
+
+    /**
+     * @brief Claims the next slot and encodes a message directly into it
+     *
+     * @param encode Callable encode(T& slot, std::uint64_t sequence)
+     * @return std::uint64_t Sequence of the published message
+     */
+    template <typename Encode>
+    std::uint64_t publish(Encode&& encode)
+    {
+        std::uint64_t sequence = storage->head.fetch_add(1, std::memory_order_relaxed) + 1;
+        Slot& slot = storage->slots[(sequence - 1) & MASK];
+
+        // Mark the slot as being written before touching the payload
+        slot.sequence.store(0, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        encode(slot.payload, sequence);
+        slot.sequence.store(sequence, std::memory_order_release);
+        return sequence;
+    }
+
+    /**
+     * @brief Copies the message of a given sequence
+     *
+     * @param sequence Sequence to read
+     * @param out Destination of the message
+     * @return ReadStatus OK, EMPTY or OVERRUN
+     */
+    ReadStatus read(std::uint64_t sequence, T& out) const
+    {
+        if (storage->head.load(std::memory_order_acquire) < sequence)
+        {
+            return ReadStatus::EMPTY;
+        }
+
+        const Slot& slot = storage->slots[(sequence - 1) & MASK];
+        std::uint64_t before = slot.sequence.load(std::memory_order_acquire);
+        if (before == sequence)
+        {
+            std::memcpy(static_cast<void*>(&out), static_cast<const void*>(&slot.payload), sizeof(T));
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot.sequence.load(std::memory_order_relaxed) == sequence)
+            {
+                return ReadStatus::OK;
+            }
+            return ReadStatus::OVERRUN;
+        }
+        if (before > sequence || storage->head.load(std::memory_order_acquire) - sequence >= Capacity)
+        {
+            return ReadStatus::OVERRUN;
+        }
+
+        // Claimed but still being written
+        return ReadStatus::EMPTY;
+    }
+
+    /**
+     * @brief Returns the sequence of the last claimed message, 0 if none
+     */
+    std::uint64_t getLastSequence() const
+    {
+        return storage->head.load(std::memory_order_acquire);
+    }
+
+    /**
+     * @class Reader
+     * @brief Consumer cursor over a broadcast ring
+     *
+     * Each consumer owns a reader; readers share nothing with each other
+     * or with the producers besides the ring itself.
+     */
+    class Reader
+    {
+    public:
+        /**
+         * @brief Creates a reader positioned after a given sequence
+         *
+         * @param source Ring to read from
+         * @param lastSeen Last sequence already known to the consumer
+         */
+        Reader(const BroadcastRing& source, std::uint64_t lastSeen)
+            : ring(&source), nextSequence(lastSeen + 1)
+        {
+        }
+
+        /**
+         * @brief Reads the next message
+         *
+         * On overrun the cursor skips to the oldest message still in the
+         * ring and the number of lost messages is added to getDropped().
+         *
+         * @param out Destination of the message
+         * @return ReadStatus OK, EMPTY or OVERRUN
+         */
+        ReadStatus poll(T& out)
+        {
+            ReadStatus status = ring->read(nextSequence, out);
+            if (status == ReadStatus::OK)
+            {
+                ++nextSequence;
+            }
+            else if (status == ReadStatus::OVERRUN)
+            {
+                std::uint64_t last = ring->getLastSequence();
+                std::uint64_t oldest = last >= Capacity ? last - Capacity + 2 : 1;
+                dropped += oldest > nextSequence ? oldest - nextSequence : 0;
+                nextSequence = oldest > nextSequence ? oldest : nextSequence + 1;
+            }
+            return status;
+        }
+
+        /**
+         * @brief Returns the next sequence this reader expects
+         */
+        std::uint64_t getNextSequence() const { return nextSequence; }
+
+        /**
+         * @brief Returns the number of messages lost to overruns
+         */
+        std::uint64_t getDropped() const { return dropped; }
+
+    private:
+        const BroadcastRing* ring; ///< Ring being read
+        std::uint64_t nextSequence; ///< Next sequence to read
+        std::uint64_t dropped = 0; ///< Messages lost to overruns
+    };
+
+private:
+    static constexpr std::uint64_t MASK = Capacity - 1;
+
+    std::unique_ptr<Storage> ownedStorage; ///< Heap storage, empty for external storage
+    Storage* storage; ///< Ring state in use
+};
+
+#endif // BROADCASTRING_HPP
@@ -0,0 +1,89 @@
+/**
+ * @file Clock.hpp
+ * @brief Time source of the matching engine and its order books
+ *
+ * Every timestamp that can reach a trade, an order priority or a GTD
+ * expiry is read from a Clock. Production uses SystemClock; replay and
+ * backtests use a SimulatedClock that only moves when told to, so the
+ * same journal always produces the same trades.
+ */
+
+#ifndef CLOCK_HPP
+#define CLOCK_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+/**
+ * @class Clock
+ * @brief Source of wall-clock time
+ */
+class Clock
+{
+public:
+    virtual ~Clock() = default;
+
+    /**
+     * @brief Returns the current time
+     */
+    virtual std::chrono::system_clock::time_point now() const = 0;
+};
+
+/**
+ * @class SystemClock
+ * @brief The real time, std::chrono::system_clock
+ */
+class SystemClock : public Clock
+{
+public:
+    std::chrono::system_clock::time_point now() const override { return std::chrono::system_clock::now(); }
+
+    /**
+     * @brief Returns the shared instance, the default clock of engines and books
+     */
+    static SystemClock& instance()
+    {
+        static SystemClock clock;
+        return clock;
+    }
+};
+
+/**
+ * @class SimulatedClock
+ * @brief Time set explicitly, for deterministic replay
+ *
+ * Starts at the epoch. Safe to read from any thread while one thread
+ * sets it.
+ */
+class SimulatedClock : public Clock
+{
+public:
+    std::chrono::system_clock::time_point now() const override
+    {
+        return std::chrono::system_clock::time_point(std::chrono::duration_cast<std::chrono::system_clock::duration>(
+            std::chrono::nanoseconds(nanoseconds.load(std::memory_order_acquire))));
+    }
+
+    /**
+     * @brief Moves the clock to a time, backwards included
+     */
+    void set(std::chrono::system_clock::time_point time)
+    {
+        nanoseconds.store(std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count(),
+                          std::memory_order_release);
+    }
+
+    /**
+     * @brief Moves the clock forward
+     */
+    void advance(std::chrono::nanoseconds duration)
+    {
+        nanoseconds.fetch_add(duration.count(), std::memory_order_acq_rel);
+    }
+
+private:
+    std::atomic<std::int64_t> nanoseconds{0}; ///< Current time since the epoch
+};
+
+#endif // CLOCK_HPP
@@ -0,0 +1,149 @@
+/**
+ * @file ConflatingSubscriber.hpp
+ * @brief Throttled Level 2 subscriber that coalesces updates per level
+ *
+ * Slow consumers (GUI, dashboards) read the Level 2 data through a
+ * conflation stage that keeps up with the feed: each book folds its
+ * deltas into a conflated image as it publishes them (see
+ * MarketDataPublisher::updateImage). The subscriber samples the images
+ * that changed and hands out only the net change of each level since the
+ * previous delivery, at most once per interval or when the consumer asks
+ * for it. Sampling reads state rather than a queue, so a consumer that
+ * falls behind loses nothing but intermediate states, which are counted.
+ * The engine and the fast feed never wait for a conflating subscriber.
+ */
+
+#ifndef CONFLATINGSUBSCRIBER_HPP
+#define CONFLATINGSUBSCRIBER_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <tuple>
+#include <vector>
+#include "MarketDataPublisher.hpp"
+
+/**
+ * @struct ConflationStats
+ * @brief Counters of one conflating subscriber
+ *
+ * Every delta is accounted for: received + depthMoves == delivered +
+ * conflated. Each delivery adds to one side only, so a delivery that
+ * both conflates deltas and moves levels across the followed depth
+ * reports their net difference.
+ */
+struct ConflationStats
+{
+    std::uint64_t received = 0; ///< Feed deltas covered by the sampled images
+    std::uint64_t delivered = 0; ///< Conflated messages handed to the consumer
+    std::uint64_t conflated = 0; ///< Deltas a delivery absorbed beyond its messages
+    std::uint64_t depthMoves = 0; ///< Messages a delivery sent beyond its deltas: levels entering or leaving the depth
+    std::uint64_t samples = 0; ///< Changed book images read
+    std::uint64_t flushes = 0; ///< Deliveries performed
+};
+
+/**
+ * @class ConflatingSubscriber
+ * @brief Per-subscriber conflation of the Level 2 feed
+ *
+ * Delivered messages are ADD_LEVEL, UPDATE_LEVEL or DELETE_LEVEL with the
+ * feed sequence of the last delta folded into them; only the best
+ * CONFLATED_DEPTH levels of each side are followed. Not thread-safe:
+ * each consumer thread owns its subscriber.
+ */
+class ConflatingSubscriber
+{
+public:
+    using Callback = std::function<void(const L2Message&)>;
+
+    /**
+     * @brief Subscribes to the conflated images of a feed
+     *
+     * @param publisher Level 2 feed whose book images are sampled
+     * @param interval Minimum time between two deliveries of poll(), 0 to deliver on every poll
+     */
+    ConflatingSubscriber(const MarketDataPublisher& publisher, std::chrono::milliseconds interval);
+
+    /**
+     * @brief Samples the images and delivers the conflated changes if the interval elapsed
+     *
+     * @param callback Receives each conflated message
+     * @return int Number of messages delivered
+     */
+    int poll(const Callback& callback);
+
+    /**
+     * @brief Samples the images and delivers the conflated changes now
+     *
+     * @param callback Receives each conflated message
+     * @return int Number of messages delivered
+     */
+    int flush(const Callback& callback);
+
+    /**
+     * @brief Changes the throttle interval
+     *
+     * @param newInterval Minimum time between two deliveries of poll()
+     */
+    void setInterval(std::chrono::milliseconds newInterval) { interval = newInterval; }
+
+    /**
+     * @brief Returns the subscriber counters
+     */
+    const ConflationStats& getStats() const { return stats; }
+
+private:
+    /// Level identity: book, instrument, side ('B' or 'S'), price
+    using LevelKey = std::tuple<int, int, std::uint8_t, double>;
+
+    /**
+     * @brief Quantity and order count of a level
+     */
+    struct LevelState
+    {
+        long long quantity; ///< Displayed quantity
+        int orderCount; ///< Number of orders
+    };
+
+    /**
+     * @brief Reads the image of every book that changed since the last sample
+     */
+    void sample();
+
+    /**
+     * @brief Replaces the levels of one book with its image
+     *
+     * @param image Image read from the publisher
+     */
+    void apply(const ConflatedBook& image);
+
+    /**
+     * @brief Delivers the net change of every level touched since the last delivery
+     *
+     * @param callback Receives each conflated message
+     * @return int Number of messages delivered
+     */
+    int deliver(const Callback& callback);
+
+    /**
+     * @brief Last sampled state of one book image
+     */
+    struct BookCursor
+    {
+        std::uint64_t writes = 0; ///< Image writes seen
+        std::uint64_t updates = 0; ///< Deltas covered by the last image read
+    };
+
+    const MarketDataPublisher& publisher; ///< Feed whose images are sampled
+    std::vector<BookCursor> cursors; ///< Sampling state, indexed by bookId - 1
+    std::chrono::milliseconds interval; ///< Throttle interval
+    std::chrono::steady_clock::time_point lastDelivery; ///< Time of the last delivery
+    std::uint64_t receivedAtDelivery = 0; ///< Deltas received up to the last delivery
+    std::map<LevelKey, LevelState> current; ///< Books as last sampled
+    std::map<LevelKey, LevelState> delivered; ///< Books as last seen by the consumer
+    std::map<LevelKey, std::uint64_t> dirty; ///< Levels changed since the last delivery, with their last sequence
+    ConflationStats stats; ///< Counters
+};
+
+#endif // CONFLATINGSUBSCRIBER_HPP
@@ -0,0 +1,299 @@
+/**
+ * @file FixProtocol.hpp
+ * @brief FIX 4.4 tag-value codec for order entry
+ *
+ * The parser frames a message on BeginString, BodyLength and CheckSum,
+ * then records each field as a (tag, pointer, length) view into the
+ * receive buffer: no map, no string and no allocation per message.
+ * NewOrderSingle, OrderCancelRequest and OrderCancelReplaceRequest are
+ * mapped onto Order fields in a single pass over the field views.
+ * The writer builds outgoing messages in a fixed buffer and fills in
+ * BodyLength and CheckSum when the message is finished.
+ */
+
+#ifndef FIXPROTOCOL_HPP
+#define FIXPROTOCOL_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include "Order.hpp"
+#include "OrderEntryProtocol.hpp"
+
+/**
+ * @struct FixTag
+ * @brief Numbers of the FIX 4.4 tags used by the engine
+ */
+struct FixTag
+{
+    static constexpr int ACCOUNT = 1;
+    static constexpr int BEGIN_SEQ_NO = 7;
+    static constexpr int BEGIN_STRING = 8;
+    static constexpr int BODY_LENGTH = 9;
+    static constexpr int CHECK_SUM = 10;
+    static constexpr int CL_ORD_ID = 11;
+    static constexpr int CUM_QTY = 14;
+    static constexpr int CURRENCY = 15;
+    static constexpr int END_SEQ_NO = 16;
+    static constexpr int EXEC_ID = 17;
+    static constexpr int MSG_SEQ_NUM = 34;
+    static constexpr int MSG_TYPE = 35;
+    static constexpr int NEW_SEQ_NO = 36;
+    static constexpr int ORDER_ID = 37;
+    static constexpr int ORDER_QTY = 38;
+    static constexpr int ORD_STATUS = 39;
+    static constexpr int ORD_TYPE = 40;
+    static constexpr int ORIG_CL_ORD_ID = 41;
+    static constexpr int POSS_DUP_FLAG = 43;
+    static constexpr int PRICE = 44;
+    static constexpr int REF_SEQ_NUM = 45;
+    static constexpr int SECURITY_ID = 48;
+    static constexpr int SENDER_COMP_ID = 49;
+    static constexpr int SENDING_TIME = 52;
+    static constexpr int SIDE = 54;
+    static constexpr int TARGET_COMP_ID = 56;
+    static constexpr int TEXT = 58;
+    static constexpr int TIME_IN_FORCE = 59;
+    static constexpr int ENCRYPT_METHOD = 98;
+    static constexpr int STOP_PX = 99;
+    static constexpr int CXL_REJ_REASON = 102;
+    static constexpr int HEART_BT_INT = 108;
+    static constexpr int MAX_FLOOR = 111;
+    static constexpr int TEST_REQ_ID = 112;
+    static constexpr int GAP_FILL_FLAG = 123;
+    static constexpr int EXPIRE_TIME = 126;
+    static constexpr int RESET_SEQ_NUM_FLAG = 141;
+    static constexpr int EXEC_TYPE = 150;
+    static constexpr int LEAVES_QTY = 151;
+    static constexpr int SECURITY_EXCHANGE = 207;
+    static constexpr int REF_MSG_TYPE = 372;
+    static constexpr int SESSION_REJECT_REASON = 373;
+    static constexpr int CXL_REJ_RESPONSE_TO = 434;
+};
+
+/// Field separator (SOH)
+constexpr char FIX_SOH = '\x01';
+
+/// Largest message accepted by the parser, BodyLength included
+constexpr std::size_t MAX_FIX_MESSAGE_SIZE = 4096;
+
+/**
+ * @struct FixField
+ * @brief View of one tag=value field in the receive buffer
+ */
+struct FixField
+{
+    int tag; ///< Tag number
+    const char* value; ///< First byte of the value, not terminated
+    std::uint32_t length; ///< Length of the value
+
+    std::string_view view() const { return std::string_view(value, length); }
+};
+
+/**
+ * @class FixMessage
+ * @brief Parsed message, a list of field views
+ *
+ * Valid as long as the buffer it was parsed from is not modified.
+ * The header fields before MsgType (BeginString, BodyLength) and the
+ * trailing CheckSum are checked by the parser and not listed.
+ */
+class FixMessage
+{
+public:
+    /// Maximum number of fields in a message
+    static constexpr std::size_t MAX_FIELDS = 64;
+
+    /**
+     * @brief Returns the MsgType of the message
+     */
+    std::string_view getMsgType() const { return msgType; }
+
+    /**
+     * @brief Returns the MsgSeqNum of the message, 0 if it has none
+     */
+    std::uint32_t getSeqNum() const { return seqNum; }
+
+    /**
+     * @brief Returns the fields in wire order, MsgType first
+     */
+    const FixField* begin() const { return fields; }
+    const FixField* end() const { return fields + fieldCount; }
+
+    /**
+     * @brief Looks up the first field with a tag
+     *
+     * @param tag Tag number
+     * @return const FixField* The field, or nullptr if absent
+     */
+    const FixField* find(int tag) const;
+
+    /**
+     * @brief Returns the value of a field, empty if absent
+     */
+    std::string_view getString(int tag) const;
+
+    /**
+     * @brief Reads an integer field
+     *
+     * @param tag Tag number
+     * @param out Value read
+     * @return true if the field is present and is an integer
+     */
+    bool getInt(int tag, long long& out) const;
+
+private:
+    friend DecodeStatus parseFixMessage(const char* data, std::size_t size, FixMessage& out,
+                                        std::size_t& consumed);
+
+    FixField fields[MAX_FIELDS]; ///< Field views
+    std::size_t fieldCount = 0; ///< Fields in use
+    std::string_view msgType; ///< Value of tag 35
+    std::uint32_t seqNum = 0; ///< Value of tag 34
+};
+
+/**
+ * @brief Parses the message at the front of a receive buffer
+ *
+ * @param data Start of the received bytes
+ * @param size Number of received bytes
+ * @param out Parsed message, valid when OK is returned
+ * @param consumed Bytes to drop from the buffer (0 for INCOMPLETE and FRAMING_ERROR)
+ * @return DecodeStatus OK, INCOMPLETE, MALFORMED (bad checksum or field,
+ *         the message is consumed) or FRAMING_ERROR (BeginString,
+ *         BodyLength or CheckSum position unusable)
+ */
+DecodeStatus parseFixMessage(const char* data, std::size_t size, FixMessage& out, std::size_t& consumed);
+
+/**
+ * @brief Parses a non-negative decimal number without allocating
+ *
+ * @param value Characters of the number, e.g. "101.25"
+ * @param out Value read
+ * @return true if value is digits with at most one decimal point
+ */
+bool parseFixDecimal(std::string_view value, double& out);
+
+/**
+ * @brief Parses a UTCTimestamp (YYYYMMDD-HH:MM:SS[.sss])
+ *
+ * @param value Characters of the timestamp
+ * @param out Time point read
+ * @return true if the timestamp is well formed
+ */
+bool parseFixTimestamp(std::string_view value, std::chrono::system_clock::time_point& out);
+
+/**
+ * @brief Fills an order from a NewOrderSingle (35=D)
+ *
+ * Maps ClOrdID (numeric), SecurityID, SecurityExchange (MIC), Currency,
+ * Side, OrderQty, OrdType (market, limit, stop, stop limit), Price,
+ * StopPx, TimeInForce (day or GTD with ExpireTime) and MaxFloor (iceberg
+ * peak). The string fields are assigned into the caller's order, which
+ * keeps their buffers when the order is reused.
+ *
+ * @param message Parsed NewOrderSingle
+ * @param idfirm Firm of the session
+ * @param now Priority timestamp of the order
+ * @param out Order to fill
+ * @return true if every required field is present and supported
+ */
+bool fixToOrder(const FixMessage& message, int idfirm, std::chrono::system_clock::time_point now, Order& out);
+
+/**
+ * @struct FixOrderChange
+ * @brief Content of an OrderCancelRequest or OrderCancelReplaceRequest
+ *
+ * The string views point into the parsed message. StopPx is not read:
+ * a replace of an untriggered stop keeps its stop price, as described
+ * in MatchingEngine::amendOrder.
+ */
+struct FixOrderChange
+{
+    int idorder = 0; ///< ClOrdID of the request
+    int origIdorder = 0; ///< OrigClOrdID, the order to change
+    int idinstrument = 0; ///< SecurityID
+    std::string_view marketIdentificationCode; ///< SecurityExchange
+    std::string_view tradingCurrency; ///< Currency
+    double newPrice = 0.0; ///< Price, replace only
+    int newQuantity = 0; ///< OrderQty, replace only
+};
+
+/**
+ * @brief Reads an OrderCancelRequest (35=F) or OrderCancelReplaceRequest (35=G)
+ *
+ * @param message Parsed request
+ * @param out Content of the request
+ * @return true if every required field is present
+ */
+bool fixToOrderChange(const FixMessage& message, FixOrderChange& out);
+
+/**
+ * @class FixWriter
+ * @brief Builds one outgoing message in a fixed buffer
+ *
+ * Usage: begin(), add() each body field, then finish() which writes
+ * BeginString, BodyLength and CheckSum around the body. Fields that
+ * do not fit are dropped and finish() returns an empty view.
+ */
+class FixWriter
+{
+public:
+    /// Capacity of the message buffer
+    static constexpr std::size_t CAPACITY = 1024;
+
+    /**
+     * @brief Starts a message with its standard header
+     *
+     * @param msgType MsgType
+     * @param seqNum MsgSeqNum
+     * @param senderCompId SenderCompID
+     * @param targetCompId TargetCompID
+     * @param sendingTime SendingTime
+     */
+    void begin(std::string_view msgType, std::uint32_t seqNum, std::string_view senderCompId,
+               std::string_view targetCompId, std::chrono::system_clock::time_point sendingTime);
+
+    void add(int tag, std::string_view value);
+    void add(int tag, char value);
+    void add(int tag, long long value);
+    void add(int tag, int value) { add(tag, static_cast<long long>(value)); }
+
+    /**
+     * @brief Adds a price, written with at most 8 decimals
+     */
+    void addDecimal(int tag, double value);
+
+    /**
+     * @brief Adds a UTCTimestamp with milliseconds
+     */
+    void addTimestamp(int tag, std::chrono::system_clock::time_point value);
+
+    /**
+     * @brief Completes the message
+     *
+     * @return std::string_view The whole message, empty if it overflowed
+     */
+    std::string_view finish();
+
+private:
+    /// Room kept in front of the body for BeginString and BodyLength
+    static constexpr std::size_t HEADER_RESERVE = 24;
+
+    /**
+     * @brief Appends raw characters to the body
+     */
+    void append(const char* text, std::size_t length);
+
+    /**
+     * @brief Appends "tag="
+     */
+    void appendTag(int tag);
+
+    char buffer[CAPACITY]; ///< Header reserve, body, then trailer
+    std::size_t bodyEnd = HEADER_RESERVE; ///< End of the body written so far
+    bool overflow = false; ///< A field did not fit
+};
+
+#endif // FIXPROTOCOL_HPP
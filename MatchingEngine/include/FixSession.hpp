@@ -0,0 +1,163 @@
+/**
+ * @file FixSession.hpp
+ * @brief Minimal FIX 4.4 acceptor session for order entry
+ *
+ * Transport-agnostic: the owner feeds received bytes to onData(), calls
+ * onTimer() periodically and writes out what getOutput() holds. The
+ * session handles Logon, Heartbeat, TestRequest, ResendRequest (answered
+ * with a gap fill, nothing is stored for resend), SequenceReset and
+ * Logout, and forwards NewOrderSingle, OrderCancelRequest and
+ * OrderCancelReplaceRequest to the MatchingEngine, answering with
+ * ExecutionReports or OrderCancelRejects.
+ */
+
+#ifndef FIXSESSION_HPP
+#define FIXSESSION_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "FixProtocol.hpp"
+#include "MatchingEngine.hpp"
+
+/**
+ * @struct FixSessionStats
+ * @brief Counters of one FIX session
+ */
+struct FixSessionStats
+{
+    std::uint64_t received = 0; ///< Messages parsed
+    std::uint64_t garbled = 0; ///< Messages dropped for a bad checksum or field
+    std::uint64_t orders = 0; ///< Application requests forwarded to the engine
+    std::uint64_t rejected = 0; ///< Application requests refused
+    std::uint64_t sent = 0; ///< Messages written to the output
+};
+
+/**
+ * @class FixSession
+ * @brief One FIX session between the engine and a firm
+ *
+ * A session is configured for one counterparty CompID, which trades
+ * for one firm: a Logon with any other SenderCompID is refused. Not
+ * thread-safe, each session is driven by one thread.
+ */
+class FixSession
+{
+public:
+    /**
+     * @brief Creates a session waiting for a Logon
+     *
+     * @param engine Engine receiving the orders
+     * @param engineCompId CompID of the engine (TargetCompID of the client)
+     * @param clientCompId CompID the client must log on with
+     * @param idfirm Firm the client trades for
+     */
+    FixSession(MatchingEngine& engine, std::string engineCompId, std::string clientCompId, int idfirm);
+
+    /**
+     * @brief Processes received bytes
+     *
+     * @param data Received bytes
+     * @param size Number of received bytes
+     * @param now Current time
+     * @return std::size_t Bytes consumed; the caller keeps the rest and
+     *         passes it again with the next bytes
+     */
+    std::size_t onData(const char* data, std::size_t size, std::chrono::system_clock::time_point now);
+
+    /**
+     * @brief Sends heartbeats and test requests, and times out a silent client
+     *
+     * @param now Current time
+     */
+    void onTimer(std::chrono::system_clock::time_point now);
+
+    /**
+     * @brief Returns the bytes waiting to be sent
+     */
+    std::string_view getOutput() const { return std::string_view(output.data(), output.size()); }
+
+    /**
+     * @brief Drops bytes that were sent from the front of the output
+     *
+     * @param count Number of bytes sent
+     */
+    void consumeOutput(std::size_t count);
+
+    bool isLoggedOn() const { return loggedOn; }
+
+    /**
+     * @brief Tells whether the session ended; the transport closes once the output is sent
+     */
+    bool isClosed() const { return closed; }
+
+    const FixSessionStats& getStats() const { return stats; }
+
+private:
+    /**
+     * @brief Checks sequencing and dispatches one message
+     */
+    void handleMessage(const FixMessage& message, std::chrono::system_clock::time_point now);
+
+    /**
+     * @brief Handles a Logon (35=A)
+     */
+    void handleLogon(const FixMessage& message, std::chrono::system_clock::time_point now);
+
+    /**
+     * @brief Handles a NewOrderSingle (35=D)
+     */
+    void handleNewOrder(const FixMessage& message, std::chrono::system_clock::time_point now);
+
+    /**
+     * @brief Handles an OrderCancelRequest (35=F) or OrderCancelReplaceRequest (35=G)
+     */
+    void handleOrderChange(const FixMessage& message, std::chrono::system_clock::time_point now);
+
+    /**
+     * @brief Starts an outgoing message with the next sequence number
+     */
+    void beginMessage(std::string_view msgType, std::chrono::system_clock::time_point now);
+
+    /**
+     * @brief Appends the message being built to the output
+     */
+    void sendMessage(std::chrono::system_clock::time_point now);
+
+    /**
+     * @brief Sends a Logout and ends the session
+     *
+     * @param text Reason given to the client, empty for none
+     */
+    void logout(std::string_view text, std::chrono::system_clock::time_point now);
+
+    /**
+     * @brief Sends a session-level Reject (35=3) of a message
+     */
+    void sendSessionReject(const FixMessage& message, int reason, std::string_view text,
+                           std::chrono::system_clock::time_point now);
+
+    MatchingEngine& engine; ///< Destination of the orders
+    std::string engineCompId; ///< Our CompID
+    std::string clientCompId; ///< Counterparty CompID
+    int idfirm; ///< Firm of the counterparty
+    bool loggedOn = false; ///< Logon accepted
+    bool closed = false; ///< Logout sent or received, or fatal error
+    bool resendRequested = false; ///< A ResendRequest is outstanding for the current gap
+    bool testRequestSent = false; ///< A TestRequest is outstanding
+    std::uint32_t expectedSeqNum = 1; ///< Next inbound MsgSeqNum
+    std::uint32_t nextSeqNum = 1; ///< Next outbound MsgSeqNum
+    std::chrono::seconds heartbeatInterval{30}; ///< Negotiated at logon
+    std::chrono::system_clock::time_point lastReceived; ///< Time of the last inbound message
+    std::chrono::system_clock::time_point lastSent; ///< Time of the last outbound message
+    std::uint64_t nextExecId = 1; ///< ExecID of the next ExecutionReport
+    FixWriter writer; ///< Message being built
+    std::vector<char> output; ///< Bytes waiting to be sent
+    Order entryOrder; ///< Reused for every NewOrderSingle, keeps its string buffers
+    FixSessionStats stats; ///< Counters
+};
+
+#endif // FIXSESSION_HPP
@@ -10,6 +10,7 @@
 #define INSTRUMENT_MANAGER_HPP
 
 #include <set>
+#include <string>
 #include <vector>
 #include "Instrument.hpp"
 #include "Utils.hpp"
@@ -38,7 +39,8 @@ public:
      *
      * @param instrument The instrument to be added
      * @return true if the instrument was successfully added
-     * @return false if the instrument already exists
+     * @return false if the instrument already exists or has more price
+     *         decimals than TradingStats::NOTIONAL_DECIMALS
      */
     bool addInstrument(const Instrument& instrument);
 
@@ -48,6 +50,23 @@ public:
      * @return const std::vector<Instrument>& Reference to the vector of instruments
      */
     const std::vector<Instrument>& getInstruments() const;
+
+    /**
+     * @brief Adds the instruments listed in a CSV file
+     *
+     * Expects the InputData/instrument_input.csv layout: a header line,
+     * then idinstrument, name, issue, state, refprice, idtradinggroup,
+     * lotsize, pricedecimal, currentorderid, currenttradeid, idapf. The
+     * file carries no market or currency, so every instrument gets the
+     * given ones. Invalid lines are reported on stderr and skipped.
+     *
+     * @param path CSV file
+     * @param marketIdentificationCode MIC of the instruments
+     * @param tradingCurrency Currency of the instruments
+     * @return int Number of instruments added, -1 if the file cannot be read
+     */
+    int loadFromCsv(const std::string& path, const std::string& marketIdentificationCode,
+                    const std::string& tradingCurrency);
 };
 
 #endif // INSTRUMENT_MANAGER_HPP
\ No newline at end of file
@@ -0,0 +1,175 @@
+/**
+ * @file InstrumentStats.hpp
+ * @brief Incremental per-instrument and per-firm trading statistics
+ *
+ * Every structure here is updated in O(1) per fill, so the order books
+ * maintain them inside the matching loop. The session figures and the
+ * bars never allocate after construction; a book allocates the figures
+ * of a firm on its first fill in that book and keeps them, zeroed,
+ * across daily resets. Notional follows TradingStats: an integer in
+ * units of 10^-TradingStats::NOTIONAL_DECIMALS, exact whatever the
+ * number of fills.
+ */
+
+#ifndef INSTRUMENTSTATS_HPP
+#define INSTRUMENTSTATS_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "TradingStats.hpp"
+
+/**
+ * @struct InstrumentTradeStats
+ * @brief Session open, high, low, last, VWAP and volume of one instrument
+ */
+struct InstrumentTradeStats
+{
+    double open = 0.0; ///< Price of the first trade of the session
+    double high = 0.0; ///< Highest trade price of the session
+    double low = 0.0; ///< Lowest trade price of the session
+    double last = 0.0; ///< Price of the latest trade
+    std::int64_t quantity = 0; ///< Quantity traded, the VWAP denominator
+    std::int64_t notional = 0; ///< Sum of price x quantity, the VWAP numerator
+    std::int64_t tradeCount = 0; ///< Trades of the session
+
+    /**
+     * @brief Adds one fill
+     */
+    void record(double price, int fillQuantity, std::int64_t fillNotional)
+    {
+        if (tradeCount == 0)
+        {
+            open = high = low = price;
+        }
+        high = price > high ? price : high;
+        low = price < low ? price : low;
+        last = price;
+        quantity += fillQuantity;
+        notional += fillNotional;
+        ++tradeCount;
+    }
+
+    /**
+     * @brief Returns the volume-weighted average price, 0 before the first trade
+     */
+    double getVwap() const
+    {
+        return quantity == 0 ? 0.0 : static_cast<double>(notional) / TradingStats::NOTIONAL_SCALE / quantity;
+    }
+};
+
+/**
+ * @struct FirmTradeStats
+ * @brief Traded volume of one firm
+ *
+ * Kept per book, under the book lock, and summed over the books on read.
+ * A fill between two orders of the same firm counts as one trade of the
+ * firm, with both its bought and sold quantity and twice its notional.
+ */
+struct FirmTradeStats
+{
+    std::int64_t boughtQuantity = 0; ///< Quantity bought
+    std::int64_t soldQuantity = 0; ///< Quantity sold
+    std::int64_t notional = 0; ///< Notional bought and sold, in 10^-NOTIONAL_DECIMALS
+    std::int64_t tradeCount = 0; ///< Fills the firm took part in, on one side or both
+
+    /**
+     * @brief Adds the figures of the firm in another book
+     */
+    void add(const FirmTradeStats& other)
+    {
+        boughtQuantity += other.boughtQuantity;
+        soldQuantity += other.soldQuantity;
+        notional += other.notional;
+        tradeCount += other.tradeCount;
+    }
+
+    /**
+     * @brief Returns the notional in currency units
+     */
+    double getVolume() const { return static_cast<double>(notional) / TradingStats::NOTIONAL_SCALE; }
+};
+
+/**
+ * @struct TradeBar
+ * @brief Open, high, low, close and volume over one time bucket
+ */
+struct TradeBar
+{
+    std::chrono::system_clock::time_point start; ///< Start of the bucket
+    double open = 0.0; ///< First trade price in the bucket
+    double high = 0.0; ///< Highest trade price in the bucket
+    double low = 0.0; ///< Lowest trade price in the bucket
+    double close = 0.0; ///< Last trade price in the bucket
+    std::int64_t quantity = 0; ///< Quantity traded in the bucket
+    std::int64_t notional = 0; ///< Notional traded in the bucket, in 10^-NOTIONAL_DECIMALS
+    std::int64_t tradeCount = 0; ///< Trades in the bucket
+
+    /**
+     * @brief Returns the volume-weighted average price of the bucket
+     */
+    double getVwap() const
+    {
+        return quantity == 0 ? 0.0 : static_cast<double>(notional) / TradingStats::NOTIONAL_SCALE / quantity;
+    }
+};
+
+/**
+ * @enum BarPeriod
+ * @brief Bucket sizes maintained by the order books
+ */
+enum class BarPeriod
+{
+    SECOND,
+    MINUTE
+};
+
+/**
+ * @class BarSeries
+ * @brief Latest bars of one period in a ring preallocated at construction
+ *
+ * Buckets without trades are skipped rather than stored, so a ring of N
+ * bars holds the N latest buckets that traded.
+ */
+class BarSeries
+{
+public:
+    /**
+     * @brief Creates an empty series
+     *
+     * @param period Duration of a bar
+     * @param capacity Number of bars kept, at least 1
+     */
+    BarSeries(std::chrono::milliseconds period, std::size_t capacity);
+
+    /**
+     * @brief Adds one fill to the bar of its timestamp
+     *
+     * Fills are expected in time order; a fill older than the current
+     * bar is counted in the current bar.
+     */
+    void record(std::chrono::system_clock::time_point timestamp, double price, int quantity,
+                std::int64_t notional);
+
+    /**
+     * @brief Returns the latest bars, oldest first
+     *
+     * @param maxCount Maximum number of bars returned
+     */
+    std::vector<TradeBar> getBars(std::size_t maxCount) const;
+
+    /**
+     * @brief Returns the duration of a bar
+     */
+    std::chrono::milliseconds getPeriod() const { return period; }
+
+private:
+    std::chrono::milliseconds period; ///< Duration of a bar
+    std::vector<TradeBar> bars; ///< Ring of bars, sized once
+    std::size_t current = 0; ///< Index of the latest bar
+    std::size_t count = 0; ///< Bars in use
+};
+
+#endif // INSTRUMENTSTATS_HPP
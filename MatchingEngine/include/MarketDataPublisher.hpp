@@ -0,0 +1,210 @@
+/**
+ * @file MarketDataPublisher.hpp
+ * @brief Level 2 (price level) market data feed of the order books
+ *
+ * Order books report the levels they changed at the end of each
+ * mutation; the publisher encodes one fixed-size binary delta per level
+ * straight into a broadcast ring. Periodic snapshots let new or overrun
+ * consumers rebuild the book without asking the engine for anything.
+ *
+ * Next to the ring, each book keeps a conflated image of its best levels
+ * up to date as it publishes: slow consumers sample the images at their
+ * own pace instead of reading every delta, and cannot be overrun.
+ */
+
+#ifndef MARKETDATAPUBLISHER_HPP
+#define MARKETDATAPUBLISHER_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include "Order.hpp"
+#include "BroadcastRing.hpp"
+#include "PriceLevel.hpp"
+#include "SeqLock.hpp"
+
+/**
+ * @enum L2MessageType
+ * @brief Type of a Level 2 message, sent as a single ASCII byte
+ *
+ * A snapshot of one instrument is SNAPSHOT_BEGIN, one SNAPSHOT_LEVEL per
+ * level (best prices first, bids then asks) and SNAPSHOT_END. Deltas for
+ * that instrument with a higher sequence apply on top of it.
+ */
+enum class L2MessageType : std::uint8_t
+{
+    ADD_LEVEL = 'A', // New price level
+    UPDATE_LEVEL = 'U', // Quantity or order count of a level changed
+    DELETE_LEVEL = 'D', // Price level removed
+    SNAPSHOT_BEGIN = 'S', // Start of a full snapshot, orderCount = number of levels
+    SNAPSHOT_LEVEL = 'L', // One level of a snapshot
+    SNAPSHOT_END = 'E' // End of a snapshot
+};
+
+/**
+ * @struct L2Message
+ * @brief Fixed-layout 40-byte Level 2 message
+ *
+ * Fields are ordered by size so the layout has no implicit padding and is
+ * identical on every supported (little-endian) target. Quantities are
+ * displayed quantities: iceberg reserves are not disclosed.
+ *
+ * An instrument may trade on several markets and currencies, each with
+ * its own book: consumers key their books by bookId, instrumentId is
+ * informative.
+ */
+struct L2Message
+{
+    std::uint64_t sequence; ///< Feed sequence number, gap-free across instruments
+    double price; ///< Level price (0 for SNAPSHOT_BEGIN/END)
+    std::int64_t quantity; ///< Displayed quantity at the level (0 for DELETE_LEVEL)
+    std::int32_t instrumentId; ///< Instrument identifier
+    std::int32_t bookId; ///< Feed identifier of the book, assigned by the engine at book creation
+    std::int32_t orderCount; ///< Orders at the level, or levels in a snapshot
+    std::uint8_t type; ///< L2MessageType
+    std::uint8_t side; ///< 'B' for bids, 'S' for asks, 0 for snapshot delimiters
+    std::uint8_t reserved[2]; ///< Zero
+};
+
+static_assert(sizeof(L2Message) == 40, "L2Message layout must stay fixed");
+
+/// Levels per side kept in the conflated image of a book
+constexpr std::size_t CONFLATED_DEPTH = 10;
+
+/**
+ * @struct ConflatedBook
+ * @brief Best levels of a book after its last mutation
+ *
+ * Written by the book, under its lock, each time it publishes deltas.
+ * A level pushed beyond CONFLATED_DEPTH leaves the image.
+ */
+struct ConflatedBook
+{
+    std::uint64_t sequence; ///< Feed sequence of the last delta folded into the image
+    std::uint64_t updates; ///< Deltas folded into the image since the book was created
+    std::int32_t instrumentId; ///< Instrument identifier
+    std::int32_t bookId; ///< Feed identifier of the book, 0 until the first write
+    std::int32_t bidLevels; ///< Valid entries of bids
+    std::int32_t askLevels; ///< Valid entries of asks
+    DepthLevel bids[CONFLATED_DEPTH]; ///< Bid levels, best price first
+    DepthLevel asks[CONFLATED_DEPTH]; ///< Ask levels, best price first
+};
+
+/**
+ * @class MarketDataPublisher
+ * @brief Publishes Level 2 deltas and snapshots into a broadcast ring
+ *
+ * Publishing never blocks and never allocates: books of different
+ * instruments can publish concurrently, each message costing one atomic
+ * increment and an in-place encode. Consumers call subscribe() and poll
+ * their reader at their own pace.
+ */
+class MarketDataPublisher
+{
+public:
+    /// Number of messages kept in the ring before the oldest are overwritten
+    static constexpr std::size_t RING_CAPACITY = 1 << 15;
+
+    /// Number of books with a conflated image, book identifiers start at 1
+    static constexpr std::size_t MAX_BOOKS = 4096;
+
+    using Ring = BroadcastRing<L2Message, RING_CAPACITY>;
+
+    MarketDataPublisher();
+
+    /**
+     * @brief Publishes one level message
+     *
+     * @param instrumentId Instrument identifier
+     * @param bookId Feed identifier of the book
+     * @param type Message type
+     * @param side BID or ASK side of the level
+     * @param price Level price
+     * @param quantity Displayed quantity at the level
+     * @param orderCount Number of orders at the level
+     * @return std::uint64_t Feed sequence of the message
+     */
+    std::uint64_t publishLevel(int instrumentId, int bookId, L2MessageType type, OrderType side,
+                               double price, long long quantity, int orderCount);
+
+    /**
+     * @brief Publishes a snapshot delimiter
+     *
+     * @param instrumentId Instrument identifier
+     * @param bookId Feed identifier of the book
+     * @param type SNAPSHOT_BEGIN or SNAPSHOT_END
+     * @param levelCount Number of levels in the snapshot
+     * @return std::uint64_t Feed sequence of the message
+     */
+    std::uint64_t publishSnapshotMarker(int instrumentId, int bookId, L2MessageType type, int levelCount);
+
+    /**
+     * @brief Creates a reader that receives the messages published from now on
+     *
+     * @return Ring::Reader Consumer cursor, owned by the caller
+     */
+    Ring::Reader subscribe() const { return Ring::Reader(ring, ring.getLastSequence()); }
+
+    /**
+     * @brief Returns the sequence of the last published message
+     */
+    std::uint64_t getLastSequence() const { return ring.getLastSequence(); }
+
+    /**
+     * @brief Rewrites the conflated image of a book in place
+     *
+     * Called by the book only, under its lock; books beyond MAX_BOOKS
+     * have no image.
+     *
+     * @param bookId Feed identifier of the book
+     * @param build Callable build(ConflatedBook&) writing the header and the valid levels
+     */
+    template <typename Build>
+    void updateImage(int bookId, Build&& build)
+    {
+        if (bookId < 1 || static_cast<std::size_t>(bookId) > MAX_BOOKS)
+        {
+            return;
+        }
+        images[bookId - 1].update(build);
+        if (imageCount.load(std::memory_order_relaxed) < bookId)
+        {
+            countImage(bookId);
+        }
+    }
+
+    /**
+     * @brief Returns the highest book identifier with an image
+     */
+    int getImageCount() const { return imageCount.load(std::memory_order_acquire); }
+
+    /**
+     * @brief Returns the number of writes of a book image, to skip unchanged books
+     *
+     * @param bookId Feed identifier of the book, 1 to getImageCount()
+     */
+    std::uint64_t getImageWrites(int bookId) const { return images[bookId - 1].getWriteCount(); }
+
+    /**
+     * @brief Reads a consistent copy of a book image without taking any lock
+     *
+     * @param bookId Feed identifier of the book
+     * @param image Receives the image
+     * @return true if the book has published an image
+     */
+    bool readImage(int bookId, ConflatedBook& image) const;
+
+private:
+    /**
+     * @brief Raises the image count to a newly written book
+     *
+     * @param bookId Feed identifier of the book
+     */
+    void countImage(int bookId);
+
+    Ring ring; ///< Shared broadcast ring
+    std::unique_ptr<SeqLock<ConflatedBook>[]> images; ///< Conflated image of each book, indexed by bookId - 1
+    std::atomic<int> imageCount{0}; ///< Highest bookId written to images
+};
+
+#endif // MARKETDATAPUBLISHER_HPP
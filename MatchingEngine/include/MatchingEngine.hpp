@@ -11,43 +11,61 @@
 #define MATCHINGENGINE_HPP
 
 #include <thread>
+#include <cstddef>
+#include <vector>
 #include <atomic>
 #include <chrono>
 #include <mutex>
+#include <map>
+#include <unordered_map>
+#include <tuple>
+#include <string>
+#include <memory>
+#include <functional>
 #include <iostream>
 #include "Trading.hpp"
+#include "LatencyHistogram.hpp"
+#include "TradingStats.hpp"
 #include "OrderBook.hpp"
+#include "MarketDataPublisher.hpp"
 #include "InstrumentManager.hpp"
 #include "Order.hpp"
+#include "Clock.hpp"
+#include "OrderJournal.hpp"
 
 /**
 * @class MatchingEngine
 * @brief Main trading engine that processes and matches orders
 *
 * Provides continuous order matching, statistics tracking, and order management
-* functionality while running in a separate thread.
+* functionality while running in a separate thread. Orders are routed to one
+* order book per instrument.
 */
 class MatchingEngine {
+public:
+   /// Identifies an instrument as (id, market code, currency), as in InstrumentManager
+   using InstrumentKey = std::tuple<int, std::string, std::string>;
+
 private:
-   OrderBook& orderBook;              ///< Reference to the order book
+   std::map<InstrumentKey, OrderBook> orderBooks; ///< One order book per instrument
+   mutable std::mutex booksMutex;     ///< Guards creation and traversal of the order books
    InstrumentManager& instrumentManager; ///< Reference to the instrument manager
+   std::unordered_map<int, SelfTradePrevention> selfTradePrevention; ///< Self-trade prevention mode per firm
+   mutable std::mutex firmConfigMutex; ///< Guards the per-firm configuration
+   std::unordered_map<int, AllocationAlgorithm> allocationByTradingGroup; ///< Allocation per trading group (guarded by booksMutex)
+   TradingPhase tradingPhase = TradingPhase::CONTINUOUS; ///< Phase applied to every book (guarded by booksMutex)
+   MarketDataPublisher marketData;    ///< Level 2 feed of every order book
+   OrderFeed orderFeed;               ///< Level 3 feed in shared memory, once enabled
+   std::unique_ptr<SeqLock<TopOfBook>[]> topOfBook; ///< Top of book of each book, in creation order
+   std::atomic<std::size_t> topOfBookCount{0}; ///< Number of slots in use
+   const Clock* clock = &SystemClock::instance(); ///< Time source of the engine and its books
+   OrderJournal* journal = nullptr;   ///< Journal of the incoming requests, if any
    std::thread engineThread;          ///< Thread for continuous processing
    std::atomic<bool> isRunning;       ///< Engine status flag
 
-   /**
-    * @brief Trading statistics structure
-    *
-    * Holds atomic counters and values for various trading metrics
-    */
-   struct {
-       std::atomic<int> dailyTradeCount{0};    ///< Number of trades for current day
-       std::atomic<double> dailyVolume{0.0};   ///< Trading volume for current day
-       std::chrono::system_clock::time_point lastReset; ///< Last statistics reset time
-       std::atomic<int> totalTradeCount{0};    ///< Total number of trades
-       std::atomic<double> totalVolume{0.0};   ///< Total trading volume
-       std::atomic<int> matchingAttempts{0};   ///< Number of matching attempts
-       std::atomic<int> successfulMatches{0};  ///< Number of successful matches
-   } stats;
+   TradingStats stats; ///< Trade counts, volumes and matching attempts, sharded per thread
+
+   EngineLatency latency; ///< Latency histograms per stage, recorded by the order entry threads
 
    std::mutex displayMutex;           ///< Mutex for thread-safe display operations
 
@@ -58,11 +76,6 @@ private:
     */
    void run();
 
-   /**
-    * @brief Checks and removes expired GTD orders
-    */
-   void checkGTDOrders();
-
    /**
     * @brief Resets daily trading statistics
     */
@@ -72,10 +85,9 @@ public:
    /**
     * @brief Constructs a new MatchingEngine
     *
-    * @param ob Reference to the order book
     * @param im Reference to the instrument manager
     */
-   MatchingEngine(OrderBook& ob, InstrumentManager& im);
+   explicit MatchingEngine(InstrumentManager& im);
 
    /**
     * @brief Destructor ensures proper engine shutdown
@@ -104,6 +116,116 @@ public:
     */
    bool isEngineRunning() const;
 
+   /**
+    * @brief Sets the time source of the engine and of every book
+    *
+    * Trades, amends, iceberg refills, GTD expiry and the engine loop all
+    * read this clock. Call before orders are sent; a SimulatedClock makes
+    * a replay reproducible.
+    *
+    * @param engineClock Clock outliving the engine
+    */
+   void setClock(const Clock& engineClock);
+
+   /**
+    * @brief Returns the time source of the engine
+    */
+   const Clock& getClock() const { return *clock; }
+
+   /**
+    * @brief Journals every new order, cancel, amend and GTD sweep
+    *
+    * Requests are journaled as they enter the engine, rejected ones
+    * included, with the engine clock's time. Requests for one instrument
+    * sent concurrently from several threads may be journaled in another
+    * order than their book applied them. Call before the engine starts.
+    *
+    * @param orderJournal Journal outliving the engine, nullptr to stop journaling
+    */
+   void setJournal(OrderJournal* orderJournal) { journal = orderJournal; }
+
+   /**
+    * @brief Removes the GTD orders expired at the engine clock's time
+    *
+    * Run hourly by the engine thread, and by replays at their recorded times.
+    *
+    * @return int Number of orders removed
+    */
+   int checkGTDOrders();
+
+   /**
+    * @brief Returns the order book of an instrument, creating it if needed
+    *
+    * @param instrument Instrument whose book is requested
+    * @return OrderBook& The instrument's order book
+    */
+   OrderBook& getOrderBook(const Instrument& instrument);
+
+   /**
+    * @brief Looks up the order book of an instrument
+    *
+    * @param key Instrument identifier tuple (id, market code, currency)
+    * @return const OrderBook* The book, or nullptr if no order was ever routed to it
+    */
+   const OrderBook* findOrderBook(const InstrumentKey& key) const;
+
+   /**
+    * @brief Calls a function on every order book, in instrument key order
+    *
+    * Holds the books lock during the walk, so no book is created meanwhile.
+    *
+    * @param visit Called with the key and the book
+    */
+   void forEachOrderBook(const std::function<void(const InstrumentKey&, const OrderBook&)>& visit) const;
+
+   /**
+    * @brief Returns the Level 2 market data feed of the engine
+    *
+    * Consumers call subscribe() on it and poll their reader from their
+    * own thread; books publish deltas as they change and a snapshot of
+    * every book is published every SNAPSHOT_INTERVAL.
+    *
+    * @return const MarketDataPublisher& The feed
+    */
+   const MarketDataPublisher& getMarketDataPublisher() const { return marketData; }
+
+   /**
+    * @brief Publishes every order event in a shared memory Level 3 feed
+    *
+    * Creates the region, lists the existing and future books in its
+    * directory and connects them. Local reader processes attach with
+    * OrderFeed::open.
+    *
+    * @param regionName Name of the shared memory object
+    * @return true if the feed was created
+    */
+   bool enableOrderFeed(const std::string& regionName = OrderFeed::DEFAULT_NAME);
+
+   /// Maximum number of books whose top of book is published
+   static constexpr std::size_t MAX_TOP_OF_BOOK = 4096;
+
+   /**
+    * @brief Returns the number of published top of book slots
+    *
+    * Wait-free; slots are numbered in book creation order.
+    */
+   std::size_t getTopOfBookCount() const { return topOfBookCount.load(std::memory_order_acquire); }
+
+   /**
+    * @brief Reads the top of book of one book without taking any lock
+    *
+    * Safe to call from any thread while the engine runs: the book
+    * publishes through a seqlock and the reader retries only if it
+    * overlapped a write.
+    *
+    * @param index Slot index, below getTopOfBookCount()
+    * @return TopOfBook Consistent copy of the slot
+    */
+   TopOfBook readTopOfBook(std::size_t index) const { return topOfBook[index].load(); }
+
+   /// Interval between two full Level 2 snapshots of every book
+   static constexpr std::chrono::seconds SNAPSHOT_INTERVAL{5};
+
    /**
     * @brief Displays current engine status and basic statistics
     */
@@ -114,6 +236,36 @@ public:
     */
    void displayDetailedStats() const;
 
+   /**
+    * @brief Returns the latency histograms of the order path
+    *
+    * Cleared with the daily statistics.
+    */
+   const EngineLatency& getLatency() const { return latency; }
+
+   /**
+    * @brief Returns the trade counts, volumes and matching attempts
+    */
+   const TradingStats& getStats() const { return stats; }
+
+   /**
+    * @brief Returns the traded volume of a firm since the daily reset
+    *
+    * Sums the figures each book keeps on its fills; per-instrument
+    * figures come from findOrderBook(key)->getTradeStats().
+    *
+    * @param idfirm Firm identifier
+    * @return FirmTradeStats Figures of the firm, zero if it has not traded
+    */
+   FirmTradeStats getFirmStats(int idfirm) const;
+
+   /**
+    * @brief Writes the latency percentiles as one line of JSON
+    *
+    * @param out Destination stream
+    */
+   void dumpLatencyStats(std::ostream& out) const { latency.dump(out); }
+
    /**
     * @brief Displays all active GTD orders
     */
@@ -133,9 +285,106 @@ public:
     */
    bool addAndValidateOrder(const Order& order);
 
+   /**
+    * @brief Validates and adds a batch of new orders, matching each touched book once
+    *
+    * Instruments are resolved and orders validated in one pass, without
+    * the engine locks. Accepted orders are then added in batch order and
+    * each book that received one is matched once, so bulk quote updates
+    * and auction loads pay the per-call costs once per batch. Orders of
+    * a batch that cross each other trade as if they arrived together:
+    * the later order of each crossing pair is the aggressor. Market
+    * orders are the exception: the book is matched as soon as one is
+    * added, so its unfilled quantity is cancelled before the next order
+    * arrives, as with addAndValidateOrder. The per-order "Order added"
+    * report is skipped; validation errors and fills are still printed,
+    * by the order checks and the books, as for single orders.
+    *
+    * @param orders First order of the batch
+    * @param count Number of orders
+    * @param accepted If not null, set for each order to whether it was added
+    * @return std::size_t Number of orders added
+    */
+   std::size_t submitBatch(const Order* orders, std::size_t count, bool* accepted = nullptr);
+
+   /**
+    * @brief Validates and adds a batch of new orders, see the pointer overload
+    */
+   std::size_t submitBatch(const std::vector<Order>& orders) { return submitBatch(orders.data(), orders.size()); }
+
+   /**
+    * @brief Cancels an order of a firm
+    *
+    * @param key Instrument of the order (id, market code, currency)
+    * @param idorder Identifier of the order
+    * @param idfirm Firm that must own the order, OrderBook::ANY_FIRM to skip the check
+    * @return true if the order was found and cancelled
+    */
+   bool cancelOrder(const InstrumentKey& key, int idorder, int idfirm = OrderBook::ANY_FIRM);
+
+   /**
+    * @brief Validates and applies an amend of an order of a firm
+    *
+    * The new price and quantity are checked against the instrument as
+    * for a new order, then the book is matched since a new price may
+    * cross it. The stop price of an untriggered stop is never amended,
+    * and a stop order only accepts its current price (see
+    * OrderBook::amendOrder).
+    *
+    * @param key Instrument of the order (id, market code, currency)
+    * @param idorder Identifier of the order
+    * @param newPrice New limit price
+    * @param newQuantity New remaining quantity
+    * @param idfirm Firm that must own the order, OrderBook::ANY_FIRM to skip the check
+    * @return true if the order was found and amended
+    */
+   bool amendOrder(const InstrumentKey& key, int idorder, double newPrice, int newQuantity,
+                   int idfirm = OrderBook::ANY_FIRM);
+
+   /**
+    * @brief Opens an auction call on every instrument
+    *
+    * Books keep collecting orders without matching until uncrossAuctions.
+    */
+   void startAuction();
+
+   /**
+    * @brief Uncrosses the auction of every instrument
+    *
+    * Each book computes its equilibrium price, tie-broken on
+    * Instrument::refprice, executes its fills in one batch and returns
+    * to continuous trading.
+    *
+    * @return long long Total volume executed across all instruments
+    */
+   long long uncrossAuctions();
+
+   /**
+    * @brief Configures self-trade prevention for a firm
+    *
+    * The mode is stamped on each order of the firm when it enters the
+    * engine, so the matching loop never looks it up.
+    *
+    * @param idfirm Firm identifier
+    * @param mode Self-trade prevention mode (NONE disables it)
+    */
+   void setSelfTradePrevention(int idfirm, SelfTradePrevention mode);
+
+   /**
+    * @brief Configures the allocation algorithm of a trading group
+    *
+    * Instruments without a configured group keep price-time priority.
+    *
+    * @param idtradinggroup Trading group identifier
+    * @param algorithm FIFO, PRO_RATA or PRICE_TIME_PRO_RATA
+    */
+   void setAllocationAlgorithm(int idtradinggroup, AllocationAlgorithm algorithm);
+
    /**
     * @brief Updates trading statistics after a trade
     *
+    * Called by the order books once per executed trade.
+    *
     * @param trade The executed trade to record
     */
    void updateStats(const Trade& trade);
@@ -10,6 +10,7 @@
 #define ORDER_HPP
 
 #include <chrono>
+#include <cstdint>
 #include <string>
 #include "Instrument.hpp"
 
@@ -55,6 +56,44 @@ enum class LimitType
     NONE // No price limit
 };
 
+/**
+ * @enum StopType
+ * @brief Defines the trigger condition of a conditional order
+ *
+ * Conditional orders wait in the trigger book until the last traded
+ * price reaches their stop price:
+ * - NONE: Regular order, active immediately
+ * - STOP: Becomes a market order once triggered
+ * - STOP_LIMIT: Becomes a limit order at its price once triggered
+ */
+enum class StopType
+{
+    NONE, // Regular order
+    STOP, // Stop order, triggers into a market order
+    STOP_LIMIT // Stop-limit order, triggers into a limit order
+};
+
+/**
+ * @enum SelfTradePrevention
+ * @brief Defines what happens when two orders of the same firm would trade
+ *
+ * The mode is configured per firm and applied by the matching loop
+ * whenever the best bid and best ask belong to the same firm:
+ * - NONE: Orders trade normally
+ * - CANCEL_RESTING: The resting order is cancelled
+ * - CANCEL_AGGRESSOR: The incoming (aggressor) order is cancelled
+ * - CANCEL_BOTH: Both orders are cancelled
+ * - DECREMENT: Both orders are reduced by the smaller quantity, without a trade
+ */
+enum class SelfTradePrevention
+{
+    NONE, // Self-trades allowed
+    CANCEL_RESTING, // Cancel the resting order
+    CANCEL_AGGRESSOR, // Cancel the aggressor order
+    CANCEL_BOTH, // Cancel both orders
+    DECREMENT // Decrement both orders by the smaller quantity
+};
+
 /**
  * @class Order
  * @brief Represents a comprehensive trading order with all necessary details
@@ -88,6 +127,20 @@ public:
     int idinstrument; // Associated instrument identifier
     int idfirm; // Submitting firm identifier
 
+    // Iceberg (Reserve) Attributes
+    int peakSize = 0; // Displayed peak of an iceberg order (0 for a regular order)
+    int hiddenQuantity = 0; // Reserve quantity not yet displayed
+
+    // Conditional (Stop) Attributes
+    StopType stopType = StopType::NONE; // Trigger condition type
+    double stopPrice = 0.0; // Last traded price that triggers the order
+
+    // Self-Trade Prevention
+    SelfTradePrevention stpMode = SelfTradePrevention::NONE; // Resolved from the firm configuration on entry
+
+    // Book Priority
+    std::uint64_t sequence = 0; // Entry sequence assigned by the order book when queued, the newer front order is the aggressor
+
     /**
      * @brief Default constructor
      * 
@@ -169,6 +222,63 @@ public:
      * - A multiple of the instrument's lot size
      */
     bool validateQuantity(const Instrument& instrument) const;
+
+    /**
+     * @brief Turns the order into an iceberg (reserve) order
+     *
+     * @param peak Quantity displayed in the book at any time
+     *
+     * Only the peak is exposed as the order quantity; the remainder
+     * is held in hiddenQuantity and replenished by the book each
+     * time the displayed peak is fully executed.
+     */
+    void setIcebergPeak(int peak);
+
+    /**
+     * @brief Tells whether the order is an iceberg order
+     *
+     * @return bool True if the order has a displayed peak
+     */
+    bool isIceberg() const { return peakSize > 0; }
+
+    /**
+     * @brief Validates the iceberg peak against instrument specifications
+     *
+     * @param instrument Reference to the instrument for peak validation
+     * @return bool True if the order is not an iceberg or its peak is valid
+     *
+     * The peak must be positive and a multiple of the instrument's lot size.
+     */
+    bool validatePeak(const Instrument& instrument) const;
+
+    /**
+     * @brief Turns the order into a conditional stop or stop-limit order
+     *
+     * @param type STOP (triggers into a market order) or STOP_LIMIT
+     * @param triggerPrice Last traded price that activates the order
+     *
+     * A buy stop triggers when a trade prints at or above the stop
+     * price, a sell stop when a trade prints at or below it.
+     */
+    void setStop(StopType type, double triggerPrice);
+
+    /**
+     * @brief Tells whether the order is waiting for a stop trigger
+     *
+     * @return bool True for untriggered stop and stop-limit orders
+     */
+    bool isStop() const { return stopType != StopType::NONE; }
+
+    /**
+     * @brief Validates the stop price against instrument specifications
+     *
+     * @param instrument Reference to the instrument for stop price validation
+     * @return bool True if the order is not a stop order or its stop price is valid
+     *
+     * The stop price must be strictly positive and consistent with
+     * the instrument's price decimal specification.
+     */
+    bool validateStopPrice(const Instrument& instrument) const;
 };
 
 #endif // ORDER_HPP
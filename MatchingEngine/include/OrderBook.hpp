@@ -2,29 +2,96 @@
 #define ORDERBOOK_HPP
 
 #include <map>
-#include <deque>
+#include <unordered_map>
+#include <limits>
 #include <mutex>
+#include <chrono>
+#include <cstdint>
 #include <vector>
 #include <iostream>
 #include "Order.hpp"
+#include "PriceLevel.hpp"
+#include "BookSide.hpp"
+#include "AllocationPolicy.hpp"
+#include "MarketDataPublisher.hpp"
+#include "OrderFeed.hpp"
+#include "SeqLock.hpp"
+#include "LatencyHistogram.hpp"
+#include "InstrumentStats.hpp"
+#include "Clock.hpp"
 #include "Trading.hpp"
 
 // Forward declaration to avoid circular dependency
 class MatchingEngine;
 
+/**
+ * @enum TradingPhase
+ * @brief Trading phase of an order book
+ *
+ * - CONTINUOUS: Orders are matched as they arrive
+ * - AUCTION: Orders are collected without matching until the uncross
+ */
+enum class TradingPhase
+{
+    CONTINUOUS, // Continuous price-time priority matching
+    AUCTION // Opening/closing call, no matching until uncross
+};
+
+/**
+ * @struct AuctionResult
+ * @brief Outcome of an auction uncrossing price computation
+ */
+struct AuctionResult
+{
+    bool crossed; ///< True if some volume is executable
+    double price; ///< Equilibrium (uncrossing) price
+    long long volume; ///< Executable volume at that price
+    long long imbalance; ///< Unmatched demand or supply at that price
+};
+
+/**
+ * @struct TopOfBook
+ * @brief Conflated view of a book, published after every book change
+ *
+ * Prices and quantities of an empty side are 0. Market orders, which
+ * never rest, are not shown as the best price.
+ */
+struct TopOfBook
+{
+    std::uint64_t sequence; ///< Number of book changes published so far
+    int instrumentId; ///< Instrument identifier
+    int bookId; ///< Feed identifier of the book
+    double bidPrice; ///< Best bid price
+    long long bidQuantity; ///< Displayed quantity at the best bid
+    double askPrice; ///< Best ask price
+    long long askQuantity; ///< Displayed quantity at the best ask
+    double lastTradePrice; ///< Price of the last trade, 0 if none
+    long long lastTradeQuantity; ///< Quantity of the last trade
+    int bidLevels; ///< Number of bid levels
+    int askLevels; ///< Number of ask levels
+    int bidOrders; ///< Number of resting bid orders
+    int askOrders; ///< Number of resting ask orders
+};
+
 /**
  * @class OrderBook
  * @brief Manages the collection and matching of trading orders
+ *
+ * A book holds the orders of a single instrument; the MatchingEngine
+ * routes each order to the book of its instrument.
  */
 class OrderBook {
 public:
+    using BidSide = BookSide<OrderType::BID>;
+    using AskSide = BookSide<OrderType::ASK>;
+
     /**
      * @brief Bid orders container
      * 
      * Stores buy orders organized by price in descending order.
      * Key: Price, Value: Queue of orders at that price level
      */
-    std::map<double, std::deque<Order>, std::greater<double> > bidOrders;
+    BidSide bidOrders;
 
     /**
      * @brief Ask orders container
@@ -32,7 +99,51 @@ public:
      * Stores sell orders organized by price in ascending order.
      * Key: Price, Value: Queue of orders at that price level
      */
-    std::map<double, std::deque<Order> > askOrders;
+    AskSide askOrders;
+
+    /**
+     * @brief Buy stop trigger book
+     *
+     * Holds untriggered buy stop and stop-limit orders by ascending
+     * stop price: they trigger when a trade prints at or above it.
+     * Key: Stop price, Value: Conditional order
+     */
+    BidSide::StopOrders buyStopOrders;
+
+    /**
+     * @brief Sell stop trigger book
+     *
+     * Holds untriggered sell stop and stop-limit orders by descending
+     * stop price: they trigger when a trade prints at or below it.
+     * Key: Stop price, Value: Conditional order
+     */
+    AskSide::StopOrders sellStopOrders;
+
+    /**
+     * @brief Where an order currently lives in the book
+     */
+    enum class OrderLocation
+    {
+        BOOK, // Resting in a price level
+        BUY_STOP, // Waiting in the buy stop trigger book
+        SELL_STOP // Waiting in the sell stop trigger book
+    };
+
+    /**
+     * @brief Entry of the order-id index
+     *
+     * Points directly at the order's node so that cancel and amend
+     * never scan a level or a trigger book.
+     */
+    struct OrderLocator
+    {
+        OrderLocation location; ///< Container holding the order
+        OrderType side; ///< Side of the order
+        double price; ///< Level price (BOOK) or stop price (trigger books)
+        PriceLevel::iterator position; ///< Node in the level, valid for BOOK
+        BidSide::StopOrders::iterator buyStopPosition; ///< Node, valid for BUY_STOP
+        AskSide::StopOrders::iterator sellStopPosition; ///< Node, valid for SELL_STOP
+    };
 
     /**
      * @brief Default constructor
@@ -42,6 +153,10 @@ public:
     /**
      * @brief Adds a new order to the order book
      *
+     * Stop and stop-limit orders go to the trigger book; market orders
+     * (LimitType::NONE) are queued ahead of every limit price and any
+     * quantity left after the next matching cycle is cancelled.
+     *
      * @param order The order to be added to the book
      */
     void addOrder(const Order& order);
@@ -49,10 +164,161 @@ public:
     /**
      * @brief Executes the order matching algorithm
      *
+     * The aggressor quantity is shared at the touch according to the
+     * book's allocation algorithm. Stop orders triggered by a trade are
+     * activated immediately and take part in the same matching cycle as
+     * new aggressors.
+     *
      * @return int Number of trades executed in this matching cycle
      */
     int matchOrders();
 
+    /// Firm filter of cancelOrder and amendOrder that accepts the order of any firm
+    static constexpr int ANY_FIRM = -1;
+
+    /**
+     * @brief Cancels an order resting in the book or in a trigger book
+     *
+     * @param idorder Identifier of the order to cancel
+     * @param idfirm Firm that must own the order, ANY_FIRM to skip the check
+     * @return bool True if the order was found and cancelled
+     */
+    bool cancelOrder(int idorder, int idfirm = ANY_FIRM);
+
+    /**
+     * @brief Amends the price and/or remaining quantity of an order
+     *
+     * A quantity decrease at the same price is applied in place and keeps
+     * the order's queue priority. A price change or a quantity increase is
+     * an atomic cancel-and-reinsert: the order goes to the back of its new
+     * level with a new priority sequence. Both paths locate the order
+     * through the order-id index. The caller runs matchOrders afterwards,
+     * as for addOrder, since a new price may cross the book.
+     *
+     * An untriggered stop keeps its stop price and its place in the
+     * trigger book; only its limit price and quantity change. A stop
+     * order triggers into a market order and has no limit price, so an
+     * amend of it with another price than its current one is rejected:
+     * to move a stop price, cancel the order and enter a new one.
+     *
+     * @param idorder Identifier of the order to amend
+     * @param newPrice New limit price
+     * @param newQuantity New remaining quantity (displayed and hidden)
+     * @param idfirm Firm that must own the order, ANY_FIRM to skip the check
+     * @return bool True if the order was found and amended
+     */
+    bool amendOrder(int idorder, double newPrice, int newQuantity, int idfirm = ANY_FIRM);
+
+    /**
+     * @brief Looks up an order through the order-id index
+     *
+     * @param idorder Identifier of the order
+     * @return const Order* The order, or nullptr if it is not in the book
+     */
+    const Order* findOrder(int idorder) const;
+
+    /**
+     * @brief Selects how the aggressor quantity is allocated at the touch
+     *
+     * @param algorithm FIFO, PRO_RATA or PRICE_TIME_PRO_RATA
+     * @param instrumentLotSize Lot size used to round pro-rata shares
+     */
+    void setAllocation(AllocationAlgorithm algorithm, int instrumentLotSize);
+
+    /**
+     * @brief Returns the allocation algorithm of the book
+     */
+    AllocationAlgorithm getAllocation() const { return allocationAlgorithm; }
+
+    /**
+     * @brief Switches the book between continuous trading and auction call
+     *
+     * @param phase New trading phase
+     */
+    void setTradingPhase(TradingPhase phase);
+
+    /**
+     * @brief Returns the current trading phase
+     */
+    TradingPhase getTradingPhase() const { return tradingPhase; }
+
+    /**
+     * @brief Computes the equilibrium price of an auction call
+     *
+     * Maximum executable volume, then minimum imbalance, then closest to
+     * the reference price, in a single pass over cumulative depth arrays.
+     * Taken under the book lock, so any thread may call it during the call.
+     *
+     * @param referencePrice Reference price used as the last tie-breaker
+     * @return AuctionResult Uncrossing price, executable volume and imbalance
+     */
+    AuctionResult computeUncrossingPrice(double referencePrice) const;
+
+    /**
+     * @brief Ends an auction call by executing all fills at the equilibrium price
+     *
+     * The book returns to continuous trading afterwards.
+     *
+     * @param referencePrice Reference price of the instrument
+     * @return AuctionResult The uncrossing price and executed volume
+     */
+    AuctionResult uncrossAuction(double referencePrice);
+
+    /**
+     * @brief Removes GTD orders whose expiration date has passed
+     *
+     * @param now Current time
+     * @return int Number of orders removed
+     */
+    int removeExpiredOrders(std::chrono::system_clock::time_point now);
+
+    /**
+     * @brief Returns the aggregated best levels of one side of the book
+     *
+     * @param side BID or ASK side
+     * @param maxLevels Maximum number of levels to return
+     * @return std::vector<DepthLevel> Levels ordered from the best price outwards
+     */
+    std::vector<DepthLevel> getDepth(OrderType side, std::size_t maxLevels) const;
+
+    /**
+     * @brief Returns the total quantity resting at a given price
+     *
+     * @param side BID or ASK side
+     * @param price Price of the level
+     * @return long long Resting quantity, 0 if the level does not exist
+     */
+    long long getQuantityAtPrice(OrderType side, double price) const;
+
+    /**
+     * @brief Returns the quantity an incoming order could execute against
+     *
+     * Sums the levels of the given resting side that cross the limit price,
+     * iceberg reserves included, which is what a fill-or-kill check needs.
+     *
+     * @param side Resting side to execute against (ASK for a buy order)
+     * @param limitPrice Limit price of the incoming order
+     * @return long long Executable quantity
+     */
+    long long getAvailableQuantity(OrderType side, double limitPrice) const;
+
+    /**
+     * @brief Returns the number of orders resting on one side of the book
+     *
+     * @param side BID or ASK side
+     * @return int Number of resting orders
+     */
+    int getOrderCount(OrderType side) const;
+
+    /**
+     * @brief Returns a copy of the resting GTD orders, bids first
+     *
+     * Taken under the book lock; safe to call from any thread.
+     *
+     * @return std::vector<Order> GTD orders in price-time priority per side
+     */
+    std::vector<Order> getGTDOrders() const;
+
     /**
      * @brief Displays the current state of the order book
      */
@@ -70,6 +336,51 @@ public:
      */
     const Trade* getLastTrade() const;
 
+    /**
+     * @brief Returns every trade of the book, oldest first
+     *
+     * Not synchronized: only call while no thread matches the book.
+     */
+    const std::vector<Trade>& getTrades() const { return trades; }
+
+    /// Number of one-second bars kept per book
+    static constexpr std::size_t SECOND_BAR_COUNT = 300;
+
+    /// Number of one-minute bars kept per book
+    static constexpr std::size_t MINUTE_BAR_COUNT = 600;
+
+    /**
+     * @brief Returns the session open, high, low, last, VWAP and volume
+     *
+     * Maintained on every fill; safe to call from any thread.
+     */
+    InstrumentTradeStats getTradeStats() const;
+
+    /**
+     * @brief Returns the latest bars of one period, oldest first
+     *
+     * Safe to call from any thread.
+     *
+     * @param period SECOND or MINUTE
+     * @param maxCount Maximum number of bars returned
+     */
+    std::vector<TradeBar> getBars(BarPeriod period, std::size_t maxCount) const;
+
+    /**
+     * @brief Adds the traded volume of each firm in this book to totals
+     *
+     * Safe to call from any thread.
+     *
+     * @param totals Figures per firm identifier, summed over the books
+     */
+    void addFirmStats(std::unordered_map<int, FirmTradeStats>& totals) const;
+
+    /**
+     * @brief Starts a new trading session for getTradeStats and the firm
+     * volumes; bars are kept
+     */
+    void resetTradeStats();
+
     /**
      * @brief Sets a reference to the matching engine
      *
@@ -77,27 +388,429 @@ public:
      */
     void setMatchingEngine(MatchingEngine* engine) { matchingEngine = engine; }
 
+    /**
+     * @brief Connects the book to a Level 2 market data feed
+     *
+     * @param publisher Feed receiving the level deltas, nullptr to disconnect
+     * @param idinstrument Instrument identifier stamped on the messages
+     * @param idbook Feed identifier of the book, unique across markets and currencies
+     */
+    void setMarketDataPublisher(MarketDataPublisher* publisher, int idinstrument, int idbook);
+
+    /**
+     * @brief Returns the feed identifier stamped on the book's messages
+     *
+     * Consumers resolve it to the book's key through
+     * MatchingEngine::forEachOrderBook or the Level 3 directory.
+     */
+    int getBookId() const { return bookId; }
+
+    /**
+     * @brief Connects the book to the Level 3 order-by-order feed
+     *
+     * Messages carry the instrument and book identifiers given to
+     * setMarketDataPublisher.
+     *
+     * @param feed Open feed receiving the order events, nullptr to disconnect
+     */
+    void setOrderFeed(OrderFeed* feed);
+
+    /**
+     * @brief Sets the slot where the book publishes its top of book
+     *
+     * The book is the only writer of its slot; any thread may read it.
+     *
+     * @param slot Seqlock-protected slot, nullptr to stop publishing
+     */
+    void setTopOfBook(SeqLock<TopOfBook>* slot);
+
+    /**
+     * @brief Sets the histogram receiving the duration of each publication
+     *
+     * Only publications to a connected feed or top of book slot are timed.
+     *
+     * @param histogram Histogram, nullptr to stop timing
+     */
+    void setPublishLatency(LatencyHistogram* histogram) { publishLatency = histogram; }
+
+    /**
+     * @brief Sets the clock stamping trades and re-queued orders
+     *
+     * @param bookClock Clock outliving the book
+     */
+    void setClock(const Clock* bookClock) { clock = bookClock; }
+
+    /**
+     * @brief Publishes a full Level 2 snapshot of the book
+     *
+     * Taken under the book lock, so it is consistent with the deltas
+     * published before and after it.
+     */
+    void publishSnapshot();
+
 private:
     /**
      * @brief Container for all executed trades
      */
     std::vector<Trade> trades;
 
+    /**
+     * @brief Session statistics, updated on every fill
+     */
+    InstrumentTradeStats tradeStats;
+
+    /**
+     * @brief Traded volume per firm in this book, updated on every fill
+     *
+     * One entry per firm that ever traded in the book, zeroed by resets.
+     */
+    std::unordered_map<int, FirmTradeStats> firmStats;
+
+    /**
+     * @brief One-second bars
+     */
+    BarSeries secondBars{std::chrono::seconds(1), SECOND_BAR_COUNT};
+
+    /**
+     * @brief One-minute bars
+     */
+    BarSeries minuteBars{std::chrono::minutes(1), MINUTE_BAR_COUNT};
+
     /**
      * @brief Tracks the ID for the next trade
      */
     int nextTradeId;
 
+    /**
+     * @brief Priority sequence given to the next queued or re-queued order
+     */
+    std::uint64_t nextSequence;
+
+    /**
+     * @brief Current trading phase
+     */
+    TradingPhase tradingPhase = TradingPhase::CONTINUOUS;
+
+    /**
+     * @brief Allocation algorithm applied at the touch
+     */
+    AllocationAlgorithm allocationAlgorithm = AllocationAlgorithm::FIFO;
+
+    /**
+     * @brief Lot size of the instrument, pro-rata shares are whole lots
+     */
+    int lotSize = 1;
+
+    /**
+     * @brief Order-id index over resting and untriggered stop orders
+     */
+    std::unordered_map<int, OrderLocator> orderIndex;
+
     /**
      * @brief Pointer to the associated MatchingEngine
      */
     MatchingEngine* matchingEngine;
 
     /**
-     * @brief Removes fully executed orders from the order book
+     * @brief Time source of trades, amends and iceberg refills
+     */
+    const Clock* clock = &SystemClock::instance();
+
+    /**
+     * @brief State of a level before the current mutation
+     *
+     * Once the deltas are published, quantity and orderCount hold the
+     * published state and change the message type, for the conflated image.
+     */
+    struct TouchedLevel
+    {
+        OrderType side; ///< Side of the level
+        double price; ///< Level price
+        bool existed; ///< True if the level existed before the mutation
+        long long quantity; ///< Displayed quantity before the mutation
+        int orderCount; ///< Order count before the mutation
+        std::uint8_t change; ///< L2MessageType published for the level, 0 if none
+    };
+
+    /**
+     * @brief Level 2 feed, nullptr when the book is not published
+     */
+    MarketDataPublisher* marketData = nullptr;
+
+    /**
+     * @brief Level 3 feed, nullptr when order events are not published
+     */
+    OrderFeed* orderFeed = nullptr;
+
+    /**
+     * @brief Top of book slot, nullptr when not published
+     */
+    SeqLock<TopOfBook>* topOfBook = nullptr;
+
+    /**
+     * @brief Number of top of book updates published
+     */
+    std::uint64_t topOfBookSequence = 0;
+
+    /**
+     * @brief Histogram of publication durations, nullptr when not timed
+     */
+    LatencyHistogram* publishLatency = nullptr;
+
+    /**
+     * @brief Instrument identifier stamped on market data messages
+     */
+    int instrumentId = 0;
+
+    /**
+     * @brief Feed identifier of the book stamped on market data messages
+     */
+    int bookId = 0;
+
+    /**
+     * @brief Deltas folded into the conflated image since the book was created
+     */
+    std::uint64_t conflatedUpdates = 0;
+
+    /**
+     * @brief Levels changed by the current mutation, published at its end
+     */
+    std::vector<TouchedLevel> touchedLevels;
+
+    /**
+     * @brief Records the state of a level about to be changed
+     *
+     * Must be called before the level is modified. Does nothing when the
+     * book is not published or the level was already recorded.
+     *
+     * @param side Side of the level
+     * @param price Level price
+     */
+    void touchLevel(OrderType side, double price);
+
+    /**
+     * @brief Publishes one delta per level changed since the last call
+     *
+     * Compares each touched level with its recorded state and emits an
+     * add, update or delete; unchanged levels and market order keys are
+     * not published.
+     */
+    void publishLevelChanges();
+
+    /**
+     * @brief Applies the deltas of a mutation to the conflated image of the book
+     *
+     * Level updates are patched in place; a side is rebuilt from the book
+     * only when a level enters or leaves its best CONFLATED_DEPTH levels.
+     *
+     * @param sequence Feed sequence of the last delta published
+     * @param published Number of deltas published by the mutation
+     */
+    void publishConflatedImage(std::uint64_t sequence, int published);
+
+    /**
+     * @brief Writes the current best prices and book totals to the top of book slot
+     *
+     * Reads only the first level of each side and running counters.
+     */
+    void publishTopOfBook();
+
+    /**
+     * @brief Publishes the Level 2 deltas and the top of book of a mutation
+     *
+     * Called at the end of every public mutation, under the book lock.
+     */
+    void publishBookChanges();
+
+    /**
+     * @brief Publishes one order event on the Level 3 feed
+     *
+     * Does nothing when no feed is connected or for market orders, which
+     * never rest in the book.
+     *
+     * @param type Message type
+     * @param order Order concerned by the event
+     * @param price Order or execution price
+     * @param quantity Quantity, meaning depends on the message type
+     * @param matchId Trade identifier for executions
+     */
+    void publishOrderEvent(L3MessageType type, const Order& order, double price, long long quantity,
+                           int matchId = 0);
+
+    /**
+     * @brief Records a trade between a buy order and a sell order
+     *
+     * @param bidLevel Level holding the buy order
+     * @param bidOrder The buy order
+     * @param askLevel Level holding the sell order
+     * @param askOrder The sell order
+     * @param price Execution price
+     * @param quantity Executed quantity
+     * @param now Execution timestamp
+     */
+    void executeTrade(PriceLevel& bidLevel, Order& bidOrder, PriceLevel& askLevel, Order& askOrder,
+                      double price, int quantity, std::chrono::system_clock::time_point now);
+
+    /**
+     * @brief Matching loop instantiated for one allocation policy
+     *
+     * @tparam Allocation FifoAllocation, ProRataAllocation or PriceTimeProRataAllocation
+     * @return int Number of trades executed
+     */
+    template <typename Allocation>
+    int matchOrdersWith();
+
+    /**
+     * @brief Removes or replenishes exhausted orders anywhere in a level
+     *
+     * @param side Side of the level
+     * @param level Level whose orders were filled away from the front
+     */
+    void sweepExhaustedOrders(OrderType side, PriceLevel& level);
+
+    /**
+     * @brief Removes fully executed orders from the best levels of the book
+     *
+     * Exhausted iceberg peaks are replenished in place instead of removed.
      */
     void cleanupExecutedOrders();
 
+    /**
+     * @brief Queues an active order at the back of its price level
+     *
+     * @param order The order to queue, stamped with a new priority sequence
+     * @param event Level 3 event published for it (add, or replace for amends)
+     */
+    void queueOrder(Order order, L3MessageType event = L3MessageType::ADD_ORDER);
+
+    /**
+     * @brief Removes an order from its price level and from the index
+     *
+     * Erases the level if it becomes empty.
+     *
+     * @param locator Index entry of a resting order
+     */
+    void eraseRestingOrder(const OrderLocator& locator);
+
+    /**
+     * @brief Returns the order an index entry points at
+     *
+     * @param locator Index entry
+     * @return const Order& The order, in its level or trigger book
+     */
+    static const Order& locatedOrder(const OrderLocator& locator);
+
+    /**
+     * @brief Tells whether an indexed order belongs to a firm
+     *
+     * @param locator Index entry
+     * @param idfirm Firm identifier, or ANY_FIRM
+     * @return bool True if idfirm is ANY_FIRM or owns the order
+     */
+    static bool isOwnedBy(const OrderLocator& locator, int idfirm)
+    {
+        return idfirm == ANY_FIRM || locatedOrder(locator).idfirm == idfirm;
+    }
+
+    /**
+     * @brief Moves the stop orders triggered by a trade price into the book
+     *
+     * Pops triggered orders from the front of the trigger books, in stop
+     * price order, so the cost is O(log n + k) for k triggered orders.
+     *
+     * @param lastPrice Price of the last trade
+     * @return int Number of stop orders activated
+     */
+    int activateTriggeredStops(double lastPrice);
+
+    /**
+     * @brief Moves the triggered stop orders of one side into the book
+     *
+     * @param stops Trigger book of the side
+     * @param lastPrice Price of the last trade
+     * @return int Number of stop orders activated
+     */
+    template <OrderType Side>
+    int activateTriggeredStops(typename BookSide<Side>::StopOrders& stops, double lastPrice);
+
+    /**
+     * @brief Calls a function with the side of the book holding a side's orders
+     *
+     * @param side BID or ASK side
+     * @param function Generic callable, instantiated once per side
+     */
+    template <typename Function>
+    decltype(auto) visitSide(OrderType side, Function&& function)
+    {
+        if (side == OrderType::BID)
+        {
+            return function(bidOrders);
+        }
+        return function(askOrders);
+    }
+
+    /**
+     * @brief Const overload of visitSide
+     */
+    template <typename Function>
+    decltype(auto) visitSide(OrderType side, Function&& function) const
+    {
+        if (side == OrderType::BID)
+        {
+            return function(bidOrders);
+        }
+        return function(askOrders);
+    }
+
+    /**
+     * @brief Applies self-trade prevention to the two front orders
+     *
+     * Called when the best bid and best ask belong to the same firm.
+     *
+     * @param bidLevel Best bid level
+     * @param askLevel Best ask level
+     * @return bool True if the orders were prevented from trading
+     */
+    bool preventSelfTrade(PriceLevel& bidLevel, PriceLevel& askLevel);
+
+    /**
+     * @brief Applies self-trade prevention to an aggressor and a resting order
+     *
+     * Called when the aggressor meets a resting order of the same firm,
+     * at the front of the level or behind it under pro-rata allocation.
+     * The aggressor's mode decides which order is cancelled or decremented.
+     *
+     * @param aggressorLevel Level holding the aggressor at its front
+     * @param aggressor The aggressor order
+     * @param restingLevel Level holding the resting order
+     * @param resting The resting order
+     * @return bool True if the orders were prevented from trading
+     */
+    bool preventSelfTrade(PriceLevel& aggressorLevel, Order& aggressor, PriceLevel& restingLevel, Order& resting);
+
+    /**
+     * @brief Cancels the unfilled quantity of market orders
+     *
+     * Market orders never rest in the book once a matching cycle is over.
+     */
+    void discardUnfilledMarketOrders();
+
+    /**
+     * @brief Computes the equilibrium price of an auction call, book lock held
+     *
+     * @param referencePrice Reference price used as the last tie-breaker
+     * @return AuctionResult Uncrossing price, executable volume and imbalance
+     */
+    AuctionResult findUncrossingPrice(double referencePrice) const;
+
+    /**
+     * @brief Cancels the unfilled market orders of one side
+     *
+     * @param orders Side of the book
+     */
+    template <OrderType Side>
+    void discardUnfilledMarketOrders(BookSide<Side>& orders);
+
     /**
      * @brief Notifies the matching engine about a trade execution
      *
@@ -108,7 +821,7 @@ private:
     /**
      * @brief Mutex for thread-safe display operations
      */
-    std::mutex displayMutex;
+    mutable std::mutex displayMutex;
 };
 
 #endif // ORDERBOOK_HPP
\ No newline at end of file
@@ -0,0 +1,357 @@
+/**
+ * @file OrderEntryProtocol.hpp
+ * @brief Fixed-layout binary order entry protocol
+ *
+ * Every message starts with an 8-byte header followed by a fixed-size
+ * body. All fields are little-endian and naturally aligned, so a message
+ * is its struct image: encoding is a copy into the send buffer, decoding
+ * validates the receive buffer in place and copies the fixed-size struct
+ * out, without any allocation. Market identification codes and currencies
+ * travel as 16-bit codes interned from the instrument reference data.
+ */
+
+#ifndef ORDERENTRYPROTOCOL_HPP
+#define ORDERENTRYPROTOCOL_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "Order.hpp"
+#include "InstrumentManager.hpp"
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__
+#error "The order entry protocol is encoded as the little-endian image of its structs"
+#endif
+
+/// Version carried by every message header
+constexpr std::uint8_t ORDER_ENTRY_VERSION = 1;
+
+/**
+ * @enum EntryMessageType
+ * @brief Type of an order entry message, sent as a single ASCII byte
+ */
+enum class EntryMessageType : std::uint8_t
+{
+    LOGON = 'L', // Client: open a session for a firm
+    NEW_ORDER = 'N', // Client: enter an order
+    CANCEL_ORDER = 'C', // Client: cancel a resting order
+    AMEND_ORDER = 'M', // Client: change price and quantity of a resting order
+    ACK = 'A', // Engine: request accepted
+    REJECT = 'R' // Engine: request refused, see RejectReason
+};
+
+/**
+ * @enum RejectReason
+ * @brief Why a request was refused, carried by REJECT messages
+ */
+enum class RejectReason : std::uint8_t
+{
+    NONE = 0, // Not rejected
+    MALFORMED = 1, // Message failed decoding
+    UNKNOWN_CODE = 2, // MIC or currency code not interned
+    UNKNOWN_INSTRUMENT = 3, // No such instrument
+    UNKNOWN_ORDER = 4, // Cancel or amend of an order not in the book, or amend refused by the book
+    INVALID_ORDER = 5, // Refused by the engine validation
+    NOT_LOGGED_ON = 6, // Request before a successful logon
+    SEQUENCE_GAP = 7, // Client sequence number out of order
+    NOT_AUTHORISED = 8 // Logon refused, or order of another firm
+};
+
+/**
+ * @struct EntryHeader
+ * @brief 8-byte header of every order entry message
+ */
+struct EntryHeader
+{
+    std::uint16_t length; ///< Total message length, header included
+    std::uint8_t type; ///< EntryMessageType
+    std::uint8_t version; ///< ORDER_ENTRY_VERSION
+    std::uint32_t sequence; ///< Sender sequence number
+};
+
+/**
+ * @struct LogonMessage
+ * @brief 24-byte request opening a session for a firm
+ *
+ * Must be the first message of a connection, with sequence 1. The token
+ * is the secret the gateway holds for the firm.
+ */
+struct LogonMessage
+{
+    EntryHeader header; ///< type = LOGON
+    std::uint64_t token; ///< Firm credential
+    std::int32_t idfirm; ///< Firm the session trades for
+    std::uint8_t reserved[4]; ///< Zero
+};
+
+/**
+ * @struct NewOrderMessage
+ * @brief 64-byte request to enter an order
+ *
+ * quantity is the total quantity of the order; for icebergs peakSize is
+ * the displayed part. expiration is in nanoseconds since the epoch and
+ * only used for GTD orders.
+ */
+struct NewOrderMessage
+{
+    EntryHeader header; ///< type = NEW_ORDER
+    double price; ///< Limit price (ignored for market orders)
+    double stopPrice; ///< Trigger price of stop orders, 0 otherwise
+    std::uint64_t expiration; ///< GTD expiration, ns since the epoch
+    std::int32_t idorder; ///< Client order identifier
+    std::int32_t idinstrument; ///< Instrument identifier
+    std::int32_t idfirm; ///< Submitting firm
+    std::int32_t quantity; ///< Total quantity
+    std::int32_t peakSize; ///< Iceberg peak, 0 for a regular order
+    std::uint16_t micCode; ///< Interned market identification code
+    std::uint16_t currencyCode; ///< Interned trading currency
+    std::uint8_t side; ///< 'B' or 'S'
+    std::uint8_t timeInForce; ///< TimeInForce
+    std::uint8_t limitType; ///< LimitType
+    std::uint8_t stopType; ///< StopType
+    std::uint8_t reserved[4]; ///< Zero
+};
+
+/**
+ * @struct CancelOrderMessage
+ * @brief 24-byte request to cancel a resting order
+ */
+struct CancelOrderMessage
+{
+    EntryHeader header; ///< type = CANCEL_ORDER
+    std::int32_t idorder; ///< Order to cancel
+    std::int32_t idinstrument; ///< Instrument of the order
+    std::uint16_t micCode; ///< Interned market identification code
+    std::uint16_t currencyCode; ///< Interned trading currency
+    std::uint8_t reserved[4]; ///< Zero
+};
+
+/**
+ * @struct AmendOrderMessage
+ * @brief 32-byte request to change a resting order
+ *
+ * Carries no stop price: see MatchingEngine::amendOrder for what an
+ * amend of an untriggered stop changes.
+ */
+struct AmendOrderMessage
+{
+    EntryHeader header; ///< type = AMEND_ORDER
+    double newPrice; ///< New limit price
+    std::int32_t idorder; ///< Order to amend
+    std::int32_t idinstrument; ///< Instrument of the order
+    std::int32_t newQuantity; ///< New total quantity
+    std::uint16_t micCode; ///< Interned market identification code
+    std::uint16_t currencyCode; ///< Interned trading currency
+};
+
+/**
+ * @struct AckMessage
+ * @brief 24-byte acceptance of a request
+ */
+struct AckMessage
+{
+    EntryHeader header; ///< type = ACK
+    std::uint64_t timestamp; ///< Engine time, ns since the epoch
+    std::int32_t idorder; ///< Order concerned
+    std::uint8_t requestType; ///< EntryMessageType of the accepted request
+    std::uint8_t reserved[3]; ///< Zero
+};
+
+/**
+ * @struct RejectMessage
+ * @brief 24-byte refusal of a request
+ */
+struct RejectMessage
+{
+    EntryHeader header; ///< type = REJECT
+    std::uint64_t timestamp; ///< Engine time, ns since the epoch
+    std::int32_t idorder; ///< Order concerned, 0 if it could not be decoded
+    std::uint8_t requestType; ///< EntryMessageType of the refused request
+    std::uint8_t reason; ///< RejectReason
+    std::uint8_t reserved[2]; ///< Zero
+};
+
+static_assert(sizeof(EntryHeader) == 8, "EntryHeader layout must stay fixed");
+static_assert(sizeof(LogonMessage) == 24, "LogonMessage layout must stay fixed");
+static_assert(sizeof(NewOrderMessage) == 64, "NewOrderMessage layout must stay fixed");
+static_assert(sizeof(CancelOrderMessage) == 24, "CancelOrderMessage layout must stay fixed");
+static_assert(sizeof(AmendOrderMessage) == 32, "AmendOrderMessage layout must stay fixed");
+static_assert(sizeof(AckMessage) == 24, "AckMessage layout must stay fixed");
+static_assert(sizeof(RejectMessage) == 24, "RejectMessage layout must stay fixed");
+
+/// Size of the largest message, enough for any receive buffer to hold one
+constexpr std::size_t MAX_ENTRY_MESSAGE_SIZE = sizeof(NewOrderMessage);
+
+/**
+ * @enum DecodeStatus
+ * @brief Outcome of decoding the front of a receive buffer
+ */
+enum class DecodeStatus
+{
+    OK, // One message decoded
+    INCOMPLETE, // Not enough bytes yet, nothing consumed
+    MALFORMED, // Framing is intact but the message is invalid, it is consumed
+    FRAMING_ERROR // Length or type unusable, the stream cannot be resynchronised
+};
+
+/**
+ * @struct EntryMessage
+ * @brief Decoded message, one of the request or response bodies
+ *
+ * Plain storage large enough for any message: decoding fills the
+ * member of the decoded type and never allocates.
+ */
+struct EntryMessage
+{
+    EntryMessageType type; ///< Which member is valid
+    union
+    {
+        EntryHeader header; ///< Common header of every member
+        LogonMessage logon; ///< LOGON
+        NewOrderMessage newOrder; ///< NEW_ORDER
+        CancelOrderMessage cancel; ///< CANCEL_ORDER
+        AmendOrderMessage amend; ///< AMEND_ORDER
+        AckMessage ack; ///< ACK
+        RejectMessage reject; ///< REJECT
+    };
+};
+
+/**
+ * @brief Decodes the message at the front of a receive buffer
+ *
+ * @param data Start of the received bytes
+ * @param size Number of received bytes
+ * @param out Decoded message, valid when OK is returned
+ * @param consumed Bytes to drop from the buffer (0 for INCOMPLETE and FRAMING_ERROR)
+ * @return DecodeStatus Outcome of the decoding
+ *
+ * Reads at most min(size, header length) bytes and never allocates.
+ */
+DecodeStatus decodeEntryMessage(const std::uint8_t* data, std::size_t size, EntryMessage& out,
+                                std::size_t& consumed);
+
+/**
+ * @brief Fills the header of an outgoing message
+ *
+ * @tparam Message One of the message structs
+ * @param message Message to stamp
+ * @param type Message type
+ * @param sequence Sender sequence number
+ */
+template <typename Message>
+void stampHeader(Message& message, EntryMessageType type, std::uint32_t sequence)
+{
+    message.header.length = static_cast<std::uint16_t>(sizeof(Message));
+    message.header.type = static_cast<std::uint8_t>(type);
+    message.header.version = ORDER_ENTRY_VERSION;
+    message.header.sequence = sequence;
+}
+
+/**
+ * @brief Encodes a message into a send buffer
+ *
+ * @param message Message with a stamped header
+ * @param buffer Destination, at least header.length bytes
+ * @return std::size_t Number of bytes written
+ */
+std::size_t encodeEntryMessage(const EntryMessage& message, std::uint8_t* buffer);
+
+/**
+ * @class CodeTable
+ * @brief Interned market identification codes and currencies
+ *
+ * Both ends build the table from the same instrument reference data, so
+ * that codes are agreed upon without being sent. Code 0 is never used.
+ */
+class CodeTable
+{
+public:
+    /**
+     * @brief Interns the MIC and currency of every instrument
+     *
+     * @param instrumentManager Instrument reference data
+     */
+    void internInstruments(const InstrumentManager& instrumentManager);
+
+    /**
+     * @brief Returns the code of a string, interning it if new
+     */
+    std::uint16_t intern(const std::string& value);
+
+    /**
+     * @brief Returns the code of a string, 0 if it is not interned
+     */
+    std::uint16_t find(const std::string& value) const;
+
+    /**
+     * @brief Returns the string of a code, nullptr if unknown
+     */
+    const std::string* lookup(std::uint16_t code) const;
+
+private:
+    std::vector<std::string> values{std::string()}; ///< String of each code, slot 0 unused
+    std::unordered_map<std::string, std::uint16_t> codes; ///< Code of each string
+};
+
+/**
+ * @brief Builds a NEW_ORDER message from an order
+ *
+ * @param order Order to send
+ * @param codes Interned codes
+ * @param sequence Sender sequence number
+ * @param out Encoded message
+ * @return true if the MIC and currency are interned
+ */
+bool makeNewOrder(const Order& order, const CodeTable& codes, std::uint32_t sequence, NewOrderMessage& out);
+
+/**
+ * @brief Builds the order described by a NEW_ORDER message
+ *
+ * @param message Decoded message
+ * @param codes Interned codes
+ * @param now Priority timestamp of the order
+ * @param out Order to fill
+ * @return true if the MIC and currency codes are known
+ */
+bool toOrder(const NewOrderMessage& message, const CodeTable& codes,
+             std::chrono::system_clock::time_point now, Order& out);
+
+/**
+ * @brief Builds a LOGON message
+ *
+ * @param idfirm Firm the session trades for
+ * @param token Firm credential
+ * @param sequence Sender sequence number, 1 on a new connection
+ * @return LogonMessage Stamped message
+ */
+LogonMessage makeLogon(int idfirm, std::uint64_t token, std::uint32_t sequence);
+
+/**
+ * @brief Builds an ACK message
+ *
+ * @param requestType Type of the accepted request
+ * @param idorder Order concerned
+ * @param sequence Sender sequence number
+ * @param now Time of the ack, from the engine clock
+ * @return AckMessage Stamped message
+ */
+AckMessage makeAck(EntryMessageType requestType, int idorder, std::uint32_t sequence,
+                   std::chrono::system_clock::time_point now);
+
+/**
+ * @brief Builds a REJECT message
+ *
+ * @param requestType Type of the refused request
+ * @param idorder Order concerned
+ * @param reason Why the request is refused
+ * @param sequence Sender sequence number
+ * @param now Time of the reject, from the engine clock
+ * @return RejectMessage Stamped message
+ */
+RejectMessage makeReject(EntryMessageType requestType, int idorder, RejectReason reason, std::uint32_t sequence,
+                         std::chrono::system_clock::time_point now);
+
+#endif // ORDERENTRYPROTOCOL_HPP
@@ -0,0 +1,212 @@
+/**
+ * @file OrderFeed.hpp
+ * @brief Level 3 (order by order) feed in a shared memory ring
+ *
+ * Every visible order event of every book (add, execute, cancel,
+ * replace) is written as a fixed-size binary message, in the spirit of
+ * ITCH, into a broadcast ring placed in POSIX shared memory. Any number
+ * of local processes can map the region read-only and consume the feed
+ * concurrently, each at its own pace, without any lock. A directory in
+ * the same region maps the bookId of each message to its instrument,
+ * market and currency.
+ */
+
+#ifndef ORDERFEED_HPP
+#define ORDERFEED_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include "Order.hpp"
+#include "BroadcastRing.hpp"
+#include "SharedMemory.hpp"
+
+/**
+ * @enum L3MessageType
+ * @brief Type of a Level 3 message, sent as a single ASCII byte
+ *
+ * Quantities are displayed quantities: iceberg reserves and untriggered
+ * stops are not disclosed, and market orders, which never rest, are not
+ * published. An order whose displayed quantity reaches 0 through
+ * executions or cancels is gone from the book. An iceberg that refills
+ * its peak from its reserve comes back under the same order id with an
+ * ADD_ORDER of the new peak, at the back of its level.
+ */
+enum class L3MessageType : std::uint8_t
+{
+    ADD_ORDER = 'A', // Order queued at the back of its level, or iceberg refilled, quantity = displayed quantity
+    EXECUTE_ORDER = 'E', // Order executed, quantity = executed quantity, matchId = trade id
+    CANCEL_ORDER = 'X', // Order reduced or removed, quantity = cancelled quantity
+    REPLACE_ORDER = 'U' // Order moved to the back of a level, new price and displayed quantity
+};
+
+/**
+ * @struct L3Message
+ * @brief Fixed-layout 56-byte Level 3 message
+ *
+ * Fields are ordered by size, without implicit padding, and are read in
+ * place on every supported (little-endian) target. Books are keyed by
+ * bookId: one instrument may have a book per market and currency.
+ */
+struct L3Message
+{
+    std::uint64_t sequence; ///< Feed sequence number, gap-free across instruments
+    std::uint64_t timestamp; ///< Event time on the engine clock, nanoseconds since the Unix epoch
+    double price; ///< Order price, or execution price for EXECUTE_ORDER
+    std::int64_t quantity; ///< Quantity, meaning depends on the message type
+    std::int32_t instrumentId; ///< Instrument identifier
+    std::int32_t bookId; ///< Feed identifier of the book, see OrderFeed::findBook
+    std::int32_t orderId; ///< Order identifier
+    std::int32_t matchId; ///< Trade identifier for EXECUTE_ORDER, 0 otherwise
+    std::uint8_t type; ///< L3MessageType
+    std::uint8_t side; ///< 'B' for buy orders, 'S' for sell orders
+    std::uint8_t reserved[6]; ///< Zero
+};
+
+static_assert(sizeof(L3Message) == 56, "L3Message layout must stay fixed");
+
+/**
+ * @struct FeedBook
+ * @brief Identity of a book of the feed, as read from the directory
+ */
+struct FeedBook
+{
+    int bookId; ///< Feed identifier of the book
+    int instrumentId; ///< Instrument identifier
+    std::string marketIdentificationCode; ///< Market of the book
+    std::string tradingCurrency; ///< Trading currency of the book
+};
+
+/**
+ * @class OrderFeed
+ * @brief Writer or reader side of the shared memory Level 3 feed
+ *
+ * The engine creates the feed and books publish into it while holding
+ * their own lock; reader processes open it by name and subscribe.
+ */
+class OrderFeed
+{
+public:
+    /// Number of messages kept before the oldest are overwritten
+    static constexpr std::size_t RING_CAPACITY = 1 << 16;
+
+    using Ring = BroadcastRing<L3Message, RING_CAPACITY>;
+
+    /// Default name of the shared memory object
+    static constexpr const char* DEFAULT_NAME = "/matching_engine_l3";
+
+    /// Number of books the directory can describe, book identifiers start at 1
+    static constexpr std::size_t MAX_BOOKS = 4096;
+
+    /**
+     * @brief Creates the shared memory region and an empty ring in it
+     *
+     * @param regionName Name of the shared memory object
+     * @return true if the feed is ready to publish
+     */
+    bool create(const std::string& regionName = DEFAULT_NAME);
+
+    /**
+     * @brief Attaches to a feed created by another process, read-only
+     *
+     * @param regionName Name of the shared memory object
+     * @return true if the region holds a compatible feed
+     */
+    bool open(const std::string& regionName = DEFAULT_NAME);
+
+    /**
+     * @brief Returns true once create or open succeeded
+     */
+    bool isOpen() const { return ring != nullptr; }
+
+    /**
+     * @brief Adds a book to the directory, before its first event
+     *
+     * @param bookId Feed identifier of the book, 1 to MAX_BOOKS
+     * @param instrumentId Instrument identifier
+     * @param marketIdentificationCode Market of the book
+     * @param tradingCurrency Trading currency of the book
+     * @return true if the book was added
+     */
+    bool registerBook(int bookId, int instrumentId, const std::string& marketIdentificationCode,
+                      const std::string& tradingCurrency);
+
+    /**
+     * @brief Looks a book up in the directory
+     *
+     * @param bookId Feed identifier read from a message
+     * @param book Receives the identity of the book
+     * @return true if the book is in the directory
+     */
+    bool findBook(int bookId, FeedBook& book) const;
+
+    /**
+     * @brief Publishes one order event
+     *
+     * @param type Message type
+     * @param timestamp Event time on the clock of the book
+     * @param instrumentId Instrument identifier
+     * @param bookId Feed identifier of the book
+     * @param order Order concerned by the event
+     * @param price Order or execution price
+     * @param quantity Quantity, meaning depends on the message type
+     * @param matchId Trade identifier for executions
+     * @return std::uint64_t Feed sequence of the message
+     */
+    std::uint64_t publish(L3MessageType type, std::chrono::system_clock::time_point timestamp, int instrumentId,
+                          int bookId, const Order& order, double price, long long quantity, int matchId = 0);
+
+    /**
+     * @brief Creates a reader that receives the messages published from now on
+     *
+     * The feed must be open.
+     *
+     * @return Ring::Reader Consumer cursor, owned by the caller
+     */
+    Ring::Reader subscribe() const { return Ring::Reader(*ring, ring->getLastSequence()); }
+
+    /**
+     * @brief Creates a reader starting at the oldest message still in the ring
+     *
+     * The feed must be open.
+     *
+     * @return Ring::Reader Consumer cursor, owned by the caller
+     */
+    Ring::Reader subscribeFromOldest() const;
+
+private:
+    /**
+     * @brief Directory slot of one book, published by its bookId
+     */
+    struct DirectoryEntry
+    {
+        std::atomic<std::int32_t> bookId; ///< 0 until the entry is written, then the book identifier
+        std::int32_t instrumentId; ///< Instrument identifier
+        char marketIdentificationCode[12]; ///< NUL-terminated market identifier
+        char tradingCurrency[8]; ///< NUL-terminated currency code
+    };
+
+    /**
+     * @brief Header at the start of the region, checked by readers
+     */
+    struct FeedLayout
+    {
+        std::atomic<std::uint32_t> magic; ///< FEED_MAGIC once the ring is initialised
+        std::uint32_t version; ///< Layout version
+        std::uint32_t messageSize; ///< sizeof(L3Message)
+        std::uint32_t capacity; ///< RING_CAPACITY
+        DirectoryEntry directory[MAX_BOOKS]; ///< Book directory, indexed by bookId - 1
+        Ring::Storage storage; ///< Ring state
+    };
+
+    static constexpr std::uint32_t FEED_MAGIC = 0x4C334D45; // "EM3L"
+    static constexpr std::uint32_t FEED_VERSION = 2;
+
+    SharedMemoryRegion region; ///< Mapped shared memory
+    FeedLayout* layout = nullptr; ///< Region contents
+    std::unique_ptr<Ring> ring; ///< Ring over the region's storage
+};
+
+#endif // ORDERFEED_HPP
@@ -0,0 +1,178 @@
+/**
+ * @file OrderFlowGenerator.hpp
+ * @brief Synthetic order flow for load tests and benchmarks
+ *
+ * Produces a stream of new orders and cancels with Poisson arrivals, a
+ * cancel ratio, limit prices spread around each instrument's reference
+ * price and a Zipf popularity skew across instruments. Each generator
+ * owns a small xoshiro256** PRNG, so one generator per thread needs no
+ * synchronisation and no std::random_device.
+ */
+
+#ifndef ORDERFLOWGENERATOR_HPP
+#define ORDERFLOWGENERATOR_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+#include "Instrument.hpp"
+#include "Order.hpp"
+
+/**
+ * @class FastRandom
+ * @brief xoshiro256** generator, seeded through splitmix64
+ */
+class FastRandom
+{
+public:
+    explicit FastRandom(std::uint64_t seed);
+
+    /**
+     * @brief Returns the next 64 random bits
+     */
+    std::uint64_t next()
+    {
+        std::uint64_t result = rotl(state[1] * 5, 7) * 9;
+        std::uint64_t t = state[1] << 17;
+        state[2] ^= state[0];
+        state[3] ^= state[1];
+        state[1] ^= state[2];
+        state[0] ^= state[3];
+        state[2] ^= t;
+        state[3] = rotl(state[3], 45);
+        return result;
+    }
+
+    /**
+     * @brief Returns a uniform double in [0, 1)
+     */
+    double nextDouble() { return static_cast<double>(next() >> 11) * 0x1.0p-53; }
+
+    /**
+     * @brief Returns a uniform integer in [0, bound), bound > 0
+     */
+    std::uint32_t nextBelow(std::uint32_t bound)
+    {
+        return static_cast<std::uint32_t>(((next() >> 32) * bound) >> 32);
+    }
+
+private:
+    static std::uint64_t rotl(std::uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+
+    std::uint64_t state[4]; ///< Generator state
+};
+
+/**
+ * @struct OrderFlowConfig
+ * @brief Shape of a synthetic order flow
+ */
+struct OrderFlowConfig
+{
+    double ordersPerSecond = 0.0; ///< Mean arrival rate, 0 for back-to-back events
+    double cancelRatio = 0.3; ///< Share of events cancelling a live order
+    double aggressiveRatio = 0.1; ///< Share of new orders priced through the reference price
+    double meanTickDistance = 5.0; ///< Mean distance to the reference price, in ticks
+    double popularitySkew = 1.0; ///< Zipf exponent over instruments in file order, 0 for uniform
+    int maxLots = 10; ///< Quantities are 1 to maxLots lots
+    int firstFirm = 1; ///< Orders are spread over firms firstFirm..firstFirm + firmCount - 1
+    int firmCount = 8; ///< Number of firms
+    std::uint64_t seed = 1; ///< PRNG seed
+};
+
+/**
+ * @enum FlowEventType
+ * @brief Kind of a generated event
+ */
+enum class FlowEventType
+{
+    NEW_ORDER, // Order to enter
+    CANCEL_ORDER // Cancel of an order entered earlier
+};
+
+/**
+ * @struct OrderFlowEvent
+ * @brief One generated event
+ *
+ * For a cancel, order holds the id and instrument of the order to cancel;
+ * the order may have traded in the meantime, in which case the cancel
+ * finds nothing, as a late cancel would.
+ */
+struct OrderFlowEvent
+{
+    FlowEventType type; ///< Kind of event
+    std::chrono::nanoseconds arrival; ///< Arrival time from the start of the flow
+    Order order; ///< Order to enter or order to cancel
+};
+
+/**
+ * @class OrderFlowGenerator
+ * @brief Generates the events of one order source
+ *
+ * Only ACTIVE instruments are traded. Order ids are firstOrderId,
+ * firstOrderId + idStride, ... so that generators of different threads,
+ * given distinct first ids below a common stride, never collide.
+ */
+class OrderFlowGenerator
+{
+public:
+    /**
+     * @brief Creates a generator over a set of instruments
+     *
+     * @param instruments Instruments, most popular first; must outlive the generator
+     * @param config Shape of the flow
+     * @param firstOrderId Id of the first order
+     * @param idStride Step between two order ids
+     */
+    OrderFlowGenerator(const std::vector<Instrument>& instruments, const OrderFlowConfig& config,
+                       int firstOrderId = 1, int idStride = 1);
+
+    /**
+     * @brief Tells whether there is at least one instrument to trade
+     */
+    bool hasInstruments() const { return !flows.empty(); }
+
+    /**
+     * @brief Generates the next event
+     *
+     * Requires hasInstruments(). The returned event is overwritten by the
+     * next call; its Order keeps its string buffers across calls.
+     */
+    const OrderFlowEvent& next();
+
+private:
+    /// Live order ids remembered per instrument for cancels
+    static constexpr std::size_t MAX_LIVE_ORDERS = 1 << 16;
+
+    /**
+     * @struct InstrumentFlow
+     * @brief Generation state of one instrument
+     */
+    struct InstrumentFlow
+    {
+        const Instrument* instrument; ///< Traded instrument
+        double tick; ///< Price increment, 10^-pricedecimal
+        long long referenceTicks; ///< Reference price in ticks
+        std::vector<int> liveOrders; ///< Ids of orders that may still rest
+    };
+
+    /**
+     * @brief Draws an instrument according to the popularity skew
+     */
+    InstrumentFlow& pickInstrument();
+
+    /**
+     * @brief Fills event.order with a new limit order
+     */
+    void makeNewOrder(InstrumentFlow& flow);
+
+    OrderFlowConfig config; ///< Shape of the flow
+    FastRandom random; ///< Source of randomness
+    std::vector<InstrumentFlow> flows; ///< Active instruments
+    std::vector<double> popularity; ///< Cumulative popularity of flows, last is 1
+    int nextOrderId; ///< Id of the next new order
+    int idStride; ///< Step between two order ids
+    std::chrono::nanoseconds clock{0}; ///< Arrival time of the last event
+    OrderFlowEvent event; ///< Event returned by next()
+};
+
+#endif // ORDERFLOWGENERATOR_HPP
@@ -0,0 +1,226 @@
+/**
+ * @file OrderGateway.hpp
+ * @brief TCP order entry gateway speaking the binary order entry protocol
+ *
+ * A single thread multiplexes every client connection with epoll. Each
+ * connection is a session: it logs on for a firm with the firm's token,
+ * then sends NEW_ORDER, CANCEL_ORDER and AMEND_ORDER requests with
+ * consecutive sequence numbers. Requests are decoded in place in the
+ * session's receive buffer and forwarded to the MatchingEngine; the
+ * acks and rejects produced by one epoll round are queued per session
+ * and sent with one writev per session at the end of the round.
+ *
+ * Linux only (epoll); on other platforms start() reports the gateway
+ * as unsupported.
+ */
+
+#ifndef ORDERGATEWAY_HPP
+#define ORDERGATEWAY_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "MatchingEngine.hpp"
+#include "OrderEntryProtocol.hpp"
+
+/**
+ * @struct GatewayStats
+ * @brief Counters of a gateway, readable from any thread
+ */
+struct GatewayStats
+{
+    std::uint64_t sessions = 0; ///< Connections accepted
+    std::uint64_t logons = 0; ///< Successful logons
+    std::uint64_t requests = 0; ///< Requests decoded
+    std::uint64_t acks = 0; ///< ACK messages queued
+    std::uint64_t rejects = 0; ///< REJECT messages queued
+    std::uint64_t writes = 0; ///< writev calls
+    std::uint64_t disconnects = 0; ///< Sessions closed by the gateway or the client
+};
+
+/**
+ * @class OrderGateway
+ * @brief Single-threaded epoll front-end of the matching engine
+ *
+ * A protocol error (framing error, sequence gap, request before logon,
+ * refused logon) is answered with a REJECT and ends the session once the
+ * reject is sent. A session whose send buffer is full because its client
+ * does not read is disconnected rather than slowing down the others.
+ */
+class OrderGateway
+{
+public:
+    /// Bytes buffered per session in each direction
+    static constexpr std::size_t SESSION_BUFFER_SIZE = 64 * 1024;
+
+    /// Events handled per epoll_wait call
+    static constexpr int MAX_EVENTS = 256;
+
+    /**
+     * @brief Creates a stopped gateway
+     *
+     * @param engine Engine receiving the decoded requests
+     * @param codes Interned MIC and currency codes agreed with the clients
+     */
+    OrderGateway(MatchingEngine& engine, const CodeTable& codes);
+
+    /**
+     * @brief Stops the gateway and closes every session
+     */
+    ~OrderGateway();
+
+    OrderGateway(const OrderGateway&) = delete;
+    OrderGateway& operator=(const OrderGateway&) = delete;
+
+    /**
+     * @brief Registers the logon token of a firm
+     *
+     * @param idfirm Firm identifier, strictly positive
+     * @param token Secret the firm presents in its LOGON message
+     */
+    void addFirm(int idfirm, std::uint64_t token);
+
+    /**
+     * @brief Listens on a TCP address and starts the gateway thread
+     *
+     * @param address IPv4 address to bind, e.g. "127.0.0.1"
+     * @param requestedPort Port to bind, 0 for any free port (see getPort)
+     * @return true if the gateway is listening
+     */
+    bool start(const std::string& address, std::uint16_t requestedPort);
+
+    /**
+     * @brief Stops the gateway thread and closes the listening socket and sessions
+     */
+    void stop();
+
+    /**
+     * @brief Returns the port the gateway listens on, 0 if stopped
+     */
+    std::uint16_t getPort() const { return port; }
+
+    /**
+     * @brief Returns a copy of the gateway counters
+     */
+    GatewayStats getStats() const;
+
+private:
+    /**
+     * @brief State of one client connection
+     */
+    struct Session
+    {
+        int fd; ///< Connected socket
+        int idfirm = 0; ///< Firm of the session, 0 before logon
+        std::uint32_t expectedSequence = 1; ///< Next client sequence number
+        std::uint32_t sendSequence = 1; ///< Next gateway sequence number
+        bool closing = false; ///< Close once the send buffer is drained
+        bool writeBlocked = false; ///< Waiting for EPOLLOUT
+        bool flushPending = false; ///< Queued in the flush list of the round
+        std::size_t received = 0; ///< Bytes in receiveBuffer
+        std::size_t sendHead = 0; ///< Offset of the first unsent byte in sendBuffer
+        std::size_t sendSize = 0; ///< Unsent bytes in sendBuffer (may wrap)
+        std::uint8_t receiveBuffer[SESSION_BUFFER_SIZE]; ///< Partial input, decoded in place
+        std::uint8_t sendBuffer[SESSION_BUFFER_SIZE]; ///< Ring of encoded responses
+    };
+
+    /**
+     * @brief Event loop of the gateway thread
+     */
+    void run();
+
+    /**
+     * @brief Accepts every pending connection
+     */
+    void acceptSessions();
+
+    /**
+     * @brief Reads from a session and handles every complete message
+     *
+     * @param session Readable session
+     * @return false if the session must be closed now
+     */
+    bool readSession(Session& session);
+
+    /**
+     * @brief Checks the session state of a request and forwards it
+     *
+     * @param session Session that sent the request
+     * @param status Decoding outcome
+     * @param message Decoded message
+     */
+    void handleMessage(Session& session, DecodeStatus status, const EntryMessage& message);
+
+    /**
+     * @brief Forwards a request of a logged on session to the engine
+     *
+     * @param session Session that sent the request
+     * @param message Valid request
+     */
+    void forwardRequest(Session& session, const EntryMessage& message);
+
+    /**
+     * @brief Queues an ACK for a request
+     */
+    void sendAck(Session& session, EntryMessageType requestType, int idorder);
+
+    /**
+     * @brief Queues a REJECT for a request
+     */
+    void sendReject(Session& session, EntryMessageType requestType, int idorder, RejectReason reason);
+
+    /**
+     * @brief Appends an encoded message to the send ring of a session
+     *
+     * @param session Destination session
+     * @param message Encoded message
+     * @param length Message length
+     */
+    void queueMessage(Session& session, const void* message, std::size_t length);
+
+    /**
+     * @brief Writes the send ring of a session with one writev
+     *
+     * @param session Session to flush
+     * @return false if the session must be closed now
+     */
+    bool flushSession(Session& session);
+
+    /**
+     * @brief Removes a session from epoll and closes its socket
+     */
+    void closeSession(int fd);
+
+    MatchingEngine& engine; ///< Destination of the requests
+    const CodeTable& codes; ///< Interned MIC and currency codes
+    std::unordered_map<int, std::uint64_t> firmTokens; ///< Logon token of each firm
+    mutable std::mutex firmsMutex; ///< Guards firmTokens
+    std::unordered_map<int, std::unique_ptr<Session>> sessions; ///< Sessions by socket (gateway thread only)
+    std::vector<Session*> flushList; ///< Sessions with responses queued in the current round
+    Order entryOrder; ///< Reused for every NEW_ORDER, keeps its string buffers
+    int listenFd = -1; ///< Listening socket
+    int epollFd = -1; ///< epoll instance
+    int wakeFd = -1; ///< eventfd used by stop() to wake the loop
+    std::uint16_t port = 0; ///< Bound port
+    std::thread gatewayThread; ///< Thread running the event loop
+    std::atomic<bool> isRunning{false}; ///< Gateway status flag
+
+    struct
+    {
+        std::atomic<std::uint64_t> sessions{0};
+        std::atomic<std::uint64_t> logons{0};
+        std::atomic<std::uint64_t> requests{0};
+        std::atomic<std::uint64_t> acks{0};
+        std::atomic<std::uint64_t> rejects{0};
+        std::atomic<std::uint64_t> writes{0};
+        std::atomic<std::uint64_t> disconnects{0};
+    } stats; ///< Counters, written by the gateway thread only
+};
+
+#endif // ORDERGATEWAY_HPP
@@ -0,0 +1,149 @@
+/**
+ * @file OrderJournal.hpp
+ * @brief Text journal of the requests entering the matching engine
+ *
+ * One request per line, comma separated, timestamps in nanoseconds since
+ * the epoch and prices with full double precision, so a replay sees
+ * exactly the values the engine saw:
+ *
+ *   N,<time>,<idorder>,<idinstrument>,<mic>,<currency>,<B|S>,<L|M>,<DAY|GTD>,<expiry>,
+ *     <price>,<quantity>,<originalqty>,<idfirm>,<peak>,<hidden>,<stop type>,<stop price>
+ *   C,<time>,<idinstrument>,<mic>,<currency>,<idorder>,<idfirm>
+ *   A,<time>,<idinstrument>,<mic>,<currency>,<idorder>,<price>,<quantity>,<idfirm>
+ *   E,<time>
+ *   B,<time>,<count>
+ *
+ * N is a new order, C a cancel, A an amend and E a GTD expiry sweep. B
+ * opens a batch: the next <count> lines are its new orders, submitted
+ * together and matched once per book. The
+ * stop type is 0 (none), 1 (stop) or 2 (stop-limit). Lines starting with
+ * '#' are comments.
+ */
+
+#ifndef ORDERJOURNAL_HPP
+#define ORDERJOURNAL_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <istream>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include "Order.hpp"
+
+/**
+ * @enum JournalEventType
+ * @brief Requests recorded in a journal
+ */
+enum class JournalEventType
+{
+    NEW_ORDER,
+    CANCEL_ORDER,
+    AMEND_ORDER,
+    EXPIRE_ORDERS,
+    BATCH
+};
+
+/**
+ * @struct JournalEvent
+ * @brief One journaled request
+ *
+ * Cancels use the order's identifier, instrument key and firm; amends
+ * also its new price and quantity; expiry sweeps only the time. A batch
+ * header carries the number of new orders that follow it.
+ */
+struct JournalEvent
+{
+    JournalEventType type = JournalEventType::NEW_ORDER; ///< Kind of request
+    std::chrono::system_clock::time_point timestamp; ///< Engine time of the request
+    Order order; ///< Order, or the fields identifying it
+    std::size_t batchSize = 0; ///< New orders following a BATCH header
+};
+
+/**
+ * @class OrderJournal
+ * @brief Appends journal lines to a stream, from any thread
+ */
+class OrderJournal
+{
+public:
+    /**
+     * @brief Journals to a stream that outlives the journal
+     */
+    explicit OrderJournal(std::ostream& out);
+
+    /**
+     * @brief Appends one request
+     */
+    void record(const JournalEvent& event);
+
+    /**
+     * @brief Appends a batch header and its new orders, as one block
+     *
+     * @param timestamp Engine time of the batch
+     * @param orders First order of the batch
+     * @param orderCount Number of orders
+     */
+    void recordBatch(std::chrono::system_clock::time_point timestamp, const Order* orders, std::size_t orderCount);
+
+    /**
+     * @brief Returns the number of requests recorded
+     */
+    long long getCount() const;
+
+private:
+    std::ostream& out; ///< Destination stream
+    mutable std::mutex mutex; ///< Serializes the writers
+    long long count = 0; ///< Requests recorded
+};
+
+/**
+ * @class OrderJournalReader
+ * @brief Reads a journal back, one request at a time
+ */
+class OrderJournalReader
+{
+public:
+    /**
+     * @brief Reads from a stream that outlives the reader
+     */
+    explicit OrderJournalReader(std::istream& in);
+
+    /**
+     * @brief Reads the next request
+     *
+     * @param event Filled with the request
+     * @return true if a request was read, false at the end or on a malformed line
+     */
+    bool next(JournalEvent& event);
+
+    /**
+     * @brief Returns true if reading stopped on a malformed line
+     */
+    bool hasError() const { return error; }
+
+    /**
+     * @brief Returns the number of the last line read
+     */
+    long long getLineNumber() const { return lineNumber; }
+
+private:
+    std::istream& in; ///< Source stream
+    std::string line; ///< Last line read
+    long long lineNumber = 0; ///< Number of the last line read
+    bool error = false; ///< True after a malformed line
+};
+
+/**
+ * @brief Formats one request as a journal line, without the newline
+ */
+std::string formatJournalEvent(const JournalEvent& event);
+
+/**
+ * @brief Parses one journal line
+ *
+ * @return true if the line is a well-formed request
+ */
+bool parseJournalEvent(const std::string& line, JournalEvent& event);
+
+#endif // ORDERJOURNAL_HPP
@@ -0,0 +1,216 @@
+/**
+ * @file PriceLevel.hpp
+ * @brief Defines a single price level of the order book
+ *
+ * A price level holds the time-priority queue of orders resting at one
+ * price, together with running aggregates that are maintained on every
+ * add, fill and removal so that depth queries never walk the orders.
+ */
+
+#ifndef PRICELEVEL_HPP
+#define PRICELEVEL_HPP
+
+#include <list>
+#include <chrono>
+#include <cstdint>
+#include <algorithm>
+#include "Order.hpp"
+
+/**
+ * @struct DepthLevel
+ * @brief Aggregated view of one price level (Level 2 market data)
+ */
+struct DepthLevel
+{
+    double price; ///< Price of the level
+    long long quantity; ///< Total displayed quantity resting at this price
+    int orderCount; ///< Number of orders resting at this price
+};
+
+/**
+ * @class PriceLevel
+ * @brief Time-priority queue of orders at a single price with running totals
+ *
+ * Orders are kept in a node-based queue: re-queuing an order at the back
+ * (iceberg replenishment) relinks its node without copying or allocating,
+ * and iterators to queued orders stay valid until the order is removed.
+ * All mutations must go through the member functions so that the totals
+ * stay consistent with the queue content.
+ */
+class PriceLevel
+{
+public:
+    using iterator = std::list<Order>::iterator;
+    using const_iterator = std::list<Order>::const_iterator;
+
+    /**
+     * @brief Appends an order at the back of the queue (lowest time priority)
+     *
+     * @param order The order to be queued
+     * @return iterator Position of the queued order
+     */
+    iterator push(const Order& order)
+    {
+        totalQuantity += order.quantity;
+        hiddenQuantity += order.hiddenQuantity;
+        ++orderCount;
+        return orders.insert(orders.end(), order);
+    }
+
+    /**
+     * @brief Reduces the displayed quantity of an order queued at this level
+     *
+     * @param order Order belonging to this level
+     * @param quantity Executed quantity
+     */
+    void fill(Order& order, int quantity)
+    {
+        order.quantity -= quantity;
+        totalQuantity -= quantity;
+    }
+
+    /**
+     * @brief Refills the displayed peak of an exhausted iceberg order
+     *
+     * @param position Position of the order in this level
+     * @param priority New priority timestamp of the order
+     *
+     * Moves the next slice of the hidden reserve into the displayed
+     * quantity and relinks the order at the back of the queue, in O(1).
+     * The order must be an exhausted iceberg with hidden quantity. Its
+     * entry sequence is kept: queue position alone gives time priority,
+     * and a resting iceberg must not become the aggressor of the trades
+     * that follow its replenishment.
+     */
+    void replenish(iterator position, std::chrono::system_clock::time_point priority)
+    {
+        Order& order = *position;
+        int refill = std::min(order.peakSize, order.hiddenQuantity);
+        order.quantity += refill;
+        order.hiddenQuantity -= refill;
+        order.priority = priority;
+        totalQuantity += refill;
+        hiddenQuantity -= refill;
+        orders.splice(orders.end(), orders, position);
+    }
+
+    /**
+     * @brief Refills the displayed peak of the front iceberg order
+     *
+     * @param priority New priority timestamp of the order
+     */
+    void replenishFront(std::chrono::system_clock::time_point priority)
+    {
+        replenish(orders.begin(), priority);
+    }
+
+    /**
+     * @brief Reduces the remaining quantity of a queued order in place
+     *
+     * @param position Position of the order in this level
+     * @param remaining New remaining quantity, displayed and hidden
+     *
+     * The order keeps its place in the queue. For iceberg orders the
+     * hidden reserve is reduced first, so the displayed peak is kept.
+     */
+    void reduce(iterator position, int remaining)
+    {
+        reduce(*position, remaining);
+    }
+
+    /**
+     * @brief Reduces the remaining quantity of a queued order in place
+     *
+     * @param order Order queued in this level
+     * @param remaining New remaining quantity, displayed and hidden
+     *
+     * Used by the allocation policies, which reach orders by reference.
+     */
+    void reduce(Order& order, int remaining)
+    {
+        int cut = order.quantity + order.hiddenQuantity - remaining;
+        int fromHidden = std::min(cut, order.hiddenQuantity);
+        order.hiddenQuantity -= fromHidden;
+        hiddenQuantity -= fromHidden;
+        order.quantity -= cut - fromHidden;
+        totalQuantity -= cut - fromHidden;
+    }
+
+    /**
+     * @brief Removes the order with the highest time priority
+     */
+    void popFront()
+    {
+        erase(orders.begin());
+    }
+
+    /**
+     * @brief Removes a queued order
+     *
+     * @param position Position of the order in this level
+     */
+    void erase(iterator position)
+    {
+        totalQuantity -= position->quantity;
+        hiddenQuantity -= position->hiddenQuantity;
+        --orderCount;
+        orders.erase(position);
+    }
+
+    /**
+     * @brief Removes every order matching a predicate
+     *
+     * @param pred Predicate returning true for orders to remove
+     * @return int Number of orders removed
+     */
+    template <typename Predicate>
+    int removeIf(Predicate pred)
+    {
+        int removed = 0;
+        for (auto it = orders.begin(); it != orders.end();)
+        {
+            if (pred(*it))
+            {
+                erase(it++);
+                ++removed;
+            }
+            else
+            {
+                ++it;
+            }
+        }
+        return removed;
+    }
+
+    Order& front() { return orders.front(); }
+    const Order& front() const { return orders.front(); }
+    bool empty() const { return orders.empty(); }
+
+    /**
+     * @brief Total displayed quantity resting at this level
+     */
+    long long getTotalQuantity() const { return totalQuantity; }
+
+    /**
+     * @brief Total iceberg reserve resting at this level
+     */
+    long long getHiddenQuantity() const { return hiddenQuantity; }
+
+    /**
+     * @brief Number of orders resting at this level
+     */
+    int getOrderCount() const { return orderCount; }
+
+    iterator begin() { return orders.begin(); }
+    iterator end() { return orders.end(); }
+    const_iterator begin() const { return orders.begin(); }
+    const_iterator end() const { return orders.end(); }
+
+private:
+    std::list<Order> orders; ///< Orders in time priority (front = oldest)
+    long long totalQuantity = 0; ///< Sum of displayed remaining quantities
+    long long hiddenQuantity = 0; ///< Sum of iceberg reserves
+    int orderCount = 0; ///< Number of queued orders
+};
+
+#endif // PRICELEVEL_HPP
@@ -0,0 +1,192 @@
+/**
+ * @file Probe.hpp
+ * @brief Hot-path probes, compiled out unless ENGINE_PROBES is defined
+ *
+ * ENGINE_PROBE(STAGE) opens a scope that lasts until the end of the
+ * enclosing block. Without ENGINE_PROBES (CMake option ENABLE_PROBES) the
+ * macro expands to nothing. With it, a probe costs one relaxed load while
+ * probes are disabled at run time, and two time stamp counter reads plus
+ * one record in the calling thread's ring while they are enabled.
+ *
+ * Each thread writes to its own ring of RING_CAPACITY records, overwriting
+ * the oldest; rings outlive their threads so a dump covers every thread
+ * that recorded. Probes::dump writes the rings as text for ProbeReport,
+ * which turns them into per-stage breakdowns and folded stacks.
+ */
+
+#ifndef PROBE_HPP
+#define PROBE_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+/**
+ * @enum ProbeId
+ * @brief Probed stages of the order path
+ *
+ * - ORDER_ENTRY: MatchingEngine::addAndValidateOrder and submitBatch
+ * - ORDER_REPORT: the engine's console report of an accepted order or batch
+ * - CANCEL: MatchingEngine::cancelOrder
+ * - AMEND: MatchingEngine::amendOrder
+ * - BOOK_ADD: OrderBook::addOrder, lock wait included
+ * - BOOK_MATCH: OrderBook::matchOrders, lock wait included
+ * - FILL_LOG: console report of a fill inside the matching loop
+ * - EXECUTE_TRADE: trade record, statistics and book update of one fill
+ * - PUBLISH: Level 2 deltas and top of book of a book mutation
+ */
+enum class ProbeId : std::uint16_t
+{
+    ORDER_ENTRY,
+    ORDER_REPORT,
+    CANCEL,
+    AMEND,
+    BOOK_ADD,
+    BOOK_MATCH,
+    FILL_LOG,
+    EXECUTE_TRADE,
+    PUBLISH,
+    COUNT
+};
+
+/**
+ * @brief Returns the lower-case name of a probe, as used in dumps
+ */
+const char* probeName(ProbeId probe);
+
+/**
+ * @brief Reads the time stamp counter, steady clock nanoseconds off x86
+ */
+inline std::uint64_t readProbeTicks()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+}
+
+/**
+ * @struct ProbeRecord
+ * @brief One closed probe scope
+ */
+struct ProbeRecord
+{
+    std::uint64_t begin; ///< Ticks at scope entry
+    std::uint64_t end; ///< Ticks at scope exit
+    std::uint16_t probe; ///< ProbeId of the scope
+    std::uint16_t depth; ///< Probe scopes open on the thread at entry
+};
+
+/**
+ * @class Probes
+ * @brief Run-time switch and per-thread rings of the probes
+ */
+class Probes
+{
+public:
+    /// True if the probes are compiled in
+#ifdef ENGINE_PROBES
+    static constexpr bool COMPILED_IN = true;
+#else
+    static constexpr bool COMPILED_IN = false;
+#endif
+
+    /// Records kept per thread, a power of two
+    static constexpr std::size_t RING_CAPACITY = 1 << 16;
+
+    /**
+     * @brief Starts or stops recording
+     *
+     * Enabling also starts the tick calibration used by dump().
+     */
+    static void setEnabled(bool enabled);
+
+    /**
+     * @brief Returns true while recording
+     */
+    static bool isEnabled() { return enabled.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Appends a record to the calling thread's ring
+     */
+    static void record(const ProbeRecord& record);
+
+    /**
+     * @brief Returns the probe scopes open on the calling thread
+     */
+    static std::uint16_t& depth();
+
+    /**
+     * @brief Writes every ring as text
+     *
+     * Format: a "ticks_per_ns <ratio>" line, one "probe <id> <name>" line
+     * per probe, then one "<thread> <probe> <depth> <begin> <end>" line
+     * per record, oldest first within a thread. Records overwritten while
+     * the ring is read are left out. Best taken with recording disabled.
+     */
+    static void dump(std::ostream& out);
+
+    /**
+     * @brief Empties every ring
+     *
+     * Only safe while no thread records.
+     */
+    static void clear();
+
+private:
+    static std::atomic<bool> enabled; ///< Run-time switch
+};
+
+/**
+ * @class ProbeScope
+ * @brief Records the duration of its lifetime while probes are enabled
+ */
+class ProbeScope
+{
+public:
+    explicit ProbeScope(ProbeId probe) : active(Probes::isEnabled())
+    {
+        if (active)
+        {
+            current.probe = static_cast<std::uint16_t>(probe);
+            current.depth = Probes::depth()++;
+            current.begin = readProbeTicks();
+        }
+    }
+
+    ~ProbeScope()
+    {
+        if (active)
+        {
+            current.end = readProbeTicks();
+            --Probes::depth();
+            Probes::record(current);
+        }
+    }
+
+    ProbeScope(const ProbeScope&) = delete;
+    ProbeScope& operator=(const ProbeScope&) = delete;
+
+private:
+    bool active; ///< True if recording was enabled at entry
+    ProbeRecord current; ///< Record filled at entry and exit
+};
+
+#define ENGINE_PROBE_CONCAT_INNER(a, b) a##b
+#define ENGINE_PROBE_CONCAT(a, b) ENGINE_PROBE_CONCAT_INNER(a, b)
+
+#ifdef ENGINE_PROBES
+#define ENGINE_PROBE(stage) ProbeScope ENGINE_PROBE_CONCAT(probeScope, __LINE__)(ProbeId::stage)
+#else
+#define ENGINE_PROBE(stage) static_cast<void>(0)
+#endif
+
+#endif // PROBE_HPP
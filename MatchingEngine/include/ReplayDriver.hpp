@@ -0,0 +1,91 @@
+/**
+ * @file ReplayDriver.hpp
+ * @brief Deterministic replay of an order journal through a matching engine
+ *
+ * The driver sets a SimulatedClock to each request's journaled time and
+ * calls the engine on the calling thread, as fast as it can. With the
+ * engine thread stopped nothing else reads the clock or touches the
+ * books, so a journal always produces the same trades, timestamps
+ * included: the trade digest of two replays of one journal is equal.
+ *
+ * Engine configuration (self-trade prevention, allocation algorithms,
+ * trading phase) is not journaled; apply it before replaying.
+ */
+
+#ifndef REPLAYDRIVER_HPP
+#define REPLAYDRIVER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "Clock.hpp"
+#include "MatchingEngine.hpp"
+#include "OrderJournal.hpp"
+
+/**
+ * @struct ReplayResult
+ * @brief Outcome of one replay
+ */
+struct ReplayResult
+{
+    long long events = 0; ///< Requests replayed, each order of a batch counted
+    long long newOrders = 0; ///< New orders sent, batched ones included
+    long long batches = 0; ///< Batches of new orders sent
+    long long accepted = 0; ///< New orders accepted by the engine
+    long long cancels = 0; ///< Cancels sent
+    long long cancelled = 0; ///< Cancels that found their order
+    long long amends = 0; ///< Amends sent
+    long long amended = 0; ///< Amends applied
+    long long expirySweeps = 0; ///< GTD sweeps run
+    long long expired = 0; ///< GTD orders removed by the sweeps
+    long long trades = 0; ///< Trades in the books after the replay
+    std::uint64_t tradeDigest = 0; ///< Digest of every trade, see digestTrades
+    double elapsedSeconds = 0.0; ///< Wall time of the replay
+    long long errorLine = 0; ///< Journal line that stopped the replay, 0 if it ran to the end
+};
+
+/**
+ * @class ReplayDriver
+ * @brief Feeds a journal to an engine under a simulated clock
+ */
+class ReplayDriver
+{
+public:
+    /**
+     * @brief Binds the driver to a stopped engine and installs the clock on it
+     *
+     * @param engine Engine to drive; its thread must not be started
+     * @param clock Clock moved to each request's time
+     */
+    ReplayDriver(MatchingEngine& engine, SimulatedClock& clock);
+
+    /**
+     * @brief Replays every request of a journal
+     *
+     * @param journal Journal positioned on its first request
+     * @return ReplayResult Counts, trade digest and wall time
+     */
+    ReplayResult replay(OrderJournalReader& journal);
+
+    /**
+     * @brief Returns a 64-bit FNV-1a digest of every trade of every book
+     *
+     * Covers instrument, trade and order identifiers, firms, the exact
+     * bits of the price, quantity and timestamp, books in key order.
+     */
+    static std::uint64_t digestTrades(const MatchingEngine& engine);
+
+private:
+    /**
+     * @brief Reads the new orders of a batch and submits them together
+     *
+     * @return bool False if the journal ended or held another request inside the batch
+     */
+    bool replayBatch(OrderJournalReader& journal, std::size_t size, ReplayResult& result);
+
+    MatchingEngine& engine; ///< Engine driven
+    SimulatedClock& clock; ///< Clock of the engine
+    std::vector<Order> batch; ///< Orders of the batch being replayed
+};
+
+#endif // REPLAYDRIVER_HPP
@@ -0,0 +1,112 @@
+/**
+ * @file SeqLock.hpp
+ * @brief Single-writer sequence lock for small trivially copyable values
+ *
+ * The writer bumps a version to an odd value, stores the value and bumps
+ * the version again; readers copy the value and retry if the version was
+ * odd or changed meanwhile. Readers never block the writer and the
+ * writer never waits for readers.
+ */
+
+#ifndef SEQLOCK_HPP
+#define SEQLOCK_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+/**
+ * @class SeqLock
+ * @brief Value published by one writer and polled by any number of readers
+ *
+ * @tparam T Trivially copyable value type
+ *
+ * Each instance sits on its own cache lines so that neighbouring values
+ * in an array are updated without false sharing. Writes to one instance
+ * must be serialised by the caller.
+ */
+template <typename T>
+class alignas(64) SeqLock
+{
+    static_assert(std::is_trivially_copyable<T>::value, "SeqLock values must be trivially copyable");
+
+public:
+    /**
+     * @brief Publishes a new value
+     *
+     * @param newValue Value to publish
+     */
+    void store(const T& newValue)
+    {
+        std::uint64_t start = version.load(std::memory_order_relaxed);
+        version.store(start + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        std::memcpy(static_cast<void*>(&value), static_cast<const void*>(&newValue), sizeof(T));
+        version.store(start + 2, std::memory_order_release);
+    }
+
+    /**
+     * @brief Modifies the value in place
+     *
+     * @param modify Callable modify(T&) writing the parts of the value that changed
+     *
+     * For large values of which a write changes only a part: nothing is
+     * copied, readers overlapping the call retry as for store.
+     */
+    template <typename Modify>
+    void update(Modify&& modify)
+    {
+        std::uint64_t start = version.load(std::memory_order_relaxed);
+        version.store(start + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        modify(value);
+        version.store(start + 2, std::memory_order_release);
+    }
+
+    /**
+     * @brief Attempts one consistent read
+     *
+     * @param out Destination of the value
+     * @return true if the copy is consistent, false if a write overlapped it
+     */
+    bool tryLoad(T& out) const
+    {
+        std::uint64_t before = version.load(std::memory_order_acquire);
+        if (before & 1)
+        {
+            return false;
+        }
+        std::memcpy(static_cast<void*>(&out), static_cast<const void*>(&value), sizeof(T));
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return version.load(std::memory_order_relaxed) == before;
+    }
+
+    /**
+     * @brief Reads a consistent value, retrying while a write overlaps
+     *
+     * @return T The last published value
+     */
+    T load() const
+    {
+        T out;
+        while (!tryLoad(out))
+        {
+        }
+        return out;
+    }
+
+    /**
+     * @brief Returns the number of completed writes
+     */
+    std::uint64_t getWriteCount() const
+    {
+        return version.load(std::memory_order_acquire) / 2;
+    }
+
+private:
+    std::atomic<std::uint64_t> version{0}; ///< Even when stable, odd during a write
+    T value{}; ///< Published value
+};
+
+#endif // SEQLOCK_HPP
@@ -0,0 +1,67 @@
+/**
+ * @file SharedMemory.hpp
+ * @brief Named shared memory region mapped into the process
+ *
+ * Thin wrapper over POSIX shared memory (shm_open + mmap). On platforms
+ * without POSIX shared memory (Windows/MinGW builds) create and open
+ * fail and report it, so callers can run without the shared feed.
+ */
+
+#ifndef SHAREDMEMORY_HPP
+#define SHAREDMEMORY_HPP
+
+#include <cstddef>
+#include <string>
+
+/**
+ * @class SharedMemoryRegion
+ * @brief Owns the mapping of one named shared memory object
+ *
+ * The creator of a region unlinks its name on destruction; processes
+ * that opened it keep their mapping until they release it.
+ */
+class SharedMemoryRegion
+{
+public:
+    SharedMemoryRegion() = default;
+    ~SharedMemoryRegion();
+
+    SharedMemoryRegion(const SharedMemoryRegion&) = delete;
+    SharedMemoryRegion& operator=(const SharedMemoryRegion&) = delete;
+
+    /**
+     * @brief Creates (or recreates) a zero-filled region and maps it read-write
+     *
+     * @param regionName Name of the object, starting with '/'
+     * @param regionSize Size in bytes
+     * @return true if the region is mapped
+     */
+    bool create(const std::string& regionName, std::size_t regionSize);
+
+    /**
+     * @brief Maps an existing region created by another process
+     *
+     * @param regionName Name of the object, starting with '/'
+     * @param regionSize Expected size in bytes
+     * @param writable Map read-write instead of read-only
+     * @return true if the region is mapped
+     */
+    bool open(const std::string& regionName, std::size_t regionSize, bool writable = false);
+
+    /**
+     * @brief Unmaps the region, and unlinks its name if this process created it
+     */
+    void release();
+
+    void* data() const { return address; }
+    std::size_t size() const { return mappedSize; }
+    bool isMapped() const { return address != nullptr; }
+
+private:
+    void* address = nullptr; ///< Start of the mapping
+    std::size_t mappedSize = 0; ///< Size of the mapping
+    std::string name; ///< Name of the shared memory object
+    bool owner = false; ///< True if this process created the object
+};
+
+#endif // SHAREDMEMORY_HPP
@@ -44,6 +44,16 @@ struct Trade
      */
     int sellOrderId;
 
+    /**
+     * @brief Firm of the buy order
+     */
+    int buyFirmId = 0;
+
+    /**
+     * @brief Firm of the sell order
+     */
+    int sellFirmId = 0;
+
     /**
      * @brief Market Identification Code (MIC)
      *
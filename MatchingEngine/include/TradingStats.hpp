@@ -0,0 +1,148 @@
+/**
+ * @file TradingStats.hpp
+ * @brief Exact, contention-free trading counters
+ *
+ * Counters are split over cache-line-aligned shards; each thread adds
+ * to its own shard with relaxed integer increments and readers sum the
+ * shards. Notional is kept as an integer (price in units of
+ * 10^-NOTIONAL_DECIMALS times quantity); instruments priced with more
+ * decimals are refused by InstrumentManager, so every tick is a whole
+ * number of units and no update is ever lost or rounded. Daily figures
+ * are the totals minus a baseline taken at the daily reset: a reset
+ * never writes to the shards. Resets are stamped with the engine clock.
+ */
+
+#ifndef TRADINGSTATS_HPP
+#define TRADINGSTATS_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include "Clock.hpp"
+
+/**
+ * @class TradingStats
+ * @brief Trade count, traded quantity, notional and matching attempts
+ */
+class TradingStats
+{
+public:
+    /// Number of shards; threads beyond this share shards, still exactly
+    static constexpr std::size_t SHARD_COUNT = 16;
+
+    /// Decimals kept on trade prices in the notional, the most an instrument may have
+    static constexpr int NOTIONAL_DECIMALS = 4;
+
+    /// Factor from a price to its integer notional unit
+    static constexpr double NOTIONAL_SCALE = 10000.0;
+
+    /**
+     * @struct Totals
+     * @brief Sum of the shards over a period
+     */
+    struct Totals
+    {
+        std::int64_t tradeCount = 0; ///< Trades executed
+        std::int64_t quantity = 0; ///< Quantity traded
+        std::int64_t notional = 0; ///< Sum of price x quantity, in 10^-NOTIONAL_DECIMALS
+        std::int64_t matchingAttempts = 0; ///< Matching cycles run by the engine loop
+
+        /**
+         * @brief Returns the notional in currency units
+         */
+        double getVolume() const { return static_cast<double>(notional) / NOTIONAL_SCALE; }
+    };
+
+    TradingStats();
+
+    /**
+     * @brief Sets the clock stamping the resets, and restamps the last one
+     *
+     * @param statsClock Clock outliving the counters
+     */
+    void setClock(const Clock* statsClock);
+
+    /**
+     * @brief Returns the integer notional of a fill
+     *
+     * @param price Trade price, a whole number of ticks of at most NOTIONAL_DECIMALS
+     * @param quantity Trade quantity
+     */
+    static std::int64_t toNotional(double price, int quantity)
+    {
+        return std::llround(price * NOTIONAL_SCALE) * quantity;
+    }
+
+    /**
+     * @brief Records one trade
+     *
+     * @param price Trade price
+     * @param quantity Trade quantity
+     */
+    void recordTrade(double price, int quantity);
+
+    /**
+     * @brief Records one matching cycle of the engine loop
+     */
+    void recordMatchingAttempt();
+
+    /**
+     * @brief Returns the figures since the last reset()
+     */
+    Totals getTotals() const;
+
+    /**
+     * @brief Returns the figures since the last resetDaily() or reset()
+     */
+    Totals getDaily() const;
+
+    /**
+     * @brief Returns the time of the last daily reset
+     */
+    std::chrono::system_clock::time_point getLastReset() const;
+
+    /**
+     * @brief Starts a new day
+     */
+    void resetDaily();
+
+    /**
+     * @brief Starts over, totals included
+     */
+    void reset();
+
+private:
+    /**
+     * @struct Shard
+     * @brief Counters of the threads mapped to one shard, alone on its cache line
+     */
+    struct alignas(64) Shard
+    {
+        std::atomic<std::int64_t> tradeCount{0};
+        std::atomic<std::int64_t> quantity{0};
+        std::atomic<std::int64_t> notional{0};
+        std::atomic<std::int64_t> matchingAttempts{0};
+    };
+
+    /**
+     * @brief Returns the shard of the calling thread
+     */
+    Shard& localShard();
+
+    /**
+     * @brief Sums the shards
+     */
+    Totals sum() const;
+
+    Shard shards[SHARD_COUNT]; ///< Counters since construction
+    mutable std::mutex baselineMutex; ///< Guards the baselines and lastReset
+    Totals totalBaseline; ///< Sum of the shards at the last reset()
+    Totals dailyBaseline; ///< Sum of the shards at the last daily reset
+    const Clock* clock = &SystemClock::instance(); ///< Time source of the reset stamps
+    std::chrono::system_clock::time_point lastReset; ///< Time of the last daily reset
+};
+
+#endif // TRADINGSTATS_HPP
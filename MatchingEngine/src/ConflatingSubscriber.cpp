@@ -0,0 +1,192 @@
+/**
+ * @file ConflatingSubscriber.cpp
+ * @brief Implementation of the conflating Level 2 subscriber
+ */
+
+#include "ConflatingSubscriber.hpp"
+#include <limits>
+
+/**
+ * @brief Subscribes to the conflated images of a feed
+ *
+ * @param publisher Level 2 feed whose book images are sampled
+ * @param interval Minimum time between two deliveries of poll()
+ *
+ * The first delivery hands out every level of every book, as
+ * ADD_LEVEL messages.
+ */
+ConflatingSubscriber::ConflatingSubscriber(const MarketDataPublisher& publisher,
+                                           std::chrono::milliseconds interval)
+    : publisher(publisher), interval(interval), lastDelivery(std::chrono::steady_clock::now())
+{
+}
+
+/**
+ * @brief Samples the images and delivers the conflated changes if the interval elapsed
+ *
+ * @param callback Receives each conflated message
+ * @return int Number of messages delivered
+ *
+ * Nothing is read before the interval elapsed: the images hold the
+ * latest state whenever the subscriber gets to them.
+ */
+int ConflatingSubscriber::poll(const Callback& callback)
+{
+    auto now = std::chrono::steady_clock::now();
+    if (now - lastDelivery < interval)
+    {
+        return 0;
+    }
+    lastDelivery = now;
+    sample();
+    return deliver(callback);
+}
+
+/**
+ * @brief Samples the images and delivers the conflated changes now
+ *
+ * @param callback Receives each conflated message
+ * @return int Number of messages delivered
+ */
+int ConflatingSubscriber::flush(const Callback& callback)
+{
+    sample();
+    lastDelivery = std::chrono::steady_clock::now();
+    return deliver(callback);
+}
+
+/**
+ * @brief Reads the image of every book that changed since the last sample
+ *
+ * Unchanged books cost one load of their seqlock version.
+ */
+void ConflatingSubscriber::sample()
+{
+    int imageCount = publisher.getImageCount();
+    if (cursors.size() < static_cast<std::size_t>(imageCount))
+    {
+        cursors.resize(imageCount);
+    }
+
+    ConflatedBook image;
+    for (int bookId = 1; bookId <= imageCount; ++bookId)
+    {
+        BookCursor& cursor = cursors[bookId - 1];
+        std::uint64_t writes = publisher.getImageWrites(bookId);
+        if (writes == cursor.writes || !publisher.readImage(bookId, image))
+        {
+            continue;
+        }
+        cursor.writes = writes;
+        stats.received += image.updates - cursor.updates;
+        cursor.updates = image.updates;
+        stats.samples++;
+        apply(image);
+    }
+}
+
+/**
+ * @brief Replaces the levels of one book with its image
+ *
+ * @param image Image read from the publisher
+ *
+ * Every level the book had or has now is marked for comparison with
+ * what the consumer last received.
+ */
+void ConflatingSubscriber::apply(const ConflatedBook& image)
+{
+    // Levels of the book sort together: (book, instrument, side, price)
+    auto first = current.lower_bound(LevelKey(image.bookId, std::numeric_limits<int>::min(), 0,
+                                              -std::numeric_limits<double>::max()));
+    auto it = first;
+    while (it != current.end() && std::get<0>(it->first) == image.bookId)
+    {
+        dirty[it->first] = image.sequence;
+        ++it;
+    }
+    current.erase(first, it);
+
+    auto addSide = [this, &image](std::uint8_t side, const DepthLevel* levels, int count)
+    {
+        for (int i = 0; i < count; ++i)
+        {
+            LevelKey key(image.bookId, image.instrumentId, side, levels[i].price);
+            current[key] = {levels[i].quantity, levels[i].orderCount};
+            dirty[key] = image.sequence;
+        }
+    };
+    addSide('B', image.bids, image.bidLevels);
+    addSide('S', image.asks, image.askLevels);
+}
+
+/**
+ * @brief Delivers the net change of every level touched since the last delivery
+ *
+ * @param callback Receives each conflated message
+ * @return int Number of messages delivered
+ *
+ * Compares each touched level with what the consumer last received:
+ * a level added and removed within one interval produces nothing. The
+ * deltas received since the previous delivery are balanced against the
+ * messages sent, into conflated or depthMoves.
+ */
+int ConflatingSubscriber::deliver(const Callback& callback)
+{
+    int count = 0;
+    for (const auto& [key, sequence] : dirty)
+    {
+        auto now = current.find(key);
+        auto seen = delivered.find(key);
+
+        L2Message message{};
+        message.sequence = sequence;
+        message.bookId = std::get<0>(key);
+        message.instrumentId = std::get<1>(key);
+        message.side = std::get<2>(key);
+        message.price = std::get<3>(key);
+
+        if (now != current.end())
+        {
+            if (seen != delivered.end() && seen->second.quantity == now->second.quantity &&
+                seen->second.orderCount == now->second.orderCount)
+            {
+                continue;
+            }
+            message.type = static_cast<std::uint8_t>(seen == delivered.end()
+                                                         ? L2MessageType::ADD_LEVEL
+                                                         : L2MessageType::UPDATE_LEVEL);
+            message.quantity = now->second.quantity;
+            message.orderCount = now->second.orderCount;
+            delivered[key] = now->second;
+        }
+        else if (seen != delivered.end())
+        {
+            message.type = static_cast<std::uint8_t>(L2MessageType::DELETE_LEVEL);
+            delivered.erase(seen);
+        }
+        else
+        {
+            continue;
+        }
+
+        callback(message);
+        count++;
+    }
+
+    // A level pushed out of the depth, or moved into it, has no delta of its own
+    dirty.clear();
+    std::uint64_t deltas = stats.received - receivedAtDelivery;
+    std::uint64_t messages = static_cast<std::uint64_t>(count);
+    if (deltas >= messages)
+    {
+        stats.conflated += deltas - messages;
+    }
+    else
+    {
+        stats.depthMoves += messages - deltas;
+    }
+    receivedAtDelivery = stats.received;
+    stats.delivered += messages;
+    stats.flushes++;
+    return count;
+}
@@ -5,6 +5,7 @@
 #include "CreateInstrumentWidget.h"
 #include "InstrumentManager.hpp" // Inclure le manager réel
 #include "Instrument.hpp"        // Inclure la classe Instrument
+#include "TradingStats.hpp"
 #include <QFormLayout>
 #include <QVBoxLayout>
 #include <QMessageBox>
@@ -54,6 +55,7 @@ void CreateInstrumentWidget::setupUi() {
     lotSizeInput->setValue(100);
 
     priceDecimalInput = new QSpinBox();
+    priceDecimalInput->setRange(0, TradingStats::NOTIONAL_DECIMALS);
     priceDecimalInput->setValue(2);
 
     currentOrderIdInput = new QSpinBox();
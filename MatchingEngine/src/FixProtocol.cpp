@@ -0,0 +1,774 @@
+/**
+ * @file FixProtocol.cpp
+ * @brief Implementation of the FIX 4.4 tag-value codec
+ */
+
+#include "FixProtocol.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace
+{
+    /// Powers of ten up to 10^18
+    constexpr long long POWERS_OF_TEN[] = {
+        1LL, 10LL, 100LL, 1000LL, 10000LL, 100000LL, 1000000LL, 10000000LL, 100000000LL,
+        1000000000LL, 10000000000LL, 100000000000LL, 1000000000000LL, 10000000000000LL,
+        100000000000000LL, 1000000000000000LL, 10000000000000000LL, 100000000000000000LL,
+        1000000000000000000LL
+    };
+
+    /// Decimals written by FixWriter::addDecimal
+    constexpr int WRITER_DECIMALS = 8;
+
+    bool isDigit(char c)
+    {
+        return c >= '0' && c <= '9';
+    }
+
+    /**
+     * @brief Parses an optionally signed integer of at most 18 digits
+     */
+    bool parseInteger(std::string_view value, long long& out)
+    {
+        std::size_t pos = 0;
+        bool negative = !value.empty() && value[0] == '-';
+        if (negative)
+        {
+            pos = 1;
+        }
+        if (pos == value.size() || value.size() - pos > 18)
+        {
+            return false;
+        }
+        long long result = 0;
+        for (; pos < value.size(); ++pos)
+        {
+            if (!isDigit(value[pos]))
+            {
+                return false;
+            }
+            result = result * 10 + (value[pos] - '0');
+        }
+        out = negative ? -result : result;
+        return true;
+    }
+
+    /**
+     * @brief Parses a strictly positive integer that fits an int
+     */
+    bool parsePositiveInt(std::string_view value, int& out)
+    {
+        long long result;
+        if (!parseInteger(value, result) || result <= 0 || result > INT32_MAX)
+        {
+            return false;
+        }
+        out = static_cast<int>(result);
+        return true;
+    }
+
+    /**
+     * @brief Reads a fixed number of digits
+     */
+    bool parseDigits(const char* text, int count, int& out)
+    {
+        out = 0;
+        for (int i = 0; i < count; ++i)
+        {
+            if (!isDigit(text[i]))
+            {
+                return false;
+            }
+            out = out * 10 + (text[i] - '0');
+        }
+        return true;
+    }
+
+    /**
+     * @brief Days since 1970-01-01 of a civil date (proleptic Gregorian)
+     */
+    long long daysFromCivil(int year, int month, int day)
+    {
+        year -= month <= 2;
+        long long era = (year >= 0 ? year : year - 399) / 400;
+        long long yearOfEra = year - era * 400;
+        long long dayOfYear = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+        long long dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+        return era * 146097 + dayOfEra - 719468;
+    }
+
+    /**
+     * @brief Civil date of a number of days since 1970-01-01
+     */
+    void civilFromDays(long long days, int& year, int& month, int& day)
+    {
+        days += 719468;
+        long long era = (days >= 0 ? days : days - 146096) / 146097;
+        long long dayOfEra = days - era * 146097;
+        long long yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+        long long dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+        long long monthIndex = (5 * dayOfYear + 2) / 153;
+        day = static_cast<int>(dayOfYear - (153 * monthIndex + 2) / 5 + 1);
+        month = static_cast<int>(monthIndex < 10 ? monthIndex + 3 : monthIndex - 9);
+        year = static_cast<int>(yearOfEra + era * 400 + (month <= 2));
+    }
+
+    /**
+     * @brief Writes a number with a fixed number of digits, zero padded
+     */
+    void writeDigits(char* text, long long value, int count)
+    {
+        for (int i = count - 1; i >= 0; --i)
+        {
+            text[i] = static_cast<char>('0' + value % 10);
+            value /= 10;
+        }
+    }
+}
+
+/**
+ * @brief Looks up the first field with a tag
+ *
+ * @param tag Tag number
+ * @return const FixField* The field, or nullptr if absent
+ *
+ * A linear scan: order entry messages carry a few dozen fields, and the
+ * order mapping functions read them in a single pass instead.
+ */
+const FixField* FixMessage::find(int tag) const
+{
+    for (const FixField& field : *this)
+    {
+        if (field.tag == tag)
+        {
+            return &field;
+        }
+    }
+    return nullptr;
+}
+
+/**
+ * @brief Returns the value of a field, empty if absent
+ */
+std::string_view FixMessage::getString(int tag) const
+{
+    const FixField* field = find(tag);
+    return field == nullptr ? std::string_view() : field->view();
+}
+
+/**
+ * @brief Reads an integer field
+ *
+ * @param tag Tag number
+ * @param out Value read
+ * @return true if the field is present and is an integer
+ */
+bool FixMessage::getInt(int tag, long long& out) const
+{
+    const FixField* field = find(tag);
+    return field != nullptr && parseInteger(field->view(), out);
+}
+
+/**
+ * @brief Parses the message at the front of a receive buffer
+ *
+ * @param data Start of the received bytes
+ * @param size Number of received bytes
+ * @param out Parsed message, valid when OK is returned
+ * @param consumed Bytes to drop from the buffer
+ * @return DecodeStatus Outcome of the parsing
+ *
+ * BodyLength locates the CheckSum field; if it is not where BodyLength
+ * says, the stream is out of step and nothing more can be trusted. A
+ * wrong checksum or an unparsable field only spoils this message.
+ */
+DecodeStatus parseFixMessage(const char* data, std::size_t size, FixMessage& out, std::size_t& consumed)
+{
+    static constexpr std::string_view PREFIX = "8=FIX.4.4\x01" "9=";
+    consumed = 0;
+    if (size == 0)
+    {
+        return DecodeStatus::INCOMPLETE;
+    }
+
+    std::size_t prefixLength = std::min(size, PREFIX.size());
+    if (std::memcmp(data, PREFIX.data(), prefixLength) != 0)
+    {
+        return DecodeStatus::FRAMING_ERROR;
+    }
+    if (size < PREFIX.size())
+    {
+        return DecodeStatus::INCOMPLETE;
+    }
+
+    // BodyLength: at most 4 digits since messages are bounded
+    std::size_t pos = PREFIX.size();
+    std::size_t bodyLength = 0;
+    for (;; ++pos)
+    {
+        if (pos >= size)
+        {
+            return DecodeStatus::INCOMPLETE;
+        }
+        if (data[pos] == FIX_SOH)
+        {
+            break;
+        }
+        if (!isDigit(data[pos]) || pos - PREFIX.size() >= 4)
+        {
+            return DecodeStatus::FRAMING_ERROR;
+        }
+        bodyLength = bodyLength * 10 + static_cast<std::size_t>(data[pos] - '0');
+    }
+    if (pos == PREFIX.size() || bodyLength == 0)
+    {
+        return DecodeStatus::FRAMING_ERROR;
+    }
+
+    std::size_t bodyStart = pos + 1;
+    std::size_t bodyEnd = bodyStart + bodyLength;
+    std::size_t total = bodyEnd + 7; // "10=nnn<SOH>"
+    if (total > MAX_FIX_MESSAGE_SIZE)
+    {
+        return DecodeStatus::FRAMING_ERROR;
+    }
+    if (size < total)
+    {
+        return DecodeStatus::INCOMPLETE;
+    }
+
+    const char* trailer = data + bodyEnd;
+    int expectedChecksum;
+    if (data[bodyEnd - 1] != FIX_SOH || std::memcmp(trailer, "10=", 3) != 0 ||
+        !parseDigits(trailer + 3, 3, expectedChecksum) || trailer[6] != FIX_SOH)
+    {
+        return DecodeStatus::FRAMING_ERROR;
+    }
+    consumed = total;
+
+    unsigned checksum = 0;
+    for (std::size_t i = 0; i < bodyEnd; ++i)
+    {
+        checksum += static_cast<unsigned char>(data[i]);
+    }
+    if (static_cast<int>(checksum % 256) != expectedChecksum)
+    {
+        return DecodeStatus::MALFORMED;
+    }
+
+    // Fields: tag=value<SOH>, MsgType first
+    out.fieldCount = 0;
+    out.seqNum = 0;
+    pos = bodyStart;
+    while (pos < bodyEnd)
+    {
+        int tag = 0;
+        std::size_t tagStart = pos;
+        while (pos < bodyEnd && isDigit(data[pos]) && pos - tagStart < 9)
+        {
+            tag = tag * 10 + (data[pos] - '0');
+            ++pos;
+        }
+        if (pos == tagStart || pos >= bodyEnd || data[pos] != '=' || out.fieldCount == FixMessage::MAX_FIELDS)
+        {
+            return DecodeStatus::MALFORMED;
+        }
+        const char* value = data + pos + 1;
+        const auto* separator = static_cast<const char*>(std::memchr(value, FIX_SOH, data + bodyEnd - value));
+        if (separator == value)
+        {
+            return DecodeStatus::MALFORMED;
+        }
+
+        FixField& field = out.fields[out.fieldCount++];
+        field.tag = tag;
+        field.value = value;
+        field.length = static_cast<std::uint32_t>(separator - value);
+        pos = static_cast<std::size_t>(separator - data) + 1;
+
+        if (tag == FixTag::MSG_SEQ_NUM)
+        {
+            long long seqNum;
+            if (!parseInteger(field.view(), seqNum) || seqNum <= 0 || seqNum > UINT32_MAX)
+            {
+                return DecodeStatus::MALFORMED;
+            }
+            out.seqNum = static_cast<std::uint32_t>(seqNum);
+        }
+    }
+    if (out.fields[0].tag != FixTag::MSG_TYPE)
+    {
+        return DecodeStatus::MALFORMED;
+    }
+    out.msgType = out.fields[0].view();
+    return DecodeStatus::OK;
+}
+
+/**
+ * @brief Parses a non-negative decimal number without allocating
+ *
+ * @param value Characters of the number, e.g. "101.25"
+ * @param out Value read
+ * @return true if value is digits with at most one decimal point
+ *
+ * The digits are accumulated as an integer and divided once by a power
+ * of ten, so prices with up to 15 significant digits are read exactly
+ * as their closest double.
+ */
+bool parseFixDecimal(std::string_view value, double& out)
+{
+    long long mantissa = 0;
+    int digits = 0;
+    int decimals = -1;
+    for (char c : value)
+    {
+        if (c == '.' && decimals < 0)
+        {
+            decimals = 0;
+            continue;
+        }
+        if (!isDigit(c) || digits == 18)
+        {
+            return false;
+        }
+        mantissa = mantissa * 10 + (c - '0');
+        digits++;
+        if (decimals >= 0)
+        {
+            decimals++;
+        }
+    }
+    if (digits == 0)
+    {
+        return false;
+    }
+    out = decimals > 0 ? static_cast<double>(mantissa) / static_cast<double>(POWERS_OF_TEN[decimals])
+                       : static_cast<double>(mantissa);
+    return true;
+}
+
+/**
+ * @brief Parses a UTCTimestamp (YYYYMMDD-HH:MM:SS[.sss])
+ *
+ * @param value Characters of the timestamp
+ * @param out Time point read
+ * @return true if the timestamp is well formed
+ */
+bool parseFixTimestamp(std::string_view value, std::chrono::system_clock::time_point& out)
+{
+    if (value.size() != 17 && value.size() != 21)
+    {
+        return false;
+    }
+    const char* text = value.data();
+    int year, month, day, hour, minute, second, millisecond = 0;
+    if (!parseDigits(text, 4, year) || !parseDigits(text + 4, 2, month) || !parseDigits(text + 6, 2, day) ||
+        text[8] != '-' || !parseDigits(text + 9, 2, hour) || text[11] != ':' ||
+        !parseDigits(text + 12, 2, minute) || text[14] != ':' || !parseDigits(text + 15, 2, second))
+    {
+        return false;
+    }
+    if (value.size() == 21 && (text[17] != '.' || !parseDigits(text + 18, 3, millisecond)))
+    {
+        return false;
+    }
+    if (month < 1 || month > 12 || day < 1 || day > 31 || hour > 23 || minute > 59 || second > 60)
+    {
+        return false;
+    }
+
+    long long seconds = daysFromCivil(year, month, day) * 86400 + hour * 3600 + minute * 60 + second;
+    out = std::chrono::system_clock::time_point(
+        std::chrono::duration_cast<std::chrono::system_clock::duration>(
+            std::chrono::seconds(seconds) + std::chrono::milliseconds(millisecond)));
+    return true;
+}
+
+/**
+ * @brief Fills an order from a NewOrderSingle (35=D)
+ *
+ * @param message Parsed NewOrderSingle
+ * @param idfirm Firm of the session
+ * @param now Priority timestamp of the order
+ * @param out Order to fill
+ * @return true if every required field is present and supported
+ */
+bool fixToOrder(const FixMessage& message, int idfirm, std::chrono::system_clock::time_point now, Order& out)
+{
+    bool hasOrderId = false, hasInstrument = false, hasMic = false, hasCurrency = false;
+    bool hasSide = false, hasQuantity = false, hasPrice = false, hasStopPrice = false, hasExpiration = false;
+    char ordType = 0;
+    int maxFloor = 0;
+    double stopPrice = 0.0;
+
+    out.price = 0.0;
+    out.timeinforce = TimeInForce::DAY;
+    for (const FixField& field : message)
+    {
+        std::string_view value = field.view();
+        switch (field.tag)
+        {
+        case FixTag::CL_ORD_ID:
+            hasOrderId = parsePositiveInt(value, out.idorder);
+            break;
+        case FixTag::SECURITY_ID:
+            hasInstrument = parsePositiveInt(value, out.idinstrument);
+            break;
+        case FixTag::SECURITY_EXCHANGE:
+            out.marketIdentificationCode.assign(value.data(), value.size());
+            hasMic = true;
+            break;
+        case FixTag::CURRENCY:
+            out.tradingCurrency.assign(value.data(), value.size());
+            hasCurrency = true;
+            break;
+        case FixTag::SIDE:
+            hasSide = value == "1" || value == "2";
+            out.ordertype = value == "1" ? OrderType::BID : OrderType::ASK;
+            break;
+        case FixTag::ORDER_QTY:
+            hasQuantity = parsePositiveInt(value, out.quantity);
+            break;
+        case FixTag::ORD_TYPE:
+            ordType = value.size() == 1 ? value[0] : 0;
+            break;
+        case FixTag::PRICE:
+            hasPrice = parseFixDecimal(value, out.price);
+            break;
+        case FixTag::STOP_PX:
+            hasStopPrice = parseFixDecimal(value, stopPrice);
+            break;
+        case FixTag::TIME_IN_FORCE:
+            if (value == "0")
+            {
+                out.timeinforce = TimeInForce::DAY;
+            }
+            else if (value == "6")
+            {
+                out.timeinforce = TimeInForce::GTD;
+            }
+            else
+            {
+                return false;
+            }
+            break;
+        case FixTag::EXPIRE_TIME:
+            hasExpiration = parseFixTimestamp(value, out.expirationDate);
+            break;
+        case FixTag::MAX_FLOOR:
+            if (!parsePositiveInt(value, maxFloor))
+            {
+                return false;
+            }
+            break;
+        default:
+            break;
+        }
+    }
+
+    // OrdType: 1 market, 2 limit, 3 stop, 4 stop limit
+    bool limitPrice = ordType == '2' || ordType == '4';
+    bool stop = ordType == '3' || ordType == '4';
+    if (!hasOrderId || !hasInstrument || !hasMic || !hasCurrency || !hasSide || !hasQuantity ||
+        ordType < '1' || ordType > '4' || (limitPrice && !hasPrice) || (stop && !hasStopPrice) ||
+        (out.timeinforce == TimeInForce::GTD && !hasExpiration))
+    {
+        return false;
+    }
+
+    out.priority = now;
+    out.originalqty = out.quantity;
+    out.limitType = limitPrice ? LimitType::LIMIT : LimitType::NONE;
+    out.idfirm = idfirm;
+    out.peakSize = 0;
+    out.hiddenQuantity = 0;
+    out.stopType = StopType::NONE;
+    out.stopPrice = 0.0;
+    out.stpMode = SelfTradePrevention::NONE;
+    out.sequence = 0;
+    if (!limitPrice)
+    {
+        out.price = 0.0;
+    }
+    if (maxFloor > 0)
+    {
+        out.setIcebergPeak(maxFloor);
+    }
+    if (stop)
+    {
+        out.setStop(ordType == '3' ? StopType::STOP : StopType::STOP_LIMIT, stopPrice);
+    }
+    return true;
+}
+
+/**
+ * @brief Reads an OrderCancelRequest (35=F) or OrderCancelReplaceRequest (35=G)
+ *
+ * @param message Parsed request
+ * @param out Content of the request
+ * @return true if every required field is present
+ */
+bool fixToOrderChange(const FixMessage& message, FixOrderChange& out)
+{
+    bool replace = message.getMsgType() == "G";
+    bool hasOrderId = false, hasOrigOrderId = false, hasInstrument = false;
+    bool hasPrice = false, hasQuantity = false;
+    out = FixOrderChange();
+
+    for (const FixField& field : message)
+    {
+        std::string_view value = field.view();
+        switch (field.tag)
+        {
+        case FixTag::CL_ORD_ID:
+            hasOrderId = parsePositiveInt(value, out.idorder);
+            break;
+        case FixTag::ORIG_CL_ORD_ID:
+            hasOrigOrderId = parsePositiveInt(value, out.origIdorder);
+            break;
+        case FixTag::SECURITY_ID:
+            hasInstrument = parsePositiveInt(value, out.idinstrument);
+            break;
+        case FixTag::SECURITY_EXCHANGE:
+            out.marketIdentificationCode = value;
+            break;
+        case FixTag::CURRENCY:
+            out.tradingCurrency = value;
+            break;
+        case FixTag::PRICE:
+            hasPrice = parseFixDecimal(value, out.newPrice);
+            break;
+        case FixTag::ORDER_QTY:
+            hasQuantity = parsePositiveInt(value, out.newQuantity);
+            break;
+        default:
+            break;
+        }
+    }
+    return hasOrderId && hasOrigOrderId && hasInstrument && !out.marketIdentificationCode.empty() &&
+        !out.tradingCurrency.empty() && (!replace || (hasPrice && hasQuantity));
+}
+
+/**
+ * @brief Starts a message with its standard header
+ *
+ * @param msgType MsgType
+ * @param seqNum MsgSeqNum
+ * @param senderCompId SenderCompID
+ * @param targetCompId TargetCompID
+ * @param sendingTime SendingTime
+ */
+void FixWriter::begin(std::string_view msgType, std::uint32_t seqNum, std::string_view senderCompId,
+                      std::string_view targetCompId, std::chrono::system_clock::time_point sendingTime)
+{
+    bodyEnd = HEADER_RESERVE;
+    overflow = false;
+    add(FixTag::MSG_TYPE, msgType);
+    add(FixTag::SENDER_COMP_ID, senderCompId);
+    add(FixTag::TARGET_COMP_ID, targetCompId);
+    add(FixTag::MSG_SEQ_NUM, static_cast<long long>(seqNum));
+    addTimestamp(FixTag::SENDING_TIME, sendingTime);
+}
+
+/**
+ * @brief Appends raw characters to the body
+ *
+ * The last 7 bytes of the buffer are kept for the CheckSum field.
+ */
+void FixWriter::append(const char* text, std::size_t length)
+{
+    if (overflow || bodyEnd + length > CAPACITY - 7)
+    {
+        overflow = true;
+        return;
+    }
+    std::memcpy(buffer + bodyEnd, text, length);
+    bodyEnd += length;
+}
+
+/**
+ * @brief Appends "tag="
+ */
+void FixWriter::appendTag(int tag)
+{
+    char text[12];
+    int length = 0;
+    char digits[10];
+    int count = 0;
+    do
+    {
+        digits[count++] = static_cast<char>('0' + tag % 10);
+        tag /= 10;
+    }
+    while (tag > 0 && count < 10);
+    while (count > 0)
+    {
+        text[length++] = digits[--count];
+    }
+    text[length++] = '=';
+    append(text, static_cast<std::size_t>(length));
+}
+
+void FixWriter::add(int tag, std::string_view value)
+{
+    appendTag(tag);
+    append(value.data(), value.size());
+    append(&FIX_SOH, 1);
+}
+
+void FixWriter::add(int tag, char value)
+{
+    appendTag(tag);
+    append(&value, 1);
+    append(&FIX_SOH, 1);
+}
+
+void FixWriter::add(int tag, long long value)
+{
+    char text[21];
+    std::size_t pos = sizeof(text);
+    unsigned long long magnitude = value < 0 ? 0ULL - static_cast<unsigned long long>(value)
+                                             : static_cast<unsigned long long>(value);
+    do
+    {
+        text[--pos] = static_cast<char>('0' + magnitude % 10);
+        magnitude /= 10;
+    }
+    while (magnitude > 0);
+    if (value < 0)
+    {
+        text[--pos] = '-';
+    }
+    appendTag(tag);
+    append(text + pos, sizeof(text) - pos);
+    append(&FIX_SOH, 1);
+}
+
+/**
+ * @brief Adds a price, written with at most 8 decimals
+ *
+ * Trailing zeros are dropped, so 101.5 is written "101.5".
+ */
+void FixWriter::addDecimal(int tag, double value)
+{
+    if (!std::isfinite(value) || std::fabs(value) >= 1e10)
+    {
+        overflow = true;
+        return;
+    }
+    long long scaled = std::llround(std::fabs(value) * static_cast<double>(POWERS_OF_TEN[WRITER_DECIMALS]));
+    long long integer = scaled / POWERS_OF_TEN[WRITER_DECIMALS];
+    long long fraction = scaled % POWERS_OF_TEN[WRITER_DECIMALS];
+
+    char text[32];
+    std::size_t length = 0;
+    if (value < 0 && scaled != 0)
+    {
+        text[length++] = '-';
+    }
+    char digits[20];
+    int count = 0;
+    do
+    {
+        digits[count++] = static_cast<char>('0' + integer % 10);
+        integer /= 10;
+    }
+    while (integer > 0);
+    while (count > 0)
+    {
+        text[length++] = digits[--count];
+    }
+    if (fraction != 0)
+    {
+        int decimals = WRITER_DECIMALS;
+        while (fraction % 10 == 0)
+        {
+            fraction /= 10;
+            decimals--;
+        }
+        text[length++] = '.';
+        writeDigits(text + length, fraction, decimals);
+        length += static_cast<std::size_t>(decimals);
+    }
+    appendTag(tag);
+    append(text, length);
+    append(&FIX_SOH, 1);
+}
+
+/**
+ * @brief Adds a UTCTimestamp with milliseconds
+ */
+void FixWriter::addTimestamp(int tag, std::chrono::system_clock::time_point value)
+{
+    long long milliseconds = std::chrono::duration_cast<std::chrono::milliseconds>(value.time_since_epoch()).count();
+    long long days = milliseconds >= 0 ? milliseconds / 86400000 : (milliseconds - 86399999) / 86400000;
+    long long inDay = milliseconds - days * 86400000;
+    int year, month, day;
+    civilFromDays(days, year, month, day);
+
+    char text[21]; // YYYYMMDD-HH:MM:SS.sss
+    writeDigits(text, year, 4);
+    writeDigits(text + 4, month, 2);
+    writeDigits(text + 6, day, 2);
+    text[8] = '-';
+    writeDigits(text + 9, inDay / 3600000, 2);
+    text[11] = ':';
+    writeDigits(text + 12, inDay / 60000 % 60, 2);
+    text[14] = ':';
+    writeDigits(text + 15, inDay / 1000 % 60, 2);
+    text[17] = '.';
+    writeDigits(text + 18, inDay % 1000, 3);
+    appendTag(tag);
+    append(text, sizeof(text));
+    append(&FIX_SOH, 1);
+}
+
+/**
+ * @brief Completes the message
+ *
+ * @return std::string_view The whole message, empty if it overflowed
+ *
+ * BeginString and BodyLength are written right in front of the body,
+ * in the space reserved by begin(), so the body is never moved.
+ */
+std::string_view FixWriter::finish()
+{
+    if (overflow)
+    {
+        return std::string_view();
+    }
+
+    char header[HEADER_RESERVE];
+    std::size_t headerLength = 0;
+    std::memcpy(header, "8=FIX.4.4\x01" "9=", 12);
+    headerLength = 12;
+    std::size_t bodyLength = bodyEnd - HEADER_RESERVE;
+    char digits[8];
+    int count = 0;
+    do
+    {
+        digits[count++] = static_cast<char>('0' + bodyLength % 10);
+        bodyLength /= 10;
+    }
+    while (bodyLength > 0);
+    while (count > 0)
+    {
+        header[headerLength++] = digits[--count];
+    }
+    header[headerLength++] = FIX_SOH;
+
+    std::size_t start = HEADER_RESERVE - headerLength;
+    std::memcpy(buffer + start, header, headerLength);
+
+    unsigned checksum = 0;
+    for (std::size_t i = start; i < bodyEnd; ++i)
+    {
+        checksum += static_cast<unsigned char>(buffer[i]);
+    }
+    char* trailer = buffer + bodyEnd;
+    std::memcpy(trailer, "10=", 3);
+    writeDigits(trailer + 3, checksum % 256, 3);
+    trailer[6] = FIX_SOH;
+    return std::string_view(buffer + start, bodyEnd + 7 - start);
+}
@@ -0,0 +1,434 @@
+/**
+ * @file FixSession.cpp
+ * @brief Implementation of the FIX 4.4 acceptor session
+ */
+
+#include "FixSession.hpp"
+#include <algorithm>
+#include <utility>
+
+namespace
+{
+    /// SessionRejectReason values used by the session
+    constexpr int REJECT_REQUIRED_TAG_MISSING = 1;
+    constexpr int REJECT_INVALID_MSG_TYPE = 11;
+
+    /// Bytes reserved for the output at construction
+    constexpr std::size_t OUTPUT_RESERVE = 64 * 1024;
+}
+
+/**
+ * @brief Creates a session waiting for a Logon
+ *
+ * @param engine Engine receiving the orders
+ * @param engineCompId CompID of the engine (TargetCompID of the client)
+ * @param clientCompId CompID the client must log on with
+ * @param idfirm Firm the client trades for
+ */
+FixSession::FixSession(MatchingEngine& engine, std::string engineCompId, std::string clientCompId, int idfirm)
+    : engine(engine), engineCompId(std::move(engineCompId)), clientCompId(std::move(clientCompId)), idfirm(idfirm)
+{
+    output.reserve(OUTPUT_RESERVE);
+}
+
+/**
+ * @brief Processes received bytes
+ *
+ * @param data Received bytes
+ * @param size Number of received bytes
+ * @param now Current time
+ * @return std::size_t Bytes consumed
+ *
+ * Garbled messages (bad checksum or field) are dropped without
+ * consuming a sequence number, as FIX requires; the client's next
+ * message then reveals the gap. A framing error ends the session.
+ */
+std::size_t FixSession::onData(const char* data, std::size_t size, std::chrono::system_clock::time_point now)
+{
+    FixMessage message;
+    std::size_t offset = 0;
+    while (!closed)
+    {
+        std::size_t consumed = 0;
+        DecodeStatus status = parseFixMessage(data + offset, size - offset, message, consumed);
+        if (status == DecodeStatus::INCOMPLETE)
+        {
+            break;
+        }
+        if (status == DecodeStatus::FRAMING_ERROR)
+        {
+            logout("Framing error", now);
+            break;
+        }
+        offset += consumed;
+        if (status == DecodeStatus::MALFORMED)
+        {
+            stats.garbled++;
+            continue;
+        }
+
+        stats.received++;
+        lastReceived = now;
+        testRequestSent = false;
+        handleMessage(message, now);
+    }
+    return closed ? size : offset;
+}
+
+/**
+ * @brief Sends heartbeats and test requests, and times out a silent client
+ *
+ * @param now Current time
+ *
+ * A TestRequest goes out after 1.2 heartbeat intervals of silence, and
+ * the session is logged out after two.
+ */
+void FixSession::onTimer(std::chrono::system_clock::time_point now)
+{
+    if (!loggedOn || closed)
+    {
+        return;
+    }
+    if (now - lastReceived >= 2 * heartbeatInterval)
+    {
+        logout("Heartbeat timeout", now);
+        return;
+    }
+    if (!testRequestSent && now - lastReceived >= heartbeatInterval + heartbeatInterval / 5)
+    {
+        beginMessage("1", now);
+        writer.add(FixTag::TEST_REQ_ID, std::string_view("TEST"));
+        sendMessage(now);
+        testRequestSent = true;
+    }
+    if (now - lastSent >= heartbeatInterval)
+    {
+        beginMessage("0", now);
+        sendMessage(now);
+    }
+}
+
+/**
+ * @brief Drops bytes that were sent from the front of the output
+ *
+ * @param count Number of bytes sent
+ */
+void FixSession::consumeOutput(std::size_t count)
+{
+    output.erase(output.begin(), output.begin() + static_cast<std::ptrdiff_t>(std::min(count, output.size())));
+}
+
+/**
+ * @brief Checks sequencing and dispatches one message
+ *
+ * A SequenceReset in reset mode applies whatever its MsgSeqNum. For
+ * other messages, a sequence number ahead of the expected one triggers
+ * a single ResendRequest for the gap and the message is not processed;
+ * one behind is a duplicate if PossDupFlag is set, a fatal error
+ * otherwise.
+ */
+void FixSession::handleMessage(const FixMessage& message, std::chrono::system_clock::time_point now)
+{
+    std::string_view msgType = message.getMsgType();
+    if (message.getString(FixTag::SENDER_COMP_ID) != clientCompId ||
+        message.getString(FixTag::TARGET_COMP_ID) != engineCompId)
+    {
+        logout("CompID problem", now);
+        return;
+    }
+    bool logon = msgType == "A";
+    if (!loggedOn && !logon)
+    {
+        logout("Logon required", now);
+        return;
+    }
+
+    if (msgType == "4" && message.getString(FixTag::GAP_FILL_FLAG) != "Y")
+    {
+        long long newSeqNum;
+        if (!message.getInt(FixTag::NEW_SEQ_NO, newSeqNum) || newSeqNum < expectedSeqNum)
+        {
+            sendSessionReject(message, REJECT_REQUIRED_TAG_MISSING, "NewSeqNo missing or too low", now);
+            return;
+        }
+        expectedSeqNum = static_cast<std::uint32_t>(newSeqNum);
+        resendRequested = false;
+        return;
+    }
+
+    if (logon)
+    {
+        handleLogon(message, now);
+        if (closed)
+        {
+            return;
+        }
+    }
+
+    std::uint32_t seqNum = message.getSeqNum();
+    if (seqNum == 0)
+    {
+        sendSessionReject(message, REJECT_REQUIRED_TAG_MISSING, "MsgSeqNum missing", now);
+        return;
+    }
+    if (seqNum > expectedSeqNum)
+    {
+        if (!resendRequested)
+        {
+            beginMessage("2", now);
+            writer.add(FixTag::BEGIN_SEQ_NO, static_cast<long long>(expectedSeqNum));
+            writer.add(FixTag::END_SEQ_NO, 0);
+            sendMessage(now);
+            resendRequested = true;
+        }
+        return;
+    }
+    if (seqNum < expectedSeqNum)
+    {
+        if (message.getString(FixTag::POSS_DUP_FLAG) != "Y")
+        {
+            logout("MsgSeqNum too low", now);
+        }
+        return;
+    }
+    expectedSeqNum++;
+    resendRequested = false;
+
+    if (logon)
+    {
+        return;
+    }
+    if (msgType == "D")
+    {
+        handleNewOrder(message, now);
+    }
+    else if (msgType == "F" || msgType == "G")
+    {
+        handleOrderChange(message, now);
+    }
+    else if (msgType == "0")
+    {
+        // Heartbeat: lastReceived already updated
+    }
+    else if (msgType == "1")
+    {
+        beginMessage("0", now);
+        writer.add(FixTag::TEST_REQ_ID, message.getString(FixTag::TEST_REQ_ID));
+        sendMessage(now);
+    }
+    else if (msgType == "2")
+    {
+        // Nothing is stored for resend: the whole range is gap filled
+        long long beginSeqNum;
+        if (message.getInt(FixTag::BEGIN_SEQ_NO, beginSeqNum) && beginSeqNum > 0 && beginSeqNum < nextSeqNum)
+        {
+            writer.begin("4", static_cast<std::uint32_t>(beginSeqNum), engineCompId, clientCompId, now);
+            writer.add(FixTag::POSS_DUP_FLAG, 'Y');
+            writer.add(FixTag::GAP_FILL_FLAG, 'Y');
+            writer.add(FixTag::NEW_SEQ_NO, static_cast<long long>(nextSeqNum));
+            sendMessage(now);
+        }
+    }
+    else if (msgType == "4")
+    {
+        long long newSeqNum;
+        if (message.getInt(FixTag::NEW_SEQ_NO, newSeqNum) && newSeqNum > expectedSeqNum)
+        {
+            expectedSeqNum = static_cast<std::uint32_t>(newSeqNum);
+        }
+    }
+    else if (msgType == "5")
+    {
+        logout("", now);
+    }
+    else
+    {
+        sendSessionReject(message, REJECT_INVALID_MSG_TYPE, "Unsupported MsgType", now);
+    }
+}
+
+/**
+ * @brief Handles a Logon (35=A)
+ *
+ * ResetSeqNumFlag=Y restarts both directions at 1. The Logon reply
+ * echoes the heartbeat interval of the client.
+ */
+void FixSession::handleLogon(const FixMessage& message, std::chrono::system_clock::time_point now)
+{
+    if (loggedOn)
+    {
+        return;
+    }
+    long long interval;
+    if (!message.getInt(FixTag::HEART_BT_INT, interval) || interval <= 0 || interval > 3600 ||
+        message.getString(FixTag::ENCRYPT_METHOD) != "0")
+    {
+        logout("Invalid Logon", now);
+        return;
+    }
+
+    bool reset = message.getString(FixTag::RESET_SEQ_NUM_FLAG) == "Y";
+    if (reset)
+    {
+        expectedSeqNum = 1;
+        nextSeqNum = 1;
+    }
+    heartbeatInterval = std::chrono::seconds(interval);
+    loggedOn = true;
+
+    beginMessage("A", now);
+    writer.add(FixTag::ENCRYPT_METHOD, '0');
+    writer.add(FixTag::HEART_BT_INT, interval);
+    if (reset)
+    {
+        writer.add(FixTag::RESET_SEQ_NUM_FLAG, 'Y');
+    }
+    sendMessage(now);
+}
+
+/**
+ * @brief Handles a NewOrderSingle (35=D)
+ *
+ * Answered with an ExecutionReport: ExecType New if the engine accepted
+ * the order, Rejected otherwise. Fills are not reported on the session.
+ */
+void FixSession::handleNewOrder(const FixMessage& message, std::chrono::system_clock::time_point now)
+{
+    bool parsed = fixToOrder(message, idfirm, now, entryOrder);
+    bool accepted = parsed && engine.addAndValidateOrder(entryOrder);
+    if (accepted)
+    {
+        stats.orders++;
+    }
+    else
+    {
+        stats.rejected++;
+    }
+
+    beginMessage("8", now);
+    std::string_view clOrdId = message.getString(FixTag::CL_ORD_ID);
+    writer.add(FixTag::ORDER_ID, accepted ? clOrdId : std::string_view("NONE"));
+    writer.add(FixTag::CL_ORD_ID, clOrdId);
+    writer.add(FixTag::EXEC_ID, static_cast<long long>(nextExecId++));
+    writer.add(FixTag::EXEC_TYPE, accepted ? '0' : '8');
+    writer.add(FixTag::ORD_STATUS, accepted ? '0' : '8');
+    writer.add(FixTag::SECURITY_ID, message.getString(FixTag::SECURITY_ID));
+    writer.add(FixTag::SIDE, message.getString(FixTag::SIDE));
+    writer.add(FixTag::ORDER_QTY, message.getString(FixTag::ORDER_QTY));
+    writer.add(FixTag::LEAVES_QTY, accepted ? message.getString(FixTag::ORDER_QTY) : std::string_view("0"));
+    writer.add(FixTag::CUM_QTY, 0);
+    if (!accepted)
+    {
+        writer.add(FixTag::TEXT, parsed ? std::string_view("Refused by the engine")
+                                        : std::string_view("Missing or unsupported field"));
+    }
+    sendMessage(now);
+}
+
+/**
+ * @brief Handles an OrderCancelRequest (35=F) or OrderCancelReplaceRequest (35=G)
+ *
+ * Answered with an ExecutionReport (Canceled or Replaced) when the
+ * engine applied the change, an OrderCancelReject otherwise. Orders
+ * of other firms are reported as unknown. A replace keeps the stop
+ * price of an untriggered stop and is rejected for a stop order when
+ * it changes the price (see MatchingEngine::amendOrder).
+ */
+void FixSession::handleOrderChange(const FixMessage& message, std::chrono::system_clock::time_point now)
+{
+    bool replace = message.getMsgType() == "G";
+    FixOrderChange change;
+    bool applied = false;
+    if (fixToOrderChange(message, change))
+    {
+        MatchingEngine::InstrumentKey key(change.idinstrument, std::string(change.marketIdentificationCode),
+                                          std::string(change.tradingCurrency));
+        applied = replace
+                      ? engine.amendOrder(key, change.origIdorder, change.newPrice, change.newQuantity, idfirm)
+                      : engine.cancelOrder(key, change.origIdorder, idfirm);
+    }
+
+    std::string_view clOrdId = message.getString(FixTag::CL_ORD_ID);
+    std::string_view origClOrdId = message.getString(FixTag::ORIG_CL_ORD_ID);
+    if (applied)
+    {
+        stats.orders++;
+        beginMessage("8", now);
+        writer.add(FixTag::ORDER_ID, origClOrdId);
+        writer.add(FixTag::CL_ORD_ID, clOrdId);
+        writer.add(FixTag::ORIG_CL_ORD_ID, origClOrdId);
+        writer.add(FixTag::EXEC_ID, static_cast<long long>(nextExecId++));
+        writer.add(FixTag::EXEC_TYPE, replace ? '5' : '4');
+        writer.add(FixTag::ORD_STATUS, replace ? '0' : '4');
+        writer.add(FixTag::SECURITY_ID, message.getString(FixTag::SECURITY_ID));
+        writer.add(FixTag::LEAVES_QTY, replace ? change.newQuantity : 0);
+        writer.add(FixTag::CUM_QTY, 0);
+        if (replace)
+        {
+            writer.addDecimal(FixTag::PRICE, change.newPrice);
+        }
+    }
+    else
+    {
+        stats.rejected++;
+        beginMessage("9", now);
+        writer.add(FixTag::ORDER_ID, std::string_view("NONE"));
+        writer.add(FixTag::CL_ORD_ID, clOrdId);
+        writer.add(FixTag::ORIG_CL_ORD_ID, origClOrdId);
+        writer.add(FixTag::ORD_STATUS, '8');
+        writer.add(FixTag::CXL_REJ_RESPONSE_TO, replace ? '2' : '1');
+        writer.add(FixTag::CXL_REJ_REASON, '1');
+        writer.add(FixTag::TEXT, std::string_view("Unknown order"));
+    }
+    sendMessage(now);
+}
+
+/**
+ * @brief Starts an outgoing message with the next sequence number
+ */
+void FixSession::beginMessage(std::string_view msgType, std::chrono::system_clock::time_point now)
+{
+    writer.begin(msgType, nextSeqNum++, engineCompId, clientCompId, now);
+}
+
+/**
+ * @brief Appends the message being built to the output
+ */
+void FixSession::sendMessage(std::chrono::system_clock::time_point now)
+{
+    std::string_view message = writer.finish();
+    output.insert(output.end(), message.begin(), message.end());
+    lastSent = now;
+    stats.sent++;
+}
+
+/**
+ * @brief Sends a Logout and ends the session
+ *
+ * @param text Reason given to the client, empty for none
+ */
+void FixSession::logout(std::string_view text, std::chrono::system_clock::time_point now)
+{
+    beginMessage("5", now);
+    if (!text.empty())
+    {
+        writer.add(FixTag::TEXT, text);
+    }
+    sendMessage(now);
+    loggedOn = false;
+    closed = true;
+}
+
+/**
+ * @brief Sends a session-level Reject (35=3) of a message
+ */
+void FixSession::sendSessionReject(const FixMessage& message, int reason, std::string_view text,
+                                   std::chrono::system_clock::time_point now)
+{
+    beginMessage("3", now);
+    writer.add(FixTag::REF_SEQ_NUM, static_cast<long long>(message.getSeqNum()));
+    writer.add(FixTag::REF_MSG_TYPE, message.getMsgType());
+    writer.add(FixTag::SESSION_REJECT_REASON, reason);
+    writer.add(FixTag::TEXT, text);
+    sendMessage(now);
+}
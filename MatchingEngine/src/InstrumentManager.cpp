@@ -7,14 +7,21 @@
  */
 
 #include "InstrumentManager.hpp"
+#include "TradingStats.hpp"
+#include <fstream>
 #include <iostream>
+#include <sstream>
 
 /**
  * @brief Attempts to add a new instrument to the management system
  *
  * @param instrument The instrument to be added
  * @return bool True if the instrument was successfully added, 
- *              false if a duplicate instrument was detected
+ *              false if a duplicate instrument was detected or its
+ *              price decimals are not supported
+ *
+ * Instruments priced with more than TradingStats::NOTIONAL_DECIMALS
+ * decimals are refused, as their notional could not be kept exactly.
  *
  * Verifies the uniqueness of the instrument before adding it to:
  * - A set tracking unique instrument identifiers
@@ -24,6 +31,13 @@
  */
 bool InstrumentManager::addInstrument(const Instrument& instrument)
 {
+    if (instrument.pricedecimal < 0 || instrument.pricedecimal > TradingStats::NOTIONAL_DECIMALS)
+    {
+        std::cout << "Instrument " << instrument.idinstrument << " refused: at most "
+            << TradingStats::NOTIONAL_DECIMALS << " price decimals are supported\n";
+        return false;
+    }
+
     // Check if the instrument is unique before adding
     if (isUniqueInstrument(instrumentSet, instrument))
     {
@@ -60,3 +74,87 @@ const std::vector<Instrument>& InstrumentManager::getInstruments() const
 {
     return instruments;
 }
+
+namespace
+{
+    /**
+     * @brief Converts the state column of the instrument file
+     *
+     * @param text State name, e.g. "ACTIVE"
+     * @param out State read
+     * @return bool True if the name is known
+     */
+    bool parseState(const std::string& text, State& out)
+    {
+        if (text == "ACTIVE") out = State::ACTIVE;
+        else if (text == "INACTIVE") out = State::INACTIVE;
+        else if (text == "SUSPENDED") out = State::SUSPENDED;
+        else if (text == "DELISTED") out = State::DELISTED;
+        else return false;
+        return true;
+    }
+}
+
+/**
+ * @brief Loads the instruments of a CSV file
+ *
+ * @param path CSV file
+ * @param marketIdentificationCode MIC given to every instrument
+ * @param tradingCurrency Currency given to every instrument
+ * @return int Number of instruments added, -1 if the file cannot be read
+ */
+int InstrumentManager::loadFromCsv(const std::string& path, const std::string& marketIdentificationCode,
+                                   const std::string& tradingCurrency)
+{
+    std::ifstream file(path);
+    if (!file)
+    {
+        return -1;
+    }
+
+    // Skip the header line
+    std::string line;
+    std::getline(file, line);
+    int added = 0;
+    int lineNumber = 1;
+    while (std::getline(file, line))
+    {
+        ++lineNumber;
+        if (line.empty() || line[0] == '#')
+        {
+            continue;
+        }
+
+        std::vector<std::string> columns;
+        std::istringstream stream(line);
+        std::string column;
+        while (std::getline(stream, column, ','))
+        {
+            columns.push_back(column);
+        }
+
+        State state;
+        if (columns.size() != 11 || !parseState(columns[3], state))
+        {
+            std::cerr << path << ":" << lineNumber << ": invalid instrument line" << std::endl;
+            continue;
+        }
+
+        try
+        {
+            Instrument instrument(std::stoi(columns[0]), marketIdentificationCode, tradingCurrency, columns[1],
+                                  std::stoi(columns[2]), state, std::stod(columns[4]),
+                                  std::stoi(columns[5]), std::stoi(columns[6]), std::stoi(columns[7]),
+                                  std::stoi(columns[8]), std::stoi(columns[9]), std::stoi(columns[10]));
+            if (addInstrument(instrument))
+            {
+                ++added;
+            }
+        }
+        catch (const std::exception&)
+        {
+            std::cerr << path << ":" << lineNumber << ": invalid number" << std::endl;
+        }
+    }
+    return added;
+}
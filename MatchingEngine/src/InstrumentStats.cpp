@@ -0,0 +1,72 @@
+/**
+ * @file InstrumentStats.cpp
+ * @brief Ring of time-bucketed trade bars
+ */
+
+#include "InstrumentStats.hpp"
+
+/**
+ * @brief Creates an empty series, every bar allocated up front
+ *
+ * @param period Length of a bar
+ * @param capacity Number of bars kept, at least one
+ */
+BarSeries::BarSeries(std::chrono::milliseconds period, std::size_t capacity)
+    : period(period), bars(capacity > 0 ? capacity : 1)
+{
+}
+
+/**
+ * @brief Adds a fill to the bar of its bucket
+ *
+ * @param timestamp Time of the fill, which never goes back
+ * @param price Fill price
+ * @param quantity Fill quantity
+ * @param notional Fill notional, see TradingStats::toNotional
+ *
+ * A fill in a later bucket than the last bar overwrites the oldest bar.
+ */
+void BarSeries::record(std::chrono::system_clock::time_point timestamp, double price, int quantity,
+                       std::int64_t notional)
+{
+    auto sinceEpoch = std::chrono::duration_cast<std::chrono::milliseconds>(timestamp.time_since_epoch());
+    std::chrono::system_clock::time_point start(
+        std::chrono::duration_cast<std::chrono::system_clock::duration>(sinceEpoch - sinceEpoch % period));
+
+    if (count == 0 || start > bars[current].start)
+    {
+        // The fill opens a new bucket: take over the oldest bar
+        current = count == 0 ? 0 : (current + 1) % bars.size();
+        count = count < bars.size() ? count + 1 : count;
+        TradeBar& bar = bars[current];
+        bar = TradeBar();
+        bar.start = start;
+        bar.open = bar.high = bar.low = price;
+    }
+
+    TradeBar& bar = bars[current];
+    bar.high = price > bar.high ? price : bar.high;
+    bar.low = price < bar.low ? price : bar.low;
+    bar.close = price;
+    bar.quantity += quantity;
+    bar.notional += notional;
+    ++bar.tradeCount;
+}
+
+/**
+ * @brief Returns the last bars, oldest first
+ *
+ * @param maxCount Maximum number of bars returned
+ * @return std::vector<TradeBar> Up to maxCount bars with at least one fill
+ */
+std::vector<TradeBar> BarSeries::getBars(std::size_t maxCount) const
+{
+    std::size_t returned = maxCount < count ? maxCount : count;
+    std::vector<TradeBar> result;
+    result.reserve(returned);
+    for (std::size_t i = returned; i > 0; --i)
+    {
+        result.push_back(bars[(current + bars.size() - (i - 1)) % bars.size()]);
+    }
+    return result;
+}
@@ -0,0 +1,138 @@
+/**
+ * @file LatencyHistogram.cpp
+ * @brief Percentiles and reports of the latency histograms
+ */
+
+#include "LatencyHistogram.hpp"
+#include <iomanip>
+
+double LatencyHistogram::getMean() const
+{
+    std::uint64_t count = getCount();
+    return count == 0 ? 0.0 : static_cast<double>(sum.load(std::memory_order_relaxed)) / count;
+}
+
+std::uint64_t LatencyHistogram::highestValueOf(std::size_t index)
+{
+    if (index < LINEAR_LIMIT)
+    {
+        return index;
+    }
+    std::size_t offset = index - LINEAR_LIMIT;
+    int shift = static_cast<int>(offset / SUB_BUCKETS) + 1;
+    std::uint64_t lowest = (SUB_BUCKETS + offset % SUB_BUCKETS) << shift;
+    return lowest + (1ULL << shift) - 1;
+}
+
+std::uint64_t LatencyHistogram::getValueAtPercentile(double percentile) const
+{
+    // Count the buckets rather than trusting totalCount, which may be ahead of them
+    std::uint64_t total = 0;
+    for (const auto& count : counts)
+    {
+        total += count.load(std::memory_order_relaxed);
+    }
+    if (total == 0)
+    {
+        return 0;
+    }
+
+    double clamped = percentile < 0.0 ? 0.0 : (percentile > 100.0 ? 100.0 : percentile);
+    auto rank = static_cast<std::uint64_t>(clamped / 100.0 * static_cast<double>(total) + 0.5);
+    rank = rank == 0 ? 1 : rank;
+
+    std::uint64_t seen = 0;
+    for (std::size_t index = 0; index < BUCKET_COUNT; ++index)
+    {
+        seen += counts[index].load(std::memory_order_relaxed);
+        if (seen >= rank)
+        {
+            std::uint64_t highest = highestValueOf(index);
+            std::uint64_t largest = getMax();
+            return highest < largest ? highest : largest;
+        }
+    }
+    return getMax();
+}
+
+void LatencyHistogram::reset()
+{
+    for (auto& count : counts)
+    {
+        count.store(0, std::memory_order_relaxed);
+    }
+    totalCount.store(0, std::memory_order_relaxed);
+    sum.store(0, std::memory_order_relaxed);
+    max.store(0, std::memory_order_relaxed);
+}
+
+const char* latencyStageName(LatencyStage stage)
+{
+    switch (stage)
+    {
+    case LatencyStage::INGRESS:
+        return "ingress";
+    case LatencyStage::VALIDATION:
+        return "validation";
+    case LatencyStage::MATCHING:
+        return "matching";
+    case LatencyStage::PUBLISH:
+        return "publish";
+    case LatencyStage::ORDER_TO_ACK:
+        return "order_to_ack";
+    case LatencyStage::ORDER_TO_FILL:
+        return "order_to_fill";
+    case LatencyStage::BATCH_VALIDATION:
+        return "batch_validate";
+    case LatencyStage::BATCH_MATCHING:
+        return "batch_matching";
+    case LatencyStage::BATCH_TO_ACK:
+        return "batch_to_ack";
+    case LatencyStage::COUNT:
+    default:
+        return "unknown";
+    }
+}
+
+void EngineLatency::display(std::ostream& out) const
+{
+    out << "  " << std::left << std::setw(15) << "stage (ns)" << std::right
+        << std::setw(12) << "count" << std::setw(10) << "mean" << std::setw(10) << "p50"
+        << std::setw(10) << "p99" << std::setw(10) << "p99.9" << std::setw(12) << "max" << "\n";
+    for (std::size_t i = 0; i < static_cast<std::size_t>(LatencyStage::COUNT); ++i)
+    {
+        const LatencyHistogram& histogram = histograms[i];
+        out << "  " << std::left << std::setw(15) << latencyStageName(static_cast<LatencyStage>(i)) << std::right
+            << std::setw(12) << histogram.getCount()
+            << std::setw(10) << static_cast<std::uint64_t>(histogram.getMean())
+            << std::setw(10) << histogram.getValueAtPercentile(50.0)
+            << std::setw(10) << histogram.getValueAtPercentile(99.0)
+            << std::setw(10) << histogram.getValueAtPercentile(99.9)
+            << std::setw(12) << histogram.getMax() << "\n";
+    }
+}
+
+void EngineLatency::dump(std::ostream& out) const
+{
+    out << "{";
+    for (std::size_t i = 0; i < static_cast<std::size_t>(LatencyStage::COUNT); ++i)
+    {
+        const LatencyHistogram& histogram = histograms[i];
+        out << (i == 0 ? "" : ",") << "\"" << latencyStageName(static_cast<LatencyStage>(i)) << "\":{"
+            << "\"count\":" << histogram.getCount()
+            << ",\"mean\":" << static_cast<std::uint64_t>(histogram.getMean())
+            << ",\"p50\":" << histogram.getValueAtPercentile(50.0)
+            << ",\"p99\":" << histogram.getValueAtPercentile(99.0)
+            << ",\"p999\":" << histogram.getValueAtPercentile(99.9)
+            << ",\"max\":" << histogram.getMax() << "}";
+    }
+    out << "}\n";
+}
+
+void EngineLatency::reset()
+{
+    for (LatencyHistogram& histogram : histograms)
+    {
+        histogram.reset();
+    }
+}
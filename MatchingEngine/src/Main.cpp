@@ -9,7 +9,6 @@
 #include <iostream>
 #include <set>
 #include <chrono>
-#include <random>
 #include <thread>
 #include "../include/Instrument.hpp"
 #include "../include/Order.hpp"
@@ -20,46 +19,6 @@
 #include <QApplication>
 #include "MainWindow.h"
 
-/**
- * @brief Utility template to get the number of enum values
- *
- * Provides a compile-time count of enum values for random generation.
- * Specialized for specific enums used in the trading system.
- *
- * @tparam T Enum type to count
- * @return int Number of enum values
- */
-template <typename T>
-int enumCount();
-
-// Specializations for specific enums
-template <>
-int enumCount<TimeInForce>() { return 2; }
-
-template <>
-int enumCount<OrderType>() { return 2; }
-
-template <>
-int enumCount<LimitType>() { return 2; }
-
-/**
- * @brief Generates a random enum value
- *
- * Uses a random device and uniform distribution to select
- * a random enum value from the available options.
- *
- * @tparam T Enum type to generate
- * @return T Randomly selected enum value
- */
-template <typename T>
-T getRandomEnumValue()
-{
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_int_distribution<> dis(0, enumCount<T>() - 1);
-    return static_cast<T>(dis(gen));
-}
-
 /**
  * @brief Main entry point for the Euronext Trading Engine demonstration
  *
@@ -0,0 +1,105 @@
+/**
+ * @file MarketDataPublisher.cpp
+ * @brief Implementation of the Level 2 market data publisher
+ */
+
+#include "MarketDataPublisher.hpp"
+#include <algorithm>
+#include <iterator>
+
+/**
+ * @brief Creates an empty feed with an empty image slot per book
+ */
+MarketDataPublisher::MarketDataPublisher() : images(new SeqLock<ConflatedBook>[MAX_BOOKS])
+{
+}
+
+/**
+ * @brief Publishes one level message
+ *
+ * @param instrumentId Instrument identifier
+ * @param bookId Feed identifier of the book
+ * @param type Message type
+ * @param side BID or ASK side of the level
+ * @param price Level price
+ * @param quantity Displayed quantity at the level
+ * @param orderCount Number of orders at the level
+ * @return std::uint64_t Feed sequence of the message
+ *
+ * The message is encoded in the ring slot itself, no copy is made.
+ */
+std::uint64_t MarketDataPublisher::publishLevel(int instrumentId, int bookId, L2MessageType type, OrderType side,
+                                                double price, long long quantity, int orderCount)
+{
+    return ring.publish([&](L2Message& message, std::uint64_t sequence)
+    {
+        message.sequence = sequence;
+        message.price = price;
+        message.quantity = quantity;
+        message.instrumentId = instrumentId;
+        message.bookId = bookId;
+        message.orderCount = orderCount;
+        message.type = static_cast<std::uint8_t>(type);
+        message.side = side == OrderType::BID ? 'B' : 'S';
+        std::fill(std::begin(message.reserved), std::end(message.reserved), 0);
+    });
+}
+
+/**
+ * @brief Publishes a snapshot delimiter
+ *
+ * @param instrumentId Instrument identifier
+ * @param bookId Feed identifier of the book
+ * @param type SNAPSHOT_BEGIN or SNAPSHOT_END
+ * @param levelCount Number of levels in the snapshot
+ * @return std::uint64_t Feed sequence of the message
+ */
+std::uint64_t MarketDataPublisher::publishSnapshotMarker(int instrumentId, int bookId, L2MessageType type,
+                                                         int levelCount)
+{
+    return ring.publish([&](L2Message& message, std::uint64_t sequence)
+    {
+        message.sequence = sequence;
+        message.price = 0.0;
+        message.quantity = 0;
+        message.instrumentId = instrumentId;
+        message.bookId = bookId;
+        message.orderCount = levelCount;
+        message.type = static_cast<std::uint8_t>(type);
+        message.side = 0;
+        std::fill(std::begin(message.reserved), std::end(message.reserved), 0);
+    });
+}
+
+/**
+ * @brief Raises the image count to a newly written book
+ *
+ * @param bookId Feed identifier of the book
+ *
+ * Books of different instruments write their first image concurrently.
+ */
+void MarketDataPublisher::countImage(int bookId)
+{
+    int known = imageCount.load(std::memory_order_relaxed);
+    while (known < bookId &&
+        !imageCount.compare_exchange_weak(known, bookId, std::memory_order_release, std::memory_order_relaxed))
+    {
+    }
+}
+
+/**
+ * @brief Reads a consistent copy of a book image without taking any lock
+ *
+ * @param bookId Feed identifier of the book
+ * @param image Receives the image
+ * @return true if the book has published an image
+ */
+bool MarketDataPublisher::readImage(int bookId, ConflatedBook& image) const
+{
+    if (bookId < 1 || static_cast<std::size_t>(bookId) > MAX_BOOKS)
+    {
+        return false;
+    }
+    image = images[bookId - 1].load();
+    return image.bookId == bookId;
+}
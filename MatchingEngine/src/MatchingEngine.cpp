@@ -8,6 +8,7 @@
 
 #include "MatchingEngine.hpp"
 #include "Order.hpp"
+#include "Probe.hpp"
 #include <iostream>
 #include <iomanip>
 #include <algorithm>
@@ -15,24 +16,14 @@
 /**
  * @brief Constructs a MatchingEngine instance
  *
- * @param ob Reference to the OrderBook for managing orders
  * @param im Reference to the InstrumentManager for tracking instruments
  *
- * Initializes the matching engine with default statistics and 
- * sets up the connection with the order book.
+ * Initializes the matching engine with default statistics. Order books
+ * are created on demand, one per instrument.
  */
-MatchingEngine::MatchingEngine(OrderBook& ob, InstrumentManager& im)
-    : orderBook(ob), instrumentManager(im), isRunning(false)
+MatchingEngine::MatchingEngine(InstrumentManager& im)
+    : instrumentManager(im), topOfBook(new SeqLock<TopOfBook>[MAX_TOP_OF_BOOK]), isRunning(false)
 {
-    // Initialize all statistical counters to zero
-    stats.dailyTradeCount.store(0);
-    stats.dailyVolume.store(0.0);
-    stats.lastReset = std::chrono::system_clock::now();
-    stats.totalTradeCount.store(0);
-    stats.totalVolume.store(0.0);
-    stats.matchingAttempts.store(0);
-    stats.successfulMatches.store(0);
-    orderBook.setMatchingEngine(this);
 }
 
 /**
@@ -54,15 +45,16 @@ MatchingEngine::~MatchingEngine()
  */
 void MatchingEngine::run()
 {
-    auto lastStatusUpdate = std::chrono::system_clock::now();
-    auto lastGTDCheck = std::chrono::system_clock::now();
-    auto lastStatsReset = std::chrono::system_clock::now();
+    auto lastStatusUpdate = clock->now();
+    auto lastGTDCheck = clock->now();
+    auto lastStatsReset = clock->now();
+    auto lastSnapshot = clock->now();
 
     while (isRunning)
     {
         try
         {
-            auto now = std::chrono::system_clock::now();
+            auto now = clock->now();
             auto now_time_t = std::chrono::system_clock::to_time_t(now);
 
             // Daily statistics reset at midnight
@@ -75,17 +67,34 @@ void MatchingEngine::run()
                     << std::put_time(std::localtime(&now_time_t), "%Y-%m-%d %H:%M:%S") << std::endl;
             }
 
-            // Attempt order matching
-            stats.matchingAttempts.fetch_add(1, std::memory_order_relaxed);
-            int matches = orderBook.matchOrders();
+            // Attempt order matching on every instrument's book
+            stats.recordMatchingAttempt();
+            int matches = 0;
+            {
+                std::lock_guard<std::mutex> booksLock(booksMutex);
+                for (auto& [key, book] : orderBooks)
+                {
+                    matches += book.matchOrders();
+                }
+            }
             if (matches > 0)
             {
                 std::lock_guard<std::mutex> lock(displayMutex);
-                stats.successfulMatches.fetch_add(matches, std::memory_order_relaxed);
                 std::cout << "\nMatched " << matches << " orders at "
                     << std::put_time(std::localtime(&now_time_t), "%H:%M:%S") << std::endl;
             }
 
+            // Periodic Level 2 snapshots for late or overrun feed consumers
+            if (now - lastSnapshot >= SNAPSHOT_INTERVAL)
+            {
+                std::lock_guard<std::mutex> booksLock(booksMutex);
+                for (auto& [key, book] : orderBooks)
+                {
+                    book.publishSnapshot();
+                }
+                lastSnapshot = now;
+            }
+
             // Periodic GTD order check
             if (now - lastGTDCheck > std::chrono::hours(1))
             {
@@ -130,13 +139,7 @@ void MatchingEngine::start()
         isRunning = true;
 
         // Reset all statistical counters
-        stats.dailyTradeCount.store(0, std::memory_order_relaxed);
-        stats.dailyVolume.store(0.0, std::memory_order_relaxed);
-        stats.totalTradeCount.store(0, std::memory_order_relaxed);
-        stats.totalVolume.store(0.0, std::memory_order_relaxed);
-        stats.matchingAttempts.store(0, std::memory_order_relaxed);
-        stats.successfulMatches.store(0, std::memory_order_relaxed);
-        stats.lastReset = std::chrono::system_clock::now();
+        stats.reset();
 
         // Launch processing thread
         engineThread = std::thread(&MatchingEngine::run, this);
@@ -170,6 +173,187 @@ bool MatchingEngine::isEngineRunning() const
     return isRunning;
 }
 
+/**
+ * @brief Returns the order book of an instrument, creating it if needed
+ *
+ * @param instrument Instrument whose book is requested
+ * @return OrderBook& The instrument's order book
+ *
+ * Books live in a node-based map, so the returned reference stays
+ * valid while other books are created.
+ */
+OrderBook& MatchingEngine::getOrderBook(const Instrument& instrument)
+{
+    std::lock_guard<std::mutex> lock(booksMutex);
+    auto [it, inserted] = orderBooks.try_emplace(
+        InstrumentKey(instrument.idinstrument, instrument.marketIdentificationCode, instrument.tradingCurrency));
+    if (inserted)
+    {
+        it->second.setMatchingEngine(this);
+        it->second.setClock(clock);
+        it->second.setTradingPhase(tradingPhase);
+        // Books are never destroyed, so the book count is a unique feed identifier
+        int bookId = static_cast<int>(orderBooks.size());
+        it->second.setMarketDataPublisher(&marketData, instrument.idinstrument, bookId);
+        it->second.setPublishLatency(&latency[LatencyStage::PUBLISH]);
+        if (orderFeed.isOpen())
+        {
+            orderFeed.registerBook(bookId, instrument.idinstrument, instrument.marketIdentificationCode,
+                                   instrument.tradingCurrency);
+            it->second.setOrderFeed(&orderFeed);
+        }
+
+        // Books are never destroyed, so slots are handed out once
+        std::size_t slot = topOfBookCount.load(std::memory_order_relaxed);
+        if (slot < MAX_TOP_OF_BOOK)
+        {
+            it->second.setTopOfBook(&topOfBook[slot]);
+            topOfBookCount.store(slot + 1, std::memory_order_release);
+        }
+        else
+        {
+            std::cerr << "Top of book table full, instrument " << instrument.idinstrument
+                << " is not published" << std::endl;
+        }
+        auto allocation = allocationByTradingGroup.find(instrument.idtradinggroup);
+        if (allocation != allocationByTradingGroup.end())
+        {
+            it->second.setAllocation(allocation->second, instrument.lotsize);
+        }
+    }
+    return it->second;
+}
+
+/**
+ * @brief Sets the time source of the engine and of every book
+ *
+ * @param engineClock Clock outliving the engine
+ */
+void MatchingEngine::setClock(const Clock& engineClock)
+{
+    std::lock_guard<std::mutex> lock(booksMutex);
+    clock = &engineClock;
+    stats.setClock(clock);
+    for (auto& [key, book] : orderBooks)
+    {
+        book.setClock(clock);
+    }
+}
+
+/**
+ * @brief Publishes every order event in a shared memory Level 3 feed
+ *
+ * @param regionName Name of the shared memory object
+ * @return true if the feed was created
+ */
+bool MatchingEngine::enableOrderFeed(const std::string& regionName)
+{
+    std::lock_guard<std::mutex> lock(booksMutex);
+    if (!orderFeed.create(regionName))
+    {
+        return false;
+    }
+    for (auto& [key, book] : orderBooks)
+    {
+        orderFeed.registerBook(book.getBookId(), std::get<0>(key), std::get<1>(key), std::get<2>(key));
+        book.setOrderFeed(&orderFeed);
+    }
+    return true;
+}
+
+/**
+ * @brief Opens an auction call on every instrument
+ *
+ * Switches all existing books, and the books created afterwards,
+ * to the auction phase where orders are collected without matching.
+ */
+void MatchingEngine::startAuction()
+{
+    std::lock_guard<std::mutex> lock(booksMutex);
+    tradingPhase = TradingPhase::AUCTION;
+    for (auto& [key, book] : orderBooks)
+    {
+        book.setTradingPhase(TradingPhase::AUCTION);
+    }
+    std::cout << "Auction call started on " << orderBooks.size() << " order books" << std::endl;
+}
+
+/**
+ * @brief Uncrosses the auction of every instrument
+ *
+ * @return long long Total volume executed across all instruments
+ *
+ * Each registered instrument's book is uncrossed at its equilibrium
+ * price, using the instrument's reference price as the final tie-break,
+ * then matched once in continuous mode to process triggered stops and
+ * cancel unfilled market orders.
+ */
+long long MatchingEngine::uncrossAuctions()
+{
+    auto start = std::chrono::steady_clock::now();
+    long long totalVolume = 0;
+    int uncrossed = 0;
+
+    std::lock_guard<std::mutex> lock(booksMutex);
+    tradingPhase = TradingPhase::CONTINUOUS;
+    for (const auto& instrument : instrumentManager.getInstruments())
+    {
+        auto it = orderBooks.find(InstrumentKey(instrument.idinstrument, instrument.marketIdentificationCode,
+                                                instrument.tradingCurrency));
+        if (it == orderBooks.end())
+        {
+            continue;
+        }
+        AuctionResult result = it->second.uncrossAuction(instrument.refprice);
+        if (result.crossed)
+        {
+            totalVolume += result.volume;
+            uncrossed++;
+        }
+        it->second.matchOrders();
+    }
+
+    // Books without a registered instrument just resume continuous trading
+    for (auto& [key, book] : orderBooks)
+    {
+        book.setTradingPhase(TradingPhase::CONTINUOUS);
+    }
+
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start).count();
+    std::cout << "Auction uncrossed on " << uncrossed << " instruments, volume " << totalVolume
+        << " in " << elapsed << " us" << std::endl;
+    return totalVolume;
+}
+
+/**
+ * @brief Looks up the order book of an instrument
+ *
+ * @param key Instrument identifier tuple (id, market code, currency)
+ * @return const OrderBook* The book, or nullptr if it does not exist
+ */
+const OrderBook* MatchingEngine::findOrderBook(const InstrumentKey& key) const
+{
+    std::lock_guard<std::mutex> lock(booksMutex);
+    auto it = orderBooks.find(key);
+    return it == orderBooks.end() ? nullptr : &it->second;
+}
+
+/**
+ * @brief Calls a function on every order book, in instrument key order
+ *
+ * @param visit Called with the key and the book
+ */
+void MatchingEngine::forEachOrderBook(
+    const std::function<void(const InstrumentKey&, const OrderBook&)>& visit) const
+{
+    std::lock_guard<std::mutex> lock(booksMutex);
+    for (const auto& [key, book] : orderBooks)
+    {
+        visit(key, book);
+    }
+}
+
 /**
  * @brief Displays the current status of the trading engine
  *
@@ -178,20 +362,35 @@ bool MatchingEngine::isEngineRunning() const
  */
 void MatchingEngine::displayEngineStatus() const
 {
-    auto now = std::chrono::system_clock::now();
+    auto now = clock->now();
     auto now_time_t = std::chrono::system_clock::to_time_t(now);
 
     std::cout << "\n=== Trading Engine Status ===\n";
     std::cout << "Time: " << std::put_time(std::localtime(&now_time_t), "%Y-%m-%d %H:%M:%S") << "\n";
     std::cout << "Engine Status: " << (isRunning ? "Running" : "Stopped") << "\n";
+    TradingStats::Totals daily = stats.getDaily();
     std::cout << "Trading Statistics:\n";
-    std::cout << "  - Daily Trades: " << stats.dailyTradeCount << "\n";
-    std::cout << "  - Daily Volume: " << std::fixed << std::setprecision(2) << stats.dailyVolume << "\n";
-    std::cout << "  - Total Trades: " << stats.totalTradeCount << "\n";
+    std::cout << "  - Daily Trades: " << daily.tradeCount << "\n";
+    std::cout << "  - Daily Volume: " << std::fixed << std::setprecision(2) << daily.getVolume() << "\n";
+    std::cout << "  - Total Trades: " << stats.getTotals().tradeCount << "\n";
     std::cout << "System Status:\n";
     std::cout << "  - Instruments: " << instrumentManager.getInstruments().size() << "\n";
-    std::cout << "  - BID Levels: " << orderBook.bidOrders.size() << "\n";
-    std::cout << "  - ASK Levels: " << orderBook.askOrders.size() << "\n";
+
+    // Book totals come from the top of book slots: no book lock, no map walk
+    std::size_t books = getTopOfBookCount();
+    long long bidLevels = 0, askLevels = 0;
+    long long bidCount = 0, askCount = 0;
+    for (std::size_t i = 0; i < books; ++i)
+    {
+        TopOfBook top = readTopOfBook(i);
+        bidLevels += top.bidLevels;
+        askLevels += top.askLevels;
+        bidCount += top.bidOrders;
+        askCount += top.askOrders;
+    }
+    std::cout << "  - Order Books: " << books << "\n";
+    std::cout << "  - BID Levels: " << bidLevels << " (" << bidCount << " orders)\n";
+    std::cout << "  - ASK Levels: " << askLevels << " (" << askCount << " orders)\n";
     std::cout << "==========================\n\n";
 }
 
@@ -203,23 +402,59 @@ void MatchingEngine::displayEngineStatus() const
  */
 void MatchingEngine::displayDetailedStats() const
 {
-    auto now = std::chrono::system_clock::now();
+    auto now = clock->now();
     auto now_time_t = std::chrono::system_clock::to_time_t(now);
 
     std::cout << "\n=== Detailed Trading Statistics ===\n";
     std::cout << "Current Time: " << std::put_time(std::localtime(&now_time_t), "%Y-%m-%d %H:%M:%S") << "\n";
+    TradingStats::Totals daily = stats.getDaily();
+    TradingStats::Totals total = stats.getTotals();
     std::cout << "Daily Performance:\n";
-    std::cout << "  - Trades Today: " << stats.dailyTradeCount << "\n";
-    std::cout << "  - Daily Volume: " << std::fixed << std::setprecision(2) << stats.dailyVolume << "\n";
+    std::cout << "  - Trades Today: " << daily.tradeCount << "\n";
+    std::cout << "  - Daily Quantity: " << daily.quantity << "\n";
+    std::cout << "  - Daily Volume: " << std::fixed << std::setprecision(2) << daily.getVolume() << "\n";
     std::cout << "Total Performance:\n";
-    std::cout << "  - Total Trades: " << stats.totalTradeCount << "\n";
-    std::cout << "  - Total Volume: " << stats.totalVolume << "\n";
+    std::cout << "  - Total Trades: " << total.tradeCount << "\n";
+    std::cout << "  - Total Quantity: " << total.quantity << "\n";
+    std::cout << "  - Total Volume: " << total.getVolume() << "\n";
     std::cout << "Engine Metrics:\n";
-    std::cout << "  - Matching Attempts: " << stats.matchingAttempts << "\n";
-    std::cout << "  - Successful Matches: " << stats.successfulMatches << "\n";
+    std::cout << "  - Matching Attempts: " << daily.matchingAttempts << "\n";
+    std::cout << "  - Successful Matches: " << daily.tradeCount << "\n";
     std::cout << "  - Success Rate: "
-        << (stats.matchingAttempts > 0 ? (100.0 * stats.successfulMatches / stats.matchingAttempts) : 0)
+        << (daily.matchingAttempts > 0 ? (100.0 * daily.tradeCount / daily.matchingAttempts) : 0)
         << "%\n";
+    std::cout << "Instruments (session):\n";
+    {
+        std::lock_guard<std::mutex> booksLock(booksMutex);
+        for (const auto& [key, book] : orderBooks)
+        {
+            InstrumentTradeStats instrument = book.getTradeStats();
+            if (instrument.tradeCount == 0)
+            {
+                continue;
+            }
+            std::cout << "  - " << std::get<0>(key) << " " << std::get<1>(key) << " " << std::get<2>(key)
+                << ": O " << instrument.open << " H " << instrument.high << " L " << instrument.low
+                << " Last " << instrument.last << " VWAP " << instrument.getVwap()
+                << " Qty " << instrument.quantity << " Trades " << instrument.tradeCount << "\n";
+        }
+    }
+    std::cout << "Firms:\n";
+    std::unordered_map<int, FirmTradeStats> firms;
+    {
+        std::lock_guard<std::mutex> booksLock(booksMutex);
+        for (const auto& [key, book] : orderBooks)
+        {
+            book.addFirmStats(firms);
+        }
+    }
+    for (const auto& [idfirm, firm] : firms)
+    {
+        std::cout << "  - " << idfirm << ": Bought " << firm.boughtQuantity << " Sold " << firm.soldQuantity
+            << " Volume " << firm.getVolume() << " Trades " << firm.tradeCount << "\n";
+    }
+    std::cout << "Latency:\n";
+    latency.display(std::cout);
     std::cout << "=============================\n";
 }
 
@@ -231,44 +466,24 @@ void MatchingEngine::displayDetailedStats() const
  */
 void MatchingEngine::displayGTDOrders() const
 {
-    auto now = std::chrono::system_clock::now();
+    auto now = clock->now();
     bool hasGTDOrders = false;
 
     std::cout << "\n=== GTD Orders Status ===\n";
 
-    // Scan BID orders
-    for (const auto& [price, orders] : orderBook.bidOrders)
+    // Each book copies its GTD orders under its own lock
+    std::lock_guard<std::mutex> lock(booksMutex);
+    for (const auto& [key, orderBook] : orderBooks)
     {
-        for (const auto& order : orders)
+        for (const Order& order : orderBook.getGTDOrders())
         {
-            if (order.timeinforce == TimeInForce::GTD)
-            {
-                hasGTDOrders = true;
-                auto timeToExpiry = std::chrono::duration_cast<std::chrono::hours>(
-                    order.expirationDate - now).count();
-                std::cout << "BID Order " << order.idorder
-                    << " (Price: " << order.price
-                    << ", Qty: " << order.quantity
-                    << ") expires in " << timeToExpiry << " hours\n";
-            }
-        }
-    }
-
-    // Scan ASK orders
-    for (const auto& [price, orders] : orderBook.askOrders)
-    {
-        for (const auto& order : orders)
-        {
-            if (order.timeinforce == TimeInForce::GTD)
-            {
-                hasGTDOrders = true;
-                auto timeToExpiry = std::chrono::duration_cast<std::chrono::hours>(
-                    order.expirationDate - now).count();
-                std::cout << "ASK Order " << order.idorder
-                    << " (Price: " << order.price
-                    << ", Qty: " << order.quantity
-                    << ") expires in " << timeToExpiry << " hours\n";
-            }
+            hasGTDOrders = true;
+            auto timeToExpiry = std::chrono::duration_cast<std::chrono::hours>(
+                order.expirationDate - now).count();
+            std::cout << (order.ordertype == OrderType::BID ? "BID" : "ASK") << " Order " << order.idorder
+                << " (Price: " << order.price
+                << ", Qty: " << order.quantity
+                << ") expires in " << timeToExpiry << " hours\n";
         }
     }
 
@@ -302,71 +517,94 @@ void MatchingEngine::displayHelp() const
 /**
  * @brief Removes expired Good Till Date (GTD) orders
  *
- * Scans through BID and ASK orders, removing those that have 
- * passed their expiration date.
+ * Asks every order book to remove the orders that have passed
+ * their expiration date, keeping the level totals consistent.
+ *
+ * @return int Number of orders removed
  */
-void MatchingEngine::checkGTDOrders()
+int MatchingEngine::checkGTDOrders()
 {
-    auto now = std::chrono::system_clock::now();
+    auto now = clock->now();
     int expiredOrders = 0;
+    if (journal)
+    {
+        JournalEvent event;
+        event.type = JournalEventType::EXPIRE_ORDERS;
+        event.timestamp = now;
+        journal->record(event);
+    }
 
-    // Remove expired BID orders
-    for (auto& [price, orders] : orderBook.bidOrders)
-    {
-        orders.erase(
-            std::remove_if(orders.begin(), orders.end(),
-                           [now, &expiredOrders](const Order& order)
-                           {
-                               if (order.timeinforce == TimeInForce::GTD && order.expirationDate <= now)
-                               {
-                                   std::cout << "Removing expired GTD order ID: " << order.idorder << std::endl;
-                                   expiredOrders++;
-                                   return true;
-                               }
-                               return false;
-                           }),
-            orders.end()
-        );
-    }
-
-    // Remove expired ASK orders
-    for (auto& [price, orders] : orderBook.askOrders)
-    {
-        orders.erase(
-            std::remove_if(orders.begin(), orders.end(),
-                           [now, &expiredOrders](const Order& order)
-                           {
-                               if (order.timeinforce == TimeInForce::GTD && order.expirationDate <= now)
-                               {
-                                   std::cout << "Removing expired GTD order ID: " << order.idorder << std::endl;
-                                   expiredOrders++;
-                                   return true;
-                               }
-                               return false;
-                           }),
-            orders.end()
-        );
+    std::lock_guard<std::mutex> lock(booksMutex);
+    for (auto& [key, book] : orderBooks)
+    {
+        expiredOrders += book.removeExpiredOrders(now);
     }
 
     if (expiredOrders > 0)
     {
         std::cout << "Removed " << expiredOrders << " expired GTD orders\n";
     }
+    return expiredOrders;
 }
 
 /**
  * @brief Resets daily trading statistics
  *
- * Zeroes out daily-specific performance metrics 
- * and updates the reset timestamp.
+ * Starts new daily figures and updates the reset timestamp; totals are
+ * kept. Firm volumes and the session statistics of every book restart
+ * from zero, the bars are kept.
  */
 void MatchingEngine::resetDailyStats()
 {
-    stats.dailyTradeCount = 0;
-    stats.dailyVolume = 0.0;
-    stats.matchingAttempts = 0;
-    stats.successfulMatches = 0;
-    stats.lastReset = std::chrono::system_clock::now();
+    stats.resetDaily();
+    {
+        std::lock_guard<std::mutex> booksLock(booksMutex);
+        for (auto& [key, book] : orderBooks)
+        {
+            book.resetTradeStats();
+        }
+    }
+    latency.reset();
+}
+
+/**
+ * @brief Configures self-trade prevention for a firm
+ *
+ * @param idfirm Firm identifier
+ * @param mode Self-trade prevention mode (NONE disables it)
+ */
+void MatchingEngine::setSelfTradePrevention(int idfirm, SelfTradePrevention mode)
+{
+    std::lock_guard<std::mutex> lock(firmConfigMutex);
+    selfTradePrevention[idfirm] = mode;
+}
+
+/**
+ * @brief Configures the allocation algorithm of a trading group
+ *
+ * @param idtradinggroup Trading group identifier
+ * @param algorithm FIFO, PRO_RATA or PRICE_TIME_PRO_RATA
+ *
+ * Applies to the existing books of the group's instruments and to the
+ * books created afterwards.
+ */
+void MatchingEngine::setAllocationAlgorithm(int idtradinggroup, AllocationAlgorithm algorithm)
+{
+    std::lock_guard<std::mutex> lock(booksMutex);
+    allocationByTradingGroup[idtradinggroup] = algorithm;
+    for (const auto& instrument : instrumentManager.getInstruments())
+    {
+        if (instrument.idtradinggroup != idtradinggroup)
+        {
+            continue;
+        }
+        auto it = orderBooks.find(
+            InstrumentKey(instrument.idinstrument, instrument.marketIdentificationCode, instrument.tradingCurrency));
+        if (it != orderBooks.end())
+        {
+            it->second.setAllocation(algorithm, instrument.lotsize);
+        }
+    }
 }
 
 /**
@@ -374,21 +612,32 @@ void MatchingEngine::resetDailyStats()
  *
  * @param trade The most recently completed trade
  *
- * Incrementally updates daily and total trade counts, 
- * volumes, and match statistics.
+ * Called by the order books once per trade, whichever thread matched it.
+ * Takes no lock: the counters are sharded per thread and the firm
+ * volumes are kept by the book, under its own lock.
  */
 void MatchingEngine::updateStats(const Trade& trade)
 {
-    double tradeValue = trade.quantity * trade.price;
-    stats.dailyTradeCount.fetch_add(1, std::memory_order_relaxed);
-    double currentDailyVolume = stats.dailyVolume.load(std::memory_order_relaxed);
-    stats.dailyVolume.store(currentDailyVolume + tradeValue, std::memory_order_relaxed);
-
-    stats.totalTradeCount.fetch_add(1, std::memory_order_relaxed);
-    double currentTotalVolume = stats.totalVolume.load(std::memory_order_relaxed);
-    stats.totalVolume.store(currentTotalVolume + tradeValue, std::memory_order_relaxed);
+    stats.recordTrade(trade.price, trade.quantity);
+}
 
-    stats.successfulMatches.fetch_add(1, std::memory_order_relaxed);
+/**
+ * @brief Returns the traded volume of a firm since the daily reset
+ *
+ * @param idfirm Firm identifier
+ */
+FirmTradeStats MatchingEngine::getFirmStats(int idfirm) const
+{
+    std::unordered_map<int, FirmTradeStats> firms;
+    {
+        std::lock_guard<std::mutex> booksLock(booksMutex);
+        for (const auto& [key, book] : orderBooks)
+        {
+            book.addFirmStats(firms);
+        }
+    }
+    auto it = firms.find(idfirm);
+    return it == firms.end() ? FirmTradeStats() : it->second;
 }
 
 /**
@@ -399,12 +648,30 @@ void MatchingEngine::updateStats(const Trade& trade)
  *
  * Performs comprehensive order validation by:
  * - Matching the order with a registered instrument
- * - Checking price and quantity against instrument specifications
- * - Adding the order to the order book
+ * - Checking price, quantity, iceberg peak and stop price against instrument specifications
+ * - Stamping the firm's self-trade prevention mode
+ * - Adding the order to the instrument's order book
  * - Attempting immediate order matching
  */
 bool MatchingEngine::addAndValidateOrder(const Order& order)
 {
+    ENGINE_PROBE(ORDER_ENTRY);
+    auto entered = std::chrono::steady_clock::now();
+
+    // Orders stamped on receipt (gateway, FIX session) show how long they waited to get here
+    if (order.priority != std::chrono::system_clock::time_point{})
+    {
+        latency[LatencyStage::INGRESS].recordElapsed(clock->now() - order.priority);
+    }
+    if (journal)
+    {
+        JournalEvent event;
+        event.type = JournalEventType::NEW_ORDER;
+        event.timestamp = clock->now();
+        event.order = order;
+        journal->record(event);
+    }
+
     // Find matching instrument for the order
     for (const auto& instrument : instrumentManager.getInstruments())
     {
@@ -413,24 +680,44 @@ bool MatchingEngine::addAndValidateOrder(const Order& order)
             instrument.tradingCurrency == order.tradingCurrency)
         {
             // Validate order price and quantity
-            if (order.validatePrice(instrument) && order.validateQuantity(instrument))
+            // Market orders carry no limit price to validate
+            bool priceValid = order.limitType == LimitType::NONE || order.validatePrice(instrument);
+            if (priceValid && order.validateQuantity(instrument) &&
+                order.validatePeak(instrument) && order.validateStopPrice(instrument))
             {
-                // Add order to the order book
-                orderBook.addOrder(order);
-                std::cout << "Order added - ID: " << order.idorder
-                    << " Type: " << (order.ordertype == OrderType::BID ? "BID" : "ASK")
-                    << " Price: " << std::fixed << std::setprecision(2) << order.price
-                    << " Quantity: " << order.quantity << "\n";
+                // Resolve the firm's self-trade prevention mode once, on entry
+                Order accepted = order;
+                {
+                    std::lock_guard<std::mutex> lock(firmConfigMutex);
+                    auto stp = selfTradePrevention.find(order.idfirm);
+                    if (stp != selfTradePrevention.end())
+                    {
+                        accepted.stpMode = stp->second;
+                    }
+                }
+
+                // Add order to the instrument's order book
+                OrderBook& orderBook = getOrderBook(instrument);
+                auto validated = std::chrono::steady_clock::now();
+                latency[LatencyStage::VALIDATION].recordElapsed(validated - entered);
+                orderBook.addOrder(accepted);
+                {
+                    ENGINE_PROBE(ORDER_REPORT);
+                    std::cout << "Order added - ID: " << order.idorder
+                        << " Type: " << (order.ordertype == OrderType::BID ? "BID" : "ASK")
+                        << " Price: " << std::fixed << std::setprecision(2) << order.price
+                        << " Quantity: " << order.quantity << "\n";
+                }
 
                 // Attempt immediate order matching
                 int matches = orderBook.matchOrders();
+
+                auto matched = std::chrono::steady_clock::now();
+                latency[LatencyStage::MATCHING].recordElapsed(matched - validated);
+                latency[LatencyStage::ORDER_TO_ACK].recordElapsed(matched - entered);
                 if (matches > 0)
                 {
-                    const Trade* lastTrade = orderBook.getLastTrade();
-                    if (lastTrade)
-                    {
-                        updateStats(*lastTrade);
-                    }
+                    latency[LatencyStage::ORDER_TO_FILL].recordElapsed(matched - entered);
                 }
                 return true;
             }
@@ -441,3 +728,224 @@ bool MatchingEngine::addAndValidateOrder(const Order& order)
     std::cout << "No matching instrument found for order\n";
     return false;
 }
+
+/**
+ * @brief Validates and adds a batch of new orders, matching each touched book once
+ *
+ * @param orders First order of the batch
+ * @param count Number of orders
+ * @param accepted If not null, set for each order to whether it was added
+ * @return std::size_t Number of orders added
+ *
+ * Three passes over the batch:
+ * - Resolves and validates, reusing the previous order's instrument
+ *   when it matches, as in a quote update
+ * - Stamps the self-trade prevention modes under a single lock
+ * - Adds the accepted orders to their books, then matches each book once;
+ *   a market order is matched as soon as it is added
+ *
+ * Timings go to the batch stages, one sample per batch.
+ */
+std::size_t MatchingEngine::submitBatch(const Order* orders, std::size_t count, bool* accepted)
+{
+    ENGINE_PROBE(ORDER_ENTRY);
+    auto entered = std::chrono::steady_clock::now();
+    auto now = clock->now();
+
+    if (journal && count > 0)
+    {
+        journal->recordBatch(now, orders, count);
+    }
+
+    // Resolve and validate without the engine locks; the order checks print their errors
+    std::vector<const Instrument*> instruments(count, nullptr);
+    const Instrument* previous = nullptr;
+    auto isInstrumentOf = [](const Instrument& instrument, const Order& order)
+    {
+        return instrument.idinstrument == order.idinstrument &&
+            instrument.marketIdentificationCode == order.marketIdentificationCode &&
+            instrument.tradingCurrency == order.tradingCurrency;
+    };
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        const Order& order = orders[i];
+        if (order.priority != std::chrono::system_clock::time_point{})
+        {
+            latency[LatencyStage::INGRESS].recordElapsed(now - order.priority);
+        }
+
+        const Instrument* instrument = previous != nullptr && isInstrumentOf(*previous, order) ? previous : nullptr;
+        for (auto it = instrumentManager.getInstruments().begin();
+             instrument == nullptr && it != instrumentManager.getInstruments().end(); ++it)
+        {
+            instrument = isInstrumentOf(*it, order) ? &*it : nullptr;
+        }
+        previous = instrument != nullptr ? instrument : previous;
+
+        bool valid = instrument != nullptr &&
+            (order.limitType == LimitType::NONE || order.validatePrice(*instrument)) &&
+            order.validateQuantity(*instrument) && order.validatePeak(*instrument) &&
+            order.validateStopPrice(*instrument);
+        instruments[i] = valid ? instrument : nullptr;
+    }
+
+    // Resolve every firm's self-trade prevention mode under one lock
+    std::vector<SelfTradePrevention> stpModes(count, SelfTradePrevention::NONE);
+    {
+        std::lock_guard<std::mutex> lock(firmConfigMutex);
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            auto stp = selfTradePrevention.find(orders[i].idfirm);
+            stpModes[i] = instruments[i] != nullptr && stp != selfTradePrevention.end()
+                              ? stp->second
+                              : orders[i].stpMode;
+        }
+    }
+
+    auto validated = std::chrono::steady_clock::now();
+
+    // Add in batch order; a batch touches few books, so a linear lookup does
+    std::vector<std::pair<const Instrument*, OrderBook*> > books;
+    std::size_t added = 0;
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        if (accepted)
+        {
+            accepted[i] = instruments[i] != nullptr;
+        }
+        if (instruments[i] == nullptr)
+        {
+            continue;
+        }
+        auto book = std::find_if(books.begin(), books.end(), [&instruments, i](const auto& entry)
+        {
+            return entry.first == instruments[i];
+        });
+        if (book == books.end())
+        {
+            book = books.emplace(books.end(), instruments[i], &getOrderBook(*instruments[i]));
+        }
+
+        Order order = orders[i];
+        order.stpMode = stpModes[i];
+        book->second->addOrder(order);
+        ++added;
+
+        // A market order trades on what rests now and is not left for later orders
+        if (order.limitType == LimitType::NONE)
+        {
+            book->second->matchOrders();
+        }
+    }
+
+    for (const auto& entry : books)
+    {
+        entry.second->matchOrders();
+    }
+
+    auto matched = std::chrono::steady_clock::now();
+    latency[LatencyStage::BATCH_VALIDATION].recordElapsed(validated - entered);
+    latency[LatencyStage::BATCH_MATCHING].recordElapsed(matched - validated);
+    latency[LatencyStage::BATCH_TO_ACK].recordElapsed(matched - entered);
+    return added;
+}
+
+/**
+ * @brief Cancels an order of a firm
+ *
+ * @param key Instrument of the order (id, market code, currency)
+ * @param idorder Identifier of the order
+ * @param idfirm Firm that must own the order, OrderBook::ANY_FIRM to skip the check
+ * @return bool True if the order was found and cancelled
+ *
+ * Orders of other firms are reported as not found, so a session
+ * cannot probe the identifiers of another firm.
+ */
+bool MatchingEngine::cancelOrder(const InstrumentKey& key, int idorder, int idfirm)
+{
+    ENGINE_PROBE(CANCEL);
+    if (journal)
+    {
+        JournalEvent event;
+        event.type = JournalEventType::CANCEL_ORDER;
+        event.timestamp = clock->now();
+        std::tie(event.order.idinstrument, event.order.marketIdentificationCode, event.order.tradingCurrency) = key;
+        event.order.idorder = idorder;
+        event.order.idfirm = idfirm;
+        journal->record(event);
+    }
+    OrderBook* orderBook;
+    {
+        std::lock_guard<std::mutex> lock(booksMutex);
+        auto it = orderBooks.find(key);
+        if (it == orderBooks.end())
+        {
+            return false;
+        }
+        orderBook = &it->second;
+    }
+    return orderBook->cancelOrder(idorder, idfirm);
+}
+
+/**
+ * @brief Validates and applies an amend of an order of a firm
+ *
+ * @param key Instrument of the order (id, market code, currency)
+ * @param idorder Identifier of the order
+ * @param newPrice New limit price
+ * @param newQuantity New remaining quantity
+ * @param idfirm Firm that must own the order, OrderBook::ANY_FIRM to skip the check
+ * @return bool True if the order was found and amended
+ */
+bool MatchingEngine::amendOrder(const InstrumentKey& key, int idorder, double newPrice, int newQuantity,
+                                int idfirm)
+{
+    ENGINE_PROBE(AMEND);
+    if (journal)
+    {
+        JournalEvent event;
+        event.type = JournalEventType::AMEND_ORDER;
+        event.timestamp = clock->now();
+        std::tie(event.order.idinstrument, event.order.marketIdentificationCode, event.order.tradingCurrency) = key;
+        event.order.idorder = idorder;
+        event.order.price = newPrice;
+        event.order.quantity = newQuantity;
+        event.order.idfirm = idfirm;
+        journal->record(event);
+    }
+    for (const auto& instrument : instrumentManager.getInstruments())
+    {
+        if (InstrumentKey(instrument.idinstrument, instrument.marketIdentificationCode,
+                          instrument.tradingCurrency) != key)
+        {
+            continue;
+        }
+
+        // Same price and quantity checks as a new order
+        Order amended;
+        amended.price = newPrice;
+        amended.quantity = newQuantity;
+        if (!amended.validatePrice(instrument) || !amended.validateQuantity(instrument))
+        {
+            return false;
+        }
+
+        OrderBook* orderBook;
+        {
+            std::lock_guard<std::mutex> lock(booksMutex);
+            auto it = orderBooks.find(key);
+            if (it == orderBooks.end())
+            {
+                return false;
+            }
+            orderBook = &it->second;
+        }
+        if (!orderBook->amendOrder(idorder, newPrice, newQuantity, idfirm))
+        {
+            return false;
+        }
+        orderBook->matchOrders();
+        return true;
+    }
+    return false;
+}
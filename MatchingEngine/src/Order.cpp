@@ -9,6 +9,7 @@
 #include "Order.hpp"
 #include "Instrument.hpp"
 
+#include <algorithm>
 #include <cmath>
 #include <iomanip>
 #include <ctime>
@@ -138,6 +139,16 @@ void Order::display() const
     std::cout << "Order Type: " << (ordertype == OrderType::BID ? "BID" : "ASK") << "\n";
     std::cout << "Instrument ID: " << idinstrument << "\n";
     std::cout << "Original Quantity: " << originalqty << "\n";
+    if (isStop())
+    {
+        std::cout << "Stop Type: " << (stopType == StopType::STOP ? "STOP" : "STOP_LIMIT") << "\n";
+        std::cout << "Stop Price: " << stopPrice << "\n";
+    }
+    if (isIceberg())
+    {
+        std::cout << "Iceberg Peak: " << peakSize << "\n";
+        std::cout << "Hidden Quantity: " << hiddenQuantity << "\n";
+    }
     std::cout << "Firm ID: " << idfirm << "\n";
 
     // Display expiration date only for GTD orders
@@ -154,6 +165,35 @@ void Order::display() const
     std::cout << "================================\n";
 }
 
+/**
+ * @brief Checks that a price is a multiple of the instrument's price precision
+ *
+ * @param value Price to check
+ * @param pricedecimal Number of decimal places allowed by the instrument
+ * @return bool True if the price has no digit beyond the allowed decimals
+ *
+ * Multiplies the price by 10^pricedecimal and checks that the result is
+ * close to the nearest integer within a small tolerance, which is robust
+ * to floating-point representation errors.
+ */
+static bool isMultipleOfPriceDecimal(double value, int pricedecimal)
+{
+    // 1. Calculate the factor (e.g., 100 for 2 decimals)
+    double precisionFactor = std::pow(10, pricedecimal);
+
+    // 2. Multiply the price by the factor
+    double multipliedPrice = value * precisionFactor;
+
+    // 3. Round the result to the nearest integer
+    double roundedPrice = std::round(multipliedPrice);
+
+    // 4. Check if the multiplied price is close to the rounded integer within tolerance
+    // This confirms that the original price was a valid multiple of the precision.
+    double tolerance = 1e-8;
+
+    return std::fabs(multipliedPrice - roundedPrice) <= tolerance;
+}
+
 /**
  * @brief Validates the order's price against instrument specifications
  *
@@ -174,24 +214,9 @@ bool Order::validatePrice(const Instrument& instrument) const
     }
 
     // ⭐️ CRITICAL FIX: Use rounding for robust floating-point precision check ⭐️
-    // 1. Calculate the factor (e.g., 100 for 2 decimals)
-    double precisionFactor = std::pow(10, instrument.pricedecimal);
-
-    // 2. Multiply the price by the factor
-    double multipliedPrice = price * precisionFactor;
-
-    // 3. Round the result to the nearest integer
-    double roundedPrice = std::round(multipliedPrice);
-
-    // 4. Check if the multiplied price is close to the rounded integer within tolerance
-    // This confirms that the original price was a valid multiple of the precision.
-    double tolerance = 1e-8;
-
-    if (std::fabs(multipliedPrice - roundedPrice) > tolerance)
+    if (!isMultipleOfPriceDecimal(price, instrument.pricedecimal))
     {
         std::cout << "ERROR: Price (" << price << ") must be a multiple of the instrument's pricedecimal (" << instrument.pricedecimal << ").\n";
-        // Optional debug output:
-        // std::cout << "DEBUG: Multiplied: " << multipliedPrice << ", Rounded: " << roundedPrice << ", Difference: " << std::fabs(multipliedPrice - roundedPrice) << "\n";
         return false;
     }
     // ⭐️ END CRITICAL FIX ⭐️
@@ -235,3 +260,98 @@ bool Order::validateQuantity(const Instrument& instrument) const
 
     return true;
 }
+
+/**
+ * @brief Turns the order into an iceberg (reserve) order
+ *
+ * @param peak Quantity displayed in the book at any time
+ *
+ * Splits the remaining quantity into a displayed peak and
+ * a hidden reserve. A non-positive peak turns the order back
+ * into a regular, fully displayed order.
+ */
+void Order::setIcebergPeak(int peak)
+{
+    int total = quantity + hiddenQuantity;
+    if (peak <= 0)
+    {
+        peakSize = 0;
+        quantity = total;
+        hiddenQuantity = 0;
+        return;
+    }
+    peakSize = peak;
+    quantity = std::min(peak, total);
+    hiddenQuantity = total - quantity;
+}
+
+/**
+ * @brief Validates the iceberg peak against instrument specifications
+ *
+ * @param instrument Reference instrument for validation
+ * @return bool True if the order is not an iceberg or its peak is valid
+ */
+bool Order::validatePeak(const Instrument& instrument) const
+{
+    if (!isIceberg())
+    {
+        return true;
+    }
+
+    // Verify peak is a multiple of lot size
+    if (peakSize % instrument.lotsize != 0)
+    {
+        std::cout << "ERROR: Iceberg peak must be a multiple of its lot size.\n";
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Turns the order into a conditional stop or stop-limit order
+ *
+ * @param type STOP or STOP_LIMIT
+ * @param triggerPrice Last traded price that activates the order
+ *
+ * A stop order triggers into a market order, so its limit type
+ * is cleared; a stop-limit order keeps its limit price.
+ */
+void Order::setStop(StopType type, double triggerPrice)
+{
+    stopType = type;
+    stopPrice = triggerPrice;
+    if (type == StopType::STOP)
+    {
+        limitType = LimitType::NONE;
+    }
+}
+
+/**
+ * @brief Validates the stop price against instrument specifications
+ *
+ * @param instrument Reference instrument for validation
+ * @return bool True if the order is not a stop order or its stop price is valid
+ */
+bool Order::validateStopPrice(const Instrument& instrument) const
+{
+    if (!isStop())
+    {
+        return true;
+    }
+
+    // Check for positive stop price
+    if (stopPrice <= 0)
+    {
+        std::cout << "ERROR: Stop price must be strictly positive.\n";
+        return false;
+    }
+
+    if (!isMultipleOfPriceDecimal(stopPrice, instrument.pricedecimal))
+    {
+        std::cout << "ERROR: Stop price (" << stopPrice << ") must be a multiple of the instrument's pricedecimal (" << instrument.pricedecimal << ").\n";
+        return false;
+    }
+
+    return true;
+}
@@ -9,16 +9,19 @@
 #include "OrderBook.hpp"
 #include <iomanip>
 #include "MatchingEngine.hpp"
+#include "Probe.hpp"
 #include <algorithm>
+#include <cmath>
 
 /**
  * @brief Default constructor for OrderBook
  *
  * Initializes the order book with default values:
  * - Sets initial trade ID to 1
+ * - Sets initial priority sequence to 1
  * - Sets matching engine pointer to null
  */
-OrderBook::OrderBook() : nextTradeId(1), matchingEngine(nullptr)
+OrderBook::OrderBook() : nextTradeId(1), nextSequence(1), matchingEngine(nullptr)
 {
 }
 
@@ -43,162 +46,1424 @@ void OrderBook::notifyMatch(const Trade& trade)
  *
  * @param order The order to be added
  *
- * Inserts the order into either BID or ASK orders map
- * based on its order type.
+ * Stop and stop-limit orders are held in the trigger book of their
+ * side; a stop whose price has already been reached by the last trade
+ * is activated at once. Other orders are queued in either the BID or
+ * ASK orders map, based on their order type.
  */
 void OrderBook::addOrder(const Order& order)
 {
-    // Insert BID orders into bidOrders map
-    if (order.ordertype == OrderType::BID)
+    ENGINE_PROBE(BOOK_ADD);
+    std::lock_guard<std::mutex> lock(displayMutex);
+
+    if (order.isStop())
+    {
+        OrderLocator locator{};
+        locator.side = order.ordertype;
+        locator.price = order.stopPrice;
+        if (order.ordertype == OrderType::BID)
+        {
+            locator.location = OrderLocation::BUY_STOP;
+            locator.buyStopPosition = buyStopOrders.emplace(order.stopPrice, order);
+        }
+        else
+        {
+            locator.location = OrderLocation::SELL_STOP;
+            locator.sellStopPosition = sellStopOrders.emplace(order.stopPrice, order);
+        }
+        orderIndex[order.idorder] = locator;
+
+        if (const Trade* lastTrade = getLastTrade())
+        {
+            activateTriggeredStops(lastTrade->price);
+        }
+        publishBookChanges();
+        return;
+    }
+
+    queueOrder(order);
+    publishBookChanges();
+}
+
+/**
+ * @brief Queues an active order at the back of its price level
+ *
+ * @param order The order to queue
+ * @param event Level 3 event published for it
+ *
+ * Stamps the order with the book's next priority sequence and records
+ * its position in the order-id index. Market orders are keyed ahead of
+ * every limit price of their side.
+ */
+void OrderBook::queueOrder(Order order, L3MessageType event)
+{
+    order.sequence = nextSequence++;
+
+    OrderLocator locator{};
+    locator.location = OrderLocation::BOOK;
+    locator.side = order.ordertype;
+
+    // Insert into bidOrders or askOrders, market orders at the side's market key
+    locator.position = visitSide(order.ordertype, [this, &order](auto& orders)
+    {
+        if (order.limitType == LimitType::NONE)
+        {
+            order.price = orders.MARKET_PRICE;
+        }
+        touchLevel(orders.SIDE, order.price);
+        return orders.push(order);
+    });
+    locator.price = order.price;
+    orderIndex[order.idorder] = locator;
+    publishOrderEvent(event, order, order.price, order.quantity);
+}
+
+/**
+ * @brief Removes an order from its price level and from the index
+ *
+ * @param locator Index entry of a resting order
+ *
+ * Erases the level if it becomes empty. The locator is copied
+ * before the index entry it may refer to is erased.
+ */
+void OrderBook::eraseRestingOrder(const OrderLocator& locator)
+{
+    OrderLocator entry = locator;
+    touchLevel(entry.side, entry.price);
+    orderIndex.erase(entry.position->idorder);
+    visitSide(entry.side, [&entry](auto& orders)
+    {
+        orders.erase(entry.price, entry.position);
+    });
+}
+
+/**
+ * @brief Cancels an order resting in the book or in a trigger book
+ *
+ * @param idorder Identifier of the order to cancel
+ * @param idfirm Firm that must own the order, ANY_FIRM to skip the check
+ * @return bool True if the order was found and cancelled
+ *
+ * The order is located through the order-id index, so the cost
+ * does not depend on the number of orders in the book. An order of
+ * another firm is reported as not found.
+ */
+bool OrderBook::cancelOrder(int idorder, int idfirm)
+{
+    std::lock_guard<std::mutex> lock(displayMutex);
+
+    auto it = orderIndex.find(idorder);
+    if (it == orderIndex.end() || !isOwnedBy(it->second, idfirm))
+    {
+        return false;
+    }
+
+    switch (it->second.location)
+    {
+    case OrderLocation::BOOK:
+        publishOrderEvent(L3MessageType::CANCEL_ORDER, *it->second.position, it->second.price,
+                          it->second.position->quantity);
+        eraseRestingOrder(it->second);
+        break;
+    case OrderLocation::BUY_STOP:
+        buyStopOrders.erase(it->second.buyStopPosition);
+        orderIndex.erase(it);
+        break;
+    case OrderLocation::SELL_STOP:
+        sellStopOrders.erase(it->second.sellStopPosition);
+        orderIndex.erase(it);
+        break;
+    }
+    publishBookChanges();
+    return true;
+}
+
+/**
+ * @brief Amends the price and/or remaining quantity of an order
+ *
+ * @param idorder Identifier of the order to amend
+ * @param newPrice New limit price
+ * @param newQuantity New remaining quantity (displayed and hidden)
+ * @param idfirm Firm that must own the order, ANY_FIRM to skip the check
+ * @return bool True if the order was found and amended
+ *
+ * Fast path: a quantity decrease at the same price reduces the order in
+ * place and it keeps its queue priority. Otherwise the order is removed
+ * and queued again under the same lock, at the back of its new level and
+ * with a new priority sequence. Untriggered stops have no queue priority
+ * and are amended in place, under the same stop price: a stop-limit
+ * order takes the new limit price, a stop order, which has none, only
+ * accepts its current price.
+ */
+bool OrderBook::amendOrder(int idorder, double newPrice, int newQuantity, int idfirm)
+{
+    std::lock_guard<std::mutex> lock(displayMutex);
+
+    auto it = orderIndex.find(idorder);
+    if (it == orderIndex.end() || newQuantity <= 0 || !isOwnedBy(it->second, idfirm))
+    {
+        return false;
+    }
+
+    const OrderLocator& locator = it->second;
+    if (locator.location != OrderLocation::BOOK)
+    {
+        Order& order = locator.location == OrderLocation::BUY_STOP
+                           ? locator.buyStopPosition->second
+                           : locator.sellStopPosition->second;
+        if (order.stopType == StopType::STOP && newPrice != order.price)
+        {
+            return false;
+        }
+        order.price = newPrice;
+        order.quantity = newQuantity;
+        order.hiddenQuantity = 0;
+        order.setIcebergPeak(order.peakSize);
+        return true;
+    }
+
+    Order& order = *locator.position;
+    int remaining = order.quantity + order.hiddenQuantity;
+
+    // Priority-preserving fast path: same price, smaller quantity
+    if (newPrice == order.price && newQuantity <= remaining)
+    {
+        touchLevel(locator.side, locator.price);
+        int displayed = order.quantity;
+        visitSide(locator.side, [&locator, newQuantity](auto& orders)
+        {
+            orders.find(locator.price)->second.reduce(locator.position, newQuantity);
+        });
+        if (order.quantity < displayed)
+        {
+            publishOrderEvent(L3MessageType::CANCEL_ORDER, order, order.price, displayed - order.quantity);
+        }
+        publishBookChanges();
+        return true;
+    }
+
+    // Cancel-and-reinsert: loses time priority
+    Order amended = order;
+    eraseRestingOrder(locator);
+    amended.price = newPrice;
+    amended.quantity = newQuantity;
+    amended.hiddenQuantity = 0;
+    amended.setIcebergPeak(amended.peakSize);
+    amended.priority = clock->now();
+    queueOrder(amended, L3MessageType::REPLACE_ORDER);
+    publishBookChanges();
+    return true;
+}
+
+/**
+ * @brief Looks up an order through the order-id index
+ *
+ * @param idorder Identifier of the order
+ * @return const Order* The order, or nullptr if it is not in the book
+ */
+const Order* OrderBook::findOrder(int idorder) const
+{
+    auto it = orderIndex.find(idorder);
+    return it == orderIndex.end() ? nullptr : &locatedOrder(it->second);
+}
+
+/**
+ * @brief Returns the order an index entry points at
+ *
+ * @param locator Index entry
+ * @return const Order& The order, in its level or trigger book
+ */
+const Order& OrderBook::locatedOrder(const OrderLocator& locator)
+{
+    switch (locator.location)
+    {
+    case OrderLocation::BUY_STOP:
+        return locator.buyStopPosition->second;
+    case OrderLocation::SELL_STOP:
+        return locator.sellStopPosition->second;
+    case OrderLocation::BOOK:
+    default:
+        return *locator.position;
+    }
+}
+
+/**
+ * @brief Moves the stop orders triggered by a trade price into the book
+ *
+ * @param lastPrice Price of the last trade
+ * @return int Number of stop orders activated
+ *
+ * Buy stops trigger at or above their stop price, sell stops at or
+ * below it. Activated stops become market orders, stop-limits become
+ * limit orders, and both are queued with a new priority sequence.
+ */
+int OrderBook::activateTriggeredStops(double lastPrice)
+{
+    return activateTriggeredStops<OrderType::BID>(buyStopOrders, lastPrice) +
+        activateTriggeredStops<OrderType::ASK>(sellStopOrders, lastPrice);
+}
+
+/**
+ * @brief Moves the triggered stop orders of one side into the book
+ *
+ * @param stops Trigger book of the side
+ * @param lastPrice Price of the last trade
+ * @return int Number of stop orders activated
+ *
+ * The trigger book is sorted so that the next order to trigger is
+ * always at the front: activation stops at the first order whose stop
+ * price has not been reached.
+ */
+template <OrderType Side>
+int OrderBook::activateTriggeredStops(typename BookSide<Side>::StopOrders& stops, double lastPrice)
+{
+    int activated = 0;
+    while (!stops.empty() && BookSide<Side>::isTriggered(stops.begin()->first, lastPrice))
+    {
+        auto node = stops.extract(stops.begin());
+        Order& order = node.mapped();
+        std::cout << "Stop order triggered - ID: " << order.idorder
+            << " Stop Price: " << order.stopPrice << std::endl;
+        order.stopType = StopType::NONE;
+        queueOrder(std::move(order));
+        activated++;
+    }
+    return activated;
+}
+
+/**
+ * @brief Applies self-trade prevention to the two front orders
+ *
+ * @param bidLevel Best bid level
+ * @param askLevel Best ask level
+ * @return bool True if the orders were prevented from trading
+ *
+ * The aggressor is the front order with the newer priority sequence.
+ */
+bool OrderBook::preventSelfTrade(PriceLevel& bidLevel, PriceLevel& askLevel)
+{
+    bool bidIsAggressor = bidLevel.front().sequence > askLevel.front().sequence;
+    PriceLevel& aggressorLevel = bidIsAggressor ? bidLevel : askLevel;
+    PriceLevel& restingLevel = bidIsAggressor ? askLevel : bidLevel;
+    return preventSelfTrade(aggressorLevel, aggressorLevel.front(), restingLevel, restingLevel.front());
+}
+
+/**
+ * @brief Applies self-trade prevention to an aggressor and a resting order
+ *
+ * @param aggressorLevel Level holding the aggressor at its front
+ * @param aggressor The aggressor order
+ * @param restingLevel Level holding the resting order
+ * @param resting The resting order
+ * @return bool True if the orders were prevented from trading
+ *
+ * The aggressor's mode was resolved from the firm configuration on
+ * entry, so no lookup happens here. Cancelled orders are reduced to zero
+ * remaining quantity and removed by cleanupExecutedOrders, or by
+ * sweepExhaustedOrders when they sit behind the front; decremented orders
+ * lose the smaller displayed quantity, as in a fill without a trade.
+ */
+bool OrderBook::preventSelfTrade(PriceLevel& aggressorLevel, Order& aggressor, PriceLevel& restingLevel,
+                                 Order& resting)
+{
+    SelfTradePrevention mode = aggressor.stpMode;
+
+    if (mode == SelfTradePrevention::NONE)
+    {
+        return false;
+    }
+
+    bool bidIsAggressor = aggressor.ordertype == OrderType::BID;
+    Order& bidOrder = bidIsAggressor ? aggressor : resting;
+    Order& askOrder = bidIsAggressor ? resting : aggressor;
+    touchLevel(OrderType::BID, bidOrder.price);
+    touchLevel(OrderType::ASK, askOrder.price);
+
+    std::cout << "Self-trade prevented for firm " << bidOrder.idfirm
+        << " (BID: " << bidOrder.idorder << ", ASK: " << askOrder.idorder << ")" << std::endl;
+
+    auto cancel = [this](PriceLevel& level, Order& order)
+    {
+        publishOrderEvent(L3MessageType::CANCEL_ORDER, order, order.price, order.quantity);
+        level.reduce(order, 0);
+    };
+
+    switch (mode)
+    {
+    case SelfTradePrevention::CANCEL_RESTING:
+        cancel(restingLevel, resting);
+        break;
+    case SelfTradePrevention::CANCEL_AGGRESSOR:
+        cancel(aggressorLevel, aggressor);
+        break;
+    case SelfTradePrevention::CANCEL_BOTH:
+        cancel(restingLevel, resting);
+        cancel(aggressorLevel, aggressor);
+        break;
+    case SelfTradePrevention::DECREMENT:
+    default:
+    {
+        int decrement = std::min(aggressor.quantity, resting.quantity);
+        publishOrderEvent(L3MessageType::CANCEL_ORDER, aggressor, aggressor.price, decrement);
+        publishOrderEvent(L3MessageType::CANCEL_ORDER, resting, resting.price, decrement);
+        aggressorLevel.fill(aggressor, decrement);
+        restingLevel.fill(resting, decrement);
+        break;
+    }
+    }
+    return true;
+}
+
+/**
+ * @brief Cancels the unfilled quantity of market orders
+ *
+ * Market orders are keyed ahead of every limit price, so any that
+ * remain after matching sit in the first level of their side.
+ */
+void OrderBook::discardUnfilledMarketOrders()
+{
+    discardUnfilledMarketOrders(bidOrders);
+    discardUnfilledMarketOrders(askOrders);
+}
+
+/**
+ * @brief Cancels the unfilled market orders of one side
+ *
+ * @param orders Side of the book
+ */
+template <OrderType Side>
+void OrderBook::discardUnfilledMarketOrders(BookSide<Side>& orders)
+{
+    if (orders.empty() || orders.begin()->first != BookSide<Side>::MARKET_PRICE)
+    {
+        return;
+    }
+    for (const auto& order : orders.begin()->second)
+    {
+        std::cout << "Market order " << order.idorder << " cancelled, unfilled quantity: "
+            << order.quantity + order.hiddenQuantity << std::endl;
+        orderIndex.erase(order.idorder);
+    }
+    orders.erase(orders.begin());
+}
+
+/**
+ * @brief Attempts to match BID and ASK orders
+ *
+ * @return int Number of trades executed
+ *
+ * Selects the matching loop instantiated for the book's allocation
+ * algorithm. The choice is made once per cycle, outside the loop.
+ */
+int OrderBook::matchOrders()
+{
+    ENGINE_PROBE(BOOK_MATCH);
+    std::lock_guard<std::mutex> lock(displayMutex);
+
+    // Orders are only collected during an auction call phase
+    if (tradingPhase == TradingPhase::AUCTION)
+    {
+        return 0;
+    }
+
+    int tradesExecuted;
+    switch (allocationAlgorithm)
+    {
+    case AllocationAlgorithm::PRO_RATA:
+        tradesExecuted = matchOrdersWith<ProRataAllocation>();
+        break;
+    case AllocationAlgorithm::PRICE_TIME_PRO_RATA:
+        tradesExecuted = matchOrdersWith<PriceTimeProRataAllocation>();
+        break;
+    case AllocationAlgorithm::FIFO:
+    default:
+        tradesExecuted = matchOrdersWith<FifoAllocation>();
+        break;
+    }
+
+    publishBookChanges();
+    return tradesExecuted;
+}
+
+/**
+ * @brief Matching loop for one allocation policy
+ *
+ * @tparam Allocation Policy sharing the aggressor quantity at the touch
+ * @return int Number of trades executed
+ *
+ * Implements the core order matching algorithm:
+ * - Matches the best bid level against the best ask level
+ * - Treats the newer front order as the aggressor and the other
+ *   level as the resting side
+ * - Prevents self-trades between orders of the same firm
+ * - Lets the allocation policy share the aggressor quantity among the
+ *   resting orders, at the price of the resting level
+ * - Handles partial order fulfillment
+ * - Cleans up fully executed orders
+ * - Activates the stop orders triggered by each trade
+ * - Cancels what is left of market orders
+ */
+template <typename Allocation>
+int OrderBook::matchOrdersWith()
+{
+    int tradesExecuted = 0;
+
+    while (!bidOrders.empty() && !askOrders.empty())
+    {
+        auto highestBidIt = bidOrders.begin();
+        auto lowestAskIt = askOrders.begin();
+
+        // Stop matching if lowest ask price exceeds highest bid price
+        if (!BidSide::crosses(highestBidIt->first, lowestAskIt->first))
+        {
+            break;
+        }
+
+        PriceLevel& bidLevel = highestBidIt->second;
+        PriceLevel& askLevel = lowestAskIt->second;
+        Order& bidOrder = bidLevel.front();
+        Order& askOrder = askLevel.front();
+
+        // Two market orders cannot set a price: the newer one is cancelled
+        if (bidOrder.limitType == LimitType::NONE && askOrder.limitType == LimitType::NONE)
+        {
+            PriceLevel& newerLevel = bidOrder.sequence > askOrder.sequence ? bidLevel : askLevel;
+            std::cout << "Market order " << newerLevel.front().idorder
+                << " cancelled, no price reference" << std::endl;
+            newerLevel.reduce(newerLevel.begin(), 0);
+            cleanupExecutedOrders();
+            continue;
+        }
+
+        // Self-trade prevention costs a single integer compare per fill
+        if (bidOrder.idfirm == askOrder.idfirm && preventSelfTrade(bidLevel, askLevel))
+        {
+            cleanupExecutedOrders();
+            continue;
+        }
+
+        // The newer front order is the aggressor; trades print at the resting price,
+        // or at the aggressor's limit when a market order rests (auction leftovers)
+        bool bidIsAggressor = bidOrder.sequence > askOrder.sequence;
+        Order& aggressor = bidIsAggressor ? bidOrder : askOrder;
+        PriceLevel& aggressorLevel = bidIsAggressor ? bidLevel : askLevel;
+        PriceLevel& restingLevel = bidIsAggressor ? askLevel : bidLevel;
+        double tradePrice = restingLevel.front().limitType == LimitType::NONE
+                                ? aggressor.price
+                                : restingLevel.front().price;
+
+        auto now = clock->now();
+        auto now_time_t = std::chrono::system_clock::to_time_t(now);
+
+        bool prevented = false;
+        auto fill = [&](Order& resting, int tradeQuantity) -> int
+        {
+            // A cancelled or decremented aggressor caps the remaining shares
+            tradeQuantity = std::min(tradeQuantity, aggressor.quantity);
+            if (tradeQuantity <= 0)
+            {
+                return 0;
+            }
+
+            // Orders behind the front get the same single compare
+            if (resting.idfirm == aggressor.idfirm
+                && preventSelfTrade(aggressorLevel, aggressor, restingLevel, resting))
+            {
+                prevented = true;
+                return 0;
+            }
+
+            Order& buyOrder = bidIsAggressor ? aggressor : resting;
+            Order& sellOrder = bidIsAggressor ? resting : aggressor;
+
+            // Log matching order details
+            {
+                ENGINE_PROBE(FILL_LOG);
+                std::cout << "\nMatching orders found at "
+                    << std::put_time(std::localtime(&now_time_t), "%H:%M:%S") << ":\n"
+                    << "BID: " << buyOrder.idorder << " Price: "
+                    << std::fixed << std::setprecision(2) << buyOrder.price << "\n"
+                    << "ASK: " << sellOrder.idorder << " Price: "
+                    << sellOrder.price << std::endl;
+            }
+
+            // Record the trade and update order quantities and level totals
+            executeTrade(bidIsAggressor ? aggressorLevel : restingLevel, buyOrder,
+                         bidIsAggressor ? restingLevel : aggressorLevel, sellOrder,
+                         tradePrice, tradeQuantity, now);
+            tradesExecuted++;
+
+            // Log trade execution details
+            std::cout << "Executed trade: " << tradeQuantity
+                << " units at price " << tradePrice << std::endl;
+            return tradeQuantity;
+        };
+
+        int executed = Allocation::allocate(restingLevel, aggressor.quantity, lotSize, fill);
+
+        // Fills away from the front leave exhausted orders inside the level
+        if (!Allocation::FRONT_ONLY)
+        {
+            sweepExhaustedOrders(bidIsAggressor ? OrderType::ASK : OrderType::BID, restingLevel);
+        }
+
+        // Remove fully executed orders
+        cleanupExecutedOrders();
+        if (executed == 0 && !prevented)
+        {
+            break;
+        }
+
+        // Triggered stops join this cycle as new aggressors
+        activateTriggeredStops(tradePrice);
+    }
+
+    discardUnfilledMarketOrders();
+    return tradesExecuted;
+}
+
+/**
+ * @brief Records a trade between a buy order and a sell order
+ *
+ * @param bidLevel Level holding the buy order
+ * @param bidOrder The buy order
+ * @param askLevel Level holding the sell order
+ * @param askOrder The sell order
+ * @param price Execution price
+ * @param quantity Executed quantity
+ * @param now Execution timestamp
+ *
+ * Appends the trade to the history, updates the session statistics and
+ * bars, notifies the matching engine and reduces both orders and their
+ * level totals.
+ */
+void OrderBook::executeTrade(PriceLevel& bidLevel, Order& bidOrder, PriceLevel& askLevel, Order& askOrder,
+                             double price, int quantity, std::chrono::system_clock::time_point now)
+{
+    ENGINE_PROBE(EXECUTE_TRADE);
+    touchLevel(OrderType::BID, bidOrder.price);
+    touchLevel(OrderType::ASK, askOrder.price);
+
+    // Create trade record
+    Trade trade;
+    trade.tradeId = nextTradeId++;
+    trade.buyOrderId = bidOrder.idorder;
+    trade.sellOrderId = askOrder.idorder;
+    trade.buyFirmId = bidOrder.idfirm;
+    trade.sellFirmId = askOrder.idfirm;
+    trade.marketIdentificationCode = bidOrder.marketIdentificationCode;
+    trade.tradingCurrency = bidOrder.tradingCurrency;
+    trade.price = price;
+    trade.quantity = quantity;
+    trade.timestamp = now;
+
+    // Record and notify about the trade
+    std::int64_t notional = TradingStats::toNotional(price, quantity);
+    tradeStats.record(price, quantity, notional);
+    FirmTradeStats& buyer = firmStats[trade.buyFirmId];
+    buyer.boughtQuantity += quantity;
+    buyer.notional += notional;
+    ++buyer.tradeCount;
+    FirmTradeStats& seller = firmStats[trade.sellFirmId];
+    seller.soldQuantity += quantity;
+    seller.notional += notional;
+    if (trade.sellFirmId != trade.buyFirmId)
+    {
+        ++seller.tradeCount;
+    }
+    secondBars.record(now, price, quantity, notional);
+    minuteBars.record(now, price, quantity, notional);
+    trades.push_back(trade);
+    notifyMatch(trades.back());
+    publishOrderEvent(L3MessageType::EXECUTE_ORDER, bidOrder, price, quantity, trade.tradeId);
+    publishOrderEvent(L3MessageType::EXECUTE_ORDER, askOrder, price, quantity, trade.tradeId);
+
+    // Update remaining order quantities and level totals
+    bidLevel.fill(bidOrder, quantity);
+    askLevel.fill(askOrder, quantity);
+}
+
+/**
+ * @brief Selects how the aggressor quantity is allocated at the touch
+ *
+ * @param algorithm FIFO, PRO_RATA or PRICE_TIME_PRO_RATA
+ * @param instrumentLotSize Lot size used to round pro-rata shares
+ */
+void OrderBook::setAllocation(AllocationAlgorithm algorithm, int instrumentLotSize)
+{
+    std::lock_guard<std::mutex> lock(displayMutex);
+    allocationAlgorithm = algorithm;
+    lotSize = instrumentLotSize > 0 ? instrumentLotSize : 1;
+}
+
+/**
+ * @brief Switches the book between continuous trading and auction call
+ *
+ * @param phase New trading phase
+ */
+void OrderBook::setTradingPhase(TradingPhase phase)
+{
+    std::lock_guard<std::mutex> lock(displayMutex);
+    tradingPhase = phase;
+}
+
+/**
+ * @brief Computes the indicative equilibrium price of an auction call
+ *
+ * @param referencePrice Reference price used as the last tie-breaker
+ * @return AuctionResult Uncrossing price, executable volume and imbalance
+ *
+ * Takes the book lock, so any thread may publish an indicative price
+ * while the engine thread collects orders.
+ */
+AuctionResult OrderBook::computeUncrossingPrice(double referencePrice) const
+{
+    std::lock_guard<std::mutex> lock(displayMutex);
+    return findUncrossingPrice(referencePrice);
+}
+
+/**
+ * @brief Computes the equilibrium price of an auction call, book lock held
+ *
+ * @param referencePrice Reference price used as the last tie-breaker
+ * @return AuctionResult Uncrossing price, executable volume and imbalance
+ *
+ * The candidate prices are the limit prices of both sides. Bid levels are
+ * walked from the lowest price upwards and ask levels from the lowest
+ * price upwards in a single merged pass, so that at each candidate p:
+ * - demand(p) = quantity bid at p or higher (total bid minus what is below p)
+ * - supply(p) = quantity offered at p or lower
+ * The selected price maximises min(demand, supply), then minimises
+ * |demand - supply|, then is closest to the reference price. Market
+ * orders count on every candidate; icebergs count with their reserve.
+ * The caller holds the book lock.
+ */
+AuctionResult OrderBook::findUncrossingPrice(double referencePrice) const
+{
+    // Cumulative depth arrays, in ascending price order for both sides
+    std::vector<std::pair<double, long long> > bidDepth;
+    std::vector<std::pair<double, long long> > askDepth;
+    bidDepth.reserve(bidOrders.size());
+    askDepth.reserve(askOrders.size());
+
+    long long marketBid = 0;
+    long long totalBid = 0;
+    for (auto it = bidOrders.rbegin(); it != bidOrders.rend(); ++it)
+    {
+        long long quantity = it->second.getTotalQuantity() + it->second.getHiddenQuantity();
+        totalBid += quantity;
+        if (it->first == BidSide::MARKET_PRICE)
+        {
+            marketBid = quantity;
+            continue;
+        }
+        bidDepth.emplace_back(it->first, quantity);
+    }
+
+    long long cumulativeAsk = 0;
+    for (const auto& [price, level] : askOrders)
+    {
+        cumulativeAsk += level.getTotalQuantity() + level.getHiddenQuantity();
+        if (price == AskSide::MARKET_PRICE)
+        {
+            continue;
+        }
+        askDepth.emplace_back(price, cumulativeAsk);
+    }
+    long long marketAsk = askOrders.empty() || askOrders.begin()->first != AskSide::MARKET_PRICE
+                              ? 0
+                              : askOrders.begin()->second.getTotalQuantity() +
+                              askOrders.begin()->second.getHiddenQuantity();
+
+    AuctionResult best{false, referencePrice, 0, 0};
+    std::size_t bidIndex = 0;
+    std::size_t askIndex = 0;
+    long long bidBelow = 0; // Limit bid quantity strictly below the candidate price
+    long long supply = marketAsk; // Offered quantity at or below the candidate price
+
+    while (bidIndex < bidDepth.size() || askIndex < askDepth.size())
+    {
+        // Next candidate price in ascending order across both sides
+        double price;
+        if (askIndex >= askDepth.size() ||
+            (bidIndex < bidDepth.size() && bidDepth[bidIndex].first < askDepth[askIndex].first))
+        {
+            price = bidDepth[bidIndex].first;
+        }
+        else
+        {
+            price = askDepth[askIndex].first;
+        }
+
+        if (askIndex < askDepth.size() && askDepth[askIndex].first == price)
+        {
+            supply = askDepth[askIndex++].second;
+        }
+        long long demand = totalBid - bidBelow;
+        if (bidIndex < bidDepth.size() && bidDepth[bidIndex].first == price)
+        {
+            bidBelow += bidDepth[bidIndex++].second;
+        }
+
+        long long volume = std::min(demand, supply);
+        long long imbalance = demand > supply ? demand - supply : supply - demand;
+        if (volume <= 0)
+        {
+            continue;
+        }
+
+        bool better = !best.crossed || volume > best.volume ||
+            (volume == best.volume && imbalance < best.imbalance) ||
+            (volume == best.volume && imbalance == best.imbalance &&
+                std::fabs(price - referencePrice) < std::fabs(best.price - referencePrice));
+        if (better)
+        {
+            best = {true, price, volume, imbalance};
+        }
+    }
+
+    // Only market orders on both sides: they uncross at the reference price
+    if (!best.crossed && marketBid > 0 && marketAsk > 0)
+    {
+        long long volume = std::min(marketBid, marketAsk);
+        best = {true, referencePrice, volume, std::max(marketBid, marketAsk) - volume};
+    }
+
+    return best;
+}
+
+/**
+ * @brief Ends an auction call by executing all fills at one price
+ *
+ * @param referencePrice Reference price of the instrument (Instrument::refprice)
+ * @return AuctionResult The uncrossing price and executed volume
+ *
+ * Computes the equilibrium price, then executes the crossing orders in
+ * price-time priority at that price in one batch, and switches the book
+ * back to continuous trading. Stops triggered by the uncrossing price
+ * are activated; the next matchOrders cycle processes them and cancels
+ * what is left of market orders.
+ */
+AuctionResult OrderBook::uncrossAuction(double referencePrice)
+{
+    std::lock_guard<std::mutex> lock(displayMutex);
+
+    AuctionResult result = findUncrossingPrice(referencePrice);
+    tradingPhase = TradingPhase::CONTINUOUS;
+    if (!result.crossed)
+    {
+        return result;
+    }
+
+    auto now = clock->now();
+    long long remaining = result.volume;
+    int fills = 0;
+
+    while (remaining > 0 && !bidOrders.empty() && !askOrders.empty() &&
+        BidSide::crosses(bidOrders.begin()->first, result.price) &&
+        AskSide::crosses(askOrders.begin()->first, result.price))
+    {
+        PriceLevel& bidLevel = bidOrders.begin()->second;
+        PriceLevel& askLevel = askOrders.begin()->second;
+
+        if (bidLevel.front().idfirm == askLevel.front().idfirm && preventSelfTrade(bidLevel, askLevel))
+        {
+            cleanupExecutedOrders();
+            continue;
+        }
+
+        int quantity = static_cast<int>(std::min<long long>(
+            remaining, std::min(bidLevel.front().quantity, askLevel.front().quantity)));
+        executeTrade(bidLevel, bidLevel.front(), askLevel, askLevel.front(), result.price, quantity, now);
+        remaining -= quantity;
+        fills++;
+        cleanupExecutedOrders();
+    }
+
+    result.volume -= remaining;
+    std::cout << "Auction uncrossed at " << std::fixed << std::setprecision(2) << result.price
+        << ": " << result.volume << " units in " << fills << " trades" << std::endl;
+
+    activateTriggeredStops(result.price);
+    publishBookChanges();
+    return result;
+}
+
+/**
+ * @brief Removes or replenishes exhausted orders anywhere in a level
+ *
+ * @param side Side of the level
+ * @param level Level whose orders were filled by a pro-rata allocation
+ *
+ * Exhausted icebergs with a reserve are replenished and moved to the
+ * back, other exhausted orders are removed. An empty level is left for
+ * cleanupExecutedOrders.
+ */
+void OrderBook::sweepExhaustedOrders(OrderType side, PriceLevel& level)
+{
+    auto now = clock->now();
+    visitSide(side, [this, &level, now](auto& orders)
+    {
+        orders.sweepExhausted(level, now,
+            [this](const Order& order)
+            {
+                orderIndex.erase(order.idorder);
+            },
+            [this](const Order& order)
+            {
+                publishOrderEvent(L3MessageType::ADD_ORDER, order, order.price, order.quantity);
+            });
+    });
+}
+
+/**
+ * @brief Removes orders with zero remaining quantity
+ *
+ * Only the front orders of the best levels take part in a trade, so
+ * cleanup handles exhausted orders at the head of those levels:
+ * - Iceberg orders with a reserve get a new peak and move to the back
+ *   of their level, keeping their entry sequence
+ * - Other exhausted orders are removed
+ * - Levels that became empty are removed
+ */
+void OrderBook::cleanupExecutedOrders()
+{
+    auto now = clock->now();
+    auto unindex = [this](const Order& order)
+    {
+        orderIndex.erase(order.idorder);
+    };
+    auto replenished = [this](const Order& order)
+    {
+        publishOrderEvent(L3MessageType::ADD_ORDER, order, order.price, order.quantity);
+    };
+    bidOrders.cleanupFront(now, unindex, replenished);
+    askOrders.cleanupFront(now, unindex, replenished);
+}
+
+/**
+ * @brief Removes GTD orders whose expiration date has passed
+ *
+ * @param now Current time
+ * @return int Number of orders removed
+ *
+ * Scans every level of both sides, removing expired orders
+ * through the level so that its totals stay consistent, and
+ * erases levels left empty. Untriggered stop orders expire too.
+ */
+int OrderBook::removeExpiredOrders(std::chrono::system_clock::time_point now)
+{
+    std::lock_guard<std::mutex> lock(displayMutex);
+    int expiredOrders = 0;
+
+    auto isExpired = [this, now](const Order& order)
     {
-        bidOrders[order.price].push_back(order);
-    }
-    // Insert ASK orders into askOrders map
-    else if (order.ordertype == OrderType::ASK)
+        if (order.timeinforce == TimeInForce::GTD && order.expirationDate <= now)
+        {
+            std::cout << "Removing expired GTD order ID: " << order.idorder << std::endl;
+            if (!order.isStop())
+            {
+                touchLevel(order.ordertype, order.price);
+                publishOrderEvent(L3MessageType::CANCEL_ORDER, order, order.price, order.quantity);
+            }
+            orderIndex.erase(order.idorder);
+            return true;
+        }
+        return false;
+    };
+
+    // Remove expired BID and ASK orders
+    expiredOrders += bidOrders.removeIf(isExpired);
+    expiredOrders += askOrders.removeIf(isExpired);
+
+    // Remove expired untriggered stop orders
+    auto removeExpiredStops = [&expiredOrders, &isExpired](auto& stops)
     {
-        askOrders[order.price].push_back(order);
-    }
+        for (auto it = stops.begin(); it != stops.end();)
+        {
+            if (isExpired(it->second))
+            {
+                it = stops.erase(it);
+                expiredOrders++;
+            }
+            else
+            {
+                ++it;
+            }
+        }
+    };
+    removeExpiredStops(buyStopOrders);
+    removeExpiredStops(sellStopOrders);
+
+    publishBookChanges();
+    return expiredOrders;
 }
 
 /**
- * @brief Attempts to match BID and ASK orders
+ * @brief Connects the book to a Level 2 market data feed
  *
- * @return int Number of trades executed
+ * @param publisher Feed receiving the level deltas, nullptr to disconnect
+ * @param idinstrument Instrument identifier stamped on the messages
+ * @param idbook Feed identifier of the book
+ */
+void OrderBook::setMarketDataPublisher(MarketDataPublisher* publisher, int idinstrument, int idbook)
+{
+    std::lock_guard<std::mutex> lock(displayMutex);
+    marketData = publisher;
+    instrumentId = idinstrument;
+    bookId = idbook;
+    touchedLevels.clear();
+}
+
+/**
+ * @brief Connects the book to the Level 3 order-by-order feed
  *
- * Implements the core order matching algorithm:
- * - Matches orders across price levels
- * - Executes trades when matching conditions are met
- * - Handles partial order fulfillment
- * - Cleans up fully executed orders
+ * @param feed Open feed receiving the order events, nullptr to disconnect
  */
-int OrderBook::matchOrders()
+void OrderBook::setOrderFeed(OrderFeed* feed)
 {
-    int tradesExecuted = 0;
     std::lock_guard<std::mutex> lock(displayMutex);
+    orderFeed = feed;
+}
 
-    while (!bidOrders.empty() && !askOrders.empty())
+/**
+ * @brief Publishes one order event on the Level 3 feed
+ *
+ * @param type Message type
+ * @param order Order concerned by the event
+ * @param price Order or execution price
+ * @param quantity Quantity, meaning depends on the message type
+ * @param matchId Trade identifier for executions
+ *
+ * Called under the book lock, so the events of one book appear in the
+ * feed in the order they happened. Events are stamped with the clock of
+ * the book, so a replay under a simulated clock reproduces the feed.
+ */
+void OrderBook::publishOrderEvent(L3MessageType type, const Order& order, double price, long long quantity,
+                                  int matchId)
+{
+    if (!orderFeed || order.limitType == LimitType::NONE)
     {
-        auto highestBidIt = bidOrders.begin();
-        auto lowestAskIt = askOrders.begin();
+        return;
+    }
+    orderFeed->publish(type, clock->now(), instrumentId, bookId, order, price, quantity, matchId);
+}
 
-        // Stop matching if lowest ask price exceeds highest bid price
-        if (highestBidIt->first < lowestAskIt->first)
+/**
+ * @brief Records the state of a level about to be changed
+ *
+ * @param side Side of the level
+ * @param price Level price
+ *
+ * A mutation touches a handful of levels at most, so a linear
+ * search of the recorded levels is cheaper than any lookup table.
+ */
+void OrderBook::touchLevel(OrderType side, double price)
+{
+    if (!marketData)
+    {
+        return;
+    }
+    for (const auto& touched : touchedLevels)
+    {
+        if (touched.side == side && touched.price == price)
         {
-            break;
+            return;
         }
+    }
+
+    TouchedLevel touched{side, price, false, 0, 0, 0};
+    visitSide(side, [&touched](const auto& orders)
+    {
+        auto it = orders.find(touched.price);
+        if (it != orders.end())
+        {
+            touched.existed = true;
+            touched.quantity = it->second.getTotalQuantity();
+            touched.orderCount = it->second.getOrderCount();
+        }
+    });
+    touchedLevels.push_back(touched);
+}
+
+/**
+ * @brief Publishes one delta per level changed since the last call
+ *
+ * Called at the end of every public mutation, under the book lock,
+ * so the deltas of a book are published in the order they happened.
+ */
+void OrderBook::publishLevelChanges()
+{
+    if (!marketData)
+    {
+        return;
+    }
 
-        bool matchFound = false;
-        for (auto& bidOrder : highestBidIt->second)
+    std::uint64_t sequence = 0;
+    int published = 0;
+    for (auto& touched : touchedLevels)
+    {
+        visitSide(touched.side, [this, &touched, &sequence, &published](const auto& orders)
         {
-            for (auto& askOrder : lowestAskIt->second)
+            touched.change = 0;
+
+            // Market orders never rest, their key is not a price
+            if (touched.price == orders.MARKET_PRICE)
+            {
+                return;
+            }
+
+            auto it = orders.find(touched.price);
+            if (it == orders.end())
             {
-                // Verify order compatibility (instrument, market, currency)
-                if (bidOrder.idinstrument == askOrder.idinstrument &&
-                    bidOrder.marketIdentificationCode == askOrder.marketIdentificationCode &&
-                    bidOrder.tradingCurrency == askOrder.tradingCurrency)
+                if (touched.existed)
                 {
-                    auto now = std::chrono::system_clock::now();
-                    auto now_time_t = std::chrono::system_clock::to_time_t(now);
-
-                    // Log matching order details
-                    std::cout << "\nMatching orders found at "
-                        << std::put_time(std::localtime(&now_time_t), "%H:%M:%S") << ":\n"
-                        << "BID: " << bidOrder.idorder << " Price: "
-                        << std::fixed << std::setprecision(2) << bidOrder.price << "\n"
-                        << "ASK: " << askOrder.idorder << " Price: "
-                        << askOrder.price << std::endl;
-
-                    // Determine trade quantity (minimum of bid and ask quantities)
-                    int tradeQuantity = std::min(bidOrder.quantity, askOrder.quantity);
-
-                    // Create trade record
-                    Trade trade;
-                    trade.tradeId = nextTradeId++;
-                    trade.buyOrderId = bidOrder.idorder;
-                    trade.sellOrderId = askOrder.idorder;
-                    trade.marketIdentificationCode = bidOrder.marketIdentificationCode;
-                    trade.tradingCurrency = bidOrder.tradingCurrency;
-                    trade.price = askOrder.price;
-                    trade.quantity = tradeQuantity;
-                    trade.timestamp = now;
-
-                    // Record and notify about the trade
-                    trades.push_back(trade);
-                    notifyMatch(trade);
-
-                    // Update remaining order quantities
-                    bidOrder.quantity -= tradeQuantity;
-                    askOrder.quantity -= tradeQuantity;
-
-                    tradesExecuted++;
-                    matchFound = true;
-
-                    // Log trade execution details
-                    std::cout << "Executed trade: " << tradeQuantity
-                        << " units at price " << trade.price << std::endl;
-
-                    // Stop processing if either order is fully executed
-                    if (bidOrder.quantity == 0 || askOrder.quantity == 0)
-                    {
-                        break;
-                    }
+                    touched.change = static_cast<std::uint8_t>(L2MessageType::DELETE_LEVEL);
+                    sequence = marketData->publishLevel(instrumentId, bookId, L2MessageType::DELETE_LEVEL,
+                                                        orders.SIDE, touched.price, 0, 0);
+                    published++;
                 }
+                return;
             }
-            if (matchFound) break;
-        }
 
-        // Remove fully executed orders
-        cleanupExecutedOrders();
-        if (!matchFound) break;
+            long long quantity = it->second.getTotalQuantity();
+            int orderCount = it->second.getOrderCount();
+            if (!touched.existed)
+            {
+                touched.change = static_cast<std::uint8_t>(L2MessageType::ADD_LEVEL);
+            }
+            else if (quantity != touched.quantity || orderCount != touched.orderCount)
+            {
+                touched.change = static_cast<std::uint8_t>(L2MessageType::UPDATE_LEVEL);
+            }
+            else
+            {
+                return;
+            }
+            touched.quantity = quantity;
+            touched.orderCount = orderCount;
+            sequence = marketData->publishLevel(instrumentId, bookId, static_cast<L2MessageType>(touched.change),
+                                                orders.SIDE, touched.price, quantity, orderCount);
+            published++;
+        });
     }
 
-    return tradesExecuted;
+    if (published > 0)
+    {
+        publishConflatedImage(sequence, published);
+    }
+    touchedLevels.clear();
 }
 
 /**
- * @brief Removes orders with zero remaining quantity
+ * @brief Applies the deltas of a mutation to the conflated image of the book
+ *
+ * @param sequence Feed sequence of the last delta published
+ * @param published Number of deltas published by the mutation
  *
- * Cleans up both BID and ASK order containers by:
- * - Removing orders with zero quantity
- * - Removing empty price levels
+ * Keeps up with the feed by construction: the image is written in place
+ * once per mutation, whatever the number of deltas, so conflation
+ * happens here and not on the consumer's thread. Most deltas change the
+ * quantity of a level already in the image and cost a scan of at most
+ * CONFLATED_DEPTH prices; the levels of a side are walked again only
+ * when one enters or leaves the image.
  */
-void OrderBook::cleanupExecutedOrders()
+void OrderBook::publishConflatedImage(std::uint64_t sequence, int published)
 {
-    // Clean up BID orders
-    for (auto it = bidOrders.begin(); it != bidOrders.end();)
+    conflatedUpdates += static_cast<std::uint64_t>(published);
+
+    auto bestLevels = [](const auto& orders, DepthLevel* levels)
     {
-        it->second.erase(
-            std::remove_if(it->second.begin(), it->second.end(),
-                           [](const Order& o) { return o.quantity == 0; }),
-            it->second.end()
-        );
-        if (it->second.empty())
+        std::int32_t count = 0;
+        for (const auto& [price, level] : orders)
         {
-            it = bidOrders.erase(it);
+            if (static_cast<std::size_t>(count) == CONFLATED_DEPTH)
+            {
+                break;
+            }
+            if (price != orders.MARKET_PRICE)
+            {
+                levels[count++] = {price, level.getTotalQuantity(), level.getOrderCount()};
+            }
         }
-        else
+        return count;
+    };
+
+    marketData->updateImage(bookId, [&](ConflatedBook& image)
+    {
+        // The first image of the book is built from scratch
+        bool rebuildBids = image.bookId != bookId;
+        bool rebuildAsks = rebuildBids;
+
+        for (const auto& touched : touchedLevels)
         {
-            ++it;
+            bool bid = touched.side == OrderType::BID;
+            bool& rebuild = bid ? rebuildBids : rebuildAsks;
+            if (touched.change == 0 || rebuild)
+            {
+                continue;
+            }
+
+            DepthLevel* levels = bid ? image.bids : image.asks;
+            DepthLevel* end = levels + (bid ? image.bidLevels : image.askLevels);
+            DepthLevel* found = std::find_if(levels, end, [&touched](const DepthLevel& level)
+            {
+                return level.price == touched.price;
+            });
+
+            if (found != end)
+            {
+                if (touched.change == static_cast<std::uint8_t>(L2MessageType::UPDATE_LEVEL))
+                {
+                    found->quantity = touched.quantity;
+                    found->orderCount = touched.orderCount;
+                }
+                else
+                {
+                    rebuild = true;
+                }
+            }
+            else if (touched.change == static_cast<std::uint8_t>(L2MessageType::ADD_LEVEL))
+            {
+                // A new level enters the image if the side is short or it beats the worst level shown
+                rebuild = static_cast<std::size_t>(end - levels) < CONFLATED_DEPTH ||
+                    (bid ? touched.price > (end - 1)->price : touched.price < (end - 1)->price);
+            }
         }
+
+        if (rebuildBids)
+        {
+            image.bidLevels = bestLevels(bidOrders, image.bids);
+        }
+        if (rebuildAsks)
+        {
+            image.askLevels = bestLevels(askOrders, image.asks);
+        }
+        image.sequence = sequence;
+        image.updates = conflatedUpdates;
+        image.instrumentId = instrumentId;
+        image.bookId = bookId;
+    });
+}
+
+/**
+ * @brief Sets the slot where the book publishes its top of book
+ *
+ * @param slot Seqlock-protected slot, nullptr to stop publishing
+ */
+void OrderBook::setTopOfBook(SeqLock<TopOfBook>* slot)
+{
+    std::lock_guard<std::mutex> lock(displayMutex);
+    topOfBook = slot;
+    publishTopOfBook();
+}
+
+/**
+ * @brief Writes the current best prices and book totals to the top of book slot
+ *
+ * A handful of loads and one seqlock store: the best limit level of
+ * each side is the first or second entry of its map, and the level and
+ * order counts are running totals.
+ */
+void OrderBook::publishTopOfBook()
+{
+    if (!topOfBook)
+    {
+        return;
     }
 
-    // Clean up ASK orders
-    for (auto it = askOrders.begin(); it != askOrders.end();)
+    TopOfBook top{};
+    top.sequence = ++topOfBookSequence;
+    top.instrumentId = instrumentId;
+    top.bookId = bookId;
+
+    auto bestLevel = [](const auto& orders, double& price, long long& quantity)
     {
-        it->second.erase(
-            std::remove_if(it->second.begin(), it->second.end(),
-                           [](const Order& o) { return o.quantity == 0; }),
-            it->second.end()
-        );
-        if (it->second.empty())
+        auto it = orders.begin();
+        if (it != orders.end() && it->first == orders.MARKET_PRICE)
         {
-            it = askOrders.erase(it);
+            ++it;
         }
-        else
+        if (it != orders.end())
         {
-            ++it;
+            price = it->first;
+            quantity = it->second.getTotalQuantity();
         }
+    };
+    bestLevel(bidOrders, top.bidPrice, top.bidQuantity);
+    bestLevel(askOrders, top.askPrice, top.askQuantity);
+
+    if (const Trade* lastTrade = getLastTrade())
+    {
+        top.lastTradePrice = lastTrade->price;
+        top.lastTradeQuantity = lastTrade->quantity;
+    }
+    top.bidLevels = static_cast<int>(bidOrders.size());
+    top.askLevels = static_cast<int>(askOrders.size());
+    top.bidOrders = bidOrders.getOrderCount();
+    top.askOrders = askOrders.getOrderCount();
+
+    topOfBook->store(top);
+}
+
+/**
+ * @brief Publishes the Level 2 deltas and the top of book of a mutation
+ */
+void OrderBook::publishBookChanges()
+{
+    ENGINE_PROBE(PUBLISH);
+    if (publishLatency == nullptr || (marketData == nullptr && topOfBook == nullptr))
+    {
+        publishLevelChanges();
+        publishTopOfBook();
+        return;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    publishLevelChanges();
+    publishTopOfBook();
+    publishLatency->recordElapsed(std::chrono::steady_clock::now() - start);
+}
+
+/**
+ * @brief Publishes a full Level 2 snapshot of the book
+ *
+ * Bid levels then ask levels, best prices first. Consumers that join
+ * late or were overrun rebuild the instrument from the next snapshot.
+ */
+void OrderBook::publishSnapshot()
+{
+    std::lock_guard<std::mutex> lock(displayMutex);
+    if (!marketData)
+    {
+        return;
     }
+
+    auto publishSide = [this](const auto& orders)
+    {
+        for (const auto& [price, level] : orders)
+        {
+            if (price != orders.MARKET_PRICE)
+            {
+                marketData->publishLevel(instrumentId, bookId, L2MessageType::SNAPSHOT_LEVEL, orders.SIDE,
+                                         price, level.getTotalQuantity(), level.getOrderCount());
+            }
+        }
+    };
+
+    // Resting market orders have no price level to publish
+    auto publishedLevels = [](const auto& orders)
+    {
+        bool market = !orders.empty() && orders.begin()->first == orders.MARKET_PRICE;
+        return static_cast<int>(orders.size()) - (market ? 1 : 0);
+    };
+
+    int levelCount = publishedLevels(bidOrders) + publishedLevels(askOrders);
+    marketData->publishSnapshotMarker(instrumentId, bookId, L2MessageType::SNAPSHOT_BEGIN, levelCount);
+    publishSide(bidOrders);
+    publishSide(askOrders);
+    marketData->publishSnapshotMarker(instrumentId, bookId, L2MessageType::SNAPSHOT_END, levelCount);
+}
+
+/**
+ * @brief Returns the aggregated best levels of one side of the book
+ *
+ * @param side BID or ASK side
+ * @param maxLevels Maximum number of levels to return
+ * @return std::vector<DepthLevel> Levels ordered from the best price outwards
+ *
+ * Reads the running totals of each level, so the cost depends on
+ * the number of levels returned, not on the number of orders. Takes the
+ * book lock, like the other readers, so any thread may call it.
+ */
+std::vector<DepthLevel> OrderBook::getDepth(OrderType side, std::size_t maxLevels) const
+{
+    std::lock_guard<std::mutex> lock(displayMutex);
+    return visitSide(side, [maxLevels](const auto& orders)
+    {
+        return orders.getDepth(maxLevels);
+    });
+}
+
+/**
+ * @brief Returns the total quantity resting at a given price
+ *
+ * @param side BID or ASK side
+ * @param price Price of the level
+ * @return long long Resting quantity, 0 if the level does not exist
+ */
+long long OrderBook::getQuantityAtPrice(OrderType side, double price) const
+{
+    std::lock_guard<std::mutex> lock(displayMutex);
+    return visitSide(side, [price](const auto& orders)
+    {
+        return orders.getQuantityAtPrice(price);
+    });
+}
+
+/**
+ * @brief Returns the quantity an incoming order could execute against
+ *
+ * @param side Resting side to execute against (ASK for a buy order)
+ * @param limitPrice Limit price of the incoming order
+ * @return long long Executable quantity
+ *
+ * Walks the resting side from the best price and stops at the first
+ * level that no longer crosses the limit price. Iceberg reserves are
+ * executable and therefore counted.
+ */
+long long OrderBook::getAvailableQuantity(OrderType side, double limitPrice) const
+{
+    std::lock_guard<std::mutex> lock(displayMutex);
+    return visitSide(side, [limitPrice](const auto& orders)
+    {
+        return orders.getAvailableQuantity(limitPrice);
+    });
+}
+
+/**
+ * @brief Returns the number of orders resting on one side of the book
+ *
+ * @param side BID or ASK side
+ * @return int Number of resting orders
+ */
+int OrderBook::getOrderCount(OrderType side) const
+{
+    std::lock_guard<std::mutex> lock(displayMutex);
+    return visitSide(side, [](const auto& orders)
+    {
+        return orders.getOrderCount();
+    });
+}
+
+/**
+ * @brief Returns a copy of the resting GTD orders, taken under the book lock
+ *
+ * @return std::vector<Order> GTD orders in price-time priority, bids first
+ */
+std::vector<Order> OrderBook::getGTDOrders() const
+{
+    std::vector<Order> gtdOrders;
+
+    // Same scan for both sides, instantiated per side
+    auto collect = [&gtdOrders](const auto& orders)
+    {
+        for (const auto& [price, level] : orders)
+        {
+            for (const auto& order : level)
+            {
+                if (order.timeinforce == TimeInForce::GTD)
+                {
+                    gtdOrders.push_back(order);
+                }
+            }
+        }
+    };
+
+    std::lock_guard<std::mutex> lock(displayMutex);
+    collect(bidOrders);
+    collect(askOrders);
+    return gtdOrders;
 }
 
 /**
@@ -211,21 +1476,34 @@ void OrderBook::displayOrderBook() const
 {
     std::cout << "\n\n============== ORDER BOOK ==============\n\n";
 
-    std::cout << "\nBID Orders=====================\n";
-    for (const auto& bid : bidOrders)
+    auto displaySide = [](const auto& orders)
     {
-        std::cout << "Price LEVEL: " << std::fixed << std::setprecision(2) << bid.first << "\n";
-        for (const auto& order : bid.second)
+        for (const auto& [price, level] : orders)
         {
-            order.display();
+            std::cout << "Price LEVEL: " << std::fixed << std::setprecision(2) << price
+                << " (Qty: " << level.getTotalQuantity()
+                << ", Orders: " << level.getOrderCount() << ")\n";
+            for (const auto& order : level)
+            {
+                order.display();
+            }
         }
-    }
+    };
+
+    std::cout << "\nBID Orders=====================\n";
+    displaySide(bidOrders);
 
     std::cout << "\n\nASK Orders=====================\n";
-    for (const auto& ask : askOrders)
+    displaySide(askOrders);
+
+    if (!buyStopOrders.empty() || !sellStopOrders.empty())
     {
-        std::cout << "Price LEVEL: " << std::fixed << std::setprecision(2) << ask.first << "\n";
-        for (const auto& order : ask.second)
+        std::cout << "\n\nSTOP Orders====================\n";
+        for (const auto& [stopPrice, order] : buyStopOrders)
+        {
+            order.display();
+        }
+        for (const auto& [stopPrice, order] : sellStopOrders)
         {
             order.display();
         }
@@ -289,3 +1567,54 @@ const Trade* OrderBook::getLastTrade() const
 {
     return trades.empty() ? nullptr : &trades.back();
 }
+
+/**
+ * @brief Returns a copy of the session statistics, taken under the book lock
+ */
+InstrumentTradeStats OrderBook::getTradeStats() const
+{
+    std::lock_guard<std::mutex> lock(displayMutex);
+    return tradeStats;
+}
+
+/**
+ * @brief Returns a copy of the latest bars, taken under the book lock
+ *
+ * @param period SECOND or MINUTE
+ * @param maxCount Maximum number of bars returned
+ */
+std::vector<TradeBar> OrderBook::getBars(BarPeriod period, std::size_t maxCount) const
+{
+    std::lock_guard<std::mutex> lock(displayMutex);
+    return (period == BarPeriod::SECOND ? secondBars : minuteBars).getBars(maxCount);
+}
+
+/**
+ * @brief Adds the firm volumes of the book to totals, under the book lock
+ *
+ * @param totals Figures per firm identifier, summed over the books
+ */
+void OrderBook::addFirmStats(std::unordered_map<int, FirmTradeStats>& totals) const
+{
+    std::lock_guard<std::mutex> lock(displayMutex);
+    for (const auto& [idfirm, firm] : firmStats)
+    {
+        totals[idfirm].add(firm);
+    }
+}
+
+/**
+ * @brief Clears the session statistics and the firm volumes
+ *
+ * Firm entries are zeroed rather than erased, so that the firms that
+ * traded the previous day do not allocate again on their first fill.
+ */
+void OrderBook::resetTradeStats()
+{
+    std::lock_guard<std::mutex> lock(displayMutex);
+    tradeStats = InstrumentTradeStats();
+    for (auto& [idfirm, firm] : firmStats)
+    {
+        firm = FirmTradeStats();
+    }
+}
@@ -0,0 +1,371 @@
+/**
+ * @file OrderEntryProtocol.cpp
+ * @brief Implementation of the binary order entry codec
+ */
+
+#include "OrderEntryProtocol.hpp"
+#include <cmath>
+#include <cstring>
+
+namespace
+{
+    /**
+     * @brief Returns the fixed length of a message type, 0 if the type is unknown
+     */
+    std::size_t messageLength(std::uint8_t type)
+    {
+        switch (static_cast<EntryMessageType>(type))
+        {
+        case EntryMessageType::LOGON:
+            return sizeof(LogonMessage);
+        case EntryMessageType::NEW_ORDER:
+            return sizeof(NewOrderMessage);
+        case EntryMessageType::CANCEL_ORDER:
+            return sizeof(CancelOrderMessage);
+        case EntryMessageType::AMEND_ORDER:
+            return sizeof(AmendOrderMessage);
+        case EntryMessageType::ACK:
+            return sizeof(AckMessage);
+        case EntryMessageType::REJECT:
+            return sizeof(RejectMessage);
+        }
+        return 0;
+    }
+
+    /**
+     * @brief True if a reserved field is all zero
+     */
+    template <std::size_t N>
+    bool isZero(const std::uint8_t (&reserved)[N])
+    {
+        for (std::uint8_t byte : reserved)
+        {
+            if (byte != 0)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @brief True if a price is a finite, non-negative number
+     */
+    bool isValidPrice(double price)
+    {
+        return std::isfinite(price) && price >= 0.0;
+    }
+
+    /**
+     * @brief True if a byte is the type of a client request
+     */
+    bool isRequestType(std::uint8_t type)
+    {
+        return type == static_cast<std::uint8_t>(EntryMessageType::LOGON) ||
+            type == static_cast<std::uint8_t>(EntryMessageType::NEW_ORDER) ||
+            type == static_cast<std::uint8_t>(EntryMessageType::CANCEL_ORDER) ||
+            type == static_cast<std::uint8_t>(EntryMessageType::AMEND_ORDER);
+    }
+
+    /**
+     * @brief Checks the fields of a decoded message
+     *
+     * @param message Message whose header has already been checked
+     * @return true if every field holds a legal value
+     */
+    bool isValidBody(const EntryMessage& message)
+    {
+        switch (message.type)
+        {
+        case EntryMessageType::LOGON:
+            return message.logon.idfirm > 0 && isZero(message.logon.reserved);
+        case EntryMessageType::NEW_ORDER:
+        {
+            const NewOrderMessage& m = message.newOrder;
+            return (m.side == 'B' || m.side == 'S') &&
+                m.timeInForce <= static_cast<std::uint8_t>(TimeInForce::DAY) &&
+                m.limitType <= static_cast<std::uint8_t>(LimitType::NONE) &&
+                m.stopType <= static_cast<std::uint8_t>(StopType::STOP_LIMIT) &&
+                m.quantity > 0 && m.peakSize >= 0 && m.peakSize <= m.quantity &&
+                isValidPrice(m.price) && isValidPrice(m.stopPrice) && isZero(m.reserved);
+        }
+        case EntryMessageType::CANCEL_ORDER:
+            return isZero(message.cancel.reserved);
+        case EntryMessageType::AMEND_ORDER:
+            return message.amend.newQuantity > 0 && isValidPrice(message.amend.newPrice);
+        case EntryMessageType::ACK:
+            return isRequestType(message.ack.requestType) && isZero(message.ack.reserved);
+        case EntryMessageType::REJECT:
+            return message.reject.reason <= static_cast<std::uint8_t>(RejectReason::NOT_AUTHORISED) &&
+                isZero(message.reject.reserved);
+        }
+        return false;
+    }
+
+    /**
+     * @brief Converts a time point to nanoseconds since the epoch
+     */
+    std::uint64_t toNanoseconds(std::chrono::system_clock::time_point time)
+    {
+        return static_cast<std::uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count());
+    }
+}
+
+/**
+ * @brief Decodes the message at the front of a receive buffer
+ *
+ * @param data Start of the received bytes
+ * @param size Number of received bytes
+ * @param out Decoded message, valid when OK is returned
+ * @param consumed Bytes to drop from the buffer
+ * @return DecodeStatus Outcome of the decoding
+ *
+ * Every type has a fixed length, so a header whose length does not
+ * match its type means the stream is out of step and cannot be
+ * trusted any further.
+ */
+DecodeStatus decodeEntryMessage(const std::uint8_t* data, std::size_t size, EntryMessage& out,
+                                std::size_t& consumed)
+{
+    consumed = 0;
+    if (size < sizeof(EntryHeader))
+    {
+        return DecodeStatus::INCOMPLETE;
+    }
+
+    EntryHeader header;
+    std::memcpy(&header, data, sizeof(header));
+    std::size_t length = messageLength(header.type);
+    if (length == 0 || header.length != length)
+    {
+        return DecodeStatus::FRAMING_ERROR;
+    }
+    if (size < length)
+    {
+        return DecodeStatus::INCOMPLETE;
+    }
+
+    consumed = length;
+    out.type = static_cast<EntryMessageType>(header.type);
+    std::memcpy(static_cast<void*>(&out.header), data, length);
+    if (header.version != ORDER_ENTRY_VERSION || !isValidBody(out))
+    {
+        return DecodeStatus::MALFORMED;
+    }
+    return DecodeStatus::OK;
+}
+
+/**
+ * @brief Encodes a message into a send buffer
+ *
+ * @param message Message with a stamped header
+ * @param buffer Destination, at least header.length bytes
+ * @return std::size_t Number of bytes written, 0 for an unknown type
+ */
+std::size_t encodeEntryMessage(const EntryMessage& message, std::uint8_t* buffer)
+{
+    std::size_t length = messageLength(static_cast<std::uint8_t>(message.type));
+    std::memcpy(buffer, static_cast<const void*>(&message.header), length);
+    return length;
+}
+
+/**
+ * @brief Interns the MIC and currency of every instrument
+ *
+ * @param instrumentManager Instrument reference data
+ */
+void CodeTable::internInstruments(const InstrumentManager& instrumentManager)
+{
+    for (const Instrument& instrument : instrumentManager.getInstruments())
+    {
+        intern(instrument.marketIdentificationCode);
+        intern(instrument.tradingCurrency);
+    }
+}
+
+/**
+ * @brief Returns the code of a string, interning it if new
+ *
+ * @param value String to intern
+ * @return std::uint16_t Its code, 0 if the table is full
+ */
+std::uint16_t CodeTable::intern(const std::string& value)
+{
+    auto it = codes.find(value);
+    if (it != codes.end())
+    {
+        return it->second;
+    }
+    if (values.size() > UINT16_MAX)
+    {
+        return 0;
+    }
+    auto code = static_cast<std::uint16_t>(values.size());
+    values.push_back(value);
+    codes.emplace(value, code);
+    return code;
+}
+
+/**
+ * @brief Returns the code of a string, 0 if it is not interned
+ */
+std::uint16_t CodeTable::find(const std::string& value) const
+{
+    auto it = codes.find(value);
+    return it == codes.end() ? 0 : it->second;
+}
+
+/**
+ * @brief Returns the string of a code, nullptr if unknown
+ */
+const std::string* CodeTable::lookup(std::uint16_t code) const
+{
+    if (code == 0 || code >= values.size())
+    {
+        return nullptr;
+    }
+    return &values[code];
+}
+
+/**
+ * @brief Builds a NEW_ORDER message from an order
+ *
+ * @param order Order to send
+ * @param codes Interned codes
+ * @param sequence Sender sequence number
+ * @param out Encoded message
+ * @return true if the MIC and currency are interned
+ */
+bool makeNewOrder(const Order& order, const CodeTable& codes, std::uint32_t sequence, NewOrderMessage& out)
+{
+    out = NewOrderMessage{};
+    stampHeader(out, EntryMessageType::NEW_ORDER, sequence);
+    out.micCode = codes.find(order.marketIdentificationCode);
+    out.currencyCode = codes.find(order.tradingCurrency);
+    out.price = order.price;
+    out.stopPrice = order.stopPrice;
+    out.expiration = order.timeinforce == TimeInForce::GTD ? toNanoseconds(order.expirationDate) : 0;
+    out.idorder = order.idorder;
+    out.idinstrument = order.idinstrument;
+    out.idfirm = order.idfirm;
+    out.quantity = order.quantity + order.hiddenQuantity;
+    out.peakSize = order.peakSize;
+    out.side = order.ordertype == OrderType::BID ? 'B' : 'S';
+    out.timeInForce = static_cast<std::uint8_t>(order.timeinforce);
+    out.limitType = static_cast<std::uint8_t>(order.limitType);
+    out.stopType = static_cast<std::uint8_t>(order.stopType);
+    return out.micCode != 0 && out.currencyCode != 0;
+}
+
+/**
+ * @brief Builds the order described by a NEW_ORDER message
+ *
+ * @param message Decoded message
+ * @param codes Interned codes
+ * @param now Priority timestamp of the order
+ * @param out Order to fill
+ * @return true if the MIC and currency codes are known
+ *
+ * Fields are assigned into the caller's order so that a reused order
+ * keeps its string buffers; MICs and currencies fit the small string
+ * buffer anyway.
+ */
+bool toOrder(const NewOrderMessage& message, const CodeTable& codes,
+             std::chrono::system_clock::time_point now, Order& out)
+{
+    const std::string* mic = codes.lookup(message.micCode);
+    const std::string* currency = codes.lookup(message.currencyCode);
+    if (mic == nullptr || currency == nullptr)
+    {
+        return false;
+    }
+
+    out.idorder = message.idorder;
+    out.marketIdentificationCode = *mic;
+    out.tradingCurrency = *currency;
+    out.priority = now;
+    out.price = message.price;
+    out.quantity = message.quantity;
+    out.originalqty = message.quantity;
+    out.timeinforce = static_cast<TimeInForce>(message.timeInForce);
+    out.ordertype = message.side == 'B' ? OrderType::BID : OrderType::ASK;
+    out.limitType = static_cast<LimitType>(message.limitType);
+    out.idinstrument = message.idinstrument;
+    out.idfirm = message.idfirm;
+    out.expirationDate = std::chrono::system_clock::time_point(
+        std::chrono::duration_cast<std::chrono::system_clock::duration>(
+            std::chrono::nanoseconds(message.expiration)));
+    out.peakSize = 0;
+    out.hiddenQuantity = 0;
+    out.stopType = StopType::NONE;
+    out.stopPrice = 0.0;
+    out.stpMode = SelfTradePrevention::NONE;
+    out.sequence = 0;
+
+    out.setIcebergPeak(message.peakSize);
+    if (message.stopType != static_cast<std::uint8_t>(StopType::NONE))
+    {
+        out.setStop(static_cast<StopType>(message.stopType), message.stopPrice);
+    }
+    return true;
+}
+
+/**
+ * @brief Builds a LOGON message
+ *
+ * @param idfirm Firm the session trades for
+ * @param token Firm credential
+ * @param sequence Sender sequence number, 1 on a new connection
+ * @return LogonMessage Stamped message
+ */
+LogonMessage makeLogon(int idfirm, std::uint64_t token, std::uint32_t sequence)
+{
+    LogonMessage logon{};
+    stampHeader(logon, EntryMessageType::LOGON, sequence);
+    logon.token = token;
+    logon.idfirm = idfirm;
+    return logon;
+}
+
+/**
+ * @brief Builds an ACK message
+ *
+ * @param requestType Type of the accepted request
+ * @param idorder Order concerned
+ * @param sequence Sender sequence number
+ * @param now Time of the ack, from the engine clock
+ * @return AckMessage Stamped message
+ */
+AckMessage makeAck(EntryMessageType requestType, int idorder, std::uint32_t sequence,
+                   std::chrono::system_clock::time_point now)
+{
+    AckMessage ack{};
+    stampHeader(ack, EntryMessageType::ACK, sequence);
+    ack.timestamp = toNanoseconds(now);
+    ack.idorder = idorder;
+    ack.requestType = static_cast<std::uint8_t>(requestType);
+    return ack;
+}
+
+/**
+ * @brief Builds a REJECT message
+ *
+ * @param requestType Type of the refused request
+ * @param idorder Order concerned
+ * @param reason Why the request is refused
+ * @param sequence Sender sequence number
+ * @param now Time of the reject, from the engine clock
+ * @return RejectMessage Stamped message
+ */
+RejectMessage makeReject(EntryMessageType requestType, int idorder, RejectReason reason, std::uint32_t sequence,
+                         std::chrono::system_clock::time_point now)
+{
+    RejectMessage reject{};
+    stampHeader(reject, EntryMessageType::REJECT, sequence);
+    reject.timestamp = toNanoseconds(now);
+    reject.idorder = idorder;
+    reject.requestType = static_cast<std::uint8_t>(requestType);
+    reject.reason = static_cast<std::uint8_t>(reason);
+    return reject;
+}
@@ -0,0 +1,178 @@
+/**
+ * @file OrderFeed.cpp
+ * @brief Implementation of the shared memory Level 3 feed
+ */
+
+#include "OrderFeed.hpp"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <iterator>
+#include <new>
+
+/**
+ * @brief Creates the shared memory region and an empty ring in it
+ *
+ * @param regionName Name of the shared memory object
+ * @return true if the feed is ready to publish
+ *
+ * The layout is constructed in place as an empty ring; the header
+ * magic is written last so that readers never attach to a region
+ * that is still being set up.
+ */
+bool OrderFeed::create(const std::string& regionName)
+{
+    ring.reset();
+    layout = nullptr;
+    if (!region.create(regionName, sizeof(FeedLayout)))
+    {
+        return false;
+    }
+
+    layout = new (region.data()) FeedLayout();
+    layout->version = FEED_VERSION;
+    layout->messageSize = sizeof(L3Message);
+    layout->capacity = RING_CAPACITY;
+    layout->magic.store(FEED_MAGIC, std::memory_order_release);
+    ring.reset(new Ring(&layout->storage));
+
+    std::cout << "Level 3 feed published in shared memory " << regionName << std::endl;
+    return true;
+}
+
+/**
+ * @brief Attaches to a feed created by another process, read-only
+ *
+ * @param regionName Name of the shared memory object
+ * @return true if the region holds a compatible feed
+ */
+bool OrderFeed::open(const std::string& regionName)
+{
+    ring.reset();
+    layout = nullptr;
+    if (!region.open(regionName, sizeof(FeedLayout)))
+    {
+        return false;
+    }
+
+    auto* mapped = static_cast<FeedLayout*>(region.data());
+    if (mapped->magic.load(std::memory_order_acquire) != FEED_MAGIC || mapped->version != FEED_VERSION ||
+        mapped->messageSize != sizeof(L3Message) || mapped->capacity != RING_CAPACITY)
+    {
+        std::cerr << "Shared memory " << regionName << " does not hold a compatible Level 3 feed" << std::endl;
+        region.release();
+        return false;
+    }
+
+    layout = mapped;
+    ring.reset(new Ring(&layout->storage));
+    return true;
+}
+
+/**
+ * @brief Adds a book to the directory, before its first event
+ *
+ * @param bookId Feed identifier of the book, 1 to MAX_BOOKS
+ * @param instrumentId Instrument identifier
+ * @param marketIdentificationCode Market of the book
+ * @param tradingCurrency Trading currency of the book
+ * @return true if the book was added
+ *
+ * The identifier is stored last, with release ordering, so a reader
+ * that sees it also sees the codes.
+ */
+bool OrderFeed::registerBook(int bookId, int instrumentId, const std::string& marketIdentificationCode,
+                             const std::string& tradingCurrency)
+{
+    if (!layout || bookId < 1 || static_cast<std::size_t>(bookId) > MAX_BOOKS)
+    {
+        std::cerr << "Book " << bookId << " of instrument " << instrumentId
+            << " is not in the Level 3 directory" << std::endl;
+        return false;
+    }
+
+    DirectoryEntry& entry = layout->directory[bookId - 1];
+    entry.instrumentId = instrumentId;
+    std::memset(entry.marketIdentificationCode, 0, sizeof(entry.marketIdentificationCode));
+    std::memset(entry.tradingCurrency, 0, sizeof(entry.tradingCurrency));
+    marketIdentificationCode.copy(entry.marketIdentificationCode,
+                                  std::min(marketIdentificationCode.size(), sizeof(entry.marketIdentificationCode) - 1));
+    tradingCurrency.copy(entry.tradingCurrency,
+                         std::min(tradingCurrency.size(), sizeof(entry.tradingCurrency) - 1));
+    entry.bookId.store(bookId, std::memory_order_release);
+    return true;
+}
+
+/**
+ * @brief Looks a book up in the directory
+ *
+ * @param bookId Feed identifier read from a message
+ * @param book Receives the identity of the book
+ * @return true if the book is in the directory
+ */
+bool OrderFeed::findBook(int bookId, FeedBook& book) const
+{
+    if (!layout || bookId < 1 || static_cast<std::size_t>(bookId) > MAX_BOOKS)
+    {
+        return false;
+    }
+
+    const DirectoryEntry& entry = layout->directory[bookId - 1];
+    if (entry.bookId.load(std::memory_order_acquire) != bookId)
+    {
+        return false;
+    }
+    book.bookId = bookId;
+    book.instrumentId = entry.instrumentId;
+    book.marketIdentificationCode = entry.marketIdentificationCode;
+    book.tradingCurrency = entry.tradingCurrency;
+    return true;
+}
+
+/**
+ * @brief Publishes one order event
+ *
+ * @param type Message type
+ * @param timestamp Event time on the clock of the book
+ * @param instrumentId Instrument identifier
+ * @param bookId Feed identifier of the book
+ * @param order Order concerned by the event
+ * @param price Order or execution price
+ * @param quantity Quantity, meaning depends on the message type
+ * @param matchId Trade identifier for executions
+ * @return std::uint64_t Feed sequence of the message
+ *
+ * The message is encoded directly in the shared memory slot.
+ */
+std::uint64_t OrderFeed::publish(L3MessageType type, std::chrono::system_clock::time_point timestamp,
+                                 int instrumentId, int bookId, const Order& order, double price, long long quantity,
+                                 int matchId)
+{
+    auto nanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(timestamp.time_since_epoch()).count();
+
+    return ring->publish([&](L3Message& message, std::uint64_t sequence)
+    {
+        message.sequence = sequence;
+        message.timestamp = static_cast<std::uint64_t>(nanoseconds);
+        message.price = price;
+        message.quantity = quantity;
+        message.instrumentId = instrumentId;
+        message.bookId = bookId;
+        message.orderId = order.idorder;
+        message.matchId = matchId;
+        message.type = static_cast<std::uint8_t>(type);
+        message.side = order.ordertype == OrderType::BID ? 'B' : 'S';
+        std::fill(std::begin(message.reserved), std::end(message.reserved), 0);
+    });
+}
+
+/**
+ * @brief Creates a reader starting at the oldest message still in the ring
+ *
+ * @return Ring::Reader Consumer cursor, owned by the caller
+ */
+OrderFeed::Ring::Reader OrderFeed::subscribeFromOldest() const
+{
+    std::uint64_t last = ring->getLastSequence();
+    return Ring::Reader(*ring, last > RING_CAPACITY ? last - RING_CAPACITY : 0);
+}
@@ -0,0 +1,137 @@
+/**
+ * @file OrderFlowGenerator.cpp
+ * @brief Implementation of the synthetic order flow generator
+ */
+
+#include "OrderFlowGenerator.hpp"
+#include <algorithm>
+#include <cmath>
+
+FastRandom::FastRandom(std::uint64_t seed)
+{
+    // splitmix64 spreads any seed, 0 included, over the four state words
+    for (std::uint64_t& word : state)
+    {
+        seed += 0x9e3779b97f4a7c15ULL;
+        std::uint64_t z = seed;
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        word = z ^ (z >> 31);
+    }
+}
+
+OrderFlowGenerator::OrderFlowGenerator(const std::vector<Instrument>& instruments, const OrderFlowConfig& config,
+                                       int firstOrderId, int idStride)
+    : config(config), random(config.seed), nextOrderId(firstOrderId), idStride(idStride)
+{
+    double totalWeight = 0.0;
+    for (const Instrument& instrument : instruments)
+    {
+        if (instrument.state != State::ACTIVE)
+        {
+            continue;
+        }
+        InstrumentFlow flow;
+        flow.instrument = &instrument;
+        flow.tick = std::pow(10.0, -instrument.pricedecimal);
+        flow.referenceTicks = std::max(1LL, std::llround(instrument.refprice / flow.tick));
+        flows.push_back(std::move(flow));
+
+        // Zipf weight of the instrument's rank in file order
+        totalWeight += 1.0 / std::pow(static_cast<double>(flows.size()), config.popularitySkew);
+        popularity.push_back(totalWeight);
+    }
+    for (double& cumulative : popularity)
+    {
+        cumulative /= totalWeight;
+    }
+
+    event.type = FlowEventType::NEW_ORDER;
+    event.arrival = std::chrono::nanoseconds(0);
+}
+
+OrderFlowGenerator::InstrumentFlow& OrderFlowGenerator::pickInstrument()
+{
+    double draw = random.nextDouble();
+    auto it = std::upper_bound(popularity.begin(), popularity.end(), draw);
+    std::size_t index = std::min(static_cast<std::size_t>(it - popularity.begin()), flows.size() - 1);
+    return flows[index];
+}
+
+void OrderFlowGenerator::makeNewOrder(InstrumentFlow& flow)
+{
+    const Instrument& instrument = *flow.instrument;
+    Order& order = event.order;
+
+    order.idorder = nextOrderId;
+    nextOrderId += idStride;
+    order.marketIdentificationCode = instrument.marketIdentificationCode;
+    order.tradingCurrency = instrument.tradingCurrency;
+    order.idinstrument = instrument.idinstrument;
+    order.idfirm = config.firstFirm + static_cast<int>(random.nextBelow(static_cast<std::uint32_t>(config.firmCount)));
+    order.priority = std::chrono::system_clock::now();
+    order.expirationDate = std::chrono::system_clock::time_point{};
+    order.timeinforce = TimeInForce::DAY;
+    order.limitType = LimitType::LIMIT;
+    order.ordertype = random.nextBelow(2) == 0 ? OrderType::BID : OrderType::ASK;
+
+    // Geometric distance in ticks: most orders close to the reference, a long tail further away
+    double meanExtra = std::max(0.0, config.meanTickDistance - 1.0);
+    long long distance = 1 + static_cast<long long>(-std::log(1.0 - random.nextDouble()) * meanExtra);
+
+    // Passive orders rest on their side of the reference, aggressive ones cross it
+    bool aggressive = random.nextDouble() < config.aggressiveRatio;
+    bool above = (order.ordertype == OrderType::ASK) != aggressive;
+    long long ticks = flow.referenceTicks + (above ? distance : -distance);
+    order.price = static_cast<double>(std::max(1LL, ticks)) * flow.tick;
+
+    int lots = 1 + static_cast<int>(random.nextBelow(static_cast<std::uint32_t>(std::max(1, config.maxLots))));
+    order.quantity = lots * instrument.lotsize;
+    order.originalqty = order.quantity;
+    order.peakSize = 0;
+    order.hiddenQuantity = 0;
+    order.stopType = StopType::NONE;
+    order.stopPrice = 0.0;
+    order.stpMode = SelfTradePrevention::NONE;
+    order.sequence = 0;
+
+    // Remember the order for later cancels, forgetting a random one when full
+    if (flow.liveOrders.size() < MAX_LIVE_ORDERS)
+    {
+        flow.liveOrders.push_back(order.idorder);
+    }
+    else
+    {
+        flow.liveOrders[random.nextBelow(static_cast<std::uint32_t>(MAX_LIVE_ORDERS))] = order.idorder;
+    }
+}
+
+const OrderFlowEvent& OrderFlowGenerator::next()
+{
+    // Poisson arrivals: exponential gaps of mean 1 / rate
+    if (config.ordersPerSecond > 0.0)
+    {
+        double gap = -std::log(1.0 - random.nextDouble()) / config.ordersPerSecond;
+        clock += std::chrono::nanoseconds(static_cast<long long>(gap * 1e9));
+    }
+    event.arrival = clock;
+
+    InstrumentFlow& flow = pickInstrument();
+    if (!flow.liveOrders.empty() && random.nextDouble() < config.cancelRatio)
+    {
+        // Cancel a random remembered order
+        std::size_t index = random.nextBelow(static_cast<std::uint32_t>(flow.liveOrders.size()));
+        event.type = FlowEventType::CANCEL_ORDER;
+        event.order.idorder = flow.liveOrders[index];
+        event.order.idinstrument = flow.instrument->idinstrument;
+        event.order.marketIdentificationCode = flow.instrument->marketIdentificationCode;
+        event.order.tradingCurrency = flow.instrument->tradingCurrency;
+        flow.liveOrders[index] = flow.liveOrders.back();
+        flow.liveOrders.pop_back();
+        return event;
+    }
+
+    event.type = FlowEventType::NEW_ORDER;
+    makeNewOrder(flow);
+    return event;
+}
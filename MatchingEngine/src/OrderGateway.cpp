@@ -0,0 +1,623 @@
+/**
+ * @file OrderGateway.cpp
+ * @brief Implementation of the epoll order entry gateway
+ */
+
+#include "OrderGateway.hpp"
+#include <algorithm>
+#include <iostream>
+
+#ifdef __linux__
+#include <arpa/inet.h>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+/**
+ * @brief Creates a stopped gateway
+ *
+ * @param engine Engine receiving the decoded requests
+ * @param codes Interned MIC and currency codes agreed with the clients
+ */
+OrderGateway::OrderGateway(MatchingEngine& engine, const CodeTable& codes)
+    : engine(engine), codes(codes)
+{
+}
+
+/**
+ * @brief Stops the gateway and closes every session
+ */
+OrderGateway::~OrderGateway()
+{
+    stop();
+}
+
+/**
+ * @brief Registers the logon token of a firm
+ *
+ * @param idfirm Firm identifier, strictly positive
+ * @param token Secret the firm presents in its LOGON message
+ */
+void OrderGateway::addFirm(int idfirm, std::uint64_t token)
+{
+    std::lock_guard<std::mutex> lock(firmsMutex);
+    firmTokens[idfirm] = token;
+}
+
+/**
+ * @brief Returns a copy of the gateway counters
+ */
+GatewayStats OrderGateway::getStats() const
+{
+    GatewayStats copy;
+    copy.sessions = stats.sessions.load(std::memory_order_relaxed);
+    copy.logons = stats.logons.load(std::memory_order_relaxed);
+    copy.requests = stats.requests.load(std::memory_order_relaxed);
+    copy.acks = stats.acks.load(std::memory_order_relaxed);
+    copy.rejects = stats.rejects.load(std::memory_order_relaxed);
+    copy.writes = stats.writes.load(std::memory_order_relaxed);
+    copy.disconnects = stats.disconnects.load(std::memory_order_relaxed);
+    return copy;
+}
+
+/**
+ * @brief Checks the session state of a request and forwards it
+ *
+ * @param session Session that sent the request
+ * @param status OK or MALFORMED
+ * @param message Decoded message, its header is valid for both statuses
+ *
+ * The sequence number is checked first, so that a malformed message
+ * still consumes its sequence number and the client stays in step.
+ */
+void OrderGateway::handleMessage(Session& session, DecodeStatus status, const EntryMessage& message)
+{
+    stats.requests.fetch_add(1, std::memory_order_relaxed);
+
+    if (message.header.sequence != session.expectedSequence)
+    {
+        sendReject(session, message.type, 0, RejectReason::SEQUENCE_GAP);
+        session.closing = true;
+        return;
+    }
+    session.expectedSequence++;
+
+    // Responses are never valid requests
+    if (status != DecodeStatus::OK || message.type == EntryMessageType::ACK ||
+        message.type == EntryMessageType::REJECT)
+    {
+        sendReject(session, message.type, 0, RejectReason::MALFORMED);
+        return;
+    }
+
+    if (message.type == EntryMessageType::LOGON)
+    {
+        bool authorised = false;
+        if (session.idfirm == 0)
+        {
+            std::lock_guard<std::mutex> lock(firmsMutex);
+            auto it = firmTokens.find(message.logon.idfirm);
+            authorised = it != firmTokens.end() && it->second == message.logon.token;
+        }
+        if (!authorised)
+        {
+            sendReject(session, EntryMessageType::LOGON, 0, RejectReason::NOT_AUTHORISED);
+            session.closing = true;
+            return;
+        }
+        session.idfirm = message.logon.idfirm;
+        stats.logons.fetch_add(1, std::memory_order_relaxed);
+        sendAck(session, EntryMessageType::LOGON, 0);
+        return;
+    }
+
+    if (session.idfirm == 0)
+    {
+        sendReject(session, message.type, 0, RejectReason::NOT_LOGGED_ON);
+        session.closing = true;
+        return;
+    }
+    forwardRequest(session, message);
+}
+
+/**
+ * @brief Forwards a request of a logged on session to the engine
+ *
+ * @param session Session that sent the request
+ * @param message Valid NEW_ORDER, CANCEL_ORDER or AMEND_ORDER
+ *
+ * Orders are entered for the session's firm only; cancels and amends
+ * of another firm's orders are refused as unknown orders.
+ */
+void OrderGateway::forwardRequest(Session& session, const EntryMessage& message)
+{
+    switch (message.type)
+    {
+    case EntryMessageType::NEW_ORDER:
+    {
+        const NewOrderMessage& request = message.newOrder;
+        if (request.idfirm != session.idfirm)
+        {
+            sendReject(session, message.type, request.idorder, RejectReason::NOT_AUTHORISED);
+        }
+        else if (!toOrder(request, codes, engine.getClock().now(), entryOrder))
+        {
+            sendReject(session, message.type, request.idorder, RejectReason::UNKNOWN_CODE);
+        }
+        else if (!engine.addAndValidateOrder(entryOrder))
+        {
+            sendReject(session, message.type, request.idorder, RejectReason::INVALID_ORDER);
+        }
+        else
+        {
+            sendAck(session, message.type, request.idorder);
+        }
+        break;
+    }
+    case EntryMessageType::CANCEL_ORDER:
+    {
+        const CancelOrderMessage& request = message.cancel;
+        const std::string* mic = codes.lookup(request.micCode);
+        const std::string* currency = codes.lookup(request.currencyCode);
+        if (mic == nullptr || currency == nullptr)
+        {
+            sendReject(session, message.type, request.idorder, RejectReason::UNKNOWN_CODE);
+        }
+        else if (!engine.cancelOrder(MatchingEngine::InstrumentKey(request.idinstrument, *mic, *currency),
+                                     request.idorder, session.idfirm))
+        {
+            sendReject(session, message.type, request.idorder, RejectReason::UNKNOWN_ORDER);
+        }
+        else
+        {
+            sendAck(session, message.type, request.idorder);
+        }
+        break;
+    }
+    case EntryMessageType::AMEND_ORDER:
+    {
+        const AmendOrderMessage& request = message.amend;
+        const std::string* mic = codes.lookup(request.micCode);
+        const std::string* currency = codes.lookup(request.currencyCode);
+        if (mic == nullptr || currency == nullptr)
+        {
+            sendReject(session, message.type, request.idorder, RejectReason::UNKNOWN_CODE);
+        }
+        else if (!engine.amendOrder(MatchingEngine::InstrumentKey(request.idinstrument, *mic, *currency),
+                                    request.idorder, request.newPrice, request.newQuantity, session.idfirm))
+        {
+            sendReject(session, message.type, request.idorder, RejectReason::UNKNOWN_ORDER);
+        }
+        else
+        {
+            sendAck(session, message.type, request.idorder);
+        }
+        break;
+    }
+    default:
+        sendReject(session, message.type, 0, RejectReason::MALFORMED);
+        break;
+    }
+}
+
+/**
+ * @brief Queues an ACK for a request, stamped with the engine clock
+ */
+void OrderGateway::sendAck(Session& session, EntryMessageType requestType, int idorder)
+{
+    AckMessage ack = makeAck(requestType, idorder, session.sendSequence++, engine.getClock().now());
+    queueMessage(session, &ack, sizeof(ack));
+    stats.acks.fetch_add(1, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Queues a REJECT for a request, stamped with the engine clock
+ */
+void OrderGateway::sendReject(Session& session, EntryMessageType requestType, int idorder, RejectReason reason)
+{
+    RejectMessage reject = makeReject(requestType, idorder, reason, session.sendSequence++, engine.getClock().now());
+    queueMessage(session, &reject, sizeof(reject));
+    stats.rejects.fetch_add(1, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Appends an encoded message to the send ring of a session
+ *
+ * @param session Destination session
+ * @param message Encoded message
+ * @param length Message length
+ *
+ * A full ring means the client stopped reading: what is queued is
+ * dropped and the session is closed at the end of the round.
+ */
+void OrderGateway::queueMessage(Session& session, const void* message, std::size_t length)
+{
+    if (session.sendSize + length > SESSION_BUFFER_SIZE)
+    {
+        session.sendSize = 0;
+        session.closing = true;
+    }
+    else
+    {
+        const auto* bytes = static_cast<const std::uint8_t*>(message);
+        std::size_t tail = (session.sendHead + session.sendSize) % SESSION_BUFFER_SIZE;
+        std::size_t first = std::min(length, SESSION_BUFFER_SIZE - tail);
+        std::copy(bytes, bytes + first, session.sendBuffer + tail);
+        std::copy(bytes + first, bytes + length, session.sendBuffer);
+        session.sendSize += length;
+    }
+
+    if (!session.flushPending)
+    {
+        session.flushPending = true;
+        flushList.push_back(&session);
+    }
+}
+
+#ifdef __linux__
+
+/**
+ * @brief Listens on a TCP address and starts the gateway thread
+ *
+ * @param address IPv4 address to bind, e.g. "127.0.0.1"
+ * @param requestedPort Port to bind, 0 for any free port
+ * @return true if the gateway is listening
+ */
+bool OrderGateway::start(const std::string& address, std::uint16_t requestedPort)
+{
+    if (isRunning)
+    {
+        return true;
+    }
+
+    sockaddr_in local{};
+    local.sin_family = AF_INET;
+    local.sin_port = htons(requestedPort);
+    if (inet_pton(AF_INET, address.c_str(), &local.sin_addr) != 1)
+    {
+        std::cerr << "Invalid gateway address " << address << std::endl;
+        return false;
+    }
+
+    listenFd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    int reuse = 1;
+    if (listenFd < 0 ||
+        setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse)) != 0 ||
+        bind(listenFd, reinterpret_cast<sockaddr*>(&local), sizeof(local)) != 0 ||
+        listen(listenFd, SOMAXCONN) != 0)
+    {
+        std::cerr << "Cannot listen on " << address << ":" << requestedPort << ": "
+            << std::strerror(errno) << std::endl;
+        stop();
+        return false;
+    }
+
+    socklen_t localLength = sizeof(local);
+    getsockname(listenFd, reinterpret_cast<sockaddr*>(&local), &localLength);
+    port = ntohs(local.sin_port);
+
+    epollFd = epoll_create1(EPOLL_CLOEXEC);
+    wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.fd = listenFd;
+    bool registered = epollFd >= 0 && wakeFd >= 0 && epoll_ctl(epollFd, EPOLL_CTL_ADD, listenFd, &event) == 0;
+    event.data.fd = wakeFd;
+    registered = registered && epoll_ctl(epollFd, EPOLL_CTL_ADD, wakeFd, &event) == 0;
+    if (!registered)
+    {
+        std::cerr << "Cannot set up the gateway event loop: " << std::strerror(errno) << std::endl;
+        stop();
+        return false;
+    }
+
+    isRunning = true;
+    gatewayThread = std::thread(&OrderGateway::run, this);
+    std::cout << "Order gateway listening on " << address << ":" << port << std::endl;
+    return true;
+}
+
+/**
+ * @brief Stops the gateway thread and closes the listening socket and sessions
+ */
+void OrderGateway::stop()
+{
+    if (isRunning)
+    {
+        isRunning = false;
+        std::uint64_t wake = 1;
+        if (write(wakeFd, &wake, sizeof(wake)) < 0)
+        {
+            std::cerr << "Cannot wake the gateway thread: " << std::strerror(errno) << std::endl;
+        }
+        if (gatewayThread.joinable())
+        {
+            gatewayThread.join();
+        }
+        std::cout << "Order gateway stopped." << std::endl;
+    }
+
+    while (!sessions.empty())
+    {
+        closeSession(sessions.begin()->first);
+    }
+    for (int* fd : {&listenFd, &epollFd, &wakeFd})
+    {
+        if (*fd >= 0)
+        {
+            close(*fd);
+            *fd = -1;
+        }
+    }
+    port = 0;
+}
+
+/**
+ * @brief Event loop of the gateway thread
+ *
+ * Each round handles the ready sockets, then sends the responses of
+ * the round: a session that sent many requests in one read gets all
+ * its acks in a single writev.
+ */
+void OrderGateway::run()
+{
+    epoll_event events[MAX_EVENTS];
+    std::vector<Session*> flushing;
+
+    while (isRunning)
+    {
+        int ready = epoll_wait(epollFd, events, MAX_EVENTS, -1);
+        if (ready < 0)
+        {
+            if (errno != EINTR)
+            {
+                std::cerr << "Gateway epoll_wait failed: " << std::strerror(errno) << std::endl;
+                break;
+            }
+            continue;
+        }
+
+        for (int i = 0; i < ready; ++i)
+        {
+            int fd = events[i].data.fd;
+            if (fd == wakeFd)
+            {
+                continue;
+            }
+            if (fd == listenFd)
+            {
+                acceptSessions();
+                continue;
+            }
+
+            auto it = sessions.find(fd);
+            if (it == sessions.end())
+            {
+                continue;
+            }
+            Session& session = *it->second;
+            if (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR))
+            {
+                if (!readSession(session))
+                {
+                    closeSession(fd);
+                    continue;
+                }
+            }
+            if ((events[i].events & EPOLLOUT) && !session.flushPending)
+            {
+                session.flushPending = true;
+                flushList.push_back(&session);
+            }
+        }
+
+        // closeSession may edit flushList, so flush from a private copy
+        flushing.swap(flushList);
+        for (Session* session : flushing)
+        {
+            session->flushPending = false;
+            if (!flushSession(*session))
+            {
+                closeSession(session->fd);
+            }
+        }
+        flushing.clear();
+    }
+}
+
+/**
+ * @brief Accepts every pending connection
+ */
+void OrderGateway::acceptSessions()
+{
+    while (true)
+    {
+        int fd = accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0)
+        {
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+            {
+                std::cerr << "Gateway accept failed: " << std::strerror(errno) << std::endl;
+            }
+            return;
+        }
+
+        // Acks are small and latency-sensitive
+        int noDelay = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.fd = fd;
+        if (epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event) != 0)
+        {
+            close(fd);
+            continue;
+        }
+        auto session = std::make_unique<Session>();
+        session->fd = fd;
+        sessions.emplace(fd, std::move(session));
+        stats.sessions.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+/**
+ * @brief Reads from a session and handles every complete message
+ *
+ * @param session Readable session
+ * @return false if the session must be closed now
+ *
+ * Messages are decoded where they were received; only the trailing
+ * partial message is moved to the front of the buffer.
+ */
+bool OrderGateway::readSession(Session& session)
+{
+    ssize_t count = read(session.fd, session.receiveBuffer + session.received,
+                         SESSION_BUFFER_SIZE - session.received);
+    if (count == 0)
+    {
+        return false;
+    }
+    if (count < 0)
+    {
+        return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+    }
+    if (session.closing)
+    {
+        // Input after a fatal error is ignored while the reject drains
+        return true;
+    }
+    session.received += static_cast<std::size_t>(count);
+
+    EntryMessage message;
+    std::size_t offset = 0;
+    while (!session.closing)
+    {
+        std::size_t consumed = 0;
+        DecodeStatus status = decodeEntryMessage(session.receiveBuffer + offset, session.received - offset,
+                                                 message, consumed);
+        if (status == DecodeStatus::INCOMPLETE)
+        {
+            break;
+        }
+        if (status == DecodeStatus::FRAMING_ERROR)
+        {
+            auto type = static_cast<EntryMessageType>(session.receiveBuffer[offset + 2]);
+            sendReject(session, type, 0, RejectReason::MALFORMED);
+            session.closing = true;
+            break;
+        }
+        handleMessage(session, status, message);
+        offset += consumed;
+    }
+
+    if (session.closing)
+    {
+        session.received = 0;
+    }
+    else if (offset > 0)
+    {
+        std::copy(session.receiveBuffer + offset, session.receiveBuffer + session.received, session.receiveBuffer);
+        session.received -= offset;
+    }
+    return true;
+}
+
+/**
+ * @brief Writes the send ring of a session with one writev
+ *
+ * @param session Session to flush
+ * @return false if the session must be closed now
+ *
+ * The ring is sent as at most two segments, before and after the wrap.
+ * What the socket does not take is sent on EPOLLOUT.
+ */
+bool OrderGateway::flushSession(Session& session)
+{
+    if (session.sendSize > 0)
+    {
+        iovec segments[2];
+        std::size_t first = std::min(session.sendSize, SESSION_BUFFER_SIZE - session.sendHead);
+        segments[0].iov_base = session.sendBuffer + session.sendHead;
+        segments[0].iov_len = first;
+        segments[1].iov_base = session.sendBuffer;
+        segments[1].iov_len = session.sendSize - first;
+
+        ssize_t written = writev(session.fd, segments, segments[1].iov_len > 0 ? 2 : 1);
+        stats.writes.fetch_add(1, std::memory_order_relaxed);
+        if (written < 0)
+        {
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+            {
+                return false;
+            }
+            written = 0;
+        }
+        session.sendHead = (session.sendHead + static_cast<std::size_t>(written)) % SESSION_BUFFER_SIZE;
+        session.sendSize -= static_cast<std::size_t>(written);
+    }
+
+    if (session.sendSize == 0)
+    {
+        session.sendHead = 0;
+        if (session.closing)
+        {
+            return false;
+        }
+    }
+
+    // Watch for writability only while something is left to send
+    bool blocked = session.sendSize > 0;
+    if (blocked != session.writeBlocked)
+    {
+        epoll_event event{};
+        event.events = blocked ? EPOLLIN | EPOLLOUT : EPOLLIN;
+        event.data.fd = session.fd;
+        epoll_ctl(epollFd, EPOLL_CTL_MOD, session.fd, &event);
+        session.writeBlocked = blocked;
+    }
+    return true;
+}
+
+/**
+ * @brief Removes a session from epoll and closes its socket
+ */
+void OrderGateway::closeSession(int fd)
+{
+    auto it = sessions.find(fd);
+    if (it == sessions.end())
+    {
+        return;
+    }
+    if (it->second->flushPending)
+    {
+        flushList.erase(std::remove(flushList.begin(), flushList.end(), it->second.get()), flushList.end());
+    }
+    epoll_ctl(epollFd, EPOLL_CTL_DEL, fd, nullptr);
+    close(fd);
+    sessions.erase(it);
+    stats.disconnects.fetch_add(1, std::memory_order_relaxed);
+}
+
+#else
+
+bool OrderGateway::start(const std::string& address, std::uint16_t requestedPort)
+{
+    std::cerr << "Order gateway " << address << ":" << requestedPort
+        << " is not supported on this platform" << std::endl;
+    return false;
+}
+
+void OrderGateway::stop()
+{
+}
+
+#endif
@@ -0,0 +1,338 @@
+/**
+ * @file OrderJournal.cpp
+ * @brief Formatting and parsing of the order journal
+ */
+
+#include "OrderJournal.hpp"
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+#include <vector>
+
+namespace
+{
+    /**
+     * @brief Returns a time as nanoseconds since the epoch
+     */
+    long long toNanoseconds(std::chrono::system_clock::time_point time)
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count();
+    }
+
+    /**
+     * @brief Returns the time of a count of nanoseconds since the epoch
+     */
+    std::chrono::system_clock::time_point fromNanoseconds(long long nanoseconds)
+    {
+        return std::chrono::system_clock::time_point(
+            std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::nanoseconds(nanoseconds)));
+    }
+
+    /**
+     * @brief Formats a price so that parsing it back gives the same double
+     */
+    std::string formatPrice(double price)
+    {
+        char buffer[32];
+        std::snprintf(buffer, sizeof(buffer), "%.17g", price);
+        return buffer;
+    }
+
+    /**
+     * @brief Splits a line on commas, keeping empty fields
+     */
+    std::vector<std::string> splitFields(const std::string& line)
+    {
+        std::vector<std::string> fields;
+        std::size_t start = 0;
+        while (true)
+        {
+            std::size_t comma = line.find(',', start);
+            fields.push_back(line.substr(start, comma == std::string::npos ? std::string::npos : comma - start));
+            if (comma == std::string::npos)
+            {
+                return fields;
+            }
+            start = comma + 1;
+        }
+    }
+
+    /**
+     * @brief Parses a whole field as a decimal integer, false on overflow
+     */
+    bool parseInteger(const std::string& field, long long& value)
+    {
+        if (field.empty())
+        {
+            return false;
+        }
+        char* end = nullptr;
+        errno = 0;
+        value = std::strtoll(field.c_str(), &end, 10);
+        return errno == 0 && *end == '\0';
+    }
+
+    /**
+     * @brief Parses a whole field as a decimal integer in the range of an int
+     */
+    bool parseInteger(const std::string& field, int& value)
+    {
+        long long wide = 0;
+        if (!parseInteger(field, wide) || wide < std::numeric_limits<int>::min() || wide > std::numeric_limits<int>::max())
+        {
+            return false;
+        }
+        value = static_cast<int>(wide);
+        return true;
+    }
+
+    /**
+     * @brief Parses a whole field as a price
+     */
+    bool parsePrice(const std::string& field, double& value)
+    {
+        if (field.empty())
+        {
+            return false;
+        }
+        char* end = nullptr;
+        value = std::strtod(field.c_str(), &end);
+        return *end == '\0';
+    }
+
+    /**
+     * @brief Parses a field of nanoseconds since the epoch
+     */
+    bool parseTime(const std::string& field, std::chrono::system_clock::time_point& time)
+    {
+        long long nanoseconds = 0;
+        if (!parseInteger(field, nanoseconds))
+        {
+            return false;
+        }
+        time = fromNanoseconds(nanoseconds);
+        return true;
+    }
+}
+
+/**
+ * @brief Formats one request as a journal line, without the newline
+ *
+ * @param event Request to format
+ * @return std::string Comma-separated fields, led by the request letter and the time
+ */
+std::string formatJournalEvent(const JournalEvent& event)
+{
+    const Order& order = event.order;
+    std::string time = std::to_string(toNanoseconds(event.timestamp));
+    std::string key = std::to_string(order.idinstrument) + "," + order.marketIdentificationCode + "," +
+        order.tradingCurrency;
+
+    switch (event.type)
+    {
+    case JournalEventType::NEW_ORDER:
+        return "N," + time + "," + std::to_string(order.idorder) + "," + key + "," +
+            (order.ordertype == OrderType::BID ? "B" : "S") + "," +
+            (order.limitType == LimitType::LIMIT ? "L" : "M") + "," +
+            (order.timeinforce == TimeInForce::GTD ? "GTD" : "DAY") + "," +
+            std::to_string(toNanoseconds(order.expirationDate)) + "," + formatPrice(order.price) + "," +
+            std::to_string(order.quantity) + "," + std::to_string(order.originalqty) + "," +
+            std::to_string(order.idfirm) + "," + std::to_string(order.peakSize) + "," +
+            std::to_string(order.hiddenQuantity) + "," + std::to_string(static_cast<int>(order.stopType)) + "," +
+            formatPrice(order.stopPrice);
+    case JournalEventType::CANCEL_ORDER:
+        return "C," + time + "," + key + "," + std::to_string(order.idorder) + "," + std::to_string(order.idfirm);
+    case JournalEventType::AMEND_ORDER:
+        return "A," + time + "," + key + "," + std::to_string(order.idorder) + "," + formatPrice(order.price) + "," +
+            std::to_string(order.quantity) + "," + std::to_string(order.idfirm);
+    case JournalEventType::BATCH:
+        return "B," + time + "," + std::to_string(event.batchSize);
+    case JournalEventType::EXPIRE_ORDERS:
+    default:
+        return "E," + time;
+    }
+}
+
+/**
+ * @brief Parses one journal line
+ *
+ * @param line Line without its newline
+ * @param event Filled with the request; partly written when the line is malformed
+ * @return true if the line is a well-formed request
+ */
+bool parseJournalEvent(const std::string& line, JournalEvent& event)
+{
+    std::vector<std::string> fields = splitFields(line);
+    if (fields.size() < 2 || fields[0].size() != 1 || !parseTime(fields[1], event.timestamp))
+    {
+        return false;
+    }
+
+    Order& order = event.order;
+    switch (fields[0][0])
+    {
+    case 'N':
+    {
+        int stopType = 0;
+        if (fields.size() != 18 || !parseInteger(fields[2], order.idorder) ||
+            !parseInteger(fields[3], order.idinstrument) || !parseTime(fields[9], order.expirationDate) ||
+            !parsePrice(fields[10], order.price) || !parseInteger(fields[11], order.quantity) ||
+            !parseInteger(fields[12], order.originalqty) || !parseInteger(fields[13], order.idfirm) ||
+            !parseInteger(fields[14], order.peakSize) || !parseInteger(fields[15], order.hiddenQuantity) ||
+            !parseInteger(fields[16], stopType) || stopType < 0 || stopType > 2 ||
+            !parsePrice(fields[17], order.stopPrice) ||
+            (fields[6] != "B" && fields[6] != "S") || (fields[7] != "L" && fields[7] != "M") ||
+            (fields[8] != "DAY" && fields[8] != "GTD"))
+        {
+            return false;
+        }
+        event.type = JournalEventType::NEW_ORDER;
+        order.marketIdentificationCode = fields[4];
+        order.tradingCurrency = fields[5];
+        order.ordertype = fields[6] == "B" ? OrderType::BID : OrderType::ASK;
+        order.limitType = fields[7] == "L" ? LimitType::LIMIT : LimitType::NONE;
+        order.timeinforce = fields[8] == "GTD" ? TimeInForce::GTD : TimeInForce::DAY;
+        order.stopType = static_cast<StopType>(stopType);
+        order.priority = event.timestamp;
+        order.stpMode = SelfTradePrevention::NONE;
+        order.sequence = 0;
+        return true;
+    }
+    case 'C':
+        if (fields.size() != 7 || !parseInteger(fields[2], order.idinstrument) ||
+            !parseInteger(fields[5], order.idorder) || !parseInteger(fields[6], order.idfirm))
+        {
+            return false;
+        }
+        event.type = JournalEventType::CANCEL_ORDER;
+        order.marketIdentificationCode = fields[3];
+        order.tradingCurrency = fields[4];
+        return true;
+    case 'A':
+        if (fields.size() != 9 || !parseInteger(fields[2], order.idinstrument) ||
+            !parseInteger(fields[5], order.idorder) || !parsePrice(fields[6], order.price) ||
+            !parseInteger(fields[7], order.quantity) || !parseInteger(fields[8], order.idfirm))
+        {
+            return false;
+        }
+        event.type = JournalEventType::AMEND_ORDER;
+        order.marketIdentificationCode = fields[3];
+        order.tradingCurrency = fields[4];
+        return true;
+    case 'E':
+        event.type = JournalEventType::EXPIRE_ORDERS;
+        return fields.size() == 2;
+    case 'B':
+    {
+        long long count = 0;
+        if (fields.size() != 3 || !parseInteger(fields[2], count) || count < 0)
+        {
+            return false;
+        }
+        event.type = JournalEventType::BATCH;
+        event.batchSize = static_cast<std::size_t>(count);
+        return true;
+    }
+    default:
+        return false;
+    }
+}
+
+/**
+ * @brief Journals to a stream that outlives the journal
+ */
+OrderJournal::OrderJournal(std::ostream& out) : out(out)
+{
+}
+
+/**
+ * @brief Appends one request
+ *
+ * @param event Request to record
+ *
+ * The line is formatted before the lock is taken.
+ */
+void OrderJournal::record(const JournalEvent& event)
+{
+    std::string line = formatJournalEvent(event);
+    std::lock_guard<std::mutex> lock(mutex);
+    out << line << '\n';
+    ++count;
+}
+
+/**
+ * @brief Appends a batch header and its new orders, as one block
+ *
+ * @param timestamp Engine time of the batch
+ * @param orders First order of the batch
+ * @param orderCount Number of orders
+ */
+void OrderJournal::recordBatch(std::chrono::system_clock::time_point timestamp, const Order* orders,
+                               std::size_t orderCount)
+{
+    JournalEvent event;
+    event.type = JournalEventType::BATCH;
+    event.timestamp = timestamp;
+    event.batchSize = orderCount;
+    std::string block = formatJournalEvent(event) + '\n';
+
+    // One block, so that requests of other threads cannot land inside the batch
+    event.type = JournalEventType::NEW_ORDER;
+    for (std::size_t i = 0; i < orderCount; ++i)
+    {
+        event.order = orders[i];
+        block += formatJournalEvent(event);
+        block += '\n';
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    out << block;
+    count += static_cast<long long>(orderCount) + 1;
+}
+
+/**
+ * @brief Returns the number of requests recorded, batch headers included
+ */
+long long OrderJournal::getCount() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return count;
+}
+
+/**
+ * @brief Reads from a stream that outlives the reader
+ */
+OrderJournalReader::OrderJournalReader(std::istream& in) : in(in)
+{
+}
+
+/**
+ * @brief Reads the next request
+ *
+ * @param event Filled with the request
+ * @return true if a request was read, false at the end or on a malformed line
+ *
+ * Skips empty lines and '#' comments; a malformed line stops the reader.
+ */
+bool OrderJournalReader::next(JournalEvent& event)
+{
+    while (!error && std::getline(in, line))
+    {
+        ++lineNumber;
+        if (line.empty() || line[0] == '#')
+        {
+            continue;
+        }
+        if (!line.empty() && line.back() == '\r')
+        {
+            line.pop_back();
+        }
+        if (parseJournalEvent(line, event))
+        {
+            return true;
+        }
+        error = true;
+    }
+    return false;
+}
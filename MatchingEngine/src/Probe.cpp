@@ -0,0 +1,212 @@
+/**
+ * @file Probe.cpp
+ * @brief Per-thread probe rings, tick calibration and dump
+ */
+
+#include "Probe.hpp"
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    /**
+     * @struct ProbeRing
+     * @brief Records of one thread, written by that thread only
+     */
+    struct ProbeRing
+    {
+        std::uint32_t thread = 0; ///< Registration order of the thread
+        std::unique_ptr<ProbeRecord[]> records{new ProbeRecord[Probes::RING_CAPACITY]}; ///< Ring storage
+        std::atomic<std::uint64_t> written{0}; ///< Records ever written
+    };
+
+    /**
+     * @struct ProbeRegistry
+     * @brief Every ring ever created, and the tick calibration start
+     */
+    struct ProbeRegistry
+    {
+        std::mutex mutex; ///< Guards rings and the calibration start
+        std::vector<std::unique_ptr<ProbeRing>> rings; ///< Never shrinks, rings outlive their threads
+        std::uint64_t calibrationTicks = 0; ///< Ticks when recording was enabled
+        std::chrono::steady_clock::time_point calibrationTime; ///< Time when recording was enabled
+    };
+
+    /**
+     * @brief Returns the process-wide registry, created on first use
+     */
+    ProbeRegistry& registry()
+    {
+        static ProbeRegistry instance;
+        return instance;
+    }
+
+    /**
+     * @brief Returns the calling thread's ring, registering it on first use
+     */
+    ProbeRing& localRing()
+    {
+        thread_local ProbeRing* ring = nullptr;
+        if (ring == nullptr)
+        {
+            ProbeRegistry& probes = registry();
+            std::lock_guard<std::mutex> lock(probes.mutex);
+            probes.rings.emplace_back(new ProbeRing());
+            ring = probes.rings.back().get();
+            ring->thread = static_cast<std::uint32_t>(probes.rings.size() - 1);
+        }
+        return *ring;
+    }
+}
+
+/**
+ * @brief Recording switch, off until setEnabled(true)
+ */
+std::atomic<bool> Probes::enabled{false};
+
+/**
+ * @brief Returns the lower-case name of a probe, as used in dumps
+ *
+ * @param probe Probe identifier
+ * @return const char* Static name, "unknown" when out of range
+ */
+const char* probeName(ProbeId probe)
+{
+    switch (probe)
+    {
+    case ProbeId::ORDER_ENTRY:
+        return "order_entry";
+    case ProbeId::ORDER_REPORT:
+        return "order_report";
+    case ProbeId::CANCEL:
+        return "cancel";
+    case ProbeId::AMEND:
+        return "amend";
+    case ProbeId::BOOK_ADD:
+        return "book_add";
+    case ProbeId::BOOK_MATCH:
+        return "book_match";
+    case ProbeId::FILL_LOG:
+        return "fill_log";
+    case ProbeId::EXECUTE_TRADE:
+        return "execute_trade";
+    case ProbeId::PUBLISH:
+        return "publish";
+    case ProbeId::COUNT:
+    default:
+        return "unknown";
+    }
+}
+
+/**
+ * @brief Starts or stops recording
+ *
+ * @param enable True to record
+ *
+ * Switching on restarts the tick calibration that dump() completes.
+ */
+void Probes::setEnabled(bool enable)
+{
+    if (enable && !enabled.load(std::memory_order_relaxed))
+    {
+        ProbeRegistry& probes = registry();
+        std::lock_guard<std::mutex> lock(probes.mutex);
+        probes.calibrationTime = std::chrono::steady_clock::now();
+        probes.calibrationTicks = readProbeTicks();
+    }
+    enabled.store(enable, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Returns the number of probe scopes open on the calling thread
+ */
+std::uint16_t& Probes::depth()
+{
+    thread_local std::uint16_t open = 0;
+    return open;
+}
+
+/**
+ * @brief Appends a record to the calling thread's ring
+ *
+ * @param record Finished probe scope
+ *
+ * Overwrites the oldest record of a full ring; the release store
+ * publishes the slot to dump().
+ */
+void Probes::record(const ProbeRecord& record)
+{
+    ProbeRing& ring = localRing();
+    std::uint64_t index = ring.written.load(std::memory_order_relaxed);
+    ring.records[index & (RING_CAPACITY - 1)] = record;
+    ring.written.store(index + 1, std::memory_order_release);
+}
+
+/**
+ * @brief Writes the calibration, the probe names and every ring as text
+ *
+ * @param out Destination stream, read back by ProbeReport
+ *
+ * Waits until the calibration covers at least 10 ms when called early.
+ */
+void Probes::dump(std::ostream& out)
+{
+    ProbeRegistry& probes = registry();
+    std::lock_guard<std::mutex> lock(probes.mutex);
+
+    // Ticks per nanosecond over at least 10 ms since recording was enabled
+    auto calibrationEnd = probes.calibrationTime + std::chrono::milliseconds(10);
+    if (std::chrono::steady_clock::now() < calibrationEnd)
+    {
+        std::this_thread::sleep_until(calibrationEnd);
+    }
+    std::uint64_t ticks = readProbeTicks();
+    auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - probes.calibrationTime).count();
+    double ticksPerNs = probes.calibrationTicks == 0 || elapsed <= 0
+                            ? 1.0
+                            : static_cast<double>(ticks - probes.calibrationTicks) / static_cast<double>(elapsed);
+
+    out << "ticks_per_ns " << ticksPerNs << "\n";
+    for (std::size_t i = 0; i < static_cast<std::size_t>(ProbeId::COUNT); ++i)
+    {
+        out << "probe " << i << " " << probeName(static_cast<ProbeId>(i)) << "\n";
+    }
+
+    std::vector<ProbeRecord> copy(RING_CAPACITY);
+    for (const auto& ring : probes.rings)
+    {
+        std::uint64_t written = ring->written.load(std::memory_order_acquire);
+        std::uint64_t first = written > RING_CAPACITY ? written - RING_CAPACITY : 0;
+        for (std::uint64_t index = first; index < written; ++index)
+        {
+            copy[index - first] = ring->records[index & (RING_CAPACITY - 1)];
+        }
+
+        // Drop what the owner thread overwrote during the copy, and the slot
+        // of record `after`, which it may be writing before publishing it
+        std::uint64_t after = ring->written.load(std::memory_order_acquire);
+        std::uint64_t valid = after + 1 > RING_CAPACITY ? after + 1 - RING_CAPACITY : 0;
+        for (std::uint64_t index = first > valid ? first : valid; index < written; ++index)
+        {
+            const ProbeRecord& record = copy[index - first];
+            out << ring->thread << " " << record.probe << " " << record.depth << " " << record.begin << " "
+                << record.end << "\n";
+        }
+    }
+}
+
+/**
+ * @brief Empties every ring, keeping the rings registered
+ */
+void Probes::clear()
+{
+    ProbeRegistry& probes = registry();
+    std::lock_guard<std::mutex> lock(probes.mutex);
+    for (const auto& ring : probes.rings)
+    {
+        ring->written.store(0, std::memory_order_relaxed);
+    }
+}
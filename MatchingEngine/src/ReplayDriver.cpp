@@ -0,0 +1,151 @@
+/**
+ * @file ReplayDriver.cpp
+ * @brief Implementation of the journal replay
+ */
+
+#include "ReplayDriver.hpp"
+#include <chrono>
+#include <cstring>
+
+namespace
+{
+    /// FNV-1a 64-bit parameters
+    constexpr std::uint64_t FNV_OFFSET = 14695981039346656037ULL;
+    constexpr std::uint64_t FNV_PRIME = 1099511628211ULL;
+
+    /**
+     * @brief Folds the bytes of a value into an FNV-1a digest
+     */
+    template <typename T>
+    void digest(std::uint64_t& hash, T value)
+    {
+        unsigned char bytes[sizeof(T)];
+        std::memcpy(bytes, &value, sizeof(T));
+        for (unsigned char byte : bytes)
+        {
+            hash = (hash ^ byte) * FNV_PRIME;
+        }
+    }
+}
+
+/**
+ * @brief Binds the driver to a stopped engine and installs the clock on it
+ *
+ * @param engine Engine to drive; its thread must not be started
+ * @param clock Clock moved to each request's time
+ */
+ReplayDriver::ReplayDriver(MatchingEngine& engine, SimulatedClock& clock) : engine(engine), clock(clock)
+{
+    engine.setClock(clock);
+}
+
+/**
+ * @brief Replays every request of a journal
+ *
+ * @param journal Journal positioned on its first request
+ * @return ReplayResult Counts, trade digest and wall time
+ *
+ * Stops at the first malformed line or broken batch, whose line number
+ * is reported in the result.
+ */
+ReplayResult ReplayDriver::replay(OrderJournalReader& journal)
+{
+    ReplayResult result;
+    JournalEvent event;
+    auto start = std::chrono::steady_clock::now();
+
+    while (journal.next(event))
+    {
+        clock.set(event.timestamp);
+        const Order& order = event.order;
+        MatchingEngine::InstrumentKey key(order.idinstrument, order.marketIdentificationCode, order.tradingCurrency);
+        switch (event.type)
+        {
+        case JournalEventType::NEW_ORDER:
+            ++result.newOrders;
+            result.accepted += engine.addAndValidateOrder(order) ? 1 : 0;
+            break;
+        case JournalEventType::CANCEL_ORDER:
+            ++result.cancels;
+            result.cancelled += engine.cancelOrder(key, order.idorder, order.idfirm) ? 1 : 0;
+            break;
+        case JournalEventType::AMEND_ORDER:
+            ++result.amends;
+            result.amended += engine.amendOrder(key, order.idorder, order.price, order.quantity, order.idfirm) ? 1 : 0;
+            break;
+        case JournalEventType::EXPIRE_ORDERS:
+            ++result.expirySweeps;
+            result.expired += engine.checkGTDOrders();
+            break;
+        case JournalEventType::BATCH:
+            if (!replayBatch(journal, event.batchSize, result))
+            {
+                result.errorLine = journal.getLineNumber();
+            }
+            break;
+        }
+        if (result.errorLine != 0)
+        {
+            break;
+        }
+        result.events += event.type == JournalEventType::BATCH ? static_cast<long long>(event.batchSize) : 1;
+    }
+
+    result.elapsedSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    result.errorLine = journal.hasError() ? journal.getLineNumber() : result.errorLine;
+    result.tradeDigest = digestTrades(engine);
+    result.trades = engine.getStats().getTotals().tradeCount;
+    return result;
+}
+
+/**
+ * @brief Reads the new orders of a batch and submits them together
+ *
+ * @param journal Journal positioned after the batch header
+ * @param size Number of orders announced by the header
+ * @param result Replay counts, updated for the batch
+ * @return bool False if the journal ended or held another request inside the batch
+ */
+bool ReplayDriver::replayBatch(OrderJournalReader& journal, std::size_t size, ReplayResult& result)
+{
+    batch.clear();
+    JournalEvent member;
+    while (batch.size() < size)
+    {
+        if (!journal.next(member) || member.type != JournalEventType::NEW_ORDER)
+        {
+            return false;
+        }
+        batch.push_back(member.order);
+    }
+    ++result.batches;
+    result.newOrders += static_cast<long long>(size);
+    result.accepted += static_cast<long long>(engine.submitBatch(batch));
+    return true;
+}
+
+/**
+ * @brief Returns a 64-bit FNV-1a digest of every trade of every book
+ *
+ * @param engine Engine whose trades are digested, book by book
+ */
+std::uint64_t ReplayDriver::digestTrades(const MatchingEngine& engine)
+{
+    std::uint64_t hash = FNV_OFFSET;
+    engine.forEachOrderBook([&hash](const MatchingEngine::InstrumentKey& key, const OrderBook& book)
+    {
+        for (const Trade& trade : book.getTrades())
+        {
+            digest(hash, std::get<0>(key));
+            digest(hash, trade.tradeId);
+            digest(hash, trade.buyOrderId);
+            digest(hash, trade.sellOrderId);
+            digest(hash, trade.buyFirmId);
+            digest(hash, trade.sellFirmId);
+            digest(hash, trade.price);
+            digest(hash, trade.quantity);
+            digest(hash, trade.timestamp.time_since_epoch().count());
+        }
+    });
+    return hash;
+}
@@ -0,0 +1,174 @@
+/**
+ * @file ServerMain.cpp
+ * @brief Headless matching engine server
+ *
+ * Loads the instruments from a CSV file (InputData/instrument_input.csv
+ * layout), starts the matching engine and serves the binary order entry
+ * protocol on a TCP port until SIGINT or SIGTERM. SIGUSR1 writes the
+ * engine latency percentiles to stderr as one line of JSON. In a build
+ * with ENABLE_PROBES, SIGUSR2 starts the hot-path probes, and the next
+ * SIGUSR2 stops them and writes their rings to engine-probes.txt for
+ * ProbeReport. With --l3-feed the order-by-order feed is published in
+ * shared memory for FeedReader and other local consumers. No Qt
+ * dependency.
+ *
+ * Usage: MatchingEngineServer <instruments.csv> [--l3-feed[=name]] [port] [idfirm:token ...]
+ */
+
+#include <pthread.h>
+#include <signal.h>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "InstrumentManager.hpp"
+#include "MatchingEngine.hpp"
+#include "OrderEntryProtocol.hpp"
+#include "OrderGateway.hpp"
+#include "Probe.hpp"
+
+namespace
+{
+    /// Market and currency of the instruments of the input file
+    const char* const DEFAULT_MIC = "XPAR";
+    const char* const DEFAULT_CURRENCY = "EUR";
+
+    /// Port served when none is given
+    constexpr std::uint16_t DEFAULT_PORT = 9000;
+
+    /// File receiving the probe rings
+    const char* const PROBE_DUMP = "engine-probes.txt";
+
+    /// Option enabling the Level 3 feed, optionally followed by =<shared memory name>
+    const std::string L3_FEED_OPTION = "--l3-feed";
+
+    /**
+     * @brief Starts the probes, or stops them and dumps their rings
+     */
+    void toggleProbes()
+    {
+        if (!Probes::COMPILED_IN)
+        {
+            std::cerr << "Probes are not compiled in, rebuild with ENABLE_PROBES" << std::endl;
+            return;
+        }
+        if (!Probes::isEnabled())
+        {
+            Probes::setEnabled(true);
+            std::cerr << "Probes enabled" << std::endl;
+            return;
+        }
+        Probes::setEnabled(false);
+        std::ofstream dump(PROBE_DUMP);
+        Probes::dump(dump);
+        std::cerr << "Probes disabled, rings written to " << PROBE_DUMP << std::endl;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    // Options may appear anywhere after the instrument file; the rest is positional
+    std::vector<std::string> arguments;
+    bool orderFeed = false;
+    std::string orderFeedName = OrderFeed::DEFAULT_NAME;
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string argument = argv[i];
+        if (argument == L3_FEED_OPTION)
+        {
+            orderFeed = true;
+        }
+        else if (argument.compare(0, L3_FEED_OPTION.size() + 1, L3_FEED_OPTION + "=") == 0)
+        {
+            orderFeed = true;
+            orderFeedName = argument.substr(L3_FEED_OPTION.size() + 1);
+        }
+        else
+        {
+            arguments.push_back(argument);
+        }
+    }
+
+    if (arguments.empty())
+    {
+        std::cerr << "Usage: MatchingEngineServer <instruments.csv> [--l3-feed[=name]] [port] [idfirm:token ...]"
+            << std::endl;
+        return 2;
+    }
+
+    InstrumentManager instrumentManager;
+    int instrumentCount = instrumentManager.loadFromCsv(arguments[0], DEFAULT_MIC, DEFAULT_CURRENCY);
+    if (instrumentCount <= 0)
+    {
+        std::cerr << "No instrument loaded from " << arguments[0] << std::endl;
+        return 1;
+    }
+
+    std::uint16_t port = arguments.size() > 1 ? static_cast<std::uint16_t>(std::atoi(arguments[1].c_str()))
+                                              : DEFAULT_PORT;
+
+    CodeTable codes;
+    codes.internInstruments(instrumentManager);
+
+    // Block the handled signals before any thread starts so that only sigwait sees them
+    sigset_t handledSignals;
+    sigemptyset(&handledSignals);
+    sigaddset(&handledSignals, SIGINT);
+    sigaddset(&handledSignals, SIGTERM);
+    sigaddset(&handledSignals, SIGUSR1);
+    sigaddset(&handledSignals, SIGUSR2);
+    pthread_sigmask(SIG_BLOCK, &handledSignals, nullptr);
+
+    MatchingEngine engine(instrumentManager);
+    OrderGateway gateway(engine, codes);
+    for (std::size_t i = 2; i < arguments.size(); ++i)
+    {
+        const std::string& firm = arguments[i];
+        std::size_t colon = firm.find(':');
+        if (colon == std::string::npos)
+        {
+            std::cerr << "Invalid firm " << firm << ", expected idfirm:token" << std::endl;
+            return 2;
+        }
+        gateway.addFirm(std::atoi(firm.substr(0, colon).c_str()),
+                        std::strtoull(firm.c_str() + colon + 1, nullptr, 10));
+    }
+
+    if (orderFeed && !engine.enableOrderFeed(orderFeedName))
+    {
+        std::cerr << "Cannot create the Level 3 feed " << orderFeedName << std::endl;
+        return 1;
+    }
+
+    engine.start();
+    if (!gateway.start("0.0.0.0", port))
+    {
+        engine.stop();
+        return 1;
+    }
+    std::cout << "Serving " << instrumentCount << " instruments on port " << gateway.getPort() << std::endl;
+
+    int received = 0;
+    while (sigwait(&handledSignals, &received) == 0 && (received == SIGUSR1 || received == SIGUSR2))
+    {
+        if (received == SIGUSR1)
+        {
+            engine.dumpLatencyStats(std::cerr);
+        }
+        else
+        {
+            toggleProbes();
+        }
+    }
+
+    std::cout << "Stopping on signal " << received << std::endl;
+    gateway.stop();
+    engine.stop();
+
+    GatewayStats stats = gateway.getStats();
+    std::cout << "Sessions: " << stats.sessions << ", requests: " << stats.requests
+        << ", acks: " << stats.acks << ", rejects: " << stats.rejects << std::endl;
+    return 0;
+}
@@ -0,0 +1,151 @@
+/**
+ * @file SharedMemory.cpp
+ * @brief Implementation of the shared memory region wrapper
+ */
+
+#include "SharedMemory.hpp"
+#include <iostream>
+
+#ifndef _WIN32
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+SharedMemoryRegion::~SharedMemoryRegion()
+{
+    release();
+}
+
+#ifndef _WIN32
+
+/**
+ * @brief Creates (or recreates) a zero-filled region and maps it read-write
+ *
+ * @param regionName Name of the object, starting with '/'
+ * @param regionSize Size in bytes
+ * @return true if the region is mapped
+ *
+ * A stale object left by a crashed process is unlinked first, so
+ * readers never attach to a half-initialised previous region.
+ */
+bool SharedMemoryRegion::create(const std::string& regionName, std::size_t regionSize)
+{
+    release();
+    shm_unlink(regionName.c_str());
+
+    int fd = shm_open(regionName.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd < 0)
+    {
+        std::cerr << "Cannot create shared memory " << regionName << ": " << std::strerror(errno) << std::endl;
+        return false;
+    }
+    if (ftruncate(fd, static_cast<off_t>(regionSize)) != 0)
+    {
+        std::cerr << "Cannot size shared memory " << regionName << ": " << std::strerror(errno) << std::endl;
+        close(fd);
+        shm_unlink(regionName.c_str());
+        return false;
+    }
+
+    void* mapping = mmap(nullptr, regionSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED)
+    {
+        std::cerr << "Cannot map shared memory " << regionName << ": " << std::strerror(errno) << std::endl;
+        shm_unlink(regionName.c_str());
+        return false;
+    }
+
+    address = mapping;
+    mappedSize = regionSize;
+    name = regionName;
+    owner = true;
+    return true;
+}
+
+/**
+ * @brief Maps an existing region created by another process
+ *
+ * @param regionName Name of the object, starting with '/'
+ * @param regionSize Expected size in bytes
+ * @param writable Map read-write instead of read-only
+ * @return true if the region is mapped
+ */
+bool SharedMemoryRegion::open(const std::string& regionName, std::size_t regionSize, bool writable)
+{
+    release();
+
+    int fd = shm_open(regionName.c_str(), writable ? O_RDWR : O_RDONLY, 0);
+    if (fd < 0)
+    {
+        std::cerr << "Cannot open shared memory " << regionName << ": " << std::strerror(errno) << std::endl;
+        return false;
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || static_cast<std::size_t>(info.st_size) < regionSize)
+    {
+        std::cerr << "Shared memory " << regionName << " is smaller than expected" << std::endl;
+        close(fd);
+        return false;
+    }
+
+    void* mapping = mmap(nullptr, regionSize, writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED)
+    {
+        std::cerr << "Cannot map shared memory " << regionName << ": " << std::strerror(errno) << std::endl;
+        return false;
+    }
+
+    address = mapping;
+    mappedSize = regionSize;
+    name = regionName;
+    owner = false;
+    return true;
+}
+
+/**
+ * @brief Unmaps the region, and unlinks its name if this process created it
+ */
+void SharedMemoryRegion::release()
+{
+    if (address)
+    {
+        munmap(address, mappedSize);
+        if (owner)
+        {
+            shm_unlink(name.c_str());
+        }
+    }
+    address = nullptr;
+    mappedSize = 0;
+    owner = false;
+}
+
+#else
+
+bool SharedMemoryRegion::create(const std::string& regionName, std::size_t)
+{
+    std::cerr << "Shared memory " << regionName << " is not supported on this platform" << std::endl;
+    return false;
+}
+
+bool SharedMemoryRegion::open(const std::string& regionName, std::size_t, bool)
+{
+    std::cerr << "Shared memory " << regionName << " is not supported on this platform" << std::endl;
+    return false;
+}
+
+void SharedMemoryRegion::release()
+{
+    address = nullptr;
+    mappedSize = 0;
+    owner = false;
+}
+
+#endif
@@ -0,0 +1,157 @@
+/**
+ * @file TradingStats.cpp
+ * @brief Implementation of the sharded trading counters
+ */
+
+#include "TradingStats.hpp"
+
+namespace
+{
+    /**
+     * @brief Subtracts a baseline from a sum of the shards
+     */
+    TradingStats::Totals since(const TradingStats::Totals& now, const TradingStats::Totals& baseline)
+    {
+        TradingStats::Totals result;
+        result.tradeCount = now.tradeCount - baseline.tradeCount;
+        result.quantity = now.quantity - baseline.quantity;
+        result.notional = now.notional - baseline.notional;
+        result.matchingAttempts = now.matchingAttempts - baseline.matchingAttempts;
+        return result;
+    }
+}
+
+/**
+ * @brief Creates zeroed counters, the day starting now on the system clock
+ */
+TradingStats::TradingStats() : lastReset(clock->now())
+{
+}
+
+/**
+ * @brief Sets the clock stamping the resets
+ *
+ * @param statsClock Clock outliving the counters
+ *
+ * The current day is restamped with the new clock, so that a replay
+ * under a simulated clock never reports a wall-clock reset time.
+ */
+void TradingStats::setClock(const Clock* statsClock)
+{
+    std::lock_guard<std::mutex> lock(baselineMutex);
+    clock = statsClock;
+    lastReset = clock->now();
+}
+
+/**
+ * @brief Returns the shard of the calling thread
+ *
+ * Threads take shards round robin on their first update and keep them.
+ */
+TradingStats::Shard& TradingStats::localShard()
+{
+    static std::atomic<std::size_t> nextShard{0};
+    thread_local std::size_t shard = nextShard.fetch_add(1, std::memory_order_relaxed) % SHARD_COUNT;
+    return shards[shard];
+}
+
+/**
+ * @brief Records one trade
+ *
+ * @param price Trade price
+ * @param quantity Trade quantity
+ *
+ * Three relaxed increments on the shard of the calling thread.
+ */
+void TradingStats::recordTrade(double price, int quantity)
+{
+    Shard& shard = localShard();
+    shard.tradeCount.fetch_add(1, std::memory_order_relaxed);
+    shard.quantity.fetch_add(quantity, std::memory_order_relaxed);
+    shard.notional.fetch_add(toNotional(price, quantity), std::memory_order_relaxed);
+}
+
+/**
+ * @brief Records one matching cycle of the engine loop
+ */
+void TradingStats::recordMatchingAttempt()
+{
+    localShard().matchingAttempts.fetch_add(1, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Sums the shards
+ *
+ * @return Totals Figures since construction
+ *
+ * The shards are read one after the other, so a sum taken during
+ * updates may include some fields of a trade and not others.
+ */
+TradingStats::Totals TradingStats::sum() const
+{
+    Totals totals;
+    for (const Shard& shard : shards)
+    {
+        totals.tradeCount += shard.tradeCount.load(std::memory_order_relaxed);
+        totals.quantity += shard.quantity.load(std::memory_order_relaxed);
+        totals.notional += shard.notional.load(std::memory_order_relaxed);
+        totals.matchingAttempts += shard.matchingAttempts.load(std::memory_order_relaxed);
+    }
+    return totals;
+}
+
+/**
+ * @brief Returns the figures since the last reset()
+ */
+TradingStats::Totals TradingStats::getTotals() const
+{
+    Totals now = sum();
+    std::lock_guard<std::mutex> lock(baselineMutex);
+    return since(now, totalBaseline);
+}
+
+/**
+ * @brief Returns the figures since the last resetDaily() or reset()
+ */
+TradingStats::Totals TradingStats::getDaily() const
+{
+    Totals now = sum();
+    std::lock_guard<std::mutex> lock(baselineMutex);
+    return since(now, dailyBaseline);
+}
+
+/**
+ * @brief Returns the time of the last daily reset, on the stats clock
+ */
+std::chrono::system_clock::time_point TradingStats::getLastReset() const
+{
+    std::lock_guard<std::mutex> lock(baselineMutex);
+    return lastReset;
+}
+
+/**
+ * @brief Starts a new day
+ *
+ * Moves the daily baseline to the current sum; totals are kept.
+ */
+void TradingStats::resetDaily()
+{
+    Totals now = sum();
+    std::lock_guard<std::mutex> lock(baselineMutex);
+    dailyBaseline = now;
+    lastReset = clock->now();
+}
+
+/**
+ * @brief Starts over, totals included
+ *
+ * Moves both baselines to the current sum; the shards are not written.
+ */
+void TradingStats::reset()
+{
+    Totals now = sum();
+    std::lock_guard<std::mutex> lock(baselineMutex);
+    totalBaseline = now;
+    dailyBaseline = now;
+    lastReset = clock->now();
+}
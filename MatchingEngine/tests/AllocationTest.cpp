@@ -0,0 +1,200 @@
+/**
+ * @file AllocationTest.cpp
+ * @brief Checks of the pro-rata allocation policies of the order book
+ *
+ * Builds small resting levels, sends one aggressor against them and
+ * checks the quantity each resting order received:
+ * - Pro-rata shares in proportion to the displayed quantity
+ * - Rounding of the shares to whole lots, with the remainder allocated
+ *   in time priority
+ * - Top order priority of the price-time-pro-rata policy
+ * - Self-trade prevention against a same-firm order behind the front,
+ *   for each prevention mode
+ */
+
+#include "Clock.hpp"
+#include "OrderBook.hpp"
+#include <chrono>
+#include <iostream>
+#include <sstream>
+#include <streambuf>
+#include <string>
+#include "TestSupport.hpp"
+
+namespace
+{
+    /// Price of every resting order, the aggressors cross it
+    constexpr double PRICE = 100.0;
+
+    /// Failed checks of the program
+    TestReport report("Allocation test");
+
+    /**
+     * @class Scenario
+     * @brief One order book at a simulated time, with order helpers
+     */
+    class Scenario
+    {
+    public:
+        Scenario(const std::string& name, AllocationAlgorithm algorithm, int lotSize) : name(name)
+        {
+            clock.set(std::chrono::system_clock::time_point(SESSION_START));
+            book.setClock(&clock);
+            book.setAllocation(algorithm, lotSize);
+        }
+
+        /**
+         * @brief Queues a resting sell order, one microsecond after the previous one
+         */
+        void rest(int idorder, int idfirm, int quantity)
+        {
+            send(idorder, idfirm, OrderType::ASK, quantity, SelfTradePrevention::NONE);
+        }
+
+        /**
+         * @brief Sends an aggressive buy order and runs the matching cycle
+         *
+         * The book's console output during the cycle is kept for log checks.
+         */
+        void aggress(int idorder, int idfirm, int quantity, SelfTradePrevention stpMode)
+        {
+            std::ostringstream captured;
+            std::streambuf* previous = std::cout.rdbuf(captured.rdbuf());
+            send(idorder, idfirm, OrderType::BID, quantity, stpMode);
+            book.matchOrders();
+            std::cout.rdbuf(previous);
+            log = captured.str();
+        }
+
+        /**
+         * @brief Checks that the last matching cycle logged a message
+         */
+        void expectLogged(const std::string& message) const
+        {
+            report.check(log.find(message) != std::string::npos, name, "no \"" + message + "\" in the log");
+        }
+
+        /**
+         * @brief Quantity executed against a resting order across every trade
+         */
+        int executed(int idorder) const
+        {
+            int total = 0;
+            for (const Trade& trade : book.getTrades())
+            {
+                if (trade.sellOrderId == idorder || trade.buyOrderId == idorder)
+                {
+                    total += trade.quantity;
+                }
+            }
+            return total;
+        }
+
+        /**
+         * @brief Remaining quantity of an order, zero once it left the book
+         */
+        int remaining(int idorder) const
+        {
+            const Order* order = book.findOrder(idorder);
+            return order != nullptr ? order->quantity + order->hiddenQuantity : 0;
+        }
+
+        /**
+         * @brief Checks an integer against its expected value
+         */
+        void expect(int actual, int expected, const std::string& what) const
+        {
+            report.check(actual == expected, name, what + " is " + std::to_string(actual) + ", expected " +
+                  std::to_string(expected));
+        }
+
+    private:
+        void send(int idorder, int idfirm, OrderType side, int quantity, SelfTradePrevention stpMode)
+        {
+            clock.advance(std::chrono::microseconds(1));
+            Order order(idorder, "XPAR", "EUR", clock.now(), PRICE, quantity, TimeInForce::DAY, side,
+                        LimitType::LIMIT, 1, quantity, idfirm);
+            order.stpMode = stpMode;
+            book.addOrder(order);
+        }
+
+        std::string name;
+        std::string log;
+        SimulatedClock clock;
+        OrderBook book;
+    };
+
+    void proRataShares()
+    {
+        Scenario scenario("pro-rata shares", AllocationAlgorithm::PRO_RATA, 1);
+        scenario.rest(1, 2, 300);
+        scenario.rest(2, 3, 100);
+        scenario.aggress(3, 1, 200, SelfTradePrevention::NONE);
+        scenario.expect(scenario.executed(1), 150, "fill of the 300 order");
+        scenario.expect(scenario.executed(2), 50, "fill of the 100 order");
+        scenario.expect(scenario.remaining(3), 0, "aggressor remaining");
+    }
+
+    void proRataRemainder()
+    {
+        // Shares 35 and 15 round down to 30 and 10; the 10 left go to the front
+        Scenario scenario("pro-rata remainder", AllocationAlgorithm::PRO_RATA, 10);
+        scenario.rest(1, 2, 70);
+        scenario.rest(2, 3, 30);
+        scenario.aggress(3, 1, 50, SelfTradePrevention::NONE);
+        scenario.expect(scenario.executed(1), 40, "fill of the front order");
+        scenario.expect(scenario.executed(2), 10, "fill of the second order");
+        scenario.expect(scenario.remaining(1), 30, "front order remaining");
+        scenario.expect(scenario.remaining(2), 20, "second order remaining");
+    }
+
+    void priceTimeProRata()
+    {
+        // The front is filled first, then 100 is shared over 300 displayed
+        Scenario scenario("price-time-pro-rata", AllocationAlgorithm::PRICE_TIME_PRO_RATA, 1);
+        scenario.rest(1, 2, 100);
+        scenario.rest(2, 3, 100);
+        scenario.rest(3, 3, 200);
+        scenario.aggress(4, 1, 200, SelfTradePrevention::NONE);
+        scenario.expect(scenario.executed(1), 100, "fill of the front order");
+        scenario.expect(scenario.executed(2), 34, "fill of the 100 order");
+        scenario.expect(scenario.executed(3), 66, "fill of the 200 order");
+    }
+
+    /**
+     * @brief Firm 1 aggresses a level whose second order is its own
+     *
+     * The front order of firm 2 receives its share of 50; the same-firm
+     * order must never trade, whatever the prevention mode.
+     */
+    void selfTradeBehindFront(SelfTradePrevention mode, const std::string& name, int frontExecuted,
+                              int ownRemaining, int aggressorRemaining)
+    {
+        Scenario scenario("pro-rata self-trade " + name, AllocationAlgorithm::PRO_RATA, 1);
+        scenario.rest(1, 2, 100);
+        scenario.rest(2, 1, 100);
+        scenario.aggress(3, 1, 100, mode);
+        scenario.expect(scenario.executed(2), 0, "fill of the same-firm order");
+        scenario.expect(scenario.executed(1), frontExecuted, "fill of the front order");
+        scenario.expect(scenario.remaining(2), ownRemaining, "same-firm order remaining");
+        scenario.expect(scenario.remaining(3), aggressorRemaining, "aggressor remaining");
+        scenario.expectLogged("Self-trade prevented for firm 1 (BID: 3, ASK: 2)");
+    }
+}
+
+int main()
+{
+    NullBuffer discarded;
+    std::streambuf* console = std::cout.rdbuf(&discarded);
+
+    proRataShares();
+    proRataRemainder();
+    priceTimeProRata();
+    selfTradeBehindFront(SelfTradePrevention::CANCEL_RESTING, "cancel resting", 100, 0, 0);
+    selfTradeBehindFront(SelfTradePrevention::CANCEL_AGGRESSOR, "cancel aggressor", 50, 100, 0);
+    selfTradeBehindFront(SelfTradePrevention::CANCEL_BOTH, "cancel both", 50, 0, 0);
+    selfTradeBehindFront(SelfTradePrevention::DECREMENT, "decrement", 50, 50, 0);
+
+    std::cout.rdbuf(console);
+    return report.finish();
+}
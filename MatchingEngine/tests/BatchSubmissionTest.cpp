@@ -0,0 +1,179 @@
+/**
+ * @file BatchSubmissionTest.cpp
+ * @brief Checks of batched order submission against one-by-one submission
+ *
+ * Runs each scenario under a simulated clock and checks the trades and
+ * the resting orders:
+ * - A market order in a batch does not rest for the later orders of
+ *   the batch, as with addAndValidateOrder
+ * - A market order in a batch still trades on the liquidity that rests
+ * - A market order left resting by an auction prices its fills at the
+ *   limit of the aggressor, never at the market key of its side
+ * - Batch timings go to the batch histograms, one sample per batch
+ */
+
+#include <chrono>
+#include <iostream>
+#include <streambuf>
+#include <string>
+#include <vector>
+#include "Clock.hpp"
+#include "InstrumentManager.hpp"
+#include "MatchingEngine.hpp"
+#include "TestSupport.hpp"
+
+namespace
+{
+    /// Identity of the instrument under test
+    constexpr int INSTRUMENT_ID = 1;
+    const char* const MIC = "XPAR";
+    const char* const CURRENCY = "EUR";
+
+    /// Limit price of every limit order
+    constexpr double PRICE = 100.0;
+
+    /// Failed checks of the program
+    TestReport report("Batch submission test");
+
+    /**
+     * @brief Builds a day order, one microsecond after the previous one
+     */
+    Order makeOrder(SimulatedClock& clock, int idorder, int idfirm, OrderType side, LimitType limitType,
+                    int quantity)
+    {
+        clock.advance(std::chrono::microseconds(1));
+        return Order(idorder, MIC, CURRENCY, std::chrono::system_clock::time_point{},
+                     limitType == LimitType::NONE ? 0.0 : PRICE, quantity, TimeInForce::DAY, side, limitType,
+                     INSTRUMENT_ID, quantity, idfirm);
+    }
+
+    /**
+     * @class Scenario
+     * @brief One engine with a single instrument at a simulated time
+     */
+    class Scenario
+    {
+    public:
+        explicit Scenario(const std::string& name) : name(name), engine(registerInstrument(instruments))
+        {
+            clock.set(std::chrono::system_clock::time_point(SESSION_START));
+            engine.setClock(clock);
+        }
+
+        /**
+         * @brief Book of the instrument, created on the first order
+         */
+        const OrderBook& book() const
+        {
+            return *engine.findOrderBook(MatchingEngine::InstrumentKey(INSTRUMENT_ID, MIC, CURRENCY));
+        }
+
+        /**
+         * @brief Checks the number of trades and the price of each
+         */
+        void expectTrades(std::size_t count, double price) const
+        {
+            const std::vector<Trade>& trades = book().getTrades();
+            report.check(trades.size() == count, name, std::to_string(trades.size()) + " trades, expected " +
+                  std::to_string(count));
+            for (const Trade& trade : trades)
+            {
+                report.check(trade.price == price, name, "trade at " + std::to_string(trade.price) + ", expected " +
+                      std::to_string(price));
+            }
+        }
+
+        /**
+         * @brief Checks the remaining quantity of an order, zero once it left the book
+         */
+        void expectRemaining(int idorder, int expected) const
+        {
+            const Order* order = book().findOrder(idorder);
+            int remaining = order != nullptr ? order->quantity + order->hiddenQuantity : 0;
+            report.check(remaining == expected, name, "order " + std::to_string(idorder) + " remaining is " +
+                  std::to_string(remaining) + ", expected " + std::to_string(expected));
+        }
+
+        std::string name;
+        SimulatedClock clock;
+        InstrumentManager instruments;
+        MatchingEngine engine;
+
+    private:
+        static InstrumentManager& registerInstrument(InstrumentManager& manager)
+        {
+            manager.addInstrument(Instrument(INSTRUMENT_ID, MIC, CURRENCY, "TEST", 1, State::ACTIVE, PRICE, 1, 1,
+                                             2, 0, 0, 1));
+            return manager;
+        }
+    };
+
+    void marketThenCrossingLimit()
+    {
+        // One by one, the market bid finds no ask and is cancelled before the ask arrives
+        Scenario scenario("market then crossing limit");
+        std::vector<Order> batch;
+        batch.push_back(makeOrder(scenario.clock, 1, 7, OrderType::BID, LimitType::NONE, 10));
+        batch.push_back(makeOrder(scenario.clock, 2, 8, OrderType::ASK, LimitType::LIMIT, 10));
+        report.check(scenario.engine.submitBatch(batch) == 2, scenario.name, "not every order was added");
+        scenario.expectTrades(0, PRICE);
+        scenario.expectRemaining(1, 0);
+        scenario.expectRemaining(2, 10);
+    }
+
+    void limitThenMarket()
+    {
+        Scenario scenario("limit then market");
+        std::vector<Order> batch;
+        batch.push_back(makeOrder(scenario.clock, 1, 8, OrderType::ASK, LimitType::LIMIT, 10));
+        batch.push_back(makeOrder(scenario.clock, 2, 7, OrderType::BID, LimitType::NONE, 15));
+        batch.push_back(makeOrder(scenario.clock, 3, 8, OrderType::ASK, LimitType::LIMIT, 10));
+        scenario.engine.submitBatch(batch);
+        scenario.expectTrades(1, PRICE);
+        scenario.expectRemaining(2, 0);
+        scenario.expectRemaining(3, 10);
+    }
+
+    void marketLeftByAuction()
+    {
+        // Switched back to continuous trading without an uncrossing, the market bid still rests
+        Scenario scenario("market left by an auction");
+        scenario.engine.startAuction();
+        scenario.engine.addAndValidateOrder(makeOrder(scenario.clock, 1, 7, OrderType::BID, LimitType::NONE, 10));
+        OrderBook& book = scenario.engine.getOrderBook(scenario.instruments.getInstruments().front());
+        book.setTradingPhase(TradingPhase::CONTINUOUS);
+        book.addOrder(makeOrder(scenario.clock, 2, 8, OrderType::ASK, LimitType::LIMIT, 10));
+        book.matchOrders();
+        scenario.expectTrades(1, PRICE);
+    }
+
+    void batchLatencySamples()
+    {
+        Scenario scenario("batch latency samples");
+        std::vector<Order> batch;
+        for (int i = 0; i < 4; ++i)
+        {
+            batch.push_back(makeOrder(scenario.clock, i + 1, 7, OrderType::BID, LimitType::LIMIT, 10));
+        }
+        scenario.engine.submitBatch(batch);
+        const EngineLatency& latency = scenario.engine.getLatency();
+        report.check(latency[LatencyStage::BATCH_TO_ACK].getCount() == 1, scenario.name, "batch to ack samples");
+        report.check(latency[LatencyStage::BATCH_MATCHING].getCount() == 1, scenario.name, "batch matching samples");
+        report.check(latency[LatencyStage::ORDER_TO_ACK].getCount() == 0, scenario.name, "order to ack samples");
+        report.check(latency[LatencyStage::MATCHING].getCount() == 0, scenario.name, "matching samples");
+    }
+}
+
+int main()
+{
+    NullBuffer discarded;
+    std::streambuf* console = std::cout.rdbuf(&discarded);
+
+    marketThenCrossingLimit();
+    limitThenMarket();
+    marketLeftByAuction();
+    batchLatencySamples();
+
+    std::cout.rdbuf(console);
+    return report.finish();
+}
@@ -0,0 +1,190 @@
+/**
+ * @file ConflationTest.cpp
+ * @brief Checks of the conflated Level 2 images and their subscriber counters
+ *
+ * Two books of the same instrument on different markets publish into one
+ * feed while a conflating subscriber does not read. Checks that:
+ * - A level churned by more deltas than the ring holds is delivered once,
+ *   with its final state, while a plain ring reader is overrun
+ * - received, delivered, conflated and depthMoves account for every
+ *   delta, including a level pushed out of the depth by a better one
+ * - A level added and removed between two deliveries produces nothing
+ * - Books of one instrument stay apart, keyed by their feed identifier
+ * - Only the best CONFLATED_DEPTH levels of a side are followed, and a
+ *   deeper level enters the image when a better one leaves
+ * - poll() does not sample before its interval elapsed
+ */
+
+#include <chrono>
+#include <iostream>
+#include <streambuf>
+#include <string>
+#include <vector>
+#include "ConflatingSubscriber.hpp"
+#include "MarketDataPublisher.hpp"
+#include "OrderBook.hpp"
+#include "TestSupport.hpp"
+
+namespace
+{
+    /// Instrument traded by both books
+    constexpr int INSTRUMENT_ID = 7;
+
+    /// Deltas published on the churned level, more than the ring holds
+    constexpr int CHURN = static_cast<int>(MarketDataPublisher::RING_CAPACITY) + 1000;
+
+    /// Failed checks of the program
+    TestReport report("Conflation test");
+
+    /**
+     * @brief Checks a counter against its expected value
+     */
+    void expect(std::uint64_t actual, std::uint64_t expected, const std::string& what)
+    {
+        report.check(actual == expected, what + " is " + std::to_string(actual) + ", expected " +
+                     std::to_string(expected));
+    }
+
+    /**
+     * @brief Sends a resting buy order of one unit
+     */
+    void addBid(OrderBook& book, int idorder, double price, const char* mic)
+    {
+        book.addOrder(Order(idorder, mic, "EUR", std::chrono::system_clock::now(), price, 1, TimeInForce::DAY,
+                            OrderType::BID, LimitType::LIMIT, INSTRUMENT_ID, 1, 1));
+    }
+
+    /**
+     * @brief Delivers the pending changes and keeps them
+     */
+    std::vector<L2Message> flush(ConflatingSubscriber& subscriber)
+    {
+        std::vector<L2Message> messages;
+        subscriber.flush([&messages](const L2Message& message)
+        {
+            messages.push_back(message);
+        });
+        return messages;
+    }
+}
+
+int main()
+{
+    NullBuffer discarded;
+    std::streambuf* console = std::cout.rdbuf(&discarded);
+
+    MarketDataPublisher publisher;
+    MarketDataPublisher::Ring::Reader ringReader = publisher.subscribe();
+    ConflatingSubscriber subscriber(publisher, std::chrono::milliseconds(0));
+    ConflatingSubscriber throttled(publisher, std::chrono::hours(1));
+
+    OrderBook paris;
+    OrderBook london;
+    paris.setMarketDataPublisher(&publisher, INSTRUMENT_ID, 1);
+    london.setMarketDataPublisher(&publisher, INSTRUMENT_ID, 2);
+
+    // One ADD_LEVEL then CHURN - 1 UPDATE_LEVEL deltas on one level
+    int nextOrderId = 1;
+    for (int i = 0; i < CHURN; ++i)
+    {
+        addBid(paris, nextOrderId++, 100.0, "XPAR");
+    }
+    int londonBest = nextOrderId++;
+    addBid(london, londonBest, 100.0, "XLON");
+
+    L2Message ringMessage;
+    report.check(ringReader.poll(ringMessage) == ReadStatus::OVERRUN, "the plain ring reader was not overrun");
+
+    std::vector<L2Message> messages = flush(subscriber);
+    expect(messages.size(), 2, "messages delivered for two churned books");
+    for (const L2Message& message : messages)
+    {
+        report.check(message.type == static_cast<std::uint8_t>(L2MessageType::ADD_LEVEL),
+                     "first delivery is not an add");
+        report.check(message.instrumentId == INSTRUMENT_ID, "instrument lost");
+        if (message.bookId == 1)
+        {
+            expect(static_cast<std::uint64_t>(message.quantity), CHURN, "conflated quantity of the Paris level");
+            expect(static_cast<std::uint64_t>(message.orderCount), CHURN, "conflated orders of the Paris level");
+        }
+        else
+        {
+            expect(static_cast<std::uint64_t>(message.bookId), 2, "book of the London level");
+            expect(static_cast<std::uint64_t>(message.quantity), 1, "quantity of the London level");
+        }
+    }
+    const ConflationStats& stats = subscriber.getStats();
+    expect(stats.received, CHURN + 1, "deltas received");
+    expect(stats.delivered, 2, "messages delivered");
+    expect(stats.conflated, CHURN - 1, "deltas conflated");
+    expect(stats.samples, 2, "images sampled");
+
+    // A level added and removed between two deliveries
+    int transient = nextOrderId++;
+    addBid(london, transient, 101.0, "XLON");
+    london.cancelOrder(transient, 1);
+    messages = flush(subscriber);
+    expect(messages.size(), 0, "messages delivered for a transient level");
+    expect(stats.received, CHURN + 3, "deltas received after the transient level");
+    expect(stats.conflated, CHURN + 1, "deltas conflated after the transient level");
+
+    // Twelve new London levels below 100, only the best CONFLATED_DEPTH are followed
+    for (int i = 1; i <= 12; ++i)
+    {
+        addBid(london, nextOrderId++, 100.0 - i, "XLON");
+    }
+    messages = flush(subscriber);
+    expect(messages.size(), CONFLATED_DEPTH - 1, "new levels delivered within the conflated depth");
+
+    // The best London level leaves, the next level below the depth takes its place
+    london.cancelOrder(londonBest, 1);
+    messages = flush(subscriber);
+    expect(messages.size(), 2, "messages delivered when the best level leaves");
+    for (const L2Message& message : messages)
+    {
+        if (message.type == static_cast<std::uint8_t>(L2MessageType::DELETE_LEVEL))
+        {
+            report.check(message.price == 100.0, "deleted level is not the best London level");
+        }
+        else
+        {
+            report.check(message.type == static_cast<std::uint8_t>(L2MessageType::ADD_LEVEL),
+                         "unexpected message type");
+            report.check(message.price == 100.0 - static_cast<double>(CONFLATED_DEPTH),
+                         "wrong level entered the image");
+        }
+    }
+    expect(stats.depthMoves, 1, "levels moved into the depth");
+    expect(stats.received + stats.depthMoves, stats.delivered + stats.conflated, "deltas accounted for");
+
+    // A better level pushes the worst followed level out: one delta, an add and a delete
+    MarketDataPublisher fullPublisher;
+    ConflatingSubscriber fullSubscriber(fullPublisher, std::chrono::milliseconds(0));
+    OrderBook full;
+    full.setMarketDataPublisher(&fullPublisher, INSTRUMENT_ID, 1);
+    for (int i = 0; i < static_cast<int>(CONFLATED_DEPTH); ++i)
+    {
+        addBid(full, nextOrderId++, 90.0 - i, "XPAR");
+    }
+    flush(fullSubscriber);
+    addBid(full, nextOrderId++, 91.0, "XPAR");
+    messages = flush(fullSubscriber);
+    expect(messages.size(), 2, "messages delivered when a level leaves the depth");
+    const ConflationStats& fullStats = fullSubscriber.getStats();
+    expect(fullStats.received, CONFLATED_DEPTH + 1, "deltas received by the full depth");
+    expect(fullStats.delivered, CONFLATED_DEPTH + 2, "messages delivered for the full depth");
+    expect(fullStats.depthMoves, 1, "levels pushed out of the depth");
+    expect(fullStats.conflated, 0, "deltas conflated for the full depth");
+
+    // The throttled subscriber never reached its interval
+    std::vector<L2Message> none;
+    int delivered = throttled.poll([&none](const L2Message& message)
+    {
+        none.push_back(message);
+    });
+    expect(static_cast<std::uint64_t>(delivered), 0, "throttled deliveries");
+    expect(throttled.getStats().samples, 0, "throttled samples");
+
+    std::cout.rdbuf(console);
+    return report.finish();
+}
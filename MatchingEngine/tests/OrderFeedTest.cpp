@@ -0,0 +1,187 @@
+/**
+ * @file OrderFeedTest.cpp
+ * @brief Reads the shared memory Level 3 feed from another process
+ *
+ * The parent creates a feed, registers a book in its directory and
+ * makes the book add and execute orders under a simulated clock. A
+ * forked child then attaches to the feed by name, as FeedReader does,
+ * and checks every message:
+ * - Types, sides, orders and quantities of the add and execute events
+ * - An exhausted iceberg refilled from its reserve is added again under
+ *   its order id, never replaced after reaching 0
+ * - Gap-free sequences
+ * - Book identifier, resolved through the directory to the instrument,
+ *   market and currency of the book
+ * - Timestamps taken from the clock of the book
+ */
+
+#include <sys/wait.h>
+#include <unistd.h>
+#include <chrono>
+#include <iostream>
+#include <streambuf>
+#include <string>
+#include <vector>
+#include "Clock.hpp"
+#include "OrderBook.hpp"
+#include "OrderFeed.hpp"
+#include "TestSupport.hpp"
+
+namespace
+{
+    /// Identity of the book under test
+    constexpr int INSTRUMENT_ID = 7;
+    constexpr int BOOK_ID = 3;
+    const char* const MIC = "XLON";
+    const char* const CURRENCY = "GBP";
+
+    /// Failed checks of the program
+    TestReport report("Order feed test");
+
+    /**
+     * @struct Expected
+     * @brief One message the reader must see
+     */
+    struct Expected
+    {
+        L3MessageType type;
+        char side;
+        int orderId;
+        long long quantity;
+        std::uint64_t timestamp;
+    };
+
+    /**
+     * @brief Nanoseconds since the epoch of a clock reading
+     */
+    std::uint64_t nanoseconds(std::chrono::system_clock::time_point time)
+    {
+        return static_cast<std::uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count());
+    }
+
+    /**
+     * @brief Child side: attaches to the feed and checks what it reads
+     */
+    int readFeed(const std::string& regionName, const std::vector<Expected>& expected)
+    {
+        OrderFeed feed;
+        if (!feed.open(regionName))
+        {
+            std::cerr << "Order feed test: cannot open " << regionName << " from the reader" << std::endl;
+            return 1;
+        }
+
+        FeedBook book{};
+        report.check(feed.findBook(BOOK_ID, book), "book missing from the directory");
+        report.check(book.instrumentId == INSTRUMENT_ID, "directory instrument " + std::to_string(book.instrumentId));
+        report.check(book.marketIdentificationCode == MIC, "directory market " + book.marketIdentificationCode);
+        report.check(book.tradingCurrency == CURRENCY, "directory currency " + book.tradingCurrency);
+        report.check(!feed.findBook(BOOK_ID + 1, book), "unregistered book found in the directory");
+
+        OrderFeed::Ring::Reader reader = feed.subscribeFromOldest();
+        L3Message message;
+        std::uint64_t previous = 0;
+        for (std::size_t i = 0; i < expected.size(); ++i)
+        {
+            std::string at = "message " + std::to_string(i) + ": ";
+            if (reader.poll(message) != ReadStatus::OK)
+            {
+                report.check(false, at + "not readable");
+                break;
+            }
+            report.check(i == 0 || message.sequence == previous + 1, at + "sequence gap");
+            previous = message.sequence;
+            report.check(message.type == static_cast<std::uint8_t>(expected[i].type), at + "type " +
+                  std::string(1, static_cast<char>(message.type)));
+            report.check(message.side == expected[i].side, at + "side");
+            report.check(message.orderId == expected[i].orderId, at + "order " + std::to_string(message.orderId));
+            report.check(message.quantity == expected[i].quantity, at + "quantity " + std::to_string(message.quantity));
+            report.check(message.timestamp == expected[i].timestamp, at + "timestamp not on the book clock");
+            report.check(message.bookId == BOOK_ID, at + "book " + std::to_string(message.bookId));
+            report.check(message.instrumentId == INSTRUMENT_ID, at + "instrument");
+        }
+        report.check(reader.poll(message) == ReadStatus::EMPTY, "more messages than published");
+        return report.getFailures() > 0 ? 1 : 0;
+    }
+}
+
+int main()
+{
+    NullBuffer discarded;
+    std::streambuf* console = std::cout.rdbuf(&discarded);
+
+    std::string regionName = "/matching_engine_l3_test_" + std::to_string(getpid());
+    OrderFeed feed;
+    if (!feed.create(regionName))
+    {
+        std::cout.rdbuf(console);
+        std::cerr << "Order feed test: cannot create " << regionName << std::endl;
+        return 1;
+    }
+    report.check(feed.registerBook(BOOK_ID, INSTRUMENT_ID, MIC, CURRENCY), "book not registered");
+
+    SimulatedClock clock;
+    auto start = std::chrono::system_clock::time_point(SESSION_START);
+    clock.set(start);
+    OrderBook book;
+    book.setClock(&clock);
+    book.setMarketDataPublisher(nullptr, INSTRUMENT_ID, BOOK_ID);
+    book.setOrderFeed(&feed);
+
+    // A resting bid, then an ask that takes 40 of it a millisecond later
+    book.addOrder(Order(1, MIC, CURRENCY, clock.now(), 100.0, 100, TimeInForce::DAY, OrderType::BID,
+                        LimitType::LIMIT, INSTRUMENT_ID, 100, 1));
+    auto restTime = clock.now();
+    clock.advance(std::chrono::milliseconds(1));
+    book.addOrder(Order(2, MIC, CURRENCY, clock.now(), 100.0, 40, TimeInForce::DAY, OrderType::ASK,
+                        LimitType::LIMIT, INSTRUMENT_ID, 40, 2));
+    book.matchOrders();
+    auto tradeTime = clock.now();
+
+    // An iceberg ask of 25 shown 10 at a time: each exhausted peak comes back as an add
+    clock.advance(std::chrono::milliseconds(1));
+    Order iceberg(3, MIC, CURRENCY, clock.now(), 100.0, 25, TimeInForce::DAY, OrderType::ASK, LimitType::LIMIT,
+                  INSTRUMENT_ID, 25, 2);
+    iceberg.setIcebergPeak(10);
+    book.addOrder(iceberg);
+    book.matchOrders();
+    auto icebergTime = clock.now();
+
+    std::vector<Expected> expected = {
+        {L3MessageType::ADD_ORDER, 'B', 1, 100, nanoseconds(restTime)},
+        {L3MessageType::ADD_ORDER, 'S', 2, 40, nanoseconds(tradeTime)},
+        {L3MessageType::EXECUTE_ORDER, 'B', 1, 40, nanoseconds(tradeTime)},
+        {L3MessageType::EXECUTE_ORDER, 'S', 2, 40, nanoseconds(tradeTime)},
+        {L3MessageType::ADD_ORDER, 'S', 3, 10, nanoseconds(icebergTime)},
+        {L3MessageType::EXECUTE_ORDER, 'B', 1, 10, nanoseconds(icebergTime)},
+        {L3MessageType::EXECUTE_ORDER, 'S', 3, 10, nanoseconds(icebergTime)},
+        {L3MessageType::ADD_ORDER, 'S', 3, 10, nanoseconds(icebergTime)},
+        {L3MessageType::EXECUTE_ORDER, 'B', 1, 10, nanoseconds(icebergTime)},
+        {L3MessageType::EXECUTE_ORDER, 'S', 3, 10, nanoseconds(icebergTime)},
+        {L3MessageType::ADD_ORDER, 'S', 3, 5, nanoseconds(icebergTime)},
+        {L3MessageType::EXECUTE_ORDER, 'B', 1, 5, nanoseconds(icebergTime)},
+        {L3MessageType::EXECUTE_ORDER, 'S', 3, 5, nanoseconds(icebergTime)},
+    };
+
+    std::cout.rdbuf(console);
+    std::cout.flush();
+
+    pid_t child = fork();
+    if (child < 0)
+    {
+        std::cerr << "Order feed test: fork failed" << std::endl;
+        return 1;
+    }
+    if (child == 0)
+    {
+        // _exit: the child must not unlink the region it inherited
+        _exit(readFeed(regionName, expected));
+    }
+
+    int status = 0;
+    waitpid(child, &status, 0);
+    report.check(WIFEXITED(status) && WEXITSTATUS(status) == 0, "reader process failed");
+
+    return report.finish();
+}
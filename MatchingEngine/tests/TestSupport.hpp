@@ -0,0 +1,94 @@
+/**
+ * @file TestSupport.hpp
+ * @brief Fixtures shared by the unit tests, benchmarks, fuzz harnesses and tools
+ *
+ * - SESSION_START, the simulated time every scenario starts from
+ * - NullBuffer, to silence the console logs of the engine and the books
+ * - TestReport, the failed checks of a test program; its finish()
+ *   returns a non-zero status when a check failed, for ctest
+ */
+
+#ifndef TESTSUPPORT_HPP
+#define TESTSUPPORT_HPP
+
+#include <chrono>
+#include <iostream>
+#include <streambuf>
+#include <string>
+#include <utility>
+
+/// Start of every simulated session: 2025-01-06 08:00:00 UTC
+constexpr std::chrono::seconds SESSION_START{1736150400};
+
+/**
+ * @class NullBuffer
+ * @brief Stream buffer that drops everything, for the engine's and books' logs
+ */
+class NullBuffer : public std::streambuf
+{
+protected:
+    int overflow(int c) override { return c; }
+    std::streamsize xsputn(const char*, std::streamsize count) override { return count; }
+};
+
+/**
+ * @class TestReport
+ * @brief Counts and reports the failed checks of one test program
+ */
+class TestReport
+{
+public:
+    /**
+     * @param testName Prefix of every report line, e.g. "Allocation test"
+     */
+    explicit TestReport(std::string testName) : name(std::move(testName))
+    {
+    }
+
+    /**
+     * @brief Records a failed check
+     */
+    void check(bool condition, const std::string& what)
+    {
+        if (!condition)
+        {
+            std::cerr << name << ": " << what << std::endl;
+            ++failures;
+        }
+    }
+
+    /**
+     * @brief Records a failed check of a named scenario
+     */
+    void check(bool condition, const std::string& scenario, const std::string& what)
+    {
+        check(condition, scenario + ": " + what);
+    }
+
+    /**
+     * @brief Returns the number of failed checks so far
+     */
+    int getFailures() const { return failures; }
+
+    /**
+     * @brief Prints the summary and returns the exit status of the program
+     *
+     * @return int 1 when a check failed, 0 otherwise
+     */
+    int finish() const
+    {
+        if (failures > 0)
+        {
+            std::cerr << name << ": " << failures << " checks failed" << std::endl;
+            return 1;
+        }
+        std::cout << name << ": all checks passed" << std::endl;
+        return 0;
+    }
+
+private:
+    std::string name; ///< Name of the test program
+    int failures = 0; ///< Failed checks
+};
+
+#endif // TESTSUPPORT_HPP
@@ -0,0 +1,94 @@
+/**
+ * @file FeedReader.cpp
+ * @brief Prints the Level 3 feed of a running engine, from another process
+ *
+ * Attaches read-only to the shared memory feed of MatchingEngineServer
+ * started with --l3-feed and prints one line per order event, with the
+ * instrument, market and currency of its book read from the feed
+ * directory. Reports the messages lost when it falls more than a ring
+ * behind. Stops on SIGINT or after the given number of messages.
+ *
+ * Usage: FeedReader [shared memory name] [messages]
+ */
+
+#include <signal.h>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstdio>
+#include <iostream>
+#include <map>
+#include <string>
+#include <thread>
+#include "OrderFeed.hpp"
+
+namespace
+{
+    /// Set by SIGINT and SIGTERM
+    volatile sig_atomic_t stopRequested = 0;
+
+    /// Pause between two polls of an empty ring
+    constexpr std::chrono::milliseconds IDLE_PAUSE{1};
+
+    void requestStop(int)
+    {
+        stopRequested = 1;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    std::string regionName = argc > 1 ? argv[1] : OrderFeed::DEFAULT_NAME;
+    long long limit = argc > 2 ? std::atoll(argv[2]) : 0;
+
+    OrderFeed feed;
+    if (!feed.open(regionName))
+    {
+        std::cerr << "Cannot open the Level 3 feed " << regionName << std::endl;
+        return 1;
+    }
+
+    signal(SIGINT, requestStop);
+    signal(SIGTERM, requestStop);
+
+    std::map<int, FeedBook> books;
+    OrderFeed::Ring::Reader reader = feed.subscribe();
+    L3Message message;
+    long long printed = 0;
+
+    while (!stopRequested && (limit <= 0 || printed < limit))
+    {
+        ReadStatus status = reader.poll(message);
+        if (status == ReadStatus::EMPTY)
+        {
+            std::this_thread::sleep_for(IDLE_PAUSE);
+            continue;
+        }
+        if (status == ReadStatus::OVERRUN)
+        {
+            std::cerr << "Overrun, " << reader.getDropped() << " messages lost so far" << std::endl;
+            continue;
+        }
+
+        // Books join the directory before their first event; look each up once
+        auto book = books.find(message.bookId);
+        if (book == books.end())
+        {
+            FeedBook entry{message.bookId, message.instrumentId, "?", "?"};
+            feed.findBook(message.bookId, entry);
+            book = books.emplace(message.bookId, entry).first;
+        }
+
+        std::printf("%llu %llu %c %c book %d (%d %s %s) order %d price %.2f qty %lld match %d\n",
+                    static_cast<unsigned long long>(message.sequence),
+                    static_cast<unsigned long long>(message.timestamp),
+                    message.type, message.side, message.bookId, book->second.instrumentId,
+                    book->second.marketIdentificationCode.c_str(), book->second.tradingCurrency.c_str(),
+                    message.orderId, message.price, static_cast<long long>(message.quantity), message.matchId);
+        printed++;
+    }
+
+    std::fflush(stdout);
+    std::cerr << "Read " << printed << " messages, " << reader.getDropped() << " lost" << std::endl;
+    return 0;
+}
@@ -0,0 +1,235 @@
+/**
+ * @file ProbeReport.cpp
+ * @brief Turns a probe dump into per-stage latency breakdowns and flame-style summaries
+ *
+ * Reads the text written by Probes::dump and prints:
+ * - per probe: count, inclusive p50/p99/max and mean, mean self time (the
+ *   probe minus its nested probes) and its share of all self time
+ * - a call tree of the probe stacks with their share of the time
+ * With an output path it also writes the stacks in folded format
+ * ("order_entry;book_match;fill_log <self ns>"), the input of
+ * flamegraph.pl and speedscope.
+ *
+ * Nesting is rebuilt per thread from the depth and timestamps of the
+ * records. When a ring wrapped, children whose parent was overwritten
+ * are reported under "[truncated]".
+ *
+ * Usage: ProbeReport <probe dump> [folded stacks output]
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+    /**
+     * @struct Span
+     * @brief One probe record with its place in the stack
+     */
+    struct Span
+    {
+        std::uint32_t thread; ///< Recording thread
+        std::uint16_t probe; ///< Probe identifier
+        std::uint16_t depth; ///< Open probes at entry
+        std::uint64_t begin; ///< Ticks at entry
+        std::uint64_t end; ///< Ticks at exit
+        std::uint64_t childTicks = 0; ///< Ticks spent in nested probes
+        std::string path; ///< Folded stack, outermost first
+    };
+
+    /**
+     * @struct ProbeSummary
+     * @brief Figures of one probe across every thread
+     */
+    struct ProbeSummary
+    {
+        std::vector<std::uint64_t> durations; ///< Inclusive ticks per record
+        std::uint64_t selfTicks = 0; ///< Ticks outside nested probes
+    };
+
+    /**
+     * @brief Links every span to its parent and fills in the paths and child times
+     */
+    void buildStacks(std::vector<Span>& spans, const std::vector<std::string>& names)
+    {
+        // Parents open before their children, and end after them on equal begin
+        std::sort(spans.begin(), spans.end(), [](const Span& a, const Span& b)
+        {
+            if (a.thread != b.thread)
+            {
+                return a.thread < b.thread;
+            }
+            if (a.begin != b.begin)
+            {
+                return a.begin < b.begin;
+            }
+            return a.depth < b.depth;
+        });
+
+        std::vector<std::size_t> stack;
+        std::uint32_t thread = 0;
+        for (std::size_t i = 0; i < spans.size(); ++i)
+        {
+            Span& span = spans[i];
+            if (i == 0 || span.thread != thread)
+            {
+                stack.clear();
+                thread = span.thread;
+            }
+            while (!stack.empty() && (stack.size() > span.depth || spans[stack.back()].end < span.begin))
+            {
+                stack.pop_back();
+            }
+
+            std::string name = span.probe < names.size() ? names[span.probe] : std::to_string(span.probe);
+            if (stack.empty())
+            {
+                span.path = span.depth == 0 ? name : "[truncated];" + name;
+            }
+            else
+            {
+                Span& parent = spans[stack.back()];
+                parent.childTicks += span.end - span.begin;
+                span.path = parent.path + ";" + name;
+            }
+            stack.push_back(i);
+        }
+    }
+
+    /**
+     * @brief Returns the value at a percentile of sorted durations
+     */
+    std::uint64_t percentile(const std::vector<std::uint64_t>& sorted, double p)
+    {
+        return sorted[static_cast<std::size_t>(p * static_cast<double>(sorted.size() - 1))];
+    }
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 2)
+    {
+        std::cerr << "Usage: ProbeReport <probe dump> [folded stacks output]" << std::endl;
+        return 2;
+    }
+    std::ifstream in(argv[1]);
+    if (!in)
+    {
+        std::cerr << "Cannot open " << argv[1] << std::endl;
+        return 1;
+    }
+
+    double ticksPerNs = 1.0;
+    std::vector<std::string> names;
+    std::vector<Span> spans;
+    std::string line;
+    while (std::getline(in, line))
+    {
+        std::istringstream fields(line);
+        std::string first;
+        fields >> first;
+        if (first == "ticks_per_ns")
+        {
+            fields >> ticksPerNs;
+        }
+        else if (first == "probe")
+        {
+            std::size_t id = 0;
+            std::string name;
+            fields >> id >> name;
+            names.resize(std::max(names.size(), id + 1));
+            names[id] = name;
+        }
+        else if (!first.empty())
+        {
+            Span span{};
+            span.thread = static_cast<std::uint32_t>(std::stoul(first));
+            fields >> span.probe >> span.depth >> span.begin >> span.end;
+            if (fields && span.end >= span.begin)
+            {
+                spans.push_back(span);
+            }
+        }
+    }
+    if (spans.empty())
+    {
+        std::cerr << "No probe record in " << argv[1] << std::endl;
+        return 1;
+    }
+    ticksPerNs = ticksPerNs > 0.0 ? ticksPerNs : 1.0;
+    auto toNs = [ticksPerNs](double ticks) { return static_cast<long long>(ticks / ticksPerNs); };
+
+    buildStacks(spans, names);
+
+    std::map<std::string, ProbeSummary> byProbe;
+    std::map<std::string, std::uint64_t> inclusiveByPath;
+    std::map<std::string, std::uint64_t> selfByPath;
+    std::uint64_t totalSelf = 0;
+    for (const Span& span : spans)
+    {
+        std::uint64_t duration = span.end - span.begin;
+        std::uint64_t self = duration > span.childTicks ? duration - span.childTicks : 0;
+        std::string name = span.path.substr(span.path.rfind(';') == std::string::npos ? 0 : span.path.rfind(';') + 1);
+        ProbeSummary& summary = byProbe[name];
+        summary.durations.push_back(duration);
+        summary.selfTicks += self;
+        inclusiveByPath[span.path] += duration;
+        selfByPath[span.path] += self;
+        totalSelf += self;
+    }
+
+    std::printf("%zu records, %.3f ticks/ns\n\n", spans.size(), ticksPerNs);
+    std::printf("%-15s %10s %10s %10s %10s %12s %10s %7s\n", "probe (ns)", "count", "mean", "p50", "p99", "max",
+                "self mean", "self %");
+    for (auto& [name, summary] : byProbe)
+    {
+        std::vector<std::uint64_t>& durations = summary.durations;
+        std::sort(durations.begin(), durations.end());
+        double sum = 0.0;
+        for (std::uint64_t duration : durations)
+        {
+            sum += static_cast<double>(duration);
+        }
+        double count = static_cast<double>(durations.size());
+        std::printf("%-15s %10zu %10lld %10lld %10lld %12lld %10lld %6.1f%%\n", name.c_str(), durations.size(),
+                    toNs(sum / count), toNs(static_cast<double>(percentile(durations, 0.50))),
+                    toNs(static_cast<double>(percentile(durations, 0.99))),
+                    toNs(static_cast<double>(durations.back())),
+                    toNs(static_cast<double>(summary.selfTicks) / count),
+                    totalSelf == 0 ? 0.0 : 100.0 * static_cast<double>(summary.selfTicks) / totalSelf);
+    }
+
+    // Paths sort with their children right after them, which reads as a tree
+    std::printf("\n%7s %7s  %s\n", "total %", "self %", "stack");
+    for (const auto& [path, inclusive] : inclusiveByPath)
+    {
+        std::size_t depth = static_cast<std::size_t>(std::count(path.begin(), path.end(), ';'));
+        std::string name = path.substr(path.rfind(';') == std::string::npos ? 0 : path.rfind(';') + 1);
+        std::printf("%6.1f%% %6.1f%%  %s%s\n", totalSelf == 0 ? 0.0 : 100.0 * static_cast<double>(inclusive) / totalSelf,
+                    totalSelf == 0 ? 0.0 : 100.0 * static_cast<double>(selfByPath[path]) / totalSelf,
+                    std::string(2 * depth, ' ').c_str(), name.c_str());
+    }
+
+    if (argc > 2)
+    {
+        std::ofstream folded(argv[2]);
+        if (!folded)
+        {
+            std::cerr << "Cannot write " << argv[2] << std::endl;
+            return 1;
+        }
+        for (const auto& [path, self] : selfByPath)
+        {
+            folded << path << " " << toNs(static_cast<double>(self)) << "\n";
+        }
+        std::printf("\nFolded stacks written to %s\n", argv[2]);
+    }
+    return 0;
+}
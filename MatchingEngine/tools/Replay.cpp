@@ -0,0 +1,265 @@
+/**
+ * @file Replay.cpp
+ * @brief Records synthetic order journals and replays journals deterministically
+ *
+ * record: runs an OrderFlowGenerator through an engine under a simulated
+ * clock starting on a fixed date, with the engine journaling every
+ * request. An hourly GTD sweep is journaled as the clock crosses each hour.
+ * Prints the digest of the recorded trades, which every replay reproduces.
+ * With a batch size above 1, consecutive new orders are submitted and
+ * journaled as batches of up to that many orders.
+ *
+ * run: replays a journal through a fresh engine per run as fast as
+ * possible, printing the replay throughput and the trade digest of each
+ * run. The exit status is 1 if two runs produced different trades.
+ * Optionally writes the trades of the last run as CSV.
+ *
+ * Usage: Replay record <instruments.csv> <journal> [events] [events/s] [cancel ratio] [seed] [batch size]
+ *        Replay run <instruments.csv> <journal> [runs] [trades.csv]
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <streambuf>
+#include <string>
+#include <vector>
+#include "Clock.hpp"
+#include "InstrumentManager.hpp"
+#include "MatchingEngine.hpp"
+#include "OrderFlowGenerator.hpp"
+#include "OrderJournal.hpp"
+#include "ReplayDriver.hpp"
+#include "TestSupport.hpp"
+
+namespace
+{
+    /// Market and currency of the instruments of the input file
+    const char* const DEFAULT_MIC = "XPAR";
+    const char* const DEFAULT_CURRENCY = "EUR";
+
+    void printUsage()
+    {
+        std::cerr << "Usage: Replay record <instruments.csv> <journal> [events] [events/s] [cancel ratio] [seed] "
+            "[batch size]\n"
+            "       Replay run <instruments.csv> <journal> [runs] [trades.csv]" << std::endl;
+    }
+
+    int record(InstrumentManager& instrumentManager, const char* path, int events, double rate,
+               double cancelRatio, std::uint64_t seed, std::size_t batchSize, std::uint64_t& tradeDigest)
+    {
+        std::ofstream out(path);
+        if (!out)
+        {
+            std::cerr << "Cannot write " << path << std::endl;
+            return 1;
+        }
+
+        OrderFlowConfig config;
+        config.ordersPerSecond = rate;
+        config.cancelRatio = cancelRatio;
+        config.seed = seed;
+        OrderFlowGenerator generator(instrumentManager.getInstruments(), config);
+        if (!generator.hasInstruments())
+        {
+            std::cerr << "No ACTIVE instrument to generate orders for" << std::endl;
+            return 1;
+        }
+
+        SimulatedClock clock;
+        OrderJournal journal(out);
+        MatchingEngine engine(instrumentManager);
+        engine.setClock(clock);
+        engine.setJournal(&journal);
+
+        std::vector<Order> batch;
+        auto flush = [&engine, &batch]
+        {
+            if (!batch.empty())
+            {
+                engine.submitBatch(batch);
+                batch.clear();
+            }
+        };
+
+        std::chrono::system_clock::time_point start(SESSION_START);
+        auto nextSweep = start + std::chrono::hours(1);
+        out << "# Synthetic flow: " << events << " events, " << rate << " events/s, cancel ratio " << cancelRatio
+            << ", seed " << seed << ", batch size " << batchSize << "\n";
+        for (int i = 0; i < events; ++i)
+        {
+            const OrderFlowEvent& event = generator.next();
+            auto now = start + std::chrono::duration_cast<std::chrono::system_clock::duration>(event.arrival);
+            if (now >= nextSweep || event.type != FlowEventType::NEW_ORDER)
+            {
+                flush();
+            }
+            while (now >= nextSweep)
+            {
+                clock.set(nextSweep);
+                engine.checkGTDOrders();
+                nextSweep += std::chrono::hours(1);
+            }
+            clock.set(now);
+            if (event.type == FlowEventType::NEW_ORDER)
+            {
+                Order order = event.order;
+                order.priority = now;
+                if (batchSize > 1)
+                {
+                    batch.push_back(order);
+                    if (batch.size() == batchSize)
+                    {
+                        flush();
+                    }
+                }
+                else
+                {
+                    engine.addAndValidateOrder(order);
+                }
+            }
+            else
+            {
+                MatchingEngine::InstrumentKey key(event.order.idinstrument, event.order.marketIdentificationCode,
+                                                  event.order.tradingCurrency);
+                engine.cancelOrder(key, event.order.idorder);
+            }
+        }
+        flush();
+        engine.setJournal(nullptr);
+        tradeDigest = ReplayDriver::digestTrades(engine);
+        return out ? 0 : 1;
+    }
+
+    void writeTrades(const MatchingEngine& engine, const char* path)
+    {
+        std::ofstream out(path);
+        out << "idinstrument,tradeid,buyorder,sellorder,buyfirm,sellfirm,price,quantity,timestamp_ns\n";
+        engine.forEachOrderBook([&out](const MatchingEngine::InstrumentKey& key, const OrderBook& book)
+        {
+            for (const Trade& trade : book.getTrades())
+            {
+                char price[32];
+                std::snprintf(price, sizeof(price), "%.17g", trade.price);
+                out << std::get<0>(key) << "," << trade.tradeId << "," << trade.buyOrderId << ","
+                    << trade.sellOrderId << "," << trade.buyFirmId << "," << trade.sellFirmId << "," << price << ","
+                    << trade.quantity << ","
+                    << std::chrono::duration_cast<std::chrono::nanoseconds>(trade.timestamp.time_since_epoch()).count()
+                    << "\n";
+            }
+        });
+    }
+
+    int run(InstrumentManager& instrumentManager, const char* path, int runs, const char* tradesPath)
+    {
+        std::uint64_t firstDigest = 0;
+        bool identical = true;
+        for (int r = 0; r < runs; ++r)
+        {
+            std::ifstream in(path);
+            if (!in)
+            {
+                std::cerr << "Cannot open " << path << std::endl;
+                return 1;
+            }
+
+            // The engine reports every order on stdout, which would dominate the replay
+            NullBuffer discarded;
+            std::streambuf* console = std::cout.rdbuf(&discarded);
+            MatchingEngine engine(instrumentManager);
+            SimulatedClock clock;
+            ReplayDriver driver(engine, clock);
+            OrderJournalReader journal(in);
+            ReplayResult result = driver.replay(journal);
+            std::cout.rdbuf(console);
+
+            if (result.errorLine != 0)
+            {
+                std::cerr << "Malformed journal line " << result.errorLine << " in " << path << std::endl;
+                return 1;
+            }
+            firstDigest = r == 0 ? result.tradeDigest : firstDigest;
+            identical = identical && result.tradeDigest == firstDigest;
+
+            std::printf("Run %d: %lld events in %.3f s, %lld events/s\n", r + 1, result.events,
+                        result.elapsedSeconds,
+                        static_cast<long long>(result.elapsedSeconds > 0.0 ? result.events / result.elapsedSeconds : 0));
+            std::printf("  new %lld (%lld accepted, %lld batches), cancel %lld (%lld found), "
+                        "amend %lld (%lld applied), sweeps %lld (%lld expired)\n", result.newOrders, result.accepted,
+                        result.batches, result.cancels, result.cancelled, result.amends, result.amended,
+                        result.expirySweeps, result.expired);
+            std::printf("  trades %lld, digest %016llx\n", result.trades,
+                        static_cast<unsigned long long>(result.tradeDigest));
+
+            if (tradesPath != nullptr && r == runs - 1)
+            {
+                writeTrades(engine, tradesPath);
+                std::printf("Trades written to %s\n", tradesPath);
+            }
+        }
+
+        if (!identical)
+        {
+            std::printf("Trades differ between runs\n");
+            return 1;
+        }
+        return 0;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 4)
+    {
+        printUsage();
+        return 2;
+    }
+    std::string mode = argv[1];
+
+    InstrumentManager instrumentManager;
+    if (instrumentManager.loadFromCsv(argv[2], DEFAULT_MIC, DEFAULT_CURRENCY) <= 0)
+    {
+        std::cerr << "No instrument loaded from " << argv[2] << std::endl;
+        return 1;
+    }
+
+    if (mode == "record")
+    {
+        int events = argc > 4 ? std::atoi(argv[4]) : 1000000;
+        double rate = argc > 5 ? std::atof(argv[5]) : 20000.0;
+        double cancelRatio = argc > 6 ? std::atof(argv[6]) : 0.3;
+        std::uint64_t seed = argc > 7 ? std::strtoull(argv[7], nullptr, 10) : 1;
+        int batchSize = argc > 8 ? std::atoi(argv[8]) : 1;
+        if (events <= 0 || rate <= 0.0 || cancelRatio < 0.0 || cancelRatio > 1.0 || batchSize <= 0)
+        {
+            std::cerr << "Invalid arguments" << std::endl;
+            return 2;
+        }
+        NullBuffer discarded;
+        std::streambuf* console = std::cout.rdbuf(&discarded);
+        std::uint64_t tradeDigest = 0;
+        int status = record(instrumentManager, argv[3], events, rate, cancelRatio, seed,
+                            static_cast<std::size_t>(batchSize), tradeDigest);
+        std::cout.rdbuf(console);
+        if (status == 0)
+        {
+            std::printf("Journal of %d events written to %s, trade digest %016llx\n", events, argv[3],
+                        static_cast<unsigned long long>(tradeDigest));
+        }
+        return status;
+    }
+    if (mode == "run")
+    {
+        int runs = argc > 4 ? std::atoi(argv[4]) : 2;
+        if (runs <= 0)
+        {
+            std::cerr << "Invalid arguments" << std::endl;
+            return 2;
+        }
+        return run(instrumentManager, argv[3], runs, argc > 5 ? argv[5] : nullptr);
+    }
+    printUsage();
+    return 2;
+}